@@ -0,0 +1,161 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include <SGL/SGL.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+
+// Usage: BatchRendererBenchmark [jobs] [resolution] [max workers]
+
+static constexpr uint32_t kTriangleCount = 4096;
+
+static const char* s_kVertexShaderSrc = R"(
+    #version 450 core
+    layout (location = 0) in vec2 vPos;
+    layout (location = 1) in vec3 vColor;
+    uniform float angle;
+    out vec3 fColor;
+    void main()
+    {
+        const float c = cos(angle), s = sin(angle);
+        fColor = vColor;
+        gl_Position = vec4(mat2(c, s, -s, c) * vPos, 0.0, 1.0);
+    };
+)";
+
+static const char* s_kFragmentShaderSrc = R"(
+    #version 450 core
+    in vec3 fColor;
+    out vec4 FragColor;
+    void main()
+    {
+        FragColor = vec4(fColor, 1.0);
+    };
+)";
+
+/** @brief Objects that cannot be shared between contexts, or are mutated */
+struct WorkerObjects
+{
+    std::shared_ptr<sgl::VertexArray> vertexArray;
+    std::shared_ptr<sgl::Shader> shader;
+};
+
+static std::shared_ptr<sgl::VertexBuffer> CreateScene()
+{
+    struct Vertex
+    {
+        float pos[2];
+        float color[3];
+    };
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<Vertex> vertices(kTriangleCount * 3);
+    for (auto& v : vertices)
+    {
+        v = { { unit(rng) * 2.0f - 1.0f, unit(rng) * 2.0f - 1.0f },
+              { unit(rng), unit(rng), unit(rng) } };
+    }
+
+    auto vbo = sgl::VertexBuffer::Create(vertices.data(),
+                                         vertices.size() * sizeof(Vertex));
+    vbo->SetLayout({
+        { sgl::ElementType::Float2, "Position" },
+        { sgl::ElementType::Float3, "Color" }
+    });
+    return vbo;
+}
+
+static double RunBatch(uint32_t workerCount, uint32_t jobCount,
+                       uint32_t resolution,
+                       const sgl::HeadlessContext* shared,
+                       const std::shared_ptr<sgl::VertexBuffer>& scene)
+{
+    std::vector<WorkerObjects> workers(workerCount);
+
+    sgl::BatchRenderer renderer(workerCount, shared,
+        [&](uint32_t i) {
+            // Shared VBO, per-worker VAO and program (uniforms are
+            //  program state, so a shared program would race)
+            workers[i].vertexArray = sgl::VertexArray::Create();
+            workers[i].vertexArray->AddVertexBuffer(scene);
+            workers[i].shader = sgl::Shader::Create({
+                sgl::ShaderObject::Create(sgl::ShaderStage::Vertex,
+                                          s_kVertexShaderSrc),
+                sgl::ShaderObject::Create(sgl::ShaderStage::Fragment,
+                                          s_kFragmentShaderSrc)
+            });
+        },
+        [&](uint32_t i) {
+            workers[i] = WorkerObjects();
+        });
+
+    std::vector<std::future<sgl::BatchResult>> results;
+    results.reserve(jobCount);
+
+    sgl::Timer timer;
+    for (uint32_t job = 0; job < jobCount; ++job)
+    {
+        const float kAngle = 0.01f * job;
+        results.push_back(renderer.Submit({ resolution, resolution,
+            [&workers, kAngle](uint32_t i) {
+                glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+
+                workers[i].shader->Use();
+                workers[i].shader->SetFloat("angle", kAngle);
+                workers[i].vertexArray->Bind();
+                glDrawArrays(GL_TRIANGLES, 0, kTriangleCount * 3);
+            }
+        }));
+    }
+
+    size_t checksum = 0;
+    for (auto& result : results)
+        checksum += result.get().pixels[0];
+
+    const double kSeconds = timer.ElapsedMicro() * 1e-6;
+    std::printf("%8u %10u %12.1f %10zu\n", workerCount, jobCount,
+                jobCount / kSeconds, checksum);
+
+    return jobCount / kSeconds;
+}
+
+int main(int argc, char** argv)
+{
+    sgl::Init();
+
+    const uint32_t kJobCount = argc > 1 ? std::atoi(argv[1]) : 256;
+    const uint32_t kResolution = argc > 2 ? std::atoi(argv[2]) : 256;
+    const uint32_t kMaxWorkers = argc > 3
+        ? std::atoi(argv[3])
+        : std::max(std::thread::hardware_concurrency(), 1u);
+
+    // Owns the context the scene is shared from
+    sgl::WindowData data("BatchRenderer", kResolution, kResolution);
+    data.backend = sgl::WindowBackend::Headless;
+    auto window = sgl::Window::Create(data);
+
+    const auto kScene = CreateScene();
+    glFinish();
+
+    std::printf("%8s %10s %12s %10s\n", "workers", "jobs", "jobs/s",
+                "checksum");
+
+    const double kBaseline = RunBatch(1, kJobCount, kResolution,
+                                      window->GetHeadlessContext(), kScene);
+    for (uint32_t workers = 2; workers <= kMaxWorkers; workers *= 2)
+    {
+        const double kRate = RunBatch(workers, kJobCount, kResolution,
+                                      window->GetHeadlessContext(), kScene);
+        std::printf("%8s speedup: %.2fx\n", "", kRate / kBaseline);
+    }
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include <SGL/SGL.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+
+
+// Usage: BlockCompressionBenchmark [image] [max workers]
+//  Without an image, a 2048x2048 RGBA pattern is compressed.
+
+static constexpr uint32_t kSyntheticSize = 2048;
+static constexpr uint32_t kRepeats = 3;
+
+static std::vector<unsigned char> CreatePattern()
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> noise(-12, 12);
+
+    // Gradients with noise, smooth areas and edges
+    std::vector<unsigned char> pixels(size_t(kSyntheticSize) * kSyntheticSize
+                                      * 4);
+    for (uint32_t y = 0; y < kSyntheticSize; ++y)
+    {
+        for (uint32_t x = 0; x < kSyntheticSize; ++x)
+        {
+            unsigned char* pixel = &pixels[(size_t(y) * kSyntheticSize + x)
+                                           * 4];
+            const bool kChecker = ((x >> 6) ^ (y >> 6)) & 1;
+            pixel[0] = static_cast<unsigned char>(std::clamp(
+                int(x >> 3) + noise(rng), 0, 255));
+            pixel[1] = static_cast<unsigned char>(std::clamp(
+                int(y >> 3) + noise(rng), 0, 255));
+            pixel[2] = kChecker ? 200 : 40;
+            pixel[3] = static_cast<unsigned char>((x + y) >> 4);
+        }
+    }
+    return pixels;
+}
+
+/** @return Megapixels per second, best of the repeats */
+static double Run(const unsigned char* pixels, uint32_t width,
+                  uint32_t height, uint32_t channels, uint32_t format,
+                  sgl::ThreadPool* pool)
+{
+    double best = 0.0;
+    for (uint32_t i = 0; i < kRepeats; ++i)
+    {
+        const sgl::Timer kTimer;
+        const sgl::CompressedImage kImage = sgl::CompressImage(
+            pixels, width, height, channels, format, pool);
+        const double kSeconds = kTimer.ElapsedNanos() * NANOS_TO_SECONDS;
+
+        SGL_ASSERT(kImage.Loaded());
+        best = std::max(best, width * double(height) * 1e-6 / kSeconds);
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    sgl::Init();
+
+    const uint32_t kMaxWorkers = argc > 2
+        ? std::atoi(argv[2])
+        : std::max(std::thread::hardware_concurrency(), 1u);
+
+    // Not copied, STBData frees its pixels
+    const sgl::STBData kImage = argc > 1 ? sgl::LoadImage(argv[1], 4)
+                                         : sgl::STBData();
+
+    std::vector<unsigned char> pattern;
+    const unsigned char* pixels = nullptr;
+    uint32_t width = kSyntheticSize;
+    uint32_t height = kSyntheticSize;
+    if (argc > 1)
+    {
+        SGL_ASSERT_MSG(kImage.Loaded(), "Could not load '{}'", argv[1]);
+        pixels = kImage.data;
+        width = static_cast<uint32_t>(kImage.width);
+        height = static_cast<uint32_t>(kImage.height);
+    }
+    else
+    {
+        pattern = CreatePattern();
+        pixels = pattern.data();
+    }
+
+    const uint32_t kFormats[] = {
+        GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+        GL_COMPRESSED_RED_RGTC1, GL_COMPRESSED_RG_RGTC2 };
+
+    std::printf("%ux%u, MPix/s\n%8s", width, height, "workers");
+    for (const uint32_t kFormat : kFormats)
+        std::printf(" %10s", sgl::GetCompressedFormatName(kFormat));
+    std::printf("\n");
+
+    for (uint32_t workers = 0; workers <= kMaxWorkers;
+         workers = std::max(workers * 2, 1u))
+    {
+        // 0 encodes on the calling thread
+        std::unique_ptr<sgl::ThreadPool> pool;
+        if (workers > 0)
+            pool = std::make_unique<sgl::ThreadPool>(workers);
+
+        std::printf("%8u", workers);
+        for (const uint32_t kFormat : kFormats)
+        {
+            std::printf(" %10.1f", Run(pixels, width, height, 4, kFormat,
+                                       pool.get()));
+        }
+        std::printf("\n");
+    }
+
+    // A miss decodes and compresses, a hit only reads the entry
+    if (argc > 1)
+    {
+        const std::string kDirectory = "BlockCompressionCache";
+        std::filesystem::remove_all(kDirectory);
+        sgl::CompressionCache cache(kDirectory);
+
+        for (const char* kCase : { "miss", "hit" })
+        {
+            const sgl::Timer kTimer;
+            const sgl::CompressedImage kImage = cache.Load(
+                argv[1], GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+            SGL_ASSERT(kImage.Loaded());
+            std::printf("cache %-4s %8.2f ms\n", kCase,
+                        kTimer.ElapsedMillis());
+        }
+
+        std::filesystem::remove_all(kDirectory);
+    }
+
+    return 0;
+}
@@ -0,0 +1,28 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+// Compiled into each executable with its SGL_ACTIVE_LEVEL_CORE, the
+// benchmark files belong to the core module
+
+#include <SGL/core/Log.h>
+
+#include "LogCalls.h"
+
+
+/** @brief A typical small method, not inlined into the loop */
+[[gnu::noinline]] static uint64_t TracedMethod(uint64_t value)
+{
+    SGL_FUNCTION();
+    SGL_LOG_DEBUG("Value {}", value);
+    return value * 3 + 1;
+}
+
+uint64_t TracedCalls(uint32_t iterations)
+{
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < iterations; ++i)
+        sum += TracedMethod(i);
+    return sum;
+}
@@ -0,0 +1,15 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#pragma once
+
+#include <cstdint>
+
+
+// Each level is built as its own executable, all the files of a program
+// must be compiled with the same levels
+
+/** @brief Calls a function with SGL_FUNCTION and SGL_LOG_DEBUG in it */
+uint64_t TracedCalls(uint32_t iterations);
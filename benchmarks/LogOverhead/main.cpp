@@ -0,0 +1,79 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include <SGL/SGL.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "LogCalls.h"
+
+
+// Usage: LogOverheadBenchmarkCompiledOut [iterations] > /dev/null
+//        LogOverheadBenchmarkCompiledIn [iterations] > /dev/null
+// Results go to stderr, the enabled traces to stdout
+
+// SGL_LOG_DEBUG of the benchmark files is compiled in, set per executable
+#define COMPILED_IN (SGL_ACTIVE_LEVEL_CORE <= SGL_LEVEL_DEBUG)
+
+static volatile uint64_t s_Sink = 0;
+
+/** @return Nanoseconds per call */
+static double Measure(uint32_t iterations)
+{
+    TracedCalls(iterations / 10 + 1);  // Warm-up
+
+    const auto kStart = std::chrono::steady_clock::now();
+    s_Sink = s_Sink + TracedCalls(iterations);
+    const auto kEnd = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(kEnd - kStart).count()
+           / iterations;
+}
+
+int main(int argc, char** argv)
+{
+    sgl::Init();
+
+    const uint32_t kIterations = argc > 1 ? std::atoi(argv[1]) : 10000000;
+
+    sgl::Log::SetLevel(SGL_LEVEL_OFF);
+    const double kDisabled = Measure(kIterations);
+
+#if COMPILED_IN
+    // Every call prints two messages when enabled
+    const uint32_t kEnabledIterations = std::max(kIterations / 1000, 1u);
+
+    // In bursts below half the queue, which would wake the drain thread
+    sgl::Log::SetLevel(SGL_LEVEL_TRACE);
+    const uint32_t kBurst = sgl::Log::QueueCapacity / 8;
+    double enqueued = 0.0;
+    uint32_t bursts = 0;
+    for (uint32_t i = 0; i < kEnabledIterations; i += kBurst, ++bursts)
+    {
+        enqueued += Measure(kBurst);
+        sgl::Log::Flush();
+    }
+    const double kEnqueued = enqueued / bursts;
+
+    std::fprintf(stderr,
+                 "SGL_FUNCTION + SGL_LOG_DEBUG per call:\n"
+                 "  compiled in, filtered at runtime   %8.2f ns\n"
+                 "  compiled in, enqueued              %8.2f ns\n"
+                 "  dropped, queue full                %8llu\n",
+                 kDisabled, kEnqueued,
+                 static_cast<unsigned long long>(
+                     sgl::Log::GetDroppedCount()));
+#else
+    std::fprintf(stderr,
+                 "SGL_FUNCTION + SGL_LOG_DEBUG per call:\n"
+                 "  compiled out (level INFO)          %8.2f ns\n",
+                 kDisabled);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,204 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include <SGL/SGL.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+
+// Usage: TextureArrayBenchmark [quads] [materials] [frames]
+
+static constexpr uint32_t kTextureSize = 64;
+static constexpr uint32_t kResolution = 512;
+
+static const char* s_kVertexShaderSrc = R"(
+    #version 450 core
+    layout (location = 0) in vec2 vPos;
+    layout (location = 1) in vec2 vUV;
+    layout (location = 2) in float vLayer;
+    out vec3 fUV;
+    void main()
+    {
+        fUV = vec3(vUV, vLayer);
+        gl_Position = vec4(vPos, 0.0, 1.0);
+    };
+)";
+
+static const char* s_kFragmentShaderSrc = R"(
+    #version 450 core
+    layout (binding = 0) uniform sampler2D tex;
+    in vec3 fUV;
+    out vec4 FragColor;
+    void main()
+    {
+        FragColor = texture(tex, fUV.xy);
+    };
+)";
+
+static const char* s_kArrayFragmentShaderSrc = R"(
+    #version 450 core
+    layout (binding = 0) uniform sampler2DArray tex;
+    in vec3 fUV;
+    out vec4 FragColor;
+    void main()
+    {
+        FragColor = texture(tex, fUV);
+    };
+)";
+
+/** @brief Mirrors the command of "glMultiDrawArraysIndirect" */
+struct DrawArraysCommand
+{
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t first;
+    uint32_t baseInstance;
+};
+
+static std::shared_ptr<sgl::Shader> CreateShader(const char* fragmentSrc)
+{
+    return sgl::Shader::Create({
+        sgl::ShaderObject::Create(sgl::ShaderStage::Vertex,
+                                  s_kVertexShaderSrc),
+        sgl::ShaderObject::Create(sgl::ShaderStage::Fragment, fragmentSrc)
+    });
+}
+
+/** @return Milliseconds per frame, drawn by "draw" after a clear */
+template<typename t_Draw>
+static double Run(uint32_t frameCount, const t_Draw& draw)
+{
+    // Warm up, the driver compiles the state on the first draw
+    draw();
+    glFinish();
+
+    const sgl::Timer kTimer;
+    for (uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        glClear(GL_COLOR_BUFFER_BIT);
+        draw();
+    }
+    glFinish();
+
+    return kTimer.ElapsedNanos() * NANOS_TO_SECONDS * 1e3 / frameCount;
+}
+
+int main(int argc, char** argv)
+{
+    sgl::Init();
+
+    const uint32_t kQuadCount = argc > 1 ? std::atoi(argv[1]) : 4096;
+    const uint32_t kMaterialCount = argc > 2 ? std::atoi(argv[2]) : 256;
+    const uint32_t kFrameCount = argc > 3 ? std::atoi(argv[3]) : 50;
+
+    sgl::WindowData data("TextureArray", kResolution, kResolution);
+    data.backend = sgl::WindowBackend::Headless;
+    auto window = sgl::Window::Create(data);
+
+    // A texture per material, and the same images as layers of an array
+    std::mt19937 rng(42);
+    std::vector<unsigned char> pixels(kTextureSize * kTextureSize * 4);
+    std::vector<std::shared_ptr<sgl::Texture2D>> textures;
+    auto array = sgl::Texture2DArray::Create(kTextureSize, kTextureSize,
+                                             kMaterialCount, GL_RGBA8,
+                                             GL_RGBA, 0);
+    for (uint32_t i = 0; i < kMaterialCount; ++i)
+    {
+        for (auto& value : pixels)
+            value = static_cast<unsigned char>(rng());
+
+        textures.push_back(sgl::Texture2D::Create(kTextureSize, kTextureSize,
+                                                  pixels.data(), GL_RGBA8,
+                                                  GL_RGBA, true));
+
+        const uint32_t kLayer = array->AllocateLayer();
+        array->UpdateLayer(kLayer, pixels.data());
+        array->GenLayerMipMaps(kLayer);
+    }
+
+    struct Vertex
+    {
+        float pos[2];
+        float uv[2];
+    };
+
+    // Strips of 4 vertices, a quad of 1 to 4% of the screen each
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<Vertex> vertices;
+    std::vector<float> layers;
+    std::vector<DrawArraysCommand> commands;
+    for (uint32_t i = 0; i < kQuadCount; ++i)
+    {
+        const float kX = unit(rng) * 1.8f - 1.0f;
+        const float kY = unit(rng) * 1.8f - 1.0f;
+        const float kSize = 0.2f + unit(rng) * 0.2f;
+        vertices.push_back({ { kX, kY }, { 0.0f, 0.0f } });
+        vertices.push_back({ { kX + kSize, kY }, { 1.0f, 0.0f } });
+        vertices.push_back({ { kX, kY + kSize }, { 0.0f, 1.0f } });
+        vertices.push_back({ { kX + kSize, kY + kSize }, { 1.0f, 1.0f } });
+
+        // The base instance picks the layer of the draw
+        layers.push_back(static_cast<float>(i % kMaterialCount));
+        commands.push_back({ 4, 1, 4 * i, i });
+    }
+
+    auto vertexBuffer = sgl::VertexBuffer::Create(
+        vertices.data(), vertices.size() * sizeof(Vertex));
+    vertexBuffer->SetLayout({
+        { sgl::ElementType::Float2, "Position" },
+        { sgl::ElementType::Float2, "UV" }
+    });
+    auto layerBuffer = sgl::VertexBuffer::Create(
+        layers.data(), layers.size() * sizeof(float));
+    layerBuffer->SetLayout({ { sgl::ElementType::Float, "Layer" } });
+
+    auto vertexArray = sgl::VertexArray::Create();
+    vertexArray->AddVertexBuffer(vertexBuffer);
+    vertexArray->AddVertexBuffer(layerBuffer, true);
+
+    GLuint commandBuffer = 0;
+    glCreateBuffers(1, &commandBuffer);
+    glNamedBufferStorage(commandBuffer,
+                         commands.size() * sizeof(DrawArraysCommand),
+                         commands.data(), 0);
+
+    auto shader = CreateShader(s_kFragmentShaderSrc);
+    auto arrayShader = CreateShader(s_kArrayFragmentShaderSrc);
+
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    vertexArray->Bind();
+
+    const double kSeparate = Run(kFrameCount, [&]() {
+        shader->Use();
+        for (uint32_t i = 0; i < kQuadCount; ++i)
+        {
+            textures[i % kMaterialCount]->BindUnit(0);
+            glDrawArrays(GL_TRIANGLE_STRIP, 4 * i, 4);
+        }
+    });
+
+    const double kArray = Run(kFrameCount, [&]() {
+        arrayShader->Use();
+        array->BindUnit(0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glMultiDrawArraysIndirect(GL_TRIANGLE_STRIP, nullptr, kQuadCount, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    });
+
+    glDeleteBuffers(1, &commandBuffer);
+
+    std::printf("%u quads, %u materials of %ux%u, %u frames\n", kQuadCount,
+                kMaterialCount, kTextureSize, kTextureSize, kFrameCount);
+    std::printf("%-28s %10s %8s\n", "", "ms/frame", "calls");
+    std::printf("%-28s %10.3f %8u\n", "Texture2D, bind + draw", kSeparate,
+                kQuadCount * 2);
+    std::printf("%-28s %10.3f %8u\n", "Texture2DArray, multi-draw", kArray,
+                3u);
+    std::printf("speedup: %.2fx\n", kSeparate / kArray);
+
+    return 0;
+}
@@ -120,5 +120,5 @@ void HelloTriangle::Render()
     const uint32_t kAttribCount = 2 * 3;
     const uint32_t kVertexCount = s_kVerticesColors.size() / kAttribCount;
 
-    glDrawArrays(GL_TRIANGLES, 0, kVertexCount);
+    sgl::VertexArray::DrawArrays(GL_TRIANGLES, 0, kVertexCount);
 }
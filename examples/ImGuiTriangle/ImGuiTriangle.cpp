@@ -104,6 +104,9 @@ void ImGuiTriangle::Start()
 {
     SetupPreRenderStates();
 
+    sgl::GpuProfiler::Get().Enable(true);
+    ShowPerfOverlay(true);
+
     m_Window->SetWindowSizeCallback(ImGuiTriangle::OnResize);
 }
 
@@ -114,17 +117,40 @@ void ImGuiTriangle::Update(float dt)
 
 void ImGuiTriangle::Render()
 {
+    SGL_GPU_SCOPE("Triangle");
+
     glClear(GL_COLOR_BUFFER_BIT);
 
     // sizeof(verticesColors) / (sizeof(float) * 6)
     const uint32_t kAttribCount = 2 * 3;
     const uint32_t kVertexCount = s_kVerticesColors.size() / kAttribCount;
 
-    glDrawArrays(GL_TRIANGLES, 0, kVertexCount);
+    sgl::VertexArray::DrawArrays(GL_TRIANGLES, 0, kVertexCount);
 }
 
 void ImGuiTriangle::OnImGuiRender()
 {
     static bool showDemoWindow = true;
     ImGui::ShowDemoWindow(&showDemoWindow);
+
+    ImGui::Begin("Frame pacing");
+    {
+        static float targetFps = GetTargetFrameRate();
+        if (ImGui::SliderFloat("Target FPS", &targetFps, 0.0f, 240.0f))
+            SetTargetFrameRate(targetFps);
+
+        const auto& kStats = GetFramePacingStats();
+        ImGui::Text("Mean interval: %.3f ms", kStats.MeanInterval().Millis());
+        ImGui::Text("Jitter:        %.3f ms", kStats.Jitter().Millis());
+        ImGui::Text("Max error:     %.3f ms", kStats.MaxError().Millis());
+
+        ImGui::Separator();
+        ImGui::Text("GPU time, average (max):");
+        for (const auto& kScope : sgl::GpuProfiler::Get().GetScopes())
+        {
+            ImGui::Text("%*s%-10s %.3f (%.3f) ms", kScope.depth * 2, "",
+                        kScope.name.c_str(), kScope.average, kScope.max);
+        }
+    }
+    ImGui::End();
 }
\ No newline at end of file
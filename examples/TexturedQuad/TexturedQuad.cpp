@@ -114,14 +114,23 @@ void TexturedQuad::CreateShaders()
 
 void TexturedQuad::CreateTextures()
 {
-    const int kForceRGBA = 4;
-    auto data = sgl::LoadImage(s_kTextureName, kForceRGBA);
-
-    SGL_ASSERT_MSG(data.Loaded(), "Texture loaded: {}", bool(data));
+    m_TextureLoader = sgl::TextureLoader::Create();
+
+    // Decoded on the loader workers, a placeholder is shown meanwhile
+    sgl::TextureLoadOptions options;
+    options.components = 4;
+    options.mipmaps = true;
+    options.onLoaded = [](const std::shared_ptr<sgl::Texture2D>& texture,
+                          bool loaded) {
+        SGL_ASSERT_MSG(loaded, "Texture loaded: {}", loaded);
+        if (loaded)
+        {
+            SGL_LOG_INFO("Texture loaded: {}x{}", texture->GetWidth(),
+                         texture->GetHeight());
+        }
+    };
 
-    // TODO format based on component count and type
-    m_Texture = sgl::Texture2D::Create(data.width, data.height, data.data,
-                                       GL_RGBA8, GL_RGBA, true);
+    m_Texture = m_TextureLoader->LoadAsync(s_kTextureName, options);
 }
 
 void TexturedQuad::SetupPreRenderStates()
@@ -138,7 +147,6 @@ void TexturedQuad::SetupPreRenderStates()
     m_Shader->SetMat4("model", m_Model);
 
     m_VertexArray->Bind();
-    m_Texture->BindUnit(1);
 }
 
 void TexturedQuad::OnResize(GLFWwindow* window, int width, int height)
@@ -172,9 +180,13 @@ void TexturedQuad::Render()
 {
     glClear(GL_COLOR_BUFFER_BIT);
 
+    // Publishes the texture once decoded, its ID changes then
+    m_TextureLoader->Update();
+    m_Texture->BindUnit(1);
+
     m_Shader->SetMat4("model", m_Model);
 
-    glDrawElements(GL_TRIANGLES,
-                   m_IndexBuffer->GetIndicesCount(),
-                   m_IndexBuffer->GetIndexType(), 0);
+    sgl::VertexArray::DrawElements(GL_TRIANGLES,
+                                   m_IndexBuffer->GetIndicesCount(),
+                                   m_IndexBuffer->GetIndexType());
 }
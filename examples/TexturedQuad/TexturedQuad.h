@@ -63,5 +63,6 @@ private:
     glm::mat4 m_Model{ 1.0 };
 
     static inline const char* s_kTextureName = "textures/texture.jpg";
+    std::shared_ptr<sgl::TextureLoader> m_TextureLoader{ nullptr };
     std::shared_ptr<sgl::Texture2D> m_Texture{ nullptr };
 };
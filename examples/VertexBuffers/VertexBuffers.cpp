@@ -172,13 +172,13 @@ void VertexBuffers::Render()
     const uint32_t kAttribCount = 3;
     const uint32_t kVertexCount = s_kDiamondPositions.size() / kAttribCount;
 
-    glDrawArrays(GL_TRIANGLES, 0, kVertexCount );
+    sgl::VertexArray::DrawArrays(GL_TRIANGLES, 0, kVertexCount);
 
     m_SquareVAO->Bind();
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    sgl::VertexArray::DrawArrays(GL_TRIANGLES, 0, 6);
 
     m_TriangleVAO->Bind();
 
-    glDrawArrays(GL_TRIANGLES, 0, 3);
+    sgl::VertexArray::DrawArrays(GL_TRIANGLES, 0, 3);
 }
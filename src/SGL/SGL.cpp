@@ -6,26 +6,39 @@
 #include "SGL/pch.h"
 #include "SGL/SGL.h"
 
+#include <cstdlib>
+#include <cstring>
+
 
 namespace sgl
 {
     // -------------------------------------------------------------------------
     // Function prototypes
 
-    void InitLogging();
+    void InitLogging(const LogSpec& logSpec);
+    void InitClock();
 
     // -------------------------------------------------------------------------
     
-    void Init()
+    void Init(const LogSpec& logSpec)
     {
-        InitLogging();
+        InitLogging(logSpec);
+        InitClock();
     }
 
-    void InitLogging()
+    void InitLogging(const LogSpec& logSpec)
     {
-        sgl::Log::Init();
+        sgl::Log::Init(logSpec);
         SGL_FUNCTION();
     }
 
+    void InitClock()
+    {
+        // Opt-in, the calibration blocks for a few milliseconds
+        const char* kUseTSC = std::getenv("SGL_USE_TSC");
+        if (kUseTSC != nullptr && std::strcmp(kUseTSC, "1") == 0)
+            Clock::EnableTSC();
+    }
+
 
 } // namespace sgl
\ No newline at end of file
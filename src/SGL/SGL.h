@@ -14,8 +14,22 @@
 #include "SGL/core/Log.h"
 #include "SGL/core/Assert.h"
 #include "SGL/core/Utils.h"
+#include "SGL/core/MappedFile.h"
+#include "SGL/core/IoQueue.h"
 #include "SGL/core/Window.h"
 #include "SGL/core/Application.h"
+#include "SGL/core/HeadlessContext.h"
+#include "SGL/core/BatchRenderer.h"
+#include "SGL/core/ThreadPool.h"
+#include "SGL/core/FrameCapture.h"
+#include "SGL/core/GpuProfiler.h"
+#include "SGL/core/Profiler.h"
+#include "SGL/core/RenderStats.h"
+#include "SGL/core/PerfOverlay.h"
+#include "SGL/core/Clock.h"
+#include "SGL/core/FrameStats.h"
+#include "SGL/core/HitchDetector.h"
+#include "SGL/core/Hash.h"
 
 #include "SGL/opengl/VertexBuffer.h"
 #include "SGL/opengl/IndexBuffer.h"
@@ -24,13 +38,31 @@
 #include "SGL/opengl/ShaderObject.h"
 #include "SGL/opengl/Shader.h"
 
+#include "SGL/opengl/CompressedFormat.h"
 #include "SGL/opengl/Texture2D.h"
+#include "SGL/opengl/Texture2DArray.h"
 #include "SGL/opengl/CubeMapTexture.h"
 
+#include "SGL/opengl/Renderbuffer.h"
+#include "SGL/opengl/Framebuffer.h"
+#include "SGL/opengl/ReadbackQueue.h"
+#include "SGL/opengl/StagingRing.h"
+#include "SGL/opengl/TextureLoader.h"
+#include "SGL/opengl/TextureStreamer.h"
+#include "SGL/opengl/TextureCache.h"
+#include "SGL/opengl/TextureAtlas.h"
+
+#include "SGL/image/ImageWriter.h"
+#include "SGL/image/CompressedImage.h"
+#include "SGL/image/MipChain.h"
+#include "SGL/image/BlockCompressor.h"
+#include "SGL/image/CompressionCache.h"
+
 
 namespace sgl
 {
-    void Init();
+    /** @param logSpec Log file and queue overflow policy */
+    void Init(const LogSpec& logSpec = LogSpec());
 
 } // namespace sgl
 
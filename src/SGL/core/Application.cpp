@@ -5,10 +5,20 @@
 
 #include "SGL/pch.h"
 #include "SGL/core/Application.h"
+#include "SGL/opengl/Framebuffer.h"
 
 
 namespace sgl
 {
+    /**
+     * @brief Frames rendered after each event in the "OnDemand" mode,
+     *  ImGui needs a few frames for the widgets to settle
+     */
+    static constexpr uint32_t kFramesPerEvent = 3;
+
+    /** @brief Max sleep time between checks, in seconds */
+    static constexpr double kMaxIdleWait = 0.5;
+
     Application::Application()
     {
         SGL_FUNCTION();
@@ -20,6 +30,78 @@ namespace sgl
     Application::~Application()
     {
         SGL_FUNCTION();
+
+        // Queries and pooled attachments belong to the context of the
+        //  window, it is destroyed with the window after this
+        GpuProfiler::Get().Reset();
+        AttachmentPool::Get().Clear();
+    }
+
+    void Application::SetLowLatencyMode(bool enabled, uint32_t framesInFlight,
+                                        bool lateStart)
+    {
+        SGL_FUNCTION();
+
+        m_LatencyLimiter.SetFramesInFlight(framesInFlight);
+        m_LatencyLimiter.SetLateStart(lateStart, m_Window->GetRefreshRate());
+        m_LatencyLimiter.Enable(enabled);
+    }
+
+    void Application::RequestRedraw()
+    {
+        m_RedrawRequested.store(true, std::memory_order_release);
+        Window::PostEmptyEvent();
+    }
+
+    void Application::StartAnimation(float duration)
+    {
+        SGL_FUNCTION();
+        m_AnimationEnd = std::max(m_AnimationEnd,
+                                  m_StartTimer.Elapsed() + duration);
+    }
+
+    uint64_t Application::WaitForRedraw()
+    {
+        m_Window->PollEvents();
+
+        const uint64_t kFrameEnd = Clock::Now();
+
+        bool waited = false;
+        while (!NeedsRedraw() && m_Window->IsOpen())
+        {
+            m_Window->WaitEvents(kMaxIdleWait);
+            waited = true;
+        }
+
+        // Do not report the idle time as the frame time
+        if (waited)
+        {
+            m_FrameTimer.Start();
+            return kFrameEnd;
+        }
+
+        return Clock::Now();
+    }
+
+    bool Application::NeedsRedraw()
+    {
+        const uint64_t kEventCount = m_Window->GetEventCount();
+        if (kEventCount != m_LastEventCount)
+        {
+            m_LastEventCount = kEventCount;
+            m_PendingFrames = kFramesPerEvent;
+        }
+
+        if (m_RedrawRequested.exchange(false, std::memory_order_acq_rel))
+            m_PendingFrames = std::max(m_PendingFrames, 1u);
+
+        if (m_PendingFrames > 0)
+        {
+            --m_PendingFrames;
+            return true;
+        }
+
+        return m_StartTimer.Elapsed() < m_AnimationEnd;
     }
 
 #if 0
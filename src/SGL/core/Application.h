@@ -6,9 +6,19 @@
 #ifndef SGL_CORE_APPLICATION_H_
 #define SGL_CORE_APPLICATION_H_
 
+#include <atomic>
+
 #include "SGL/core/Window.h"
 #include "SGL/core/Timer.h"
 #include "SGL/core/Timestep.h"
+#include "SGL/core/LatencyLimiter.h"
+#include "SGL/core/FrameLimiter.h"
+#include "SGL/core/GpuProfiler.h"
+#include "SGL/core/Profiler.h"
+#include "SGL/core/FrameStats.h"
+#include "SGL/core/HitchDetector.h"
+#include "SGL/core/PerfOverlay.h"
+#include "SGL/core/RenderStats.h"
 
 #ifdef SGL_USE_IMGUI
     #include <imgui/imgui.h>
@@ -18,7 +28,7 @@
 
     #define START_IMGUI_FRAME() do {    \
         ImGui_ImplOpenGL3_NewFrame();   \
-        ImGui_ImplGlfw_NewFrame();      \
+        NewImGuiPlatformFrame();        \
         ImGui::NewFrame();              \
     } while(0)
 
@@ -34,6 +44,13 @@
 
 namespace sgl
 {
+    enum class RenderMode
+    {
+        Continuous = 0, ///< Renders each frame, as fast as pacing allows
+        OnDemand        ///< Renders only on events, redraw requests and
+                        ///  active animations, sleeps otherwise
+    };
+
     /**
      * @brief Derive this class for convenience
      */
@@ -49,6 +66,87 @@ namespace sgl
             Init();
             Loop();
         }
+
+        /**
+         * @brief Limits the frames queued ahead of the GPU to reduce the
+         *  input-to-present latency
+         * @param framesInFlight Max frames queued, 1 waits for the previous
+         *  frame to be done before sampling input
+         * @param lateStart Sleeps to start each frame as late as possible
+         *  before the next refresh, useful with VSync and 1 frame in flight
+         */
+        void SetLowLatencyMode(bool enabled,
+                               uint32_t framesInFlight = 1,
+                               bool lateStart = false);
+
+        void SetRenderMode(RenderMode mode) { m_RenderMode = mode; }
+        RenderMode GetRenderMode() const { return m_RenderMode; }
+
+        /**
+         * @brief Renders the next frame in the "OnDemand" render mode,
+         *  may be called from any thread
+         */
+        void RequestRedraw();
+
+        /**
+         * @brief Keeps rendering each frame in the "OnDemand" render mode,
+         *  until the duration elapses
+         * @param duration In seconds
+         */
+        void StartAnimation(float duration);
+
+        /**
+         * @brief Caps the frame rate, sleeping instead of busy-waiting.
+         *  Useful with VSync off, or to go below the refresh rate.
+         * @param fps Frames per second, 0 means unlimited
+         */
+        void SetTargetFrameRate(float fps) {
+            m_FrameLimiter.SetTargetFrameRate(fps);
+        }
+        float GetTargetFrameRate() const {
+            return m_FrameLimiter.GetTargetFrameRate();
+        }
+        /** @return Frame pacing jitter statistics of the frame limiter */
+        const FrameLimiter::Stats& GetFramePacingStats() const {
+            return m_FrameLimiter.GetStats();
+        }
+
+        /**
+         * @brief Shows the performance HUD in the ImGui frame. Frames are
+         *  recorded while hidden too, so the graphs are full when shown.
+         */
+        void ShowPerfOverlay(bool visible) {
+            m_PerfOverlay.SetVisible(visible);
+        }
+        bool IsPerfOverlayVisible() const {
+            return m_PerfOverlay.IsVisible();
+        }
+        /** @return Render counters of the last frame of the main thread */
+        const RenderStats& GetRenderStats() const {
+            return m_PerfOverlay.GetLastStats();
+        }
+
+        /** @return Rolling frame, update and render times */
+        const FrameStats& GetFrameStats() const { return m_FrameStats; }
+
+        /**
+         * @brief Writes a trace of the last frames when a frame goes over
+         *  the budget, see "HitchSpec"
+         */
+        void EnableHitchDetector(const HitchSpec& spec = HitchSpec()) {
+            m_HitchDetector.Enable(spec);
+        }
+        void DisableHitchDetector() { m_HitchDetector.Disable(); }
+        HitchDetector& GetHitchDetector() { return m_HitchDetector; }
+
+        /** @return Last measured time from input sampling to present */
+        Timestep GetInputLatency() const {
+            return m_LatencyLimiter.GetInputLatency();
+        }
+        /** @return Smoothed time from input sampling to present */
+        Timestep GetAverageInputLatency() const {
+            return m_LatencyLimiter.GetAverageInputLatency();
+        }
     
     protected:
         /** @brief Called once in "Run" function, before the main loop */
@@ -76,7 +174,15 @@ namespace sgl
     private:
     #ifndef SGL_USE_IMGUI
         void CreateImGuiContext() {}
+        void DrawPerfOverlay() {}
     #else
+        /** @brief Costs a branch while hidden */
+        void DrawPerfOverlay()
+        {
+            if (m_PerfOverlay.IsVisible())
+                m_PerfOverlay.Draw(m_FrameStats);
+        }
+
         /**
          * Creates ImGui Context AFTER glfw has been initialized, that is
          *  after the window has been created
@@ -96,8 +202,9 @@ namespace sgl
         ImGui::StyleColorsDark();
         //ImGui::StyleColorsLight();
 
-        // Setup Platform/Renderer backends
-        ImGui_ImplGlfw_InitForOpenGL(m_Window->GetGLFWWindow(), true);
+        // Setup Platform/Renderer backends, headless has no platform
+        if (!m_Window->IsHeadless())
+            ImGui_ImplGlfw_InitForOpenGL(m_Window->GetGLFWWindow(), true);
         ImGui_ImplOpenGL3_Init(SGL_GLSL_VERSION_STR);
 
         // Load Fonts
@@ -115,6 +222,20 @@ namespace sgl
         //ImFont* font = io.Fonts->AddFontFromFileTTF("c:\\Windows\\Fonts\\ArialUni.ttf", 18.0f, NULL, io.Fonts->GetGlyphRangesJapanese());
         //IM_ASSERT(font != NULL);
         }
+
+        void NewImGuiPlatformFrame() const
+        {
+            if (!m_Window->IsHeadless())
+            {
+                ImGui_ImplGlfw_NewFrame();
+                return;
+            }
+
+            ImGuiIO& io = ImGui::GetIO();
+            io.DisplaySize = ImVec2(static_cast<float>(m_Window->GetWidth()),
+                                    static_cast<float>(m_Window->GetHeight()));
+            io.DeltaTime = std::max(m_DeltaTime, 0.0001f);
+        }
     #endif
         void Init()
         {
@@ -125,27 +246,126 @@ namespace sgl
 
         void Loop()
         {
+            SGL_PROFILE_THREAD("Main");
+
             while ( m_Window->IsOpen() )
             {
-                const float curTime = static_cast<float>(glfwGetTime());
-                const sgl::Timestep dt(curTime - m_LastFrameTime);
-                m_LastFrameTime = curTime;
+                SGL_PROFILE_SCOPE("Frame");
+
+                const sgl::Timestep dt = sgl::Timestep::FromNanos(
+                    m_FrameTimer.ElapsedNanos());
+                m_FrameTimer.Start();
+                m_DeltaTime = dt;
+
+                RenderStats::Reset();
+                const uint64_t kCpuBegin = m_FrameTimer.GetStart();
+
+                GpuProfiler::Get().BeginFrame();
+
+                {
+                    SGL_PROFILE_SCOPE("Update");
+                    this->Update(dt);
+                }
+                const uint64_t kUpdateEnd = Clock::Now();
 
-                this->Update(dt);
+                {
+                    SGL_PROFILE_SCOPE("Render");
+                    this->Render();
+                }
+                const uint64_t kRenderEnd = Clock::Now();
 
-                this->Render();
+                {
+                    SGL_PROFILE_SCOPE("ImGui");
+                    SGL_GPU_SCOPE("ImGui");
+                    START_IMGUI_FRAME();
+                        this->OnImGuiRender();
+                        DrawPerfOverlay();
+                    RENDER_IMGUI_FRAME();
+                }
 
-                START_IMGUI_FRAME();
-                    this->OnImGuiRender();
-                RENDER_IMGUI_FRAME();
+                const uint64_t kCpuEnd = Clock::Now();
 
-                m_Window->Display();
-                m_Window->PollEvents();
+                GpuProfiler::Get().EndFrame();
+
+                {
+                    SGL_PROFILE_SCOPE("FrameLimiter");
+                    m_FrameLimiter.Wait();
+                }
+
+                {
+                    SGL_PROFILE_SCOPE("Display");
+                    m_Window->Display();
+                    m_LatencyLimiter.OnPresent();
+                }
+
+                {
+                    SGL_PROFILE_SCOPE("WaitForFrame");
+                    m_LatencyLimiter.WaitForFrame();
+                }
+
+                // An idle wait is not part of the frame, it ends before it
+                uint64_t frameEnd = 0;
+                {
+                    SGL_PROFILE_SCOPE("Events");
+                    if (m_RenderMode == RenderMode::OnDemand)
+                    {
+                        frameEnd = WaitForRedraw();
+                    }
+                    else
+                    {
+                        m_Window->PollEvents();
+                        frameEnd = Clock::Now();
+                    }
+                    m_LatencyLimiter.OnInputSampled();
+                }
+
+                // Not the start of the timer, an idle wait restarts it
+                const uint64_t kFrameBegin = kCpuBegin;
+
+                m_FrameStats.Record(FrameStage::Frame,
+                                    frameEnd - kFrameBegin);
+                m_FrameStats.Record(FrameStage::Update,
+                                    kUpdateEnd - kCpuBegin);
+                m_FrameStats.Record(FrameStage::Render,
+                                    kRenderEnd - kUpdateEnd);
+                m_FrameStats.Record(FrameStage::Cpu, kCpuEnd - kCpuBegin);
+                m_PerfOverlay.Record(RenderStats::Current());
+
+                // Keeps the thread buffers from filling up
+                if (Profiler::IsRecording())
+                    Profiler::Get().Collect();
+
+                m_HitchDetector.EndFrame(kFrameBegin, frameEnd);
             }
         }
 
+        /**
+         * @brief Processes events, sleeps until something needs to be
+         *  redrawn or the window should close
+         * @return "Clock" time the frame ended, when the sleep started or
+         *  now if there was none
+         */
+        uint64_t WaitForRedraw();
+
+        bool NeedsRedraw();
+
     private:
-        float m_LastFrameTime{ 0.0 };
+        Timer m_FrameTimer;     ///< Time since the last frame started
+        float m_DeltaTime{ 0.0f };
+
+        RenderMode m_RenderMode{ RenderMode::Continuous };
+        std::atomic<bool> m_RedrawRequested{ false };
+        float m_AnimationEnd{ 0.0f };   ///< In seconds since "Start()"
+        uint64_t m_LastEventCount{ 0 };
+        uint32_t m_PendingFrames{ 0 };  ///< Frames to render after an event
+
+        FrameLimiter m_FrameLimiter;
+        FrameStats m_FrameStats;
+        HitchDetector m_HitchDetector;
+        PerfOverlay m_PerfOverlay;
+
+        /// Destroyed before the window, owns GL fences
+        LatencyLimiter m_LatencyLimiter;
     };
 
 } // namespace sgl
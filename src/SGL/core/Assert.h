@@ -17,11 +17,15 @@
     #include <signal.h>
     #define SGL_DEXIT() raise(SIGTRAP)
 
+    // The queued messages are written out first, the assert message is
+    // synchronous
+
     /**
      * @brief Assert macro. Prints default message
      *  when 'check' does NOT hold
      */
     #define SGL_ASSERT(check) { if(!(check)) {                                \
+        ::sgl::Log::Flush();                                                  \
         SPDLOG_LOGGER_CRITICAL(SGL_ASSERT_LOGGER(), "Assertion '{0}' failed", \
                                SGL_STRINGIFY(check));                         \
         SGL_DEXIT(); } }
@@ -32,13 +36,15 @@
      * @param msg Log message printed if assert triggered
      */
     #define SGL_ASSERT_MSG(check, ...) { if(!(check)) {            \
+        ::sgl::Log::Flush();                                       \
         SPDLOG_LOGGER_CRITICAL(SGL_ASSERT_LOGGER(), __VA_ARGS__);  \
         SGL_DEXIT(); } }
 
 #else
     #define SGL_DEXIT()
-    #define SGL_ASSERT(...)
-    #define SGL_ASSERT_MSG(...)
+    // Unevaluated, only keeps the checked variables used
+    #define SGL_ASSERT(check) ((void)sizeof(check))
+    #define SGL_ASSERT_MSG(check, ...) ((void)sizeof(check))
 #endif // SGL_ENABLE_ASSERTS
 
 #endif // SGL_CORE_ASSERT_H_
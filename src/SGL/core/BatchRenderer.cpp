@@ -0,0 +1,203 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/core/BatchRenderer.h"
+#include "SGL/core/HeadlessContext.h"
+#include "SGL/core/Profiler.h"
+
+
+namespace sgl
+{
+    /** @brief Loads GL functions if no context loaded them yet */
+    static void LoadGLOnce()
+    {
+        static std::once_flag s_Loaded;
+        std::call_once(s_Loaded, []() {
+            if (glCreateFramebuffers != nullptr)
+                return;
+
+            const int kSuccess = gladLoadGLLoader(
+                HeadlessContext::GetProcAddress);
+            SGL_ASSERT_MSG(kSuccess, "Could not load OpenGL using GLAD");
+        });
+    }
+
+    BatchRenderer::BatchRenderer(uint32_t workerCount,
+                                 const HeadlessContext* shared,
+                                 WorkerInit init, WorkerInit exit)
+        : m_Shared(shared),
+          m_Init(std::move(init)),
+          m_Exit(std::move(exit))
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT_MSG(HeadlessContext::IsAvailable(),
+                       "BatchRenderer needs the headless backend");
+
+        if (workerCount == 0)
+            workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+        m_Workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; ++i)
+            m_Workers.emplace_back(&BatchRenderer::WorkerLoop, this, i);
+
+        SGL_LOG_INFO("BatchRenderer started {} workers", workerCount);
+    }
+
+    BatchRenderer::~BatchRenderer()
+    {
+        SGL_FUNCTION();
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stop = true;
+        }
+        m_JobAvailable.notify_all();
+
+        for (auto& worker : m_Workers)
+            worker.join();
+    }
+
+    std::future<BatchResult> BatchRenderer::Submit(BatchJob job)
+    {
+        SGL_ASSERT(job.width > 0 && job.height > 0 && job.render);
+
+        std::future<BatchResult> result;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Jobs.push_back({ std::move(job), {} });
+            result = m_Jobs.back().result.get_future();
+        }
+        m_JobAvailable.notify_one();
+
+        return result;
+    }
+
+    void BatchRenderer::WaitIdle()
+    {
+        SGL_FUNCTION();
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Idle.wait(lock, [this]() { return m_Jobs.empty() && m_Busy == 0; });
+    }
+
+    bool BatchRenderer::PopJob(QueuedJob& out)
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_JobAvailable.wait(lock, [this]() {
+            return m_Stop || !m_Jobs.empty();
+        });
+
+        // Drains the queue before stopping
+        if (m_Jobs.empty())
+            return false;
+
+        out = std::move(m_Jobs.front());
+        m_Jobs.pop_front();
+        ++m_Busy;
+
+        return true;
+    }
+
+    void BatchRenderer::WorkerLoop(uint32_t workerIndex)
+    {
+        SGL_PROFILE_THREAD("BatchRenderer");
+
+        // Created on this thread, so that no other context gets replaced
+        HeadlessContext context(m_Shared);
+        LoadGLOnce();
+        // Pixel store state is per context, the same default as "Window"
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        if (m_Init)
+            m_Init(workerIndex);
+
+        WorkerTarget target;
+        QueuedJob queued;
+
+        while (PopJob(queued))
+        {
+            const BatchJob& kJob = queued.job;
+
+            SGL_PROFILE_SCOPE("BatchJob");
+
+            ResizeTarget(target, kJob.width, kJob.height);
+            glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+            glViewport(0, 0, kJob.width, kJob.height);
+
+            kJob.render(workerIndex);
+
+            // The job may have rendered through its own framebuffers
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, target.fbo);
+            glReadBuffer(GL_COLOR_ATTACHMENT0);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            BatchResult result;
+            result.width = kJob.width;
+            result.height = kJob.height;
+            result.pixels.resize(size_t(kJob.width) * kJob.height * 4);
+
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glReadPixels(0, 0, kJob.width, kJob.height, GL_RGBA,
+                         GL_UNSIGNED_BYTE, result.pixels.data());
+
+            queued.result.set_value(std::move(result));
+            m_Completed.fetch_add(1, std::memory_order_relaxed);
+
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                --m_Busy;
+            }
+            m_Idle.notify_all();
+        }
+
+        if (m_Exit)
+            m_Exit(workerIndex);
+
+        DeleteTarget(target);
+    }
+
+    void BatchRenderer::ResizeTarget(WorkerTarget& target, uint32_t width,
+                                     uint32_t height)
+    {
+        if (target.fbo != 0 && target.width == width &&
+            target.height == height)
+            return;
+
+        DeleteTarget(target);
+
+        glCreateRenderbuffers(1, &target.colorRBO);
+        glNamedRenderbufferStorage(target.colorRBO, GL_RGBA8, width, height);
+
+        glCreateRenderbuffers(1, &target.depthRBO);
+        glNamedRenderbufferStorage(target.depthRBO, GL_DEPTH24_STENCIL8,
+                                   width, height);
+
+        glCreateFramebuffers(1, &target.fbo);
+        glNamedFramebufferRenderbuffer(target.fbo, GL_COLOR_ATTACHMENT0,
+                                       GL_RENDERBUFFER, target.colorRBO);
+        glNamedFramebufferRenderbuffer(target.fbo,
+                                       GL_DEPTH_STENCIL_ATTACHMENT,
+                                       GL_RENDERBUFFER, target.depthRBO);
+
+        SGL_ASSERT(glCheckNamedFramebufferStatus(target.fbo, GL_FRAMEBUFFER)
+                   == GL_FRAMEBUFFER_COMPLETE);
+
+        target.width = width;
+        target.height = height;
+    }
+
+    void BatchRenderer::DeleteTarget(WorkerTarget& target)
+    {
+        if (target.fbo == 0)
+            return;
+
+        glDeleteFramebuffers(1, &target.fbo);
+        glDeleteRenderbuffers(1, &target.colorRBO);
+        glDeleteRenderbuffers(1, &target.depthRBO);
+        target = WorkerTarget();
+    }
+
+} // namespace sgl
@@ -0,0 +1,135 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_BATCH_RENDERER_H_
+#define SGL_CORE_BATCH_RENDERER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace sgl
+{
+    class HeadlessContext;
+
+    /** @brief One offscreen image to render */
+    struct BatchJob
+    {
+        uint32_t width{ 0 };
+        uint32_t height{ 0 };
+
+        /**
+         * @brief Renders the scene, called on a worker thread with its
+         *  context current, its framebuffer bound and the viewport set.
+         * @param workerIndex Index of the worker, to look up per-worker
+         *  objects that are not shared between contexts, e.g. VAOs
+         */
+        std::function<void(uint32_t workerIndex)> render;
+    };
+
+    /** @brief Pixels of a rendered job, RGBA8, rows bottom to top */
+    struct BatchResult
+    {
+        uint32_t width{ 0 };
+        uint32_t height{ 0 };
+        std::vector<unsigned char> pixels;
+    };
+
+    /**
+     * @brief Renders offscreen jobs in parallel. Each worker thread owns a
+     *  headless context and a framebuffer, pulls jobs from a shared queue,
+     *  and hands back the pixels.
+     */
+    class BatchRenderer
+    {
+    public:
+        /** @brief Called once on each worker, with its context current */
+        using WorkerInit = std::function<void(uint32_t workerIndex)>;
+
+    public:
+        /**
+         * @param workerCount Number of worker threads, 0 picks the number
+         *  of hardware threads
+         * @param shared Context to share objects with (buffers, textures,
+         *  programs), may be null
+         * @param init Creates per-worker objects, e.g. VAOs, may be empty
+         * @param exit Deletes per-worker objects, may be empty
+         */
+        BatchRenderer(uint32_t workerCount = 0,
+                      const HeadlessContext* shared = nullptr,
+                      WorkerInit init = {},
+                      WorkerInit exit = {});
+
+        /** @brief Finishes the queued jobs, then stops the workers */
+        ~BatchRenderer();
+
+        BatchRenderer(const BatchRenderer&) = delete;
+        BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+        std::future<BatchResult> Submit(BatchJob job);
+
+        /** @brief Blocks until all submitted jobs are done */
+        void WaitIdle();
+
+        uint32_t GetWorkerCount() const {
+            return static_cast<uint32_t>(m_Workers.size());
+        }
+        uint64_t GetCompletedCount() const {
+            return m_Completed.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct QueuedJob
+        {
+            BatchJob job;
+            std::promise<BatchResult> result;
+        };
+
+        /** @brief Offscreen render target of a worker */
+        struct WorkerTarget
+        {
+            uint32_t fbo{ 0 };
+            uint32_t colorRBO{ 0 };
+            uint32_t depthRBO{ 0 };
+            uint32_t width{ 0 };
+            uint32_t height{ 0 };
+        };
+
+        void WorkerLoop(uint32_t workerIndex);
+
+        bool PopJob(QueuedJob& out);
+
+        static void ResizeTarget(WorkerTarget& target, uint32_t width,
+                                 uint32_t height);
+        static void DeleteTarget(WorkerTarget& target);
+
+    private:
+        const HeadlessContext* m_Shared{ nullptr };
+        WorkerInit m_Init;
+        WorkerInit m_Exit;
+
+        std::vector<std::thread> m_Workers;
+
+        std::mutex m_Mutex;
+        std::condition_variable m_JobAvailable;
+        std::condition_variable m_Idle;
+        std::deque<QueuedJob> m_Jobs;
+        uint32_t m_Busy{ 0 };       ///< Workers rendering a job
+        bool m_Stop{ false };
+
+        std::atomic<uint64_t> m_Completed{ 0 };
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_CORE_BATCH_RENDERER_H_
@@ -0,0 +1,94 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/core/Clock.h"
+
+#include <thread>
+
+#if defined(SGL_CLOCK_HAS_TSC) && !defined(_MSC_VER)
+    #include <cpuid.h>
+#endif
+
+
+namespace sgl
+{
+    /** @brief Pair of readings taken as close together as possible */
+    struct ClockSample
+    {
+        uint64_t nanos{ 0 };
+        uint64_t ticks{ 0 };
+    };
+
+#ifdef SGL_CLOCK_HAS_TSC
+    /** @brief The TSC read is centered between two steady clock reads */
+    static ClockSample SampleClocks()
+    {
+        const uint64_t kBefore = Clock::SteadyNow();
+        const uint64_t kTicks = __rdtsc();
+        const uint64_t kAfter = Clock::SteadyNow();
+
+        return { kBefore + (kAfter - kBefore) / 2, kTicks };
+    }
+#endif
+
+    bool Clock::HasInvariantTSC()
+    {
+    #ifndef SGL_CLOCK_HAS_TSC
+        return false;
+    #elif defined(_MSC_VER)
+        int regs[4] = {};
+        __cpuid(regs, 0x80000000);
+        if (static_cast<unsigned>(regs[0]) < 0x80000007u)
+            return false;
+        __cpuid(regs, 0x80000007);
+        return (regs[3] & (1 << 8)) != 0;
+    #else
+        unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0)
+            return false;
+        return (edx & (1u << 8)) != 0;
+    #endif
+    }
+
+    bool Clock::EnableTSC(uint32_t calibrationMillis)
+    {
+        SGL_FUNCTION();
+
+    #ifdef SGL_CLOCK_HAS_TSC
+        if (!HasInvariantTSC())
+        {
+            SGL_LOG_WARN("No invariant TSC, the steady clock is kept");
+            return false;
+        }
+
+        const ClockSample kBegin = SampleClocks();
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(calibrationMillis));
+        const ClockSample kEnd = SampleClocks();
+
+        if (kEnd.ticks <= kBegin.ticks || kEnd.nanos <= kBegin.nanos)
+        {
+            SGL_LOG_WARN("TSC calibration failed, the steady clock is kept");
+            return false;
+        }
+
+        // Continues from the steady clock, timers started before stay valid
+        s_NanosPerTick = static_cast<double>(kEnd.nanos - kBegin.nanos)
+                         / static_cast<double>(kEnd.ticks - kBegin.ticks);
+        s_BaseTicks = kEnd.ticks;
+        s_BaseNanos = kEnd.nanos;
+        s_UseTSC = true;
+
+        SGL_LOG_INFO("Using the TSC clock, {:.3f} GHz", 1.0 / s_NanosPerTick);
+        return true;
+    #else
+        (void)calibrationMillis;
+        SGL_LOG_WARN("No TSC on this architecture, the steady clock is kept");
+        return false;
+    #endif
+    }
+
+} // namespace sgl
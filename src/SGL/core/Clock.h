@@ -0,0 +1,79 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_CLOCK_H_
+#define SGL_CORE_CLOCK_H_
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define SGL_CLOCK_HAS_TSC
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+#endif
+
+
+namespace sgl
+{
+    /**
+     * @brief Monotonic nanosecond clock shared by the timers and profilers.
+     *  Reads the steady clock, or the time stamp counter of the CPU once it
+     *  has been calibrated against it, which skips the system call.
+     */
+    class Clock
+    {
+    public:
+        /** @return Nanoseconds since an arbitrary point, monotonic */
+        static uint64_t Now()
+        {
+        #ifdef SGL_CLOCK_HAS_TSC
+            if (s_UseTSC)
+            {
+                const uint64_t kTicks = __rdtsc() - s_BaseTicks;
+                return s_BaseNanos
+                       + static_cast<uint64_t>(kTicks * s_NanosPerTick);
+            }
+        #endif
+            return SteadyNow();
+        }
+
+        /** @return Nanoseconds of the steady clock */
+        static uint64_t SteadyNow()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        /**
+         * @brief Calibrates the time stamp counter against the steady clock
+         *  and reads it from then on. Call at startup, before other threads
+         *  read the clock, "sgl::Init" does with SGL_USE_TSC=1.
+         * @param calibrationMillis Longer is more accurate, blocks meanwhile
+         * @return False if the CPU has no invariant TSC, the steady clock
+         *  is kept
+         */
+        static bool EnableTSC(uint32_t calibrationMillis = 20);
+        static void DisableTSC() { s_UseTSC = false; }
+
+        static bool IsUsingTSC() { return s_UseTSC; }
+
+        /** @return Whether the TSC rate is constant across power states */
+        static bool HasInvariantTSC();
+
+    private:
+        inline static bool s_UseTSC{ false };
+        inline static uint64_t s_BaseTicks{ 0 };
+        inline static uint64_t s_BaseNanos{ 0 };    ///< At "s_BaseTicks"
+        inline static double s_NanosPerTick{ 1.0 };
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_CORE_CLOCK_H_
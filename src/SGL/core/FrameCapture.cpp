@@ -0,0 +1,244 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/core/FrameCapture.h"
+#include "SGL/core/Profiler.h"
+#include "SGL/core/ThreadPool.h"
+#include "SGL/opengl/ReadbackQueue.h"
+
+#include <cstring>
+#include <filesystem>
+
+
+namespace sgl
+{
+    /** @brief Period of the recent frame rate, in seconds */
+    static constexpr float kRecentFpsWindow = 1.0f;
+
+    std::shared_ptr<FrameCapture> FrameCapture::Create(
+        const FrameCaptureSpec& spec)
+    {
+        return std::make_shared<FrameCapture>(spec);
+    }
+
+    // =========================================================================
+
+    FrameCapture::FrameCapture(const FrameCaptureSpec& spec)
+        : m_Spec(spec)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(m_Spec.maxQueuedFrames > 0);
+
+        if (!IsImageFileFormatSupported(m_Spec.format))
+        {
+            SGL_LOG_WARN("Capture format .{} is not available, using .qoi",
+                         GetImageFileExtension(m_Spec.format));
+            m_Spec.format = ImageFileFormat::QOI;
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(m_Spec.directory, error);
+        SGL_ASSERT_MSG(!error, "Could not create the capture directory "
+                       "'{}': {}", m_Spec.directory, error.message());
+
+        // Leaves a core for the render thread
+        if (m_Spec.encoderCount == 0)
+        {
+            m_Spec.encoderCount = std::max(
+                std::thread::hardware_concurrency(), 2u) - 1;
+        }
+
+        m_Readback = std::make_unique<ReadbackQueue>(m_Spec.readbackRingSize);
+        m_Encoders = std::make_unique<ThreadPool>(m_Spec.encoderCount);
+
+        SGL_LOG_INFO("Capturing frames to '{}' with {} encoders",
+                     m_Spec.directory, m_Spec.encoderCount);
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        SGL_FUNCTION();
+
+        Flush();
+
+        const FrameCaptureStats kStats = GetStats();
+        SGL_LOG_INFO("Captured {} of {} frames, {} dropped, {} failed, "
+                     "{:.1f} fps", kStats.written, kStats.requested,
+                     kStats.dropped, kStats.failed, kStats.sustainedFps);
+    }
+
+    void FrameCapture::Capture(uint32_t framebuffer, uint32_t width,
+                               uint32_t height)
+    {
+        SGL_FUNCTION();
+
+        if (m_Requested++ == 0)
+        {
+            m_SinceStart.Start();
+            m_WindowTimer.Start();
+        }
+
+        const uint64_t kIndex = m_NextIndex++;
+
+        // RGB, the alpha of the default framebuffer is rarely meaningful
+        const uint64_t kID = m_Readback->ReadFramebuffer(
+            framebuffer, 0, 0, width, height,
+            [this, kIndex](const ReadbackImage& image) {
+                QueuedFrame frame;
+                frame.index = kIndex;
+                frame.width = image.width;
+                frame.height = image.height;
+                frame.pixels = AcquireBuffer(image.size);
+                std::memcpy(frame.pixels.data(), image.data, image.size);
+
+                Enqueue(std::move(frame));
+            },
+            GL_RGB, GL_UNSIGNED_BYTE);
+
+        if (kID == 0)
+            m_Dropped.fetch_add(1, std::memory_order_relaxed);
+
+        Poll();
+    }
+
+    void FrameCapture::Poll()
+    {
+        SGL_FUNCTION();
+
+        m_Readback->Poll();
+
+        const float kElapsed = m_WindowTimer.Elapsed();
+        if (kElapsed >= kRecentFpsWindow)
+        {
+            const uint64_t kWritten = m_Written.load(
+                std::memory_order_relaxed);
+            m_RecentFps = (kWritten - m_WindowWritten) / kElapsed;
+            m_WindowWritten = kWritten;
+            m_WindowTimer.Start();
+        }
+    }
+
+    void FrameCapture::Flush()
+    {
+        SGL_FUNCTION();
+
+        m_Readback->Flush();
+        m_Encoders->WaitIdle();
+    }
+
+    FrameCaptureStats FrameCapture::GetStats() const
+    {
+        FrameCaptureStats stats;
+        stats.requested = m_Requested;
+        stats.written = m_Written.load(std::memory_order_relaxed);
+        stats.dropped = m_Dropped.load(std::memory_order_relaxed);
+        stats.failed = m_Failed.load(std::memory_order_relaxed);
+        stats.recentFps = m_RecentFps;
+
+        const float kElapsed = m_SinceStart.Elapsed();
+        if (m_Requested > 0 && kElapsed > 0.0f)
+            stats.sustainedFps = stats.written / kElapsed;
+
+        return stats;
+    }
+
+    void FrameCapture::Enqueue(QueuedFrame frame)
+    {
+        std::vector<unsigned char> dropped;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            if (m_Queue.size() >= m_Spec.maxQueuedFrames)
+            {
+                m_Dropped.fetch_add(1, std::memory_order_relaxed);
+
+                if (m_Spec.dropPolicy == CaptureDropPolicy::DropNewest)
+                {
+                    dropped = std::move(frame.pixels);
+                }
+                else
+                {
+                    dropped = std::move(m_Queue.front().pixels);
+                    m_Queue.pop_front();
+                    m_Queue.push_back(std::move(frame));
+                }
+            }
+            else
+            {
+                m_Queue.push_back(std::move(frame));
+            }
+        }
+
+        // One task per queued frame, a frame replacing the oldest one
+        //  takes over its task
+        if (!dropped.empty())
+        {
+            ReleaseBuffer(std::move(dropped));
+            return;
+        }
+
+        m_Encoders->Enqueue([this]() { EncodeNext(); });
+    }
+
+    void FrameCapture::EncodeNext()
+    {
+        SGL_PROFILE_FUNCTION();
+
+        QueuedFrame frame;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (m_Queue.empty())
+                return;
+
+            frame = std::move(m_Queue.front());
+            m_Queue.pop_front();
+        }
+
+        const bool kWritten = WriteImage(GetFilename(frame.index),
+                                         m_Spec.format, frame.pixels.data(),
+                                         frame.width, frame.height, 3,
+                                         true);
+        if (kWritten)
+            m_Written.fetch_add(1, std::memory_order_relaxed);
+        else
+            m_Failed.fetch_add(1, std::memory_order_relaxed);
+
+        ReleaseBuffer(std::move(frame.pixels));
+    }
+
+    std::vector<unsigned char> FrameCapture::AcquireBuffer(size_t size)
+    {
+        std::vector<unsigned char> buffer;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (!m_FreeBuffers.empty())
+            {
+                buffer = std::move(m_FreeBuffers.back());
+                m_FreeBuffers.pop_back();
+            }
+        }
+
+        buffer.resize(size);
+        return buffer;
+    }
+
+    void FrameCapture::ReleaseBuffer(std::vector<unsigned char> buffer)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        // Enough for a full queue and a frame on each encoder
+        if (m_FreeBuffers.size() < m_Spec.maxQueuedFrames
+                                   + m_Spec.encoderCount)
+            m_FreeBuffers.push_back(std::move(buffer));
+    }
+
+    std::string FrameCapture::GetFilename(uint64_t index) const
+    {
+        return fmt::format("{}/{}_{:06}.{}", m_Spec.directory, m_Spec.prefix,
+                           index, GetImageFileExtension(m_Spec.format));
+    }
+
+} // namespace sgl
@@ -0,0 +1,140 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_FRAME_CAPTURE_H_
+#define SGL_CORE_FRAME_CAPTURE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "SGL/core/Timer.h"
+#include "SGL/image/ImageWriter.h"
+
+
+namespace sgl
+{
+    class ReadbackQueue;
+    class ThreadPool;
+
+    /** @brief What to do with a frame when the encoders fall behind */
+    enum class CaptureDropPolicy
+    {
+        DropNewest = 0, ///< Keeps the queued frames, skips the new one
+        DropOldest      ///< Replaces the oldest queued frame, lower lag
+    };
+
+    struct FrameCaptureSpec
+    {
+        std::string directory{ "." };
+        std::string prefix{ "frame" };  ///< Files are <prefix>_<index>.<ext>
+        ImageFileFormat format{ ImageFileFormat::QOI };
+
+        uint32_t encoderCount{ 0 };     ///< 0 picks hardware threads - 1
+
+        /// Frames read back but not written yet, bounds the memory used
+        uint32_t maxQueuedFrames{ 8 };
+        CaptureDropPolicy dropPolicy{ CaptureDropPolicy::DropNewest };
+
+        uint32_t readbackRingSize{ 3 }; ///< Reads in flight on the GPU
+    };
+
+    struct FrameCaptureStats
+    {
+        uint64_t requested{ 0 };    ///< Calls to "Capture"
+        uint64_t written{ 0 };      ///< Frames encoded and on disk
+        uint64_t dropped{ 0 };      ///< Readback or encoder queue was full
+        uint64_t failed{ 0 };       ///< Encoding or writing failed
+
+        /** @brief Written frames per second since the capture started */
+        float sustainedFps{ 0.0f };
+        /** @brief Written frames per second over the last second */
+        float recentFps{ 0.0f };
+    };
+
+    /**
+     * @brief Writes rendered frames to disk without stalling the render
+     *  thread. Frames are read back asynchronously, then encoded and
+     *  written by a pool of worker threads.
+     */
+    class FrameCapture
+    {
+    public:
+        static std::shared_ptr<FrameCapture> Create(
+            const FrameCaptureSpec& spec);
+
+    public:
+        FrameCapture(const FrameCaptureSpec& spec);
+
+        /** @brief Writes the frames in flight, then stops the encoders */
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        /**
+         * @brief Queues a readback of the framebuffer, call after rendering
+         *  and before presenting. Also hands finished reads to encoders.
+         * @param framebuffer 0 or Window::GetFramebufferID for the default
+         */
+        void Capture(uint32_t framebuffer, uint32_t width, uint32_t height);
+
+        /** @brief Hands finished reads to encoders, call once per frame */
+        void Poll();
+
+        /** @brief Blocks until every requested frame is written or dropped */
+        void Flush();
+
+        FrameCaptureStats GetStats() const;
+
+    private:
+        struct QueuedFrame
+        {
+            uint64_t index{ 0 };
+            uint32_t width{ 0 };
+            uint32_t height{ 0 };
+            std::vector<unsigned char> pixels;
+        };
+
+        void Enqueue(QueuedFrame frame);
+        void EncodeNext();
+
+        std::vector<unsigned char> AcquireBuffer(size_t size);
+        void ReleaseBuffer(std::vector<unsigned char> buffer);
+
+        std::string GetFilename(uint64_t index) const;
+
+    private:
+        FrameCaptureSpec m_Spec;
+
+        std::unique_ptr<ReadbackQueue> m_Readback;
+
+        mutable std::mutex m_Mutex;
+        std::deque<QueuedFrame> m_Queue;
+        std::vector<std::vector<unsigned char>> m_FreeBuffers;
+
+        uint64_t m_NextIndex{ 0 };
+        uint64_t m_Requested{ 0 };
+        std::atomic<uint64_t> m_Written{ 0 };
+        std::atomic<uint64_t> m_Dropped{ 0 };
+        std::atomic<uint64_t> m_Failed{ 0 };
+
+        Timer m_SinceStart;
+        Timer m_WindowTimer;
+        uint64_t m_WindowWritten{ 0 };
+        float m_RecentFps{ 0.0f };
+
+        /// Declared last, its workers are joined before the rest is gone
+        std::unique_ptr<ThreadPool> m_Encoders;
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_CORE_FRAME_CAPTURE_H_
@@ -0,0 +1,157 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/core/FrameLimiter.h"
+
+#include <thread>
+
+#ifdef __unix__
+    #include <time.h>
+    #include <errno.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define SGL_CPU_RELAX() _mm_pause()
+#else
+    #define SGL_CPU_RELAX()
+#endif
+
+
+namespace sgl
+{
+    using namespace std::chrono_literals;
+
+    /** @brief Spin window the limiter starts with, and its bounds */
+    static constexpr auto kInitialSpinWindow = 2ms;
+    static constexpr auto kMinSpinWindow = 200us;
+    static constexpr auto kMaxSpinWindow = 4ms;
+
+    /** @brief Weight of the latest oversleep sample */
+    static constexpr double kOversleepSmoothing = 0.1;
+
+    FrameLimiter::FrameLimiter(float targetFps)
+        : m_SpinWindow(kInitialSpinWindow)
+    {
+        SetTargetFrameRate(targetFps);
+    }
+
+    void FrameLimiter::SetTargetFrameRate(float fps)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(fps >= 0.0f);
+
+        m_TargetFps = fps;
+        m_Period = fps > 0.0f
+            ? std::chrono::duration_cast<SteadyClock::duration>(
+                std::chrono::duration<double>(1.0 / fps))
+            : SteadyClock::duration(0);
+
+        m_Deadline = SteadyClock::now() + m_Period;
+        ResetStats();
+    }
+
+    void FrameLimiter::Wait()
+    {
+        if (!IsEnabled())
+            return;
+
+        SteadyClock::time_point now = SteadyClock::now();
+
+        // Fell behind by more than a frame, do not try to catch up
+        if (now > m_Deadline + m_Period)
+            m_Deadline = now;
+
+        if (m_Deadline - now > m_SpinWindow)
+            SleepUntil(m_Deadline - m_SpinWindow);
+
+        while ((now = SteadyClock::now()) < m_Deadline)
+            SGL_CPU_RELAX();
+
+        UpdateStats(now);
+        m_Deadline += m_Period;
+    }
+
+    void FrameLimiter::SleepUntil(SteadyClock::time_point deadline)
+    {
+        const auto kRequested = deadline - SteadyClock::now();
+
+    #ifdef __unix__
+        const auto kNanos = std::chrono::duration_cast<
+            std::chrono::nanoseconds>(kRequested).count();
+
+        timespec request{ time_t(kNanos / 1000000000),
+                          long(kNanos % 1000000000) };
+        timespec remaining{};
+        while (nanosleep(&request, &remaining) == -1 && errno == EINTR)
+            request = remaining;
+    #else
+        std::this_thread::sleep_for(kRequested);
+    #endif
+
+        // Adapt the spin window to how late the scheduler wakes us up
+        const double kOversleep = std::chrono::duration<double>(
+            SteadyClock::now() - deadline).count();
+        m_Stats.oversleep += kOversleepSmoothing
+                             * (std::max(kOversleep, 0.0) - m_Stats.oversleep);
+
+        const auto kWindow = std::chrono::duration_cast<
+            SteadyClock::duration>(
+                std::chrono::duration<double>(2.0 * m_Stats.oversleep));
+        m_SpinWindow = std::clamp<SteadyClock::duration>(
+            kWindow, kMinSpinWindow, kMaxSpinWindow);
+    }
+
+    void FrameLimiter::UpdateStats(SteadyClock::time_point now)
+    {
+        if (m_LastFrame != SteadyClock::time_point())
+        {
+            m_Intervals[m_IntervalHead] = std::chrono::duration<double>(
+                now - m_LastFrame).count();
+            m_IntervalHead = (m_IntervalHead + 1) % StatsWindow;
+            m_IntervalCount = std::min(m_IntervalCount + 1, StatsWindow);
+            ++m_Stats.frameCount;
+
+            // Recomputed over the window, an old hitch leaves it
+            const double kTarget = std::chrono::duration<double>(
+                m_Period).count();
+            double sum = 0.0;
+            double maxError = 0.0;
+            for (uint32_t i = 0; i < m_IntervalCount; ++i)
+            {
+                sum += m_Intervals[i];
+                maxError = std::max(maxError,
+                                    std::abs(m_Intervals[i] - kTarget));
+            }
+            const double kMean = sum / m_IntervalCount;
+
+            double squares = 0.0;
+            for (uint32_t i = 0; i < m_IntervalCount; ++i)
+            {
+                const double kDelta = m_Intervals[i] - kMean;
+                squares += kDelta * kDelta;
+            }
+
+            m_Stats.meanInterval = kMean;
+            m_Stats.jitter = std::sqrt(squares / m_IntervalCount);
+            m_Stats.maxError = maxError;
+        }
+
+        m_LastFrame = now;
+    }
+
+    void FrameLimiter::ResetStats()
+    {
+        const double kOversleep = m_Stats.oversleep;
+
+        m_Stats = Stats();
+        m_Stats.oversleep = kOversleep;
+        m_IntervalHead = 0;
+        m_IntervalCount = 0;
+        m_LastFrame = SteadyClock::time_point();
+    }
+
+} // namespace sgl
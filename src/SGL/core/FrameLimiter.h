@@ -0,0 +1,90 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_FRAME_LIMITER_H_
+#define SGL_CORE_FRAME_LIMITER_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "SGL/core/Timestep.h"
+
+
+namespace sgl
+{
+    /**
+     * @brief Caps the frame rate to a target, without burning the CPU.
+     *  Sleeps coarsely until shortly before the frame deadline, then spins
+     *  on a monotonic clock for the rest. The spin window adapts to the
+     *  measured oversleep of the OS scheduler.
+     */
+    class FrameLimiter
+    {
+    public:
+        /** @brief Intervals the pacing statistics are computed over */
+        static constexpr uint32_t StatsWindow = 120;
+
+        /**
+         * @brief Frame pacing statistics of the last "StatsWindow"
+         *  intervals between frames, so they follow the current pacing
+         */
+        struct Stats
+        {
+            uint64_t frameCount{ 0 };       ///< Since the reset
+            double meanInterval{ 0.0 };     ///< In seconds
+            double jitter{ 0.0 };           ///< Std. deviation, in seconds
+            double maxError{ 0.0 };         ///< Max |interval - target|
+            double oversleep{ 0.0 };        ///< Smoothed sleep overshoot
+
+            Timestep MeanInterval() const { return float(meanInterval); }
+            Timestep Jitter() const { return float(jitter); }
+            Timestep MaxError() const { return float(maxError); }
+        };
+
+    public:
+        /** @param targetFps Frames per second, 0 means unlimited */
+        FrameLimiter(float targetFps = 0.0f);
+
+        /** @param fps Frames per second, 0 means unlimited */
+        void SetTargetFrameRate(float fps);
+        float GetTargetFrameRate() const { return m_TargetFps; }
+        bool IsEnabled() const { return m_TargetFps > 0.0f; }
+
+        /** @brief Blocks until the deadline of the next frame */
+        void Wait();
+
+        const Stats& GetStats() const { return m_Stats; }
+        void ResetStats();
+
+    private:
+        /// Not the "Clock" of SGL, the deadlines are std::chrono points
+        using SteadyClock = std::chrono::steady_clock;
+
+        void SleepUntil(SteadyClock::time_point deadline);
+        void UpdateStats(SteadyClock::time_point now);
+
+    private:
+        float m_TargetFps{ 0.0f };
+        SteadyClock::duration m_Period{ 0 };
+
+        SteadyClock::time_point m_Deadline;
+        SteadyClock::time_point m_LastFrame;
+
+        /// Time before the deadline when sleeping ends and spinning starts
+        SteadyClock::duration m_SpinWindow;
+
+        Stats m_Stats;
+
+        /// Ring of the last intervals, in seconds
+        std::array<double, StatsWindow> m_Intervals{};
+        uint32_t m_IntervalHead{ 0 };   ///< Next interval to write
+        uint32_t m_IntervalCount{ 0 };
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_CORE_FRAME_LIMITER_H_
@@ -0,0 +1,136 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/core/FrameStats.h"
+
+
+namespace sgl
+{
+    void FrameStats::Record(FrameStage stage, uint64_t nanos)
+    {
+        Channel& channel = m_Channels[static_cast<uint32_t>(stage)];
+        const float kMillis = static_cast<float>(nanos * 1e-6);
+
+        if (channel.count == WindowSize)
+        {
+            const double kOldest = channel.millis[channel.head];
+            channel.sum -= kOldest;
+            channel.sumSquares -= kOldest * kOldest;
+        }
+        else
+        {
+            ++channel.count;
+        }
+
+        channel.millis[channel.head] = kMillis;
+        channel.sum += kMillis;
+        channel.sumSquares += static_cast<double>(kMillis) * kMillis;
+        channel.head = (channel.head + 1) % WindowSize;
+
+        // Once per window, the running sums drop their rounding errors
+        if (channel.head == 0)
+        {
+            channel.sum = 0.0;
+            channel.sumSquares = 0.0;
+            for (const float kSample : channel.millis)
+            {
+                channel.sum += kSample;
+                channel.sumSquares += static_cast<double>(kSample) * kSample;
+            }
+        }
+    }
+
+    float FrameStats::GetMean(FrameStage stage) const
+    {
+        const Channel& kChannel = Get(stage);
+        if (kChannel.count == 0)
+            return 0.0f;
+
+        return static_cast<float>(kChannel.sum / kChannel.count);
+    }
+
+    float FrameStats::GetVariance(FrameStage stage) const
+    {
+        const Channel& kChannel = Get(stage);
+        if (kChannel.count == 0)
+            return 0.0f;
+
+        const double kMean = kChannel.sum / kChannel.count;
+        const double kVariance = kChannel.sumSquares / kChannel.count
+                                 - kMean * kMean;
+        return static_cast<float>(std::max(kVariance, 0.0));
+    }
+
+    float FrameStats::GetLast(FrameStage stage) const
+    {
+        const Channel& kChannel = Get(stage);
+        if (kChannel.count == 0)
+            return 0.0f;
+
+        return kChannel.millis[(kChannel.head + WindowSize - 1) % WindowSize];
+    }
+
+    TimingSummary FrameStats::GetSummary(FrameStage stage) const
+    {
+        const Channel& kChannel = Get(stage);
+
+        TimingSummary summary;
+        summary.samples = kChannel.count;
+        if (kChannel.count == 0)
+            return summary;
+
+        SortWindow(kChannel);
+
+        summary.mean = GetMean(stage);
+        summary.stdDev = std::sqrt(GetVariance(stage));
+        summary.min = m_Sorted[0];
+        summary.max = m_Sorted[kChannel.count - 1];
+        summary.p50 = SortedPercentile(kChannel.count, 50.0f);
+        summary.p95 = SortedPercentile(kChannel.count, 95.0f);
+        summary.p99 = SortedPercentile(kChannel.count, 99.0f);
+
+        return summary;
+    }
+
+    float FrameStats::GetPercentile(FrameStage stage, float percentile) const
+    {
+        const Channel& kChannel = Get(stage);
+        if (kChannel.count == 0)
+            return 0.0f;
+
+        SortWindow(kChannel);
+        return SortedPercentile(kChannel.count, percentile);
+    }
+
+    uint32_t FrameStats::GetHistoryOffset(FrameStage stage) const
+    {
+        // The ring starts at 0 until it wraps
+        const Channel& kChannel = Get(stage);
+        return kChannel.count == WindowSize ? kChannel.head : 0;
+    }
+
+    void FrameStats::Clear()
+    {
+        m_Channels = {};
+    }
+
+    void FrameStats::SortWindow(const Channel& channel) const
+    {
+        std::copy(channel.millis.begin(),
+                  channel.millis.begin() + channel.count, m_Sorted.begin());
+        std::sort(m_Sorted.begin(), m_Sorted.begin() + channel.count);
+    }
+
+    float FrameStats::SortedPercentile(uint32_t count, float percentile) const
+    {
+        // Nearest rank
+        const float kRank = std::clamp(percentile, 0.0f, 100.0f) * 0.01f
+                            * (count - 1);
+        const uint32_t kIndex = static_cast<uint32_t>(std::lround(kRank));
+        return m_Sorted[std::min(kIndex, count - 1)];
+    }
+
+} // namespace sgl
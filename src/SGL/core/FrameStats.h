@@ -0,0 +1,107 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_FRAME_STATS_H_
+#define SGL_CORE_FRAME_STATS_H_
+
+#include <array>
+#include <cstdint>
+
+
+namespace sgl
+{
+    /** @brief Timed part of a frame */
+    enum class FrameStage : uint32_t
+    {
+        Frame = 0,  ///< With the present and waits, not the idle sleeps
+        Update,
+        Render,
+        Cpu,        ///< Update, Render and ImGui work
+        Count
+    };
+
+    /** @brief Statistics over the window of recent frames, in milliseconds */
+    struct TimingSummary
+    {
+        float mean{ 0.0f };
+        float stdDev{ 0.0f };
+        float min{ 0.0f };
+        float max{ 0.0f };
+        float p50{ 0.0f };
+        float p95{ 0.0f };
+        float p99{ 0.0f };
+        uint32_t samples{ 0 };
+    };
+
+    /**
+     * @brief Rolling frame, update and render times, kept in fixed-size
+     *  rings. Recording is O(1) and never allocates, the mean and variance
+     *  are running sums, the order statistics sort a copy of the window.
+     *  Used by the main thread only.
+     */
+    class FrameStats
+    {
+    public:
+        /** @brief Samples kept per stage */
+        static constexpr uint32_t WindowSize = 256;
+
+    public:
+        /** @brief Adds a sample, the oldest one leaves a full window */
+        void Record(FrameStage stage, uint64_t nanos);
+
+        /** @brief Running statistics, O(1) */
+        float GetMean(FrameStage stage) const;
+        float GetVariance(FrameStage stage) const;
+        /** @return Last recorded sample, in milliseconds */
+        float GetLast(FrameStage stage) const;
+
+        /** @brief All statistics of a stage, sorts the window once */
+        TimingSummary GetSummary(FrameStage stage) const;
+
+        /** @return Time at a percentile in [0, 100], in milliseconds */
+        float GetPercentile(FrameStage stage, float percentile) const;
+
+        /**
+         * @brief Ring of samples in milliseconds, for graphs. Starts at
+         *  "GetHistoryOffset", the oldest sample.
+         */
+        const float* GetHistory(FrameStage stage) const {
+            return Get(stage).millis.data();
+        }
+        uint32_t GetHistoryOffset(FrameStage stage) const;
+        uint32_t GetCount(FrameStage stage) const { return Get(stage).count; }
+
+        void Clear();
+
+    private:
+        struct Channel
+        {
+            std::array<float, WindowSize> millis{};
+            uint32_t head{ 0 };     ///< Next sample to write
+            uint32_t count{ 0 };
+
+            double sum{ 0.0 };
+            double sumSquares{ 0.0 };
+        };
+
+        const Channel& Get(FrameStage stage) const {
+            return m_Channels[static_cast<uint32_t>(stage)];
+        }
+
+        /** @brief Sorts the window into the scratch array */
+        void SortWindow(const Channel& channel) const;
+        float SortedPercentile(uint32_t count, float percentile) const;
+
+    private:
+        std::array<Channel, static_cast<size_t>(FrameStage::Count)> m_Channels;
+
+        /// Sorted copy of a window, the queries stay allocation free
+        mutable std::array<float, WindowSize> m_Sorted{};
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_CORE_FRAME_STATS_H_
@@ -0,0 +1,317 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/core/GpuProfiler.h"
+#include "SGL/core/Profiler.h"
+
+
+namespace sgl
+{
+    /** @brief Marks a scope opened outside of a frame, not timed */
+    static constexpr uint32_t kUntimedScope = ~0u;
+
+    /** @brief Queries created at once when the pool is empty */
+    static constexpr uint32_t kQueryBatch = 32;
+
+    static constexpr double kNanosToMillis = 1e-6;
+
+    /** @brief Frames between two GPU to CPU clock syncs, bounds the drift */
+    static constexpr uint64_t kClockSyncInterval = 256;
+
+    GpuProfiler& GpuProfiler::Get()
+    {
+        static GpuProfiler s_Profiler;
+        return s_Profiler;
+    }
+
+    // =========================================================================
+
+    void GpuProfiler::Enable(bool enabled)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT_MSG(!m_InFrame, "GPU profiler toggled inside a frame");
+
+        m_Enabled = enabled;
+
+        // Scopes go to the CPU profiler trace too while it records
+        if (enabled)
+            Profiler::SetTrackName(Profiler::GpuTrackID, "GPU");
+    }
+
+    void GpuProfiler::BeginFrame()
+    {
+        if (!m_Enabled)
+            return;
+
+        SGL_ASSERT_MSG(!m_InFrame, "GPU profiler frame was not ended");
+
+        CollectResults();
+
+        // Not done after MaxFramesInFlight frames, drops the results
+        //  instead of stalling
+        FrameSlot& slot = m_Frames[m_Current];
+        if (slot.pending)
+        {
+            ReleaseFrame(slot);
+            ++m_DroppedFrames;
+        }
+
+        slot.frame = m_FrameIndex++;
+        slot.pending = true;
+        m_InFrame = true;
+
+        if (Profiler::IsRecording()
+            && (!m_ClockSynced || slot.frame % kClockSyncInterval == 0))
+            SyncClock();
+
+        BeginScope("Frame");
+    }
+
+    void GpuProfiler::EndFrame()
+    {
+        if (!m_InFrame)
+            return;
+
+        EndScope();
+        SGL_ASSERT_MSG(m_OpenRecords.empty(),
+                       "GPU scopes still open at the end of the frame");
+
+        m_InFrame = false;
+        m_Current = (m_Current + 1) % MaxFramesInFlight;
+    }
+
+    void GpuProfiler::BeginScope(std::string_view name)
+    {
+        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0,
+                         static_cast<GLsizei>(name.size()), name.data());
+
+        if (!m_InFrame)
+        {
+            m_OpenRecords.push_back(kUntimedScope);
+            return;
+        }
+
+        FrameSlot& slot = m_Frames[m_Current];
+
+        ScopeRecord record;
+        record.scope = FindOrAddScope(name);
+        record.beginQuery = AcquireQuery();
+        record.endQuery = AcquireQuery();
+        glQueryCounter(record.beginQuery, GL_TIMESTAMP);
+
+        m_OpenRecords.push_back(static_cast<uint32_t>(slot.records.size()));
+        slot.records.push_back(record);
+    }
+
+    void GpuProfiler::EndScope()
+    {
+        SGL_ASSERT_MSG(!m_OpenRecords.empty(), "No GPU scope to end");
+
+        const uint32_t kRecord = m_OpenRecords.back();
+        m_OpenRecords.pop_back();
+
+        if (kRecord != kUntimedScope)
+        {
+            glQueryCounter(m_Frames[m_Current].records[kRecord].endQuery,
+                           GL_TIMESTAMP);
+        }
+
+        glPopDebugGroup();
+    }
+
+    void GpuProfiler::Reset()
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT_MSG(!m_InFrame, "GPU profiler reset inside a frame");
+
+        for (auto& slot : m_Frames)
+            slot = FrameSlot();
+
+        if (!m_AllQueries.empty())
+        {
+            glDeleteQueries(static_cast<GLsizei>(m_AllQueries.size()),
+                            m_AllQueries.data());
+        }
+
+        m_AllQueries.clear();
+        m_FreeQueries.clear();
+        m_OpenRecords.clear();
+        m_ScopeIndex.clear();
+        m_Scopes.clear();
+        m_TraceNames.clear();
+        m_DroppedFrames = 0;
+        m_ClockSynced = false;
+    }
+
+    void GpuProfiler::SyncClock()
+    {
+        // Time the commands issued so far reach the GPU, no flush
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+
+        m_ClockOffset = static_cast<int64_t>(Clock::Now()) - gpuNow;
+        m_ClockSynced = true;
+    }
+
+    void GpuProfiler::CollectResults()
+    {
+        // Oldest first, a frame cannot be done before the previous one
+        for (uint32_t i = 0; i < MaxFramesInFlight; ++i)
+        {
+            FrameSlot& slot = m_Frames[(m_Current + i) % MaxFramesInFlight];
+            if (!slot.pending)
+                continue;
+
+            if (!ReadFrame(slot))
+                return;
+        }
+    }
+
+    bool GpuProfiler::ReadFrame(FrameSlot& slot)
+    {
+        // The root end query is issued last, the rest is done if it is
+        const uint32_t kLastQuery = slot.records.front().endQuery;
+
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(kLastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE)
+            return false;
+
+        const bool kTrace = Profiler::IsRecording() && m_ClockSynced;
+
+        for (const auto& record : slot.records)
+        {
+            GLuint64 begin = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(record.beginQuery, GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(record.endQuery, GL_QUERY_RESULT, &end);
+
+            const float kMillis = end > begin
+                ? static_cast<float>((end - begin) * kNanosToMillis)
+                : 0.0f;
+            AddSample(m_Scopes[record.scope], kMillis, slot.frame);
+
+            if (kTrace && end > begin)
+            {
+                Profiler::RecordOnTrack(
+                    Profiler::GpuTrackID, m_TraceNames[record.scope],
+                    static_cast<uint64_t>(begin + m_ClockOffset),
+                    static_cast<uint64_t>(end + m_ClockOffset));
+            }
+        }
+
+        ReleaseFrame(slot);
+        return true;
+    }
+
+    void GpuProfiler::ReleaseFrame(FrameSlot& slot)
+    {
+        for (const auto& record : slot.records)
+        {
+            m_FreeQueries.push_back(record.beginQuery);
+            m_FreeQueries.push_back(record.endQuery);
+        }
+
+        slot.records.clear();
+        slot.pending = false;
+    }
+
+    uint32_t GpuProfiler::FindOrAddScope(std::string_view name)
+    {
+        int32_t parent = -1;
+        uint32_t depth = 0;
+
+        // Parent is the innermost timed scope
+        for (auto it = m_OpenRecords.rbegin(); it != m_OpenRecords.rend();
+             ++it)
+        {
+            if (*it == kUntimedScope)
+                continue;
+
+            const uint32_t kParent = m_Frames[m_Current].records[*it].scope;
+            parent = static_cast<int32_t>(kParent);
+            depth = m_Scopes[kParent].depth + 1;
+            break;
+        }
+
+        auto it = m_ScopeIndex.find({ parent, name });
+        if (it != m_ScopeIndex.end())
+            return it->second;
+
+        const uint32_t kIndex = static_cast<uint32_t>(m_Scopes.size());
+
+        GpuScopeStats& stats = m_Scopes.emplace_back();
+        stats.name = name;
+        stats.parent = parent;
+        stats.depth = depth;
+
+        m_ScopeIndex.emplace(ScopeKey{ parent, stats.name }, kIndex);
+
+        auto interned = m_InternedNames.find(name);
+        if (interned == m_InternedNames.end())
+            interned = m_InternedNames.emplace(name).first;
+        m_TraceNames.push_back(interned->c_str());
+
+        return kIndex;
+    }
+
+    void GpuProfiler::AddSample(GpuScopeStats& stats, float millis,
+                                uint64_t frame)
+    {
+        // A scope may run several times per frame, the times are summed
+        if (stats.samples > 0 && stats.lastFrame == frame)
+        {
+            const uint32_t kPrev = (stats.historyHead
+                                    + GpuScopeStats::HistorySize - 1)
+                                   % GpuScopeStats::HistorySize;
+            millis += stats.history[kPrev];
+            stats.historyHead = kPrev;
+            --stats.samples;
+        }
+
+        stats.history[stats.historyHead] = millis;
+        stats.historyHead = (stats.historyHead + 1)
+                            % GpuScopeStats::HistorySize;
+        stats.last = millis;
+        stats.lastFrame = frame;
+        ++stats.samples;
+
+        const uint32_t kCount = static_cast<uint32_t>(std::min<uint64_t>(
+            stats.samples, GpuScopeStats::HistorySize));
+
+        float sum = 0.0f;
+        stats.min = millis;
+        stats.max = millis;
+        for (uint32_t i = 0; i < kCount; ++i)
+        {
+            const float kSample = stats.history[i];
+            sum += kSample;
+            stats.min = std::min(stats.min, kSample);
+            stats.max = std::max(stats.max, kSample);
+        }
+        stats.average = sum / kCount;
+    }
+
+    uint32_t GpuProfiler::AcquireQuery()
+    {
+        if (m_FreeQueries.empty())
+        {
+            GLuint queries[kQueryBatch];
+            glCreateQueries(GL_TIMESTAMP, kQueryBatch, queries);
+
+            m_FreeQueries.insert(m_FreeQueries.end(), queries,
+                                 queries + kQueryBatch);
+            m_AllQueries.insert(m_AllQueries.end(), queries,
+                                queries + kQueryBatch);
+        }
+
+        const uint32_t kQuery = m_FreeQueries.back();
+        m_FreeQueries.pop_back();
+
+        return kQuery;
+    }
+
+} // namespace sgl
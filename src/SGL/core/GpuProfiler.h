@@ -0,0 +1,199 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_GPU_PROFILER_H_
+#define SGL_CORE_GPU_PROFILER_H_
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+
+namespace sgl
+{
+    /** @brief Rolling GPU time statistics of a named scope, in milliseconds */
+    struct GpuScopeStats
+    {
+        static constexpr uint32_t HistorySize = 120;
+
+        std::string name;
+        int32_t parent{ -1 };   ///< Index of the parent scope, -1 for roots
+        uint32_t depth{ 0 };
+
+        float last{ 0.0f };
+        float average{ 0.0f };  ///< Over the history window
+        float min{ 0.0f };
+        float max{ 0.0f };
+
+        uint64_t samples{ 0 };
+        uint64_t lastFrame{ 0 };    ///< Frame of the last sample
+
+        std::array<float, HistorySize> history{};
+        uint32_t historyHead{ 0 };  ///< Next sample to write
+    };
+
+    /**
+     * @brief Measures GPU time of nested scopes with timestamp queries.
+     *  Results are read back without blocking a few frames later.
+     *  Scopes are also pushed as debug groups, so that external tools,
+     *  e.g. RenderDoc, see the same hierarchy. While the CPU "Profiler"
+     *  records, the scopes are added to its trace on the GPU track.
+     */
+    class GpuProfiler
+    {
+    public:
+        /** @brief Frames kept in flight before results are dropped */
+        static constexpr uint32_t MaxFramesInFlight = 4;
+
+        /** @brief Profiler of the main context */
+        static GpuProfiler& Get();
+
+    public:
+        GpuProfiler() = default;
+
+        GpuProfiler(const GpuProfiler&) = delete;
+        GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+        void Enable(bool enabled);
+        bool IsEnabled() const { return m_Enabled; }
+
+        /**
+         * @brief Collects finished frames, then starts the root "Frame"
+         *  scope. Called by the Application loop.
+         */
+        void BeginFrame();
+        /** @brief Ends the root scope, called before presenting */
+        void EndFrame();
+
+        /** @param name Shown in the stats and in debug tools */
+        void BeginScope(std::string_view name);
+        void EndScope();
+
+        /** @return Stats of all scopes seen so far, parents first */
+        const std::deque<GpuScopeStats>& GetScopes() const {
+            return m_Scopes;
+        }
+
+        /** @return Stats of the root scope, null before the first result */
+        const GpuScopeStats* GetFrameStats() const {
+            return m_Scopes.empty() ? nullptr : &m_Scopes.front();
+        }
+
+        /** @return Frames whose results were dropped, not ready in time */
+        uint64_t GetDroppedFrames() const { return m_DroppedFrames; }
+
+        /**
+         * @brief Deletes the queries and clears the stats, call before the
+         *  context is destroyed
+         */
+        void Reset();
+
+    private:
+        struct ScopeRecord
+        {
+            uint32_t scope{ 0 };
+            uint32_t beginQuery{ 0 };
+            uint32_t endQuery{ 0 };
+        };
+
+        struct FrameSlot
+        {
+            std::vector<ScopeRecord> records;
+            uint64_t frame{ 0 };
+            bool pending{ false };
+        };
+
+        struct ScopeKey
+        {
+            int32_t parent;
+            std::string_view name;  ///< Points to the name in the stats
+
+            bool operator<(const ScopeKey& o) const {
+                return std::tie(parent, name) < std::tie(o.parent, o.name);
+            }
+        };
+
+        /** @brief Reads the finished frames, oldest first */
+        void CollectResults();
+        bool ReadFrame(FrameSlot& slot);
+        void ReleaseFrame(FrameSlot& slot);
+
+        uint32_t FindOrAddScope(std::string_view name);
+        void AddSample(GpuScopeStats& stats, float millis, uint64_t frame);
+
+        uint32_t AcquireQuery();
+
+        /** @brief Offset from the GPU timestamps to the CPU "Clock" */
+        void SyncClock();
+
+    private:
+        bool m_Enabled{ false };
+        bool m_InFrame{ false };
+
+        std::array<FrameSlot, MaxFramesInFlight> m_Frames;
+        uint32_t m_Current{ 0 };
+        uint64_t m_FrameIndex{ 0 };
+        uint64_t m_DroppedFrames{ 0 };
+
+        /// Indices into the records of the current frame
+        std::vector<uint32_t> m_OpenRecords;
+
+        std::vector<uint32_t> m_FreeQueries;
+        std::vector<uint32_t> m_AllQueries;
+
+        std::deque<GpuScopeStats> m_Scopes;     ///< Stable addresses
+        std::map<ScopeKey, uint32_t> m_ScopeIndex;
+
+        /// Names of the trace events, by scope. The events keep pointers
+        ///  to them, so the names are never freed, not even by "Reset".
+        std::vector<const char*> m_TraceNames;
+        std::set<std::string, std::less<>> m_InternedNames;
+
+        int64_t m_ClockOffset{ 0 };     ///< CPU minus GPU nanoseconds
+        bool m_ClockSynced{ false };
+    };
+
+    /** @brief Measures the GPU time until the end of the C++ scope */
+    class GpuScope
+    {
+    public:
+        GpuScope(std::string_view name)
+            : m_Active(GpuProfiler::Get().IsEnabled())
+        {
+            if (m_Active)
+                GpuProfiler::Get().BeginScope(name);
+        }
+
+        ~GpuScope()
+        {
+            if (m_Active)
+                GpuProfiler::Get().EndScope();
+        }
+
+        GpuScope(const GpuScope&) = delete;
+        GpuScope& operator=(const GpuScope&) = delete;
+
+    private:
+        bool m_Active;
+    };
+
+} // namespace sgl
+
+
+#define SGL_GPU_SCOPE_CONCAT_IMPL(a, b) a##b
+#define SGL_GPU_SCOPE_CONCAT(a, b) SGL_GPU_SCOPE_CONCAT_IMPL(a, b)
+
+/** @brief Measures the GPU time of the rest of the enclosing C++ scope */
+#define SGL_GPU_SCOPE(name) \
+    ::sgl::GpuScope SGL_GPU_SCOPE_CONCAT(sglGpuScope, __LINE__)(name)
+
+
+#endif // SGL_CORE_GPU_PROFILER_H_
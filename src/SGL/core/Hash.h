@@ -0,0 +1,97 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_HASH_H_
+#define SGL_CORE_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+namespace sgl
+{
+    namespace hash
+    {
+        constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+        constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+        constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+        constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+
+        inline uint64_t RotateLeft(uint64_t value, int bits) {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        inline uint64_t Round(uint64_t acc, uint64_t word) {
+            return RotateLeft(acc + word * kPrime2, 31) * kPrime1;
+        }
+
+        inline uint64_t ReadWord(const unsigned char* bytes) {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes, sizeof(word));
+            return word;
+        }
+    } // namespace hash
+
+    /**
+     * @brief Fast 64-bit hash of a buffer, in the manner of XXH64: four
+     *  independent lanes over 32-byte stripes, then an avalanche. For keys
+     *  of caches, not for security. Depends on the byte order.
+     */
+    inline uint64_t Hash64(const void* data, size_t size, uint64_t seed = 0)
+    {
+        using namespace hash;
+
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        const unsigned char* const kEnd = bytes + size;
+
+        uint64_t result = 0;
+        if (size >= 32)
+        {
+            uint64_t lanes[4] = { seed + kPrime1 + kPrime2, seed + kPrime2,
+                                  seed, seed - kPrime1 };
+            for (; kEnd - bytes >= 32; bytes += 32)
+            {
+                for (int i = 0; i < 4; ++i)
+                    lanes[i] = Round(lanes[i], ReadWord(bytes + i * 8));
+            }
+
+            result = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7)
+                     + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+            for (const uint64_t kLane : lanes)
+                result = (result ^ Round(0, kLane)) * kPrime1 + kPrime4;
+        }
+        else
+        {
+            result = seed + kPrime3;
+        }
+
+        result += static_cast<uint64_t>(size);
+
+        for (; kEnd - bytes >= 8; bytes += 8)
+        {
+            result ^= Round(0, ReadWord(bytes));
+            result = RotateLeft(result, 27) * kPrime1 + kPrime4;
+        }
+        for (; bytes < kEnd; ++bytes)
+        {
+            result ^= *bytes * kPrime3;
+            result = RotateLeft(result, 11) * kPrime1;
+        }
+
+        // Avalanche, every input bit flips about half of the output
+        result ^= result >> 33;
+        result *= kPrime2;
+        result ^= result >> 29;
+        result *= kPrime3;
+        result ^= result >> 32;
+
+        return result;
+    }
+
+} // namespace sgl
+
+
+#endif // SGL_CORE_HASH_H_
@@ -0,0 +1,256 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/core/HeadlessContext.h"
+
+#include <cstring>
+#include <mutex>
+
+#ifdef SGL_HAS_EGL
+    #define EGL_NO_X11
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
+#endif
+
+
+namespace sgl
+{
+#ifdef SGL_HAS_EGL
+    /** @brief The display is shared by all headless contexts */
+    static std::mutex s_DisplayMutex;
+    static EGLDisplay s_Display = EGL_NO_DISPLAY;
+    static EGLConfig s_Config = nullptr;
+    static bool s_Surfaceless = false;
+    static uint32_t s_ContextCount = 0;
+
+    static bool HasExtension(const char* extensions, const char* name)
+    {
+        return extensions != nullptr
+               && std::strstr(extensions, name) != nullptr;
+    }
+
+    static EGLDisplay GetPlatformDisplay()
+    {
+        const char* kClientExts = eglQueryString(EGL_NO_DISPLAY,
+                                                 EGL_EXTENSIONS);
+
+        // Mesa surfaceless platform needs neither X11 nor a GPU device
+        if (HasExtension(kClientExts, "EGL_MESA_platform_surfaceless"))
+        {
+            auto getPlatformDisplay =
+                reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                    eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+            if (getPlatformDisplay != nullptr)
+            {
+                EGLDisplay display = getPlatformDisplay(
+                    EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY,
+                    nullptr);
+                if (display != EGL_NO_DISPLAY)
+                    return display;
+            }
+        }
+
+        return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    static void InitDisplay()
+    {
+        SGL_FUNCTION();
+
+        s_Display = GetPlatformDisplay();
+        SGL_ASSERT_MSG(s_Display != EGL_NO_DISPLAY, "No EGL display");
+
+        EGLint major = 0, minor = 0;
+        const EGLBoolean kInitialized = eglInitialize(s_Display, &major,
+                                                      &minor);
+        SGL_ASSERT_MSG(kInitialized, "Failed to initialize EGL");
+        SGL_LOG_INFO("Initialized EGL {}.{}", major, minor);
+
+        s_Surfaceless = HasExtension(eglQueryString(s_Display, EGL_EXTENSIONS),
+                                     "EGL_KHR_surfaceless_context");
+
+        const EGLint kConfigAttribs[] = {
+            EGL_SURFACE_TYPE, s_Surfaceless ? 0 : EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_NONE
+        };
+
+        EGLint configCount = 0;
+        eglChooseConfig(s_Display, kConfigAttribs, &s_Config, 1,
+                        &configCount);
+        SGL_ASSERT_MSG(configCount > 0, "No suitable EGL config");
+    }
+
+    static void TerminateDisplay()
+    {
+        SGL_FUNCTION();
+
+        eglTerminate(s_Display);
+        s_Display = EGL_NO_DISPLAY;
+        s_Config = nullptr;
+    }
+#endif // SGL_HAS_EGL
+
+    bool HeadlessContext::IsAvailable()
+    {
+    #ifdef SGL_HAS_EGL
+        return true;
+    #else
+        return false;
+    #endif
+    }
+
+    void* HeadlessContext::GetProcAddress(const char* name)
+    {
+    #ifdef SGL_HAS_EGL
+        return reinterpret_cast<void*>(eglGetProcAddress(name));
+    #else
+        return nullptr;
+    #endif
+    }
+
+    // =========================================================================
+
+    HeadlessContext::HeadlessContext(const HeadlessContext* shared)
+    {
+        SGL_FUNCTION();
+
+    #ifdef SGL_HAS_EGL
+        std::lock_guard<std::mutex> lock(s_DisplayMutex);
+
+        if (s_ContextCount == 0)
+            InitDisplay();
+
+        // The bound API is per thread
+        const EGLBoolean kBound = eglBindAPI(EGL_OPENGL_API);
+        SGL_ASSERT_MSG(kBound, "EGL does not support desktop OpenGL");
+
+        const EGLint kContextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, SGL_GL_MAJOR_VERSION,
+            EGL_CONTEXT_MINOR_VERSION, SGL_GL_MINOR_VERSION,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        #ifdef SGL_DEBUG
+            EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+        #endif
+            EGL_NONE
+        };
+
+        EGLContext sharedContext = shared != nullptr
+                                   ? shared->m_Context : EGL_NO_CONTEXT;
+        m_Context = eglCreateContext(s_Display, s_Config, sharedContext,
+                                     kContextAttribs);
+        SGL_ASSERT_MSG(m_Context != EGL_NO_CONTEXT,
+                       "Headless OpenGL context creation failed: {:#x}",
+                       eglGetError());
+
+        if (!s_Surfaceless)
+        {
+            // Never rendered to, only makes the context current
+            const EGLint kPbufferAttribs[] = {
+                EGL_WIDTH, 1,
+                EGL_HEIGHT, 1,
+                EGL_NONE
+            };
+            m_Surface = eglCreatePbufferSurface(s_Display, s_Config,
+                                                kPbufferAttribs);
+            SGL_ASSERT_MSG(m_Surface != EGL_NO_SURFACE,
+                           "Pbuffer surface creation failed");
+        }
+
+        ++s_ContextCount;
+    #else
+        SGL_ASSERT_MSG(false, "SGL was built without a headless backend");
+    #endif
+
+        MakeCurrent();
+    }
+
+    HeadlessContext::~HeadlessContext()
+    {
+        SGL_FUNCTION();
+
+    #ifdef SGL_HAS_EGL
+        MakeCurrent();
+        DeleteFramebuffer();
+        ReleaseCurrent();
+
+        std::lock_guard<std::mutex> lock(s_DisplayMutex);
+
+        if (m_Surface != nullptr)
+            eglDestroySurface(s_Display, m_Surface);
+        if (m_Context != nullptr)
+            eglDestroyContext(s_Display, m_Context);
+
+        if (--s_ContextCount == 0)
+            TerminateDisplay();
+    #endif
+    }
+
+    void HeadlessContext::MakeCurrent() const
+    {
+    #ifdef SGL_HAS_EGL
+        const EGLSurface kSurface = m_Surface != nullptr ? m_Surface
+                                                         : EGL_NO_SURFACE;
+        const EGLBoolean kCurrent = eglMakeCurrent(s_Display,
+                                                   kSurface, kSurface,
+                                                   m_Context);
+        SGL_ASSERT_MSG(kCurrent, "Failed to make a headless context current");
+    #endif
+    }
+
+    void HeadlessContext::ReleaseCurrent()
+    {
+    #ifdef SGL_HAS_EGL
+        eglMakeCurrent(s_Display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                       EGL_NO_CONTEXT);
+    #endif
+    }
+
+    void HeadlessContext::CreateFramebuffer(uint32_t width, uint32_t height)
+    {
+        SGL_FUNCTION();
+
+        DeleteFramebuffer();
+
+        glCreateRenderbuffers(1, &m_ColorRBO);
+        glNamedRenderbufferStorage(m_ColorRBO, GL_RGBA8, width, height);
+
+        glCreateRenderbuffers(1, &m_DepthRBO);
+        glNamedRenderbufferStorage(m_DepthRBO, GL_DEPTH24_STENCIL8,
+                                   width, height);
+
+        glCreateFramebuffers(1, &m_FBO);
+        glNamedFramebufferRenderbuffer(m_FBO, GL_COLOR_ATTACHMENT0,
+                                       GL_RENDERBUFFER, m_ColorRBO);
+        glNamedFramebufferRenderbuffer(m_FBO, GL_DEPTH_STENCIL_ATTACHMENT,
+                                       GL_RENDERBUFFER, m_DepthRBO);
+
+        const GLenum kStatus = glCheckNamedFramebufferStatus(m_FBO,
+                                                             GL_FRAMEBUFFER);
+        SGL_ASSERT_MSG(kStatus == GL_FRAMEBUFFER_COMPLETE,
+                       "Headless framebuffer incomplete: {}", kStatus);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+        glViewport(0, 0, width, height);
+    }
+
+    void HeadlessContext::DeleteFramebuffer()
+    {
+        if (m_FBO == 0)
+            return;
+
+        glDeleteFramebuffers(1, &m_FBO);
+        glDeleteRenderbuffers(1, &m_ColorRBO);
+        glDeleteRenderbuffers(1, &m_DepthRBO);
+        m_FBO = m_ColorRBO = m_DepthRBO = 0;
+    }
+
+} // namespace sgl
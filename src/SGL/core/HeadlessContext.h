@@ -0,0 +1,67 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_HEADLESS_CONTEXT_H_
+#define SGL_CORE_HEADLESS_CONTEXT_H_
+
+#include <cstdint>
+
+
+namespace sgl
+{
+    /**
+     * @brief OpenGL context without any display server, using EGL.
+     *  Prefers a surfaceless context, falls back to a small pbuffer surface.
+     *  Rendering goes into a framebuffer object that replaces the default
+     *  framebuffer of a window.
+     */
+    class HeadlessContext
+    {
+    public:
+        /** @return True if SGL was built with a headless backend */
+        static bool IsAvailable();
+
+        /** @brief Function loader for GLAD, valid after a context exists */
+        static void* GetProcAddress(const char* name);
+
+    public:
+        /**
+         * @brief Creates the context and makes it current on this thread
+         * @param shared Context to share objects with, may be null
+         */
+        HeadlessContext(const HeadlessContext* shared = nullptr);
+        ~HeadlessContext();
+
+        HeadlessContext(const HeadlessContext&) = delete;
+        HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+        void MakeCurrent() const;
+        static void ReleaseCurrent();
+
+        /**
+         * @brief (Re)creates the framebuffer with color and depth-stencil
+         *  attachments.
+         * @pre GL functions are loaded, the context is current
+         */
+        void CreateFramebuffer(uint32_t width, uint32_t height);
+
+        uint32_t GetFramebufferID() const { return m_FBO; }
+
+    private:
+        void DeleteFramebuffer();
+
+    private:
+        void* m_Context{ nullptr };
+        void* m_Surface{ nullptr };     ///< Null when surfaceless
+
+        uint32_t m_FBO{ 0 };
+        uint32_t m_ColorRBO{ 0 };
+        uint32_t m_DepthRBO{ 0 };
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_CORE_HEADLESS_CONTEXT_H_
@@ -0,0 +1,189 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/core/HitchDetector.h"
+#include "SGL/core/GpuProfiler.h"
+#include "SGL/core/Profiler.h"
+#include "SGL/core/ThreadPool.h"
+
+#include <ctime>
+#include <filesystem>
+
+
+namespace sgl
+{
+    /**
+     * @brief Frames a capture waits after the hitch, the GPU results of the
+     *  hitch are read back or dropped by then
+     */
+    static constexpr uint32_t kCaptureDelay = GpuProfiler::MaxFramesInFlight;
+
+    HitchDetector::HitchDetector() = default;
+
+    HitchDetector::~HitchDetector() = default;
+
+    void HitchDetector::Enable(const HitchSpec& spec)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(spec.windowFrames > 0);
+
+        m_Spec = spec;
+
+        std::error_code error;
+        std::filesystem::create_directories(m_Spec.directory, error);
+        SGL_ASSERT_MSG(!error, "Could not create the hitch directory "
+                       "'{}': {}", m_Spec.directory, error.message());
+
+        m_FrameBegins.assign(m_Spec.windowFrames, 0);
+        m_FrameIndex = 0;
+        m_CapturePending = false;
+        m_CaptureRequested = false;
+
+        if (!Profiler::IsRecording())
+        {
+            Profiler::Get().BeginSession();
+            m_OwnsSession = true;
+        }
+
+        m_GpuWasEnabled = GpuProfiler::Get().IsEnabled();
+        if (m_Spec.gpuTimings)
+            GpuProfiler::Get().Enable(true);
+
+        if (m_Writer == nullptr)
+            m_Writer = std::make_unique<ThreadPool>(1);
+
+        m_Enabled = true;
+
+        SGL_LOG_INFO("Hitch detector enabled, budget {:.2f} ms, {} frames "
+                     "kept", m_Spec.budgetMillis, m_Spec.windowFrames);
+    }
+
+    void HitchDetector::Disable()
+    {
+        SGL_FUNCTION();
+
+        if (!m_Enabled)
+            return;
+
+        if (m_OwnsSession)
+            Profiler::Get().EndSession();
+        if (m_Spec.gpuTimings)
+            GpuProfiler::Get().Enable(m_GpuWasEnabled);
+
+        if (m_Writer != nullptr)
+            m_Writer->WaitIdle();
+
+        m_OwnsSession = false;
+        m_Enabled = false;
+    }
+
+    void HitchDetector::EndFrame(uint64_t frameBegin, uint64_t frameEnd)
+    {
+        if (!m_Enabled)
+            return;
+
+        const uint64_t kFrame = m_FrameIndex++;
+        m_FrameBegins[kFrame % m_FrameBegins.size()] = frameBegin;
+
+        const float kMillis = static_cast<float>(
+            (frameEnd - frameBegin) * NANOS_TO_MILLIS);
+        const bool kHitch = kMillis > m_Spec.budgetMillis;
+        if (kHitch)
+            ++m_HitchCount;
+
+        if (!m_CapturePending
+            && (m_CaptureRequested || (kHitch && CanCapture(frameEnd))))
+        {
+            m_CaptureManual = m_CaptureRequested;
+            m_CaptureRequested = false;
+            m_CapturePending = true;
+            m_PendingFrames = kCaptureDelay;
+            m_HitchFrame = kFrame;
+            m_HitchMillis = kMillis;
+        }
+
+        if (m_CapturePending)
+        {
+            // The window grows meanwhile, frames after the hitch are kept
+            if (m_PendingFrames > 0)
+            {
+                --m_PendingFrames;
+                return;
+            }
+
+            WriteCapture();
+        }
+
+        Profiler::Get().DiscardBefore(GetWindowBegin());
+    }
+
+    bool HitchDetector::CanCapture(uint64_t now) const
+    {
+        if (m_Spec.maxCaptures > 0 && m_CaptureCount >= m_Spec.maxCaptures)
+            return false;
+
+        const uint64_t kCooldown = static_cast<uint64_t>(
+            m_Spec.cooldownSeconds / NANOS_TO_SECONDS);
+        return m_CaptureCount == 0 || now - m_LastCaptureTime >= kCooldown;
+    }
+
+    uint64_t HitchDetector::GetWindowBegin() const
+    {
+        // Next slot to write holds the oldest frame once the ring is full
+        if (m_FrameIndex < m_FrameBegins.size())
+            return m_FrameBegins[0];
+
+        return m_FrameBegins[m_FrameIndex % m_FrameBegins.size()];
+    }
+
+    void HitchDetector::WriteCapture()
+    {
+        SGL_FUNCTION();
+
+        m_CapturePending = false;
+
+        const std::time_t kTime = std::time(nullptr);
+        std::tm local{};
+    #ifdef _WIN32
+        localtime_s(&local, &kTime);
+    #else
+        localtime_r(&kTime, &local);
+    #endif
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &local);
+
+        const std::string kFile = fmt::format("{}/hitch_{}_{:06}.json",
+                                              m_Spec.directory, stamp,
+                                              m_HitchFrame);
+        ++m_CaptureCount;
+        m_LastCapture = kFile;
+
+        // Only the copy happens here, writing the file would be a hitch
+        m_Writer->Enqueue([kFile, kFrame = m_HitchFrame,
+                           kManual = m_CaptureManual,
+                           kMillis = m_HitchMillis,
+                           kBudget = m_Spec.budgetMillis,
+                           trace = Profiler::Get().GetTrace()]() {
+            if (!Profiler::WriteChromeTrace(trace, kFile))
+                return;
+
+            if (kManual)
+            {
+                SGL_LOG_INFO("Requested trace of frame {} written to '{}'",
+                             kFrame, kFile);
+            }
+            else
+            {
+                SGL_LOG_WARN("Frame {} took {:.2f} ms ({:.2f} ms budget), "
+                             "trace written to '{}'", kFrame, kMillis,
+                             kBudget, kFile);
+            }
+        });
+
+        m_LastCaptureTime = Clock::Now();
+    }
+
+} // namespace sgl
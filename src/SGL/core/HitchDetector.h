@@ -0,0 +1,106 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_HITCH_DETECTOR_H_
+#define SGL_CORE_HITCH_DETECTOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace sgl
+{
+    class ThreadPool;
+
+    struct HitchSpec
+    {
+        float budgetMillis{ 50.0f };    ///< Longer frames are hitches
+        uint32_t windowFrames{ 120 };   ///< Frames kept before a hitch
+
+        std::string directory{ "." };   ///< Files are hitch_<time>_<frame>
+        uint32_t maxCaptures{ 10 };     ///< Per run, 0 for no limit
+        float cooldownSeconds{ 10.0f }; ///< Between two captures
+
+        bool gpuTimings{ true };        ///< Enables the GPU profiler
+    };
+
+    /**
+     * @brief Keeps the profiler events of the last frames and writes them
+     *  to a Chrome trace when a frame goes over the budget, or when asked.
+     *  The window holds the CPU scopes, the GPU scopes and the upload and
+     *  compile scopes of the GL classes. Recording only fills the profiler
+     *  buffers, files are written on demand by a worker thread, so it can
+     *  stay enabled. The detector owns the profiler session while enabled.
+     */
+    class HitchDetector
+    {
+    public:
+        HitchDetector();
+        ~HitchDetector();
+
+        void Enable(const HitchSpec& spec = HitchSpec());
+        /** @brief Restores the GPU profiler, waits for the pending writes */
+        void Disable();
+        bool IsEnabled() const { return m_Enabled; }
+
+        /** @brief Writes the window at the end of the next frame */
+        void RequestCapture() { m_CaptureRequested = true; }
+
+        /**
+         * @brief Called once per frame by the Application loop, after the
+         *  profiler events were collected
+         * @param frameBegin, frameEnd Nanoseconds of the "Clock"
+         */
+        void EndFrame(uint64_t frameBegin, uint64_t frameEnd);
+
+        /** @return Frames over the budget, captured or not */
+        uint64_t GetHitchCount() const { return m_HitchCount; }
+        uint32_t GetCaptureCount() const { return m_CaptureCount; }
+        /**
+         * @return File of the last capture, empty before the first one.
+         *  The worker may still be writing it.
+         */
+        const std::string& GetLastCapture() const { return m_LastCapture; }
+
+    private:
+        bool CanCapture(uint64_t now) const;
+        /** @return Start of the oldest frame in the window */
+        uint64_t GetWindowBegin() const;
+
+        void WriteCapture();
+
+    private:
+        HitchSpec m_Spec;
+        bool m_Enabled{ false };
+        bool m_OwnsSession{ false };
+        bool m_GpuWasEnabled{ false };  ///< GPU profiler before "Enable"
+
+        /// Writes the traces, off the render thread
+        std::unique_ptr<ThreadPool> m_Writer;
+
+        /// Ring of the frame starts, sized to the window
+        std::vector<uint64_t> m_FrameBegins;
+        uint64_t m_FrameIndex{ 0 };
+
+        bool m_CaptureRequested{ false };
+        /// Frames left until the GPU results of the hitch are read back
+        uint32_t m_PendingFrames{ 0 };
+        bool m_CapturePending{ false };
+        bool m_CaptureManual{ false };  ///< Requested, not a hitch
+        uint64_t m_HitchFrame{ 0 };
+        float m_HitchMillis{ 0.0f };
+
+        uint64_t m_HitchCount{ 0 };
+        uint32_t m_CaptureCount{ 0 };
+        uint64_t m_LastCaptureTime{ 0 };
+        std::string m_LastCapture;
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_CORE_HITCH_DETECTOR_H_
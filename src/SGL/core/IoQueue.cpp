@@ -0,0 +1,548 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/core/IoQueue.h"
+#include "SGL/core/Profiler.h"
+
+#include <limits>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <cstring>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+namespace sgl
+{
+    namespace io
+    {
+        constexpr uint64_t kEndOfFile = std::numeric_limits<uint64_t>::max();
+
+        /** @brief Positional reads, threads do not share a file offset */
+        class File
+        {
+        public:
+            File() = default;
+            ~File() { Close(); }
+
+            File(const File&) = delete;
+            File& operator=(const File&) = delete;
+
+            bool Open(const std::string& path, std::string& outError)
+            {
+            #ifdef _WIN32
+                m_Handle = CreateFileA(path.c_str(), GENERIC_READ,
+                                       FILE_SHARE_READ, nullptr,
+                                       OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                                       nullptr);
+                LARGE_INTEGER size{};
+                if (m_Handle == INVALID_HANDLE_VALUE
+                    || !GetFileSizeEx(m_Handle, &size))
+                {
+                    outError = fmt::format("Failed to open '{}': error {}",
+                                           path, GetLastError());
+                    return false;
+                }
+                m_Size = static_cast<uint64_t>(size.QuadPart);
+            #else
+                m_FD = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                struct stat status{};
+                if (m_FD < 0 || ::fstat(m_FD, &status) != 0)
+                {
+                    outError = fmt::format("Failed to open '{}': {}", path,
+                                           std::strerror(errno));
+                    return false;
+                }
+                m_Size = static_cast<uint64_t>(status.st_size);
+            #endif
+                return true;
+            }
+
+            void Close()
+            {
+            #ifdef _WIN32
+                if (m_Handle != INVALID_HANDLE_VALUE)
+                    CloseHandle(m_Handle);
+                m_Handle = INVALID_HANDLE_VALUE;
+            #else
+                if (m_FD >= 0)
+                    ::close(m_FD);
+                m_FD = -1;
+            #endif
+            }
+
+            /**
+             * @brief Hints how a range is read next, "willNeed" starts its
+             *  readahead now. Windows has no hints on an open file.
+             */
+            void Advise(uint64_t offset, uint64_t size, bool willNeed) const
+            {
+            #if !defined(_WIN32) && !defined(__APPLE__)
+                ::posix_fadvise(m_FD, static_cast<off_t>(offset),
+                                static_cast<off_t>(size),
+                                willNeed ? POSIX_FADV_WILLNEED
+                                         : POSIX_FADV_SEQUENTIAL);
+            #else
+                (void)offset;
+                (void)size;
+                (void)willNeed;
+            #endif
+            }
+
+            /** @return Bytes read, 0 at the end of the file, -1 on errors */
+            int64_t ReadAt(unsigned char* data, size_t size,
+                           uint64_t offset) const
+            {
+            #ifdef _WIN32
+                // The offset of an overlapped structure makes a
+                //  synchronous read positional
+                OVERLAPPED overlapped{};
+                overlapped.Offset = static_cast<DWORD>(offset);
+                overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+                DWORD read = 0;
+                if (!ReadFile(m_Handle, data, static_cast<DWORD>(size),
+                              &read, &overlapped))
+                {
+                    return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+                }
+                return static_cast<int64_t>(read);
+            #else
+                while (true)
+                {
+                    const ssize_t kRead = ::pread(m_FD, data, size,
+                                                  static_cast<off_t>(offset));
+                    if (kRead >= 0 || errno != EINTR)
+                        return static_cast<int64_t>(kRead);
+                }
+            #endif
+            }
+
+            uint64_t GetSize() const { return m_Size; }
+
+        private:
+        #ifdef _WIN32
+            HANDLE m_Handle{ INVALID_HANDLE_VALUE };
+        #else
+            int m_FD{ -1 };
+        #endif
+            uint64_t m_Size{ 0 };
+        };
+
+        /** @return End of a range, "kEndOfFile" for the whole file */
+        inline uint64_t RangeEnd(uint64_t offset, size_t size)
+        {
+            return size == IoQueue::WholeFile ? kEndOfFile : offset + size;
+        }
+
+        inline std::string LastError()
+        {
+        #ifdef _WIN32
+            return fmt::format("error {}", GetLastError());
+        #else
+            return std::strerror(errno);
+        #endif
+        }
+    } // namespace io
+
+    std::shared_ptr<IoQueue> IoQueue::Create(uint32_t threadCount)
+    {
+        return std::make_shared<IoQueue>(threadCount);
+    }
+
+    // =========================================================================
+
+    IoQueue::IoQueue(uint32_t threadCount)
+    {
+        SGL_FUNCTION();
+
+        threadCount = std::max(threadCount, 1u);
+
+        m_Workers.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; ++i)
+            m_Workers.emplace_back(&IoQueue::WorkerLoop, this);
+    }
+
+    IoQueue::~IoQueue()
+    {
+        SGL_FUNCTION();
+
+        std::vector<Request> queued;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stop = true;
+
+            for (auto& [key, request] : m_Queue)
+                queued.push_back(std::move(request));
+            m_Queue.clear();
+            m_Queued.clear();
+
+            for (auto& [id, cancelled] : m_Running)
+                cancelled->store(true);
+        }
+        m_RequestAvailable.notify_all();
+
+        for (Request& request : queued)
+        {
+            IoResult result;
+            result.status = IoStatus::Cancelled;
+            Complete(request, std::move(result));
+        }
+
+        for (auto& worker : m_Workers)
+            worker.join();
+    }
+
+    uint64_t IoQueue::Read(const std::string& path, IoPriority priority,
+                           IoCallback callback, uint64_t offset,
+                           size_t size)
+    {
+        Request request;
+        request.path = path;
+        request.offset = offset;
+        request.size = size;
+        request.callback = std::move(callback);
+
+        uint64_t id = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            SGL_ASSERT_MSG(!m_Stop, "Read queued on a stopped I/O queue");
+
+            id = m_NextID++;
+            request.id = id;
+            m_Queue.emplace(MakeKey(priority, id), std::move(request));
+            m_Queued.emplace(id, priority);
+        }
+        m_RequestAvailable.notify_one();
+
+        return id;
+    }
+
+    std::future<IoResult> IoQueue::ReadAsync(const std::string& path,
+                                             IoPriority priority,
+                                             uint64_t offset, size_t size,
+                                             uint64_t* outId)
+    {
+        // std::function needs a copyable target
+        auto promise = std::make_shared<std::promise<IoResult>>();
+        std::future<IoResult> future = promise->get_future();
+
+        const uint64_t kID = Read(path, priority,
+                                  [promise](IoResult&& result) {
+                                      promise->set_value(std::move(result));
+                                  },
+                                  offset, size);
+        if (outId != nullptr)
+            *outId = kID;
+
+        return future;
+    }
+
+    bool IoQueue::Cancel(uint64_t id)
+    {
+        Request request;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            const auto kRunning = m_Running.find(id);
+            if (kRunning != m_Running.end())
+            {
+                kRunning->second->store(true);
+                return true;
+            }
+
+            const auto kQueued = m_Queued.find(id);
+            if (kQueued == m_Queued.end())
+                return false;
+
+            auto node = m_Queue.extract(MakeKey(kQueued->second, id));
+            request = std::move(node.mapped());
+            m_Queued.erase(kQueued);
+        }
+        m_Idle.notify_all();
+
+        IoResult result;
+        result.status = IoStatus::Cancelled;
+        Complete(request, std::move(result));
+        return true;
+    }
+
+    bool IoQueue::SetPriority(uint64_t id, IoPriority priority)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        const auto kQueued = m_Queued.find(id);
+        if (kQueued == m_Queued.end())
+            return false;
+
+        // Keeps its age, it goes before the newer requests of the priority
+        auto node = m_Queue.extract(MakeKey(kQueued->second, id));
+        node.key() = MakeKey(priority, id);
+        m_Queue.insert(std::move(node));
+        kQueued->second = priority;
+        return true;
+    }
+
+    void IoQueue::WaitIdle()
+    {
+        SGL_FUNCTION();
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Idle.wait(lock, [this]() {
+            return m_Queue.empty() && m_Running.empty();
+        });
+    }
+
+    size_t IoQueue::GetQueuedCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Queue.size();
+    }
+
+    void IoQueue::WorkerLoop()
+    {
+        SGL_PROFILE_THREAD("IoQueue");
+
+        std::vector<Request> requests;
+
+        while (true)
+        {
+            std::string nextPath;
+            uint64_t nextOffset = 0;
+            size_t nextSize = WholeFile;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_RequestAvailable.wait(lock, [this]() {
+                    return m_Stop || !m_Queue.empty();
+                });
+
+                // The destructor cancels what is queued
+                if (m_Queue.empty())
+                    return;
+
+                auto first = m_Queue.begin();
+                requests.push_back(std::move(first->second));
+                m_Queue.erase(first);
+                m_Queued.erase(requests.front().id);
+
+                TakeAdjacent(requests.front(), requests);
+
+                for (Request& request : requests)
+                {
+                    request.cancelled
+                        = std::make_shared<std::atomic<bool>>(false);
+                    m_Running.emplace(request.id, request.cancelled);
+                }
+
+                if (!m_Queue.empty()
+                    && m_Queue.begin()->second.path != requests[0].path)
+                {
+                    const Request& kNext = m_Queue.begin()->second;
+                    nextPath = kNext.path;
+                    nextOffset = kNext.offset;
+                    nextSize = kNext.size;
+                }
+            }
+
+            // The kernel reads the next file while this one is served
+            if (!nextPath.empty())
+            {
+                io::File next;
+                std::string error;
+                if (next.Open(nextPath, error))
+                {
+                    const uint64_t kEnd = std::min(
+                        io::RangeEnd(nextOffset, nextSize), next.GetSize());
+                    if (nextOffset < kEnd)
+                        next.Advise(nextOffset, kEnd - nextOffset, true);
+                }
+            }
+
+            Serve(requests);
+
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                for (const Request& kRequest : requests)
+                    m_Running.erase(kRequest.id);
+            }
+            requests.clear();
+            m_Idle.notify_all();
+        }
+    }
+
+    void IoQueue::TakeAdjacent(const Request& first,
+                               std::vector<Request>& outRequests)
+    {
+        // "first" may be in "outRequests", which grows
+        const std::string kPath = first.path;
+        uint64_t begin = first.offset;
+        uint64_t end = io::RangeEnd(first.offset, first.size);
+
+        // Again until nothing is taken, a range may bridge two others
+        bool taken = true;
+        while (taken)
+        {
+            taken = false;
+            for (auto it = m_Queue.begin(); it != m_Queue.end();)
+            {
+                const Request& kRequest = it->second;
+                const uint64_t kEnd = io::RangeEnd(kRequest.offset,
+                                                   kRequest.size);
+                const bool kClose = kRequest.path == kPath
+                    && kRequest.offset <= (end == io::kEndOfFile
+                                           ? end : end + MergeGap)
+                    && begin <= (kEnd == io::kEndOfFile
+                                 ? kEnd : kEnd + MergeGap);
+                if (!kClose)
+                {
+                    ++it;
+                    continue;
+                }
+
+                begin = std::min(begin, kRequest.offset);
+                end = std::max(end, kEnd);
+                m_Queued.erase(kRequest.id);
+                outRequests.push_back(std::move(it->second));
+                it = m_Queue.erase(it);
+                taken = true;
+            }
+        }
+    }
+
+    void IoQueue::Serve(std::vector<Request>& requests)
+    {
+        SGL_PROFILE_SCOPE("IoQueue::Serve");
+
+        const std::string& kPath = requests.front().path;
+
+        io::File file;
+        std::string error;
+        if (!file.Open(kPath, error))
+        {
+            for (Request& request : requests)
+            {
+                IoResult result;
+                result.error = error;
+                Complete(request, std::move(result));
+            }
+            return;
+        }
+
+        uint64_t begin = io::kEndOfFile;
+        uint64_t end = 0;
+        for (const Request& kRequest : requests)
+        {
+            begin = std::min(begin, kRequest.offset);
+            end = std::max(end, io::RangeEnd(kRequest.offset,
+                                              kRequest.size));
+        }
+        end = std::min(end, file.GetSize());
+
+        auto AllCancelled = [&requests]() {
+            for (const Request& kRequest : requests)
+            {
+                if (!kRequest.cancelled->load(std::memory_order_relaxed))
+                    return false;
+            }
+            return true;
+        };
+
+        // One read for the merged range, in chunks to see cancels
+        std::vector<unsigned char> data;
+        uint64_t read = 0;
+        if (begin < end)
+        {
+            data.resize(static_cast<size_t>(end - begin));
+            file.Advise(begin, end - begin, false);
+
+            while (read < data.size() && !AllCancelled())
+            {
+                const size_t kChunk = std::min<size_t>(
+                    ChunkSize, data.size() - static_cast<size_t>(read));
+                const int64_t kRead = file.ReadAt(data.data() + read, kChunk,
+                                                  begin + read);
+                if (kRead < 0)
+                {
+                    error = fmt::format("Failed to read '{}': {}", kPath,
+                                        io::LastError());
+                    break;
+                }
+                if (kRead == 0)
+                    break;
+
+                read += static_cast<uint64_t>(kRead);
+            }
+            data.resize(static_cast<size_t>(read));
+        }
+
+        m_BytesRead += read;
+        m_Merged += requests.size() - 1;
+
+        for (Request& request : requests)
+        {
+            IoResult result;
+            if (request.cancelled->load())
+            {
+                result.status = IoStatus::Cancelled;
+            }
+            else if (!error.empty())
+            {
+                result.error = error;
+            }
+            else if (request.offset > file.GetSize())
+            {
+                result.error = fmt::format("Offset {} is past the end of "
+                                           "'{}', {} bytes", request.offset,
+                                           kPath, file.GetSize());
+            }
+            else
+            {
+                result.status = IoStatus::Completed;
+
+                // The only request takes the buffer, merged ones a slice
+                if (requests.size() == 1)
+                {
+                    result.data = std::move(data);
+                }
+                else
+                {
+                    const uint64_t kFirst = std::min(request.offset - begin,
+                                                     read);
+                    const uint64_t kLast = std::min(
+                        io::RangeEnd(request.offset, request.size) - begin,
+                        read);
+                    result.data.assign(
+                        data.begin() + static_cast<ptrdiff_t>(kFirst),
+                        data.begin() + static_cast<ptrdiff_t>(kLast));
+                }
+            }
+            Complete(request, std::move(result));
+        }
+    }
+
+    void IoQueue::Complete(Request& request, IoResult&& result)
+    {
+        result.id = request.id;
+        result.path = request.path;
+
+        if (result.status == IoStatus::Failed)
+            SGL_LOG_WARN("{}", result.error);
+
+        if (request.callback)
+            request.callback(std::move(result));
+    }
+
+} // namespace sgl
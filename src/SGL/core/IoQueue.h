@@ -0,0 +1,187 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_IO_QUEUE_H_
+#define SGL_CORE_IO_QUEUE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace sgl
+{
+    /** @brief Requests of a higher priority are read first */
+    enum class IoPriority
+    {
+        Low = 0,        ///< Prefetch of what may be needed later
+        Normal,
+        High            ///< Needed for the next frames
+    };
+
+    enum class IoStatus
+    {
+        Completed = 0,
+        Failed,
+        Cancelled
+    };
+
+    struct IoResult
+    {
+        uint64_t id{ 0 };
+        IoStatus status{ IoStatus::Failed };
+        /// Bytes read, fewer than requested at the end of the file
+        std::vector<unsigned char> data;
+        std::string path;
+        std::string error;
+
+        bool Ok() const { return status == IoStatus::Completed; }
+    };
+
+    /**
+     * @brief Called once per request, on an I/O thread, or by "Cancel" for
+     *  requests that did not start
+     */
+    using IoCallback = std::function<void(IoResult&& result)>;
+
+    /**
+     * @brief Reads files on a few I/O threads without blocking the caller.
+     *  Requests are read by priority, then in the order they came.
+     *  A thread that takes a request also takes the queued requests of
+     *  ranges of the same file within "MergeGap" of it, and reads them with
+     *  one pread, so chunks of a pack file or a file requested twice are
+     *  read once. The next queued file is hinted to the kernel, so that its
+     *  readahead overlaps the current read.
+     *  Queued requests are dropped by "Cancel", running ones stop after the
+     *  current chunk.
+     */
+    class IoQueue
+    {
+    public:
+        /** @brief Size of a request that reads to the end of the file */
+        static constexpr size_t WholeFile = 0;
+        /** @brief Bytes between two ranges read in one request at most */
+        static constexpr size_t MergeGap = 64 << 10;
+        /** @brief Bytes read before checking for a cancel */
+        static constexpr size_t ChunkSize = 4 << 20;
+        static constexpr uint32_t DefaultThreadCount = 2;
+
+        static std::shared_ptr<IoQueue> Create(
+            uint32_t threadCount = DefaultThreadCount);
+
+    public:
+        /**
+         * @param threadCount Reads in flight, disks serve a few in parallel
+         *  better than one, more only add seeks
+         */
+        IoQueue(uint32_t threadCount = DefaultThreadCount);
+
+        /** @brief Cancels the queued requests, waits for the running ones */
+        ~IoQueue();
+
+        IoQueue(const IoQueue&) = delete;
+        IoQueue& operator=(const IoQueue&) = delete;
+
+        /**
+         * @brief Queues the read of a range of a file
+         * @param size In bytes, "WholeFile" up to the end
+         * @return Id of the request, for "Cancel" and "SetPriority"
+         */
+        uint64_t Read(const std::string& path,
+                      IoPriority priority,
+                      IoCallback callback,
+                      uint64_t offset = 0,
+                      size_t size = WholeFile);
+
+        /** @brief "Read" whose result is given by a future */
+        std::future<IoResult> ReadAsync(const std::string& path,
+                                        IoPriority priority,
+                                        uint64_t offset = 0,
+                                        size_t size = WholeFile,
+                                        uint64_t* outId = nullptr);
+
+        /**
+         * @brief Drops a queued request, its callback is called now with
+         *  "IoStatus::Cancelled". A running one ends so, without its data.
+         * @return False if the request is done already, or unknown
+         */
+        bool Cancel(uint64_t id);
+
+        /**
+         * @brief Moves a queued request, e.g. of an asset coming into view
+         * @return False if it is not queued anymore
+         */
+        bool SetPriority(uint64_t id, IoPriority priority);
+
+        /** @brief Blocks until no request is queued or running */
+        void WaitIdle();
+
+        size_t GetQueuedCount() const;
+        /** @return Requests served by the read of another one */
+        uint64_t GetMergedCount() const { return m_Merged.load(); }
+        uint64_t GetBytesRead() const { return m_BytesRead.load(); }
+
+    private:
+        struct Request
+        {
+            uint64_t id{ 0 };
+            std::string path;
+            uint64_t offset{ 0 };
+            size_t size{ WholeFile };
+            IoCallback callback;
+            std::shared_ptr<std::atomic<bool>> cancelled;
+        };
+
+        /// Highest priority first, then the oldest
+        using QueueKey = std::pair<int, uint64_t>;
+
+        static QueueKey MakeKey(IoPriority priority, uint64_t id) {
+            return { -static_cast<int>(priority), id };
+        }
+
+        void WorkerLoop();
+
+        /** @brief Reads the requests of one file, merged in one range */
+        void Serve(std::vector<Request>& requests);
+
+        /** @brief Takes the queued requests close to "first", locked */
+        void TakeAdjacent(const Request& first,
+                          std::vector<Request>& outRequests);
+
+        static void Complete(Request& request, IoResult&& result);
+
+    private:
+        std::vector<std::thread> m_Workers;
+
+        mutable std::mutex m_Mutex;
+        std::condition_variable m_RequestAvailable;
+        std::condition_variable m_Idle;
+        std::map<QueueKey, Request> m_Queue;
+        /// Priorities of the queued requests, by id
+        std::unordered_map<uint64_t, IoPriority> m_Queued;
+        /// Cancel flags of the running requests, by id
+        std::unordered_map<uint64_t,
+                           std::shared_ptr<std::atomic<bool>>> m_Running;
+        uint64_t m_NextID{ 1 };
+        bool m_Stop{ false };
+
+        std::atomic<uint64_t> m_Merged{ 0 };
+        std::atomic<uint64_t> m_BytesRead{ 0 };
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_CORE_IO_QUEUE_H_
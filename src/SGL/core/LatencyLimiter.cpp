@@ -0,0 +1,187 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/core/LatencyLimiter.h"
+
+#include <thread>
+
+
+namespace sgl
+{
+    /** @brief Keeps a margin for the scheduler wake-up when sleeping */
+    static constexpr float kLateStartMargin = 0.002f;
+
+    /** @brief Weight of the latest sample in the average latency */
+    static constexpr float kLatencySmoothing = 0.1f;
+
+    LatencyLimiter::LatencyLimiter(uint32_t framesInFlight)
+    {
+        SGL_FUNCTION();
+        SetFramesInFlight(framesInFlight);
+    }
+
+    LatencyLimiter::~LatencyLimiter()
+    {
+        SGL_FUNCTION();
+        DeleteFences();
+    }
+
+    void LatencyLimiter::Enable(bool enabled)
+    {
+        SGL_FUNCTION();
+
+        if (!enabled)
+            DeleteFences();
+
+        m_Enabled = enabled;
+    }
+
+    void LatencyLimiter::SetFramesInFlight(uint32_t count)
+    {
+        m_FramesInFlight = std::clamp(count, 1u, MaxFramesInFlight);
+    }
+
+    void LatencyLimiter::SetLateStart(bool enabled, float refreshRate)
+    {
+        SGL_ASSERT(refreshRate > 0.0f);
+
+        m_LateStart = enabled;
+        m_RefreshPeriod = 1.0f / refreshRate;
+    }
+
+    void LatencyLimiter::OnPresent()
+    {
+        if (!m_Enabled)
+            return;
+
+        FrameSlot& slot = m_Slots[m_Current];
+        SGL_ASSERT_MSG(slot.fence == nullptr, "Frame slot still in flight");
+
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        m_Current = (m_Current + 1) % MaxFramesInFlight;
+    }
+
+    void LatencyLimiter::WaitForFrame()
+    {
+        if (!m_Enabled)
+            return;
+
+        CollectSignaled();
+
+        // Age 1 is the frame just presented, wait on every frame at least
+        //  N frames old, oldest first
+        for (uint32_t age = MaxFramesInFlight; age >= m_FramesInFlight; --age)
+        {
+            const uint32_t kIndex = (m_Current + MaxFramesInFlight - age)
+                                    % MaxFramesInFlight;
+            WaitForSlot(m_Slots[kIndex]);
+        }
+
+        if (m_LateStart)
+            SleepUntilLateStart();
+    }
+
+    void LatencyLimiter::OnInputSampled()
+    {
+        if (!m_Enabled)
+            return;
+
+        FrameSlot& slot = m_Slots[m_Current];
+        slot.inputTimer.Start();
+        slot.inputSampled = true;
+    }
+
+    void LatencyLimiter::WaitForSlot(FrameSlot& slot)
+    {
+        if (slot.fence == nullptr)
+            return;
+
+        // One second, waits in a loop as the driver may cap the timeout
+        const GLuint64 kTimeoutNanos = 1000000000;
+
+        GLenum status = glClientWaitSync(slot.fence,
+                                         GL_SYNC_FLUSH_COMMANDS_BIT,
+                                         kTimeoutNanos);
+        while (status == GL_TIMEOUT_EXPIRED)
+            status = glClientWaitSync(slot.fence, 0, kTimeoutNanos);
+
+        SGL_ASSERT_MSG(status != GL_WAIT_FAILED, "Waiting on a fence failed");
+
+        m_SinceSignaled.Start();
+        ReportLatency(slot);
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+
+    void LatencyLimiter::CollectSignaled()
+    {
+        for (uint32_t age = MaxFramesInFlight; age > 0; --age)
+        {
+            const uint32_t kIndex = (m_Current + MaxFramesInFlight - age)
+                                    % MaxFramesInFlight;
+            FrameSlot& slot = m_Slots[kIndex];
+            if (slot.fence == nullptr)
+                continue;
+
+            const GLenum kStatus = glClientWaitSync(slot.fence, 0, 0);
+            if (kStatus != GL_ALREADY_SIGNALED &&
+                kStatus != GL_CONDITION_SATISFIED)
+            {
+                // Later frames cannot be done before this one
+                return;
+            }
+
+            m_SinceSignaled.Start();
+            ReportLatency(slot);
+
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+    }
+
+    void LatencyLimiter::ReportLatency(FrameSlot& slot)
+    {
+        if (!slot.inputSampled)
+            return;
+
+        m_LastLatency = slot.inputTimer.ElapsedMicro() * MICROS_TO_SECONDS;
+
+        m_AvgLatency = m_AvgLatency == 0.0f
+            ? m_LastLatency
+            : m_AvgLatency + kLatencySmoothing * (m_LastLatency - m_AvgLatency);
+
+        slot.inputSampled = false;
+    }
+
+    void LatencyLimiter::SleepUntilLateStart() const
+    {
+        // The last signaled fence approximates the last refresh, the next
+        //  frame has to be done within the remaining part of the period
+        const float kElapsed = m_SinceSignaled.ElapsedMicro()
+                               * MICROS_TO_SECONDS;
+        const float kSleep = m_RefreshPeriod - kElapsed - m_AvgLatency
+                             - kLateStartMargin;
+        if (kSleep <= 0.0f)
+            return;
+
+        std::this_thread::sleep_for(std::chrono::duration<float>(kSleep));
+    }
+
+    void LatencyLimiter::DeleteFences()
+    {
+        for (auto& slot : m_Slots)
+        {
+            if (slot.fence != nullptr)
+                glDeleteSync(slot.fence);
+
+            slot.fence = nullptr;
+            slot.inputSampled = false;
+        }
+    }
+
+} // namespace sgl
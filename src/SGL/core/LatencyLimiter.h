@@ -0,0 +1,109 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_LATENCY_LIMITER_H_
+#define SGL_CORE_LATENCY_LIMITER_H_
+
+#include <array>
+#include <cstdint>
+
+#include "SGL/core/Timer.h"
+#include "SGL/core/Timestep.h"
+
+typedef struct __GLsync* GLsync;
+
+
+namespace sgl
+{
+    /**
+     * @brief Limits the number of frames queued ahead of the GPU to reduce
+     *  input-to-photon latency.
+     *  Places a fence after each presented frame and, before the input of
+     *  the next frame is sampled, waits on the fence from N-1 frames back.
+     *  Optionally sleeps so the work of the next frame starts as late as
+     *  possible before the next refresh.
+     * @pre Used on the thread with the current GL context
+     */
+    class LatencyLimiter
+    {
+    public:
+        static constexpr uint32_t MaxFramesInFlight = 4;
+
+    public:
+        LatencyLimiter(uint32_t framesInFlight = 1);
+        ~LatencyLimiter();
+
+        void Enable(bool enabled);
+        bool IsEnabled() const { return m_Enabled; }
+
+        /** @param count Clamped to [1, MaxFramesInFlight] */
+        void SetFramesInFlight(uint32_t count);
+        uint32_t GetFramesInFlight() const { return m_FramesInFlight; }
+
+        /**
+         * @brief Sleeps before sampling input, to start the frame as late as
+         *  possible before the next refresh
+         * @param refreshRate Display refresh rate in Hz
+         */
+        void SetLateStart(bool enabled, float refreshRate = 60.0f);
+        bool IsLateStart() const { return m_LateStart; }
+
+        /** @brief Call right after the frame has been presented */
+        void OnPresent();
+
+        /**
+         * @brief Waits on the fence from N-1 frames back, call before
+         *  sampling input
+         */
+        void WaitForFrame();
+
+        /** @brief Call right after the input has been sampled */
+        void OnInputSampled();
+
+        /** @return Last measured time from input sampling to present */
+        Timestep GetInputLatency() const { return m_LastLatency; }
+
+        /** @return Exponential moving average of the input latency */
+        Timestep GetAverageInputLatency() const { return m_AvgLatency; }
+
+    private:
+        struct FrameSlot
+        {
+            GLsync fence{ nullptr };
+            Timer inputTimer;   ///< Started when the input was sampled
+            bool inputSampled{ false };
+        };
+
+        void WaitForSlot(FrameSlot& slot);
+
+        /** @brief Collects already signaled fences without blocking */
+        void CollectSignaled();
+
+        void ReportLatency(FrameSlot& slot);
+
+        void SleepUntilLateStart() const;
+
+        void DeleteFences();
+
+    private:
+        bool m_Enabled{ false };
+        bool m_LateStart{ false };
+
+        uint32_t m_FramesInFlight{ 1 };
+        float m_RefreshPeriod{ 1.0f / 60.0f };  ///< In seconds
+
+        std::array<FrameSlot, MaxFramesInFlight> m_Slots;
+        uint32_t m_Current{ 0 };    ///< Slot of the frame being recorded
+
+        Timer m_SinceSignaled;      ///< Time since the last waited fence
+
+        float m_LastLatency{ 0.0f };
+        float m_AvgLatency{ 0.0f };
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_CORE_LATENCY_LIMITER_H_
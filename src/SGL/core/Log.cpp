@@ -1,33 +1,459 @@
 /**
- *  Copyright (c) 2022 SGL authors Distributed under MIT License 
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
  * (http://opensource.org/licenses/MIT)
  */
 
 #include "SGL/pch.h"
 #include "SGL/core/Log.h"
 
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
 #include <spdlog/spdlog.h>
+#include <spdlog/details/os.h>
+#include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
 
 namespace sgl
 {
-    std::shared_ptr<spdlog::logger> Log::s_Logger;
+    static constexpr uint64_t kQueueMask = Log::QueueCapacity - 1;
+    static_assert((Log::QueueCapacity & kQueueMask) == 0,
+                  "Log queue capacity must be a power of two");
+
+    /**
+     * @brief Max time a message waits in a queue, in milliseconds. The
+     *  drain thread gathers the messages of this window into one write.
+     */
+    static constexpr uint32_t kDrainInterval = 5;
+
+    /** @brief Single producer, the owner thread, single consumer */
+    struct LogQueue
+    {
+        std::unique_ptr<LogRecord[]> records;
+        std::atomic<uint64_t> head{ 0 };    ///< Written by the owner
+        std::atomic<uint64_t> tail{ 0 };    ///< Written by the drain
+        std::atomic<uint64_t> dropped{ 0 };
+
+        size_t threadID{ 0 };
+    };
+
+    /** @brief Queue registry, drain thread and sinks */
+    class LogBackend
+    {
+    public:
+        /** @brief Never destroyed, static destructors may still log */
+        static LogBackend& Get()
+        {
+            static LogBackend* s_Backend = new LogBackend();
+            return *s_Backend;
+        }
+
+        void Start(const LogSpec& spec);
+        void Stop();
+
+        LogQueue* RegisterThread();
+
+        /** @brief Writes out all queued messages, from any thread */
+        void Drain();
+        /**
+         * @brief Called by producers after publishing a message, wakes up
+         *  the drain thread if it sleeps with nothing pending
+         */
+        void NotifyPending();
+        /** @brief Called by producers when their queue fills up */
+        void Wake();
+
+        bool IsRunning() const {
+            return m_Running.load(std::memory_order_relaxed);
+        }
+        LogOverflowPolicy GetOverflowPolicy() const {
+            return m_OverflowPolicy.load(std::memory_order_relaxed);
+        }
+
+        uint64_t GetDroppedCount();
+
+    private:
+        void DrainLoop();
+        void WriteRecord(const LogRecord& record);
+        void ReportDrops();
+
+    private:
+        std::mutex m_Mutex;     ///< Guards the registry
+        std::vector<std::shared_ptr<LogQueue>> m_Queues;
+        uint64_t m_RetiredDrops{ 0 };   ///< Of the removed queues
+
+        /// Held while draining, the sinks are used by one thread at a time
+        std::mutex m_DrainMutex;
+        std::vector<std::pair<LogQueue*, uint64_t>> m_Heads;
+        std::vector<LogRecord*> m_Batch;
+        fmt::memory_buffer m_Payload;
+        uint64_t m_ReportedDrops{ 0 };
+
+        std::shared_ptr<spdlog::sinks::sink> m_ConsoleSink;
+        std::shared_ptr<spdlog::sinks::sink> m_SourceSink;  ///< With location
+        std::shared_ptr<spdlog::sinks::sink> m_FileSink;
+        std::atomic<LogOverflowPolicy> m_OverflowPolicy{
+            LogOverflowPolicy::Drop };
+
+        std::atomic<bool> m_Running{ false };
+        /// Whether a message was published since the drain took the heads
+        std::atomic<bool> m_Pending{ false };
+        bool m_Urgent{ false };     ///< A queue fills up, guarded by the below
+        std::mutex m_WakeMutex;
+        std::condition_variable m_Wake;
+        std::thread m_Thread;
+    };
+
+    /** @brief Queue of the calling thread, trivial for a cheap access */
+    static thread_local LogQueue* t_Queue = nullptr;
+    static thread_local bool t_QueueReleased = false;
+
+    /** @brief Keeps the queue registered while the thread lives */
+    struct LogQueueOwner
+    {
+        std::shared_ptr<LogQueue> queue;
+
+        ~LogQueueOwner()
+        {
+            // Later messages of the exiting thread are dropped
+            t_Queue = nullptr;
+            t_QueueReleased = true;
+        }
+    };
+    static thread_local LogQueueOwner t_QueueOwner;
+
     std::shared_ptr<spdlog::logger> Log::s_AssertLogger;
 
-    void Log::Init()
+    void Log::Init(const LogSpec& spec)
     {
         spdlog::set_level(spdlog::level::trace);
 
-        s_Logger = spdlog::stdout_color_mt("SGL");
-        // TODO expose level later
-        s_Logger->set_level(spdlog::level::trace);
-        s_Logger->set_pattern("%^[%T]: %v%$");
-
         // TODO to file also
         s_AssertLogger = spdlog::stdout_color_mt("SGLA");
         s_AssertLogger->set_level(spdlog::level::trace);
         s_AssertLogger->set_pattern("%^[%T]: %s:%#:%!() %v%$");
-    }    
+
+        LogBackend::Get().Start(spec);
+
+        // Writes out the last messages at exit
+        static const bool s_kAtExit = std::atexit(Log::Shutdown) == 0;
+        (void)s_kAtExit;
+    }
+
+    void Log::Shutdown()
+    {
+        LogBackend::Get().Stop();
+    }
+
+    void Log::Flush()
+    {
+        LogBackend::Get().Drain();
+    }
+
+    uint64_t Log::GetDroppedCount()
+    {
+        return LogBackend::Get().GetDroppedCount();
+    }
+
+    LogRecord* Log::BeginRecord()
+    {
+        if (t_Queue == nullptr)
+        {
+            if (t_QueueReleased)
+                return nullptr;
+            t_Queue = LogBackend::Get().RegisterThread();
+        }
+
+        LogQueue& queue = *t_Queue;
+        const uint64_t kHead = queue.head.load(std::memory_order_relaxed);
+
+        while (kHead - queue.tail.load(std::memory_order_acquire)
+               >= QueueCapacity)
+        {
+            LogBackend& backend = LogBackend::Get();
+            if (backend.GetOverflowPolicy() == LogOverflowPolicy::Drop
+                || !backend.IsRunning())
+            {
+                queue.dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            backend.Wake();
+            std::this_thread::yield();
+        }
+
+        // Half full, drains before the queue overflows
+        if (kHead - queue.tail.load(std::memory_order_relaxed)
+            == QueueCapacity / 2)
+            LogBackend::Get().Wake();
+
+        LogRecord* record = &queue.records[kHead & kQueueMask];
+        record->threadID = queue.threadID;
+        return record;
+    }
+
+    void Log::EndRecord()
+    {
+        LogQueue& queue = *t_Queue;
+        queue.head.store(queue.head.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_release);
+
+        LogBackend::Get().NotifyPending();
+    }
+
+    // =========================================================================
+
+    void LogBackend::Start(const LogSpec& spec)
+    {
+        Stop();
+
+        {
+            std::lock_guard<std::mutex> lock(m_DrainMutex);
+
+            m_ConsoleSink = std::make_shared<
+                spdlog::sinks::stdout_color_sink_mt>();
+            m_ConsoleSink->set_pattern("%^[%T]: %v%$");
+
+            m_SourceSink = std::make_shared<
+                spdlog::sinks::stdout_color_sink_mt>();
+            m_SourceSink->set_pattern("%^[%T]: %s:%#:%!() %v%$");
+
+            m_FileSink.reset();
+            if (!spec.file.empty())
+            {
+                m_FileSink = std::make_shared<
+                    spdlog::sinks::rotating_file_sink_st>(
+                        spec.file, spec.maxFileSize, spec.maxFiles);
+                m_FileSink->set_pattern(
+                    "[%Y-%m-%d %T.%e] [%l] [%t] %@ %v");
+            }
+
+            m_OverflowPolicy.store(spec.overflowPolicy,
+                                   std::memory_order_relaxed);
+        }
+
+        m_Running.store(true, std::memory_order_relaxed);
+        m_Thread = std::thread(&LogBackend::DrainLoop, this);
+    }
+
+    void LogBackend::Stop()
+    {
+        if (!m_Thread.joinable())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_WakeMutex);
+            m_Running.store(false, std::memory_order_relaxed);
+        }
+        m_Wake.notify_one();
+        m_Thread.join();
+
+        // Messages queued while stopping
+        Drain();
+    }
+
+    LogQueue* LogBackend::RegisterThread()
+    {
+        auto queue = std::make_shared<LogQueue>();
+        queue->records = std::make_unique<LogRecord[]>(Log::QueueCapacity);
+        queue->threadID = spdlog::details::os::thread_id();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        m_Queues.push_back(queue);
+        t_QueueOwner.queue = queue;
+
+        return queue.get();
+    }
+
+    void LogBackend::NotifyPending()
+    {
+        // Pairs with the fence of the drain thread: either the drain sees
+        //  the new head, or this sees the cleared flag and wakes it up
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_Pending.load(std::memory_order_relaxed) ||
+            m_Pending.exchange(true, std::memory_order_relaxed))
+            return;
+
+        {
+            // Not between the check of the predicate and the sleep
+            std::lock_guard<std::mutex> lock(m_WakeMutex);
+        }
+        m_Wake.notify_one();
+    }
+
+    void LogBackend::Wake()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_WakeMutex);
+            m_Urgent = true;
+        }
+        m_Wake.notify_one();
+    }
+
+    void LogBackend::DrainLoop()
+    {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_WakeMutex);
+
+                // Sleeps for as long as nothing is logged
+                m_Wake.wait(lock, [this] {
+                    return !m_Running.load(std::memory_order_relaxed) ||
+                           m_Pending.load(std::memory_order_relaxed) ||
+                           m_Urgent;
+                });
+                if (!m_Running.load(std::memory_order_relaxed))
+                    return;
+
+                // Gathers the messages that follow, unless a queue fills up
+                m_Wake.wait_for(lock,
+                                std::chrono::milliseconds(kDrainInterval),
+                                [this] {
+                    return !m_Running.load(std::memory_order_relaxed) ||
+                           m_Urgent;
+                });
+                m_Urgent = false;
+            }
+
+            m_Pending.store(false, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            Drain();
+        }
+    }
+
+    void LogBackend::Drain()
+    {
+        std::lock_guard<std::mutex> drainLock(m_DrainMutex);
+        if (m_ConsoleSink == nullptr)
+            return;     // Before "Init", kept queued
+
+        // Snapshot of the heads, later messages wait for the next drain
+        m_Heads.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            // Only the registry holds queues of finished threads
+            for (size_t i = 0; i < m_Queues.size();)
+            {
+                LogQueue& queue = *m_Queues[i];
+                const bool kEmpty = queue.tail.load(std::memory_order_relaxed)
+                    == queue.head.load(std::memory_order_acquire);
+                if (m_Queues[i].use_count() == 1 && kEmpty)
+                {
+                    m_RetiredDrops += queue.dropped.load(
+                        std::memory_order_relaxed);
+                    m_Queues[i] = std::move(m_Queues.back());
+                    m_Queues.pop_back();
+                    continue;
+                }
+                ++i;
+            }
+
+            for (const auto& kQueue : m_Queues)
+            {
+                m_Heads.emplace_back(
+                    kQueue.get(),
+                    kQueue->head.load(std::memory_order_acquire));
+            }
+        }
+
+        // Merged in time order across the threads
+        m_Batch.clear();
+        for (const auto& [queue, kHead] : m_Heads)
+        {
+            const uint64_t kTail = queue->tail.load(std::memory_order_relaxed);
+            for (uint64_t i = kTail; i < kHead; ++i)
+                m_Batch.push_back(&queue->records[i & kQueueMask]);
+        }
+        std::stable_sort(m_Batch.begin(), m_Batch.end(),
+                         [](const LogRecord* a, const LogRecord* b) {
+                             return a->time < b->time;
+                         });
+
+        for (LogRecord* record : m_Batch)
+        {
+            WriteRecord(*record);
+            record->destroy(*record);
+        }
+
+        // Frees the slots for the owners
+        for (const auto& [queue, kHead] : m_Heads)
+            queue->tail.store(kHead, std::memory_order_release);
+
+        ReportDrops();
+
+        if (!m_Batch.empty())
+        {
+            m_ConsoleSink->flush();
+            if (m_FileSink != nullptr)
+                m_FileSink->flush();
+        }
+    }
+
+    void LogBackend::WriteRecord(const LogRecord& record)
+    {
+        m_Payload.clear();
+        try
+        {
+            record.formatArgs(record, m_Payload);
+        }
+        catch (const std::exception& e)
+        {
+            m_Payload.clear();
+            fmt::format_to(std::back_inserter(m_Payload),
+                           "[format error: {}] {}", e.what(),
+                           std::string_view(record.format.data(),
+                                            record.format.size()));
+        }
+
+        spdlog::details::log_msg msg(
+            record.time, record.source, "SGL",
+            static_cast<spdlog::level::level_enum>(record.level),
+            spdlog::string_view_t(m_Payload.data(), m_Payload.size()));
+        msg.thread_id = record.threadID;
+
+        // Function traces show where they come from
+        if (record.level <= SGL_LEVEL_DEBUG)
+            m_SourceSink->log(msg);
+        else
+            m_ConsoleSink->log(msg);
+
+        if (m_FileSink != nullptr)
+            m_FileSink->log(msg);
+    }
+
+    void LogBackend::ReportDrops()
+    {
+        const uint64_t kDropped = GetDroppedCount();
+        if (kDropped == m_ReportedDrops)
+            return;
+
+        const std::string kText = fmt::format(
+            "{} log messages dropped, queues were full",
+            kDropped - m_ReportedDrops);
+        m_ReportedDrops = kDropped;
+
+        spdlog::details::log_msg msg("SGL", spdlog::level::warn, kText);
+        m_ConsoleSink->log(msg);
+        if (m_FileSink != nullptr)
+            m_FileSink->log(msg);
+    }
+
+    uint64_t LogBackend::GetDroppedCount()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        uint64_t dropped = m_RetiredDrops;
+        for (const auto& kQueue : m_Queues)
+            dropped += kQueue->dropped.load(std::memory_order_relaxed);
+
+        return dropped;
+    }
 
 } // namespace sgl
@@ -1,12 +1,22 @@
 /**
- *  Copyright (c) 2022 SGL authors Distributed under MIT License 
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
  * (http://opensource.org/licenses/MIT)
  */
 
 #ifndef SGL_SRC_CORE_LOG_H_
 #define SGL_SRC_CORE_LOG_H_
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
 // Ignore any warnings raised inside external headers
@@ -15,50 +25,317 @@
 #pragma warning(pop)
 
 
+// -----------------------------------------------------------------------------
+// Compile-time levels, calls below the level of their module compile out
+
+#define SGL_LEVEL_TRACE 0
+#define SGL_LEVEL_DEBUG 1
+#define SGL_LEVEL_INFO  2
+#define SGL_LEVEL_WARN  3
+#define SGL_LEVEL_ERR   4
+#define SGL_LEVEL_CRIT  5
+#define SGL_LEVEL_OFF   6
+
+#ifndef SGL_ACTIVE_LEVEL
+    #ifdef SGL_DEBUG
+        #define SGL_ACTIVE_LEVEL SGL_LEVEL_TRACE
+    #else
+        #define SGL_ACTIVE_LEVEL SGL_LEVEL_WARN
+    #endif
+#endif
+
+#ifndef SGL_ACTIVE_LEVEL_CORE
+    #define SGL_ACTIVE_LEVEL_CORE SGL_ACTIVE_LEVEL
+#endif
+#ifndef SGL_ACTIVE_LEVEL_OPENGL
+    #define SGL_ACTIVE_LEVEL_OPENGL SGL_ACTIVE_LEVEL
+#endif
+#ifndef SGL_ACTIVE_LEVEL_ASSETS
+    #define SGL_ACTIVE_LEVEL_ASSETS SGL_ACTIVE_LEVEL
+#endif
+
+
 namespace sgl
 {
+    /** @brief Group of sources sharing a compile-time log level */
+    enum class LogModule
+    {
+        Core = 0,   ///< Anything not matched below, user code included
+        OpenGL,     ///< SGL/opengl/
+        Assets      ///< SGL/image/, SGL/assets/, Utils file loading
+    };
+
+    /** @brief What a thread does when its log queue is full */
+    enum class LogOverflowPolicy
+    {
+        Drop = 0,   ///< Drops the message, the drops are reported later
+        Block       ///< Waits for the drain thread to make room
+    };
+
+    struct LogSpec
+    {
+        std::string file;               ///< Rotating log file, empty for none
+        size_t maxFileSize{ 5 << 20 };  ///< Bytes before the file rotates
+        size_t maxFiles{ 3 };
+
+        LogOverflowPolicy overflowPolicy{ LogOverflowPolicy::Drop };
+    };
+
+    /**
+     * @brief Message waiting in a thread queue. The arguments and the
+     *  format string are copied into the record, they are formatted later
+     *  by the drain thread.
+     */
+    struct LogRecord
+    {
+        static constexpr size_t InlineArgsSize = 192;
+
+        using FormatFunc = void (*)(const LogRecord&, fmt::memory_buffer&);
+        using DestroyFunc = void (*)(LogRecord&);
+
+        spdlog::log_clock::time_point time;
+        spdlog::source_loc source;
+        fmt::string_view format;    ///< Into "args", empty if formatted
+        FormatFunc formatArgs{ nullptr };
+        DestroyFunc destroy{ nullptr };
+        size_t threadID{ 0 };
+        int level{ SGL_LEVEL_INFO };
+
+        alignas(std::max_align_t) unsigned char args[InlineArgsSize];
+    };
+
+    /**
+     * @brief Asynchronous logging. Each thread writes to its own lock-free
+     *  queue, a background thread drains them in time order, formats the
+     *  messages and writes them to the console and the log file.
+     */
     class Log
     {
     public:
-        static void Init();
-        
-        static std::shared_ptr<spdlog::logger>& GetLogger()
-        {
-            return s_Logger;
+        /** @brief Messages a thread can queue, power of two */
+        static constexpr uint32_t QueueCapacity = 1024;
+
+        /**
+         * @brief Starts the drain thread, messages logged before are kept
+         *  up to the queue capacity
+         */
+        static void Init(const LogSpec& spec = LogSpec());
+        /** @brief Drains the queues and stops the drain thread */
+        static void Shutdown();
+
+        /** @brief Writes out the queued messages, blocks until done */
+        static void Flush();
+
+        /** @brief Runtime level, on top of the compile-time levels */
+        static void SetLevel(int level) {
+            s_Level.store(level, std::memory_order_relaxed);
+        }
+        static int GetLevel() {
+            return s_Level.load(std::memory_order_relaxed);
         }
+
+        /** @return Messages lost to full queues */
+        static uint64_t GetDroppedCount();
+
+        /** @brief Synchronous, the message is out before the program stops */
         static std::shared_ptr<spdlog::logger>& GetAssertLogger()
         {
              return s_AssertLogger;
         }
 
+        /** @brief Queues a message, hot path of the SGL_LOG_* macros */
+        template <typename... Args>
+        static void Write(int level, const spdlog::source_loc& source,
+                          fmt::format_string<Args...> format, Args&&... args);
+
+        /**
+         * @return Module of a source file, from its path. Only the SGL
+         *  sources match a module directory, user code is in "Core".
+         */
+        static constexpr LogModule ModuleOf(const char* file)
+        {
+            if (PathContains(file, "SGL/opengl/"))
+                return LogModule::OpenGL;
+            if (PathContains(file, "SGL/image/")
+                || PathContains(file, "SGL/assets/")
+                || PathContains(file, "SGL/core/Utils."))
+                return LogModule::Assets;
+            return LogModule::Core;
+        }
+
+        /**
+         * @return Whether a level is compiled in for a source file. The
+         *  levels are given by the macros at the call, they are not part
+         *  of this inline definition, which is the same for any levels.
+         */
+        static constexpr bool IsActive(int level, const char* file,
+                                       int coreLevel, int openglLevel,
+                                       int assetsLevel)
+        {
+            switch (ModuleOf(file))
+            {
+                case LogModule::OpenGL: return level >= openglLevel;
+                case LogModule::Assets: return level >= assetsLevel;
+                default:                return level >= coreLevel;
+            }
+        }
+
     private:
-        static std::shared_ptr<spdlog::logger> s_Logger;
+        /** @brief Copies of the arguments, strings are owned */
+        template <typename T>
+        using StoredArg = std::conditional_t<
+            std::is_same_v<std::decay_t<T>, const char*>
+                || std::is_same_v<std::decay_t<T>, char*>
+                || std::is_same_v<std::decay_t<T>, std::string_view>
+                || std::is_same_v<std::decay_t<T>, fmt::string_view>,
+            std::string, std::decay_t<T>>;
+
+        /**
+         * @brief Whether the copy of an argument owns what it formats.
+         *  Anything else, e.g. fmt::join views or user types that point
+         *  into caller memory, is formatted by the caller.
+         */
+        template <typename T>
+        static constexpr bool IsDeferrable =
+            std::is_arithmetic_v<StoredArg<T>>
+            || std::is_enum_v<StoredArg<T>>
+            || std::is_same_v<StoredArg<T>, std::string>
+            || std::is_same_v<StoredArg<T>, const void*>
+            || std::is_same_v<StoredArg<T>, void*>
+            || std::is_same_v<StoredArg<T>, std::nullptr_t>;
+
+        /** @return Free slot of the calling thread, null when dropped */
+        static LogRecord* BeginRecord();
+        /** @brief Publishes the slot to the drain thread */
+        static void EndRecord();
+
+        /**
+         * @brief Substring search from the start of a directory name, so
+         *  that "SGL/" does not match "MySGL/". '/' also matches '\'.
+         */
+        static constexpr bool PathContains(const char* path, const char* dir)
+        {
+            for (const char* start = path; *path != '\0'; ++path)
+            {
+                if (path != start && path[-1] != '/' && path[-1] != '\\')
+                    continue;
+
+                size_t i = 0;
+                for (; dir[i] != '\0'; ++i)
+                {
+                    const char kChar = path[i] == '\\' ? '/' : path[i];
+                    if (kChar != dir[i])
+                        break;
+                }
+                if (dir[i] == '\0')
+                    return true;
+            }
+            return false;
+        }
+
+    private:
+        inline static std::atomic<int> s_Level{ SGL_LEVEL_TRACE };
+
         static std::shared_ptr<spdlog::logger> s_AssertLogger;
     };
 
-} // namespace sgl
+    template <typename... Args>
+    void Log::Write(int level, const spdlog::source_loc& source,
+                    fmt::format_string<Args...> format, Args&&... args)
+    {
+        if (level < s_Level.load(std::memory_order_relaxed))
+            return;
+
+        LogRecord* record = BeginRecord();
+        if (record == nullptr)
+            return;
 
+        record->time = spdlog::log_clock::now();
+        record->source = source;
+        record->level = level;
 
-#ifdef SGL_DEBUG
-    #define SGL_LOG_TRACE(...) ::sgl::Log::GetLogger()->trace(__VA_ARGS__)
-    #define SGL_LOG_INFO(...)  ::sgl::Log::GetLogger()->info(__VA_ARGS__)
-    #define SGL_LOG_WARN(...)  ::sgl::Log::GetLogger()->warn(__VA_ARGS__)
-    #define SGL_LOG_ERR(...)   ::sgl::Log::GetLogger()->error(__VA_ARGS__)
-    #define SGL_LOG_CRIT(...)  ::sgl::Log::GetLogger()->critical(__VA_ARGS__)
+        // The format string may be a runtime string that does not outlive
+        //  the call, it is copied behind the arguments
+        const auto kFormat = static_cast<fmt::string_view>(format);
 
-    #define SGL_ASSERT_LOGGER() ::sgl::Log::GetAssertLogger()
-    
-    // @brief Prints that the function has been called, and when
-    #define SGL_FUNCTION() { \
-        SPDLOG_LOGGER_TRACE(::sgl::Log::GetAssertLogger(), ""); \
+        using Packed = std::tuple<StoredArg<Args>...>;
+        if constexpr ((IsDeferrable<Args> && ...)
+                      && sizeof(Packed) <= LogRecord::InlineArgsSize
+                      && alignof(Packed) <= alignof(std::max_align_t))
+        {
+            if (kFormat.size() <= LogRecord::InlineArgsSize - sizeof(Packed))
+            {
+                new (record->args) Packed(std::forward<Args>(args)...);
+
+                char* formatCopy = reinterpret_cast<char*>(record->args)
+                                 + sizeof(Packed);
+                std::memcpy(formatCopy, kFormat.data(), kFormat.size());
+                record->format = fmt::string_view(formatCopy, kFormat.size());
+
+                record->formatArgs = [](const LogRecord& r,
+                                        fmt::memory_buffer& out) {
+                    const auto& kPacked = *std::launder(
+                        reinterpret_cast<const Packed*>(r.args));
+                    std::apply([&](const auto&... a) {
+                        fmt::vformat_to(std::back_inserter(out), r.format,
+                                        fmt::make_format_args(a...));
+                    }, kPacked);
+                };
+                record->destroy = [](LogRecord& r) {
+                    std::launder(reinterpret_cast<Packed*>(r.args))->~Packed();
+                };
+
+                EndRecord();
+                return;
+            }
+        }
+
+        // Too large or not safe to defer, formatted by the caller
+        new (record->args) std::string(
+            fmt::format(format, std::forward<Args>(args)...));
+        record->format = fmt::string_view();
+
+        record->formatArgs = [](const LogRecord& r, fmt::memory_buffer& out) {
+            const auto& kText = *std::launder(
+                reinterpret_cast<const std::string*>(r.args));
+            out.append(kText.data(), kText.data() + kText.size());
+        };
+        record->destroy = [](LogRecord& r) {
+            using std::string;
+            std::launder(reinterpret_cast<string*>(r.args))->~string();
+        };
+
+        EndRecord();
     }
-#else
-    #define SGL_LOG_TRACE(...)
-    #define SGL_LOG_INFO(...)
-    #define SGL_LOG_WARN(...)
-    #define SGL_LOG_ERR(...)
-    #define SGL_LOG_CRIT(...)
-    #define SGL_FUNCTION()
-#endif
+
+} // namespace sgl
+
+
+/** @brief Runs "call" only if "level" is compiled in for the current file */
+#define SGL_LOG_IF(level, call) do {                                    \
+        if constexpr (::sgl::Log::IsActive(level, __FILE__,             \
+                SGL_ACTIVE_LEVEL_CORE, SGL_ACTIVE_LEVEL_OPENGL,         \
+                SGL_ACTIVE_LEVEL_ASSETS)) {                             \
+            call;                                                       \
+        }                                                               \
+    } while (0)
+
+/** @brief Queues a message with its source location */
+#define SGL_LOG_AT(level, ...) SGL_LOG_IF(level,                        \
+    ::sgl::Log::Write(level,                                            \
+        ::spdlog::source_loc{ __FILE__, __LINE__, SPDLOG_FUNCTION },    \
+        __VA_ARGS__))
+
+#define SGL_LOG_TRACE(...) SGL_LOG_AT(SGL_LEVEL_TRACE, __VA_ARGS__)
+#define SGL_LOG_DEBUG(...) SGL_LOG_AT(SGL_LEVEL_DEBUG, __VA_ARGS__)
+#define SGL_LOG_INFO(...)  SGL_LOG_AT(SGL_LEVEL_INFO, __VA_ARGS__)
+#define SGL_LOG_WARN(...)  SGL_LOG_AT(SGL_LEVEL_WARN, __VA_ARGS__)
+#define SGL_LOG_ERR(...)   SGL_LOG_AT(SGL_LEVEL_ERR, __VA_ARGS__)
+#define SGL_LOG_CRIT(...)  SGL_LOG_AT(SGL_LEVEL_CRIT, __VA_ARGS__)
+
+#define SGL_ASSERT_LOGGER() ::sgl::Log::GetAssertLogger()
+
+// @brief Prints that the function has been called, and when
+#define SGL_FUNCTION() SGL_LOG_TRACE("")
 
 #endif // SGL_SRC_CORE_LOG_H_
@@ -0,0 +1,186 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/core/MappedFile.h"
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <cstring>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+namespace sgl
+{
+    MappedFile::MappedFile(const std::string& filename, MapAccess access)
+    {
+        Open(filename, access);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Close();
+
+            m_Data = other.m_Data;
+            m_Size = other.m_Size;
+            m_Open = other.m_Open;
+            m_Error = std::move(other.m_Error);
+
+            other.m_Data = nullptr;
+            other.m_Size = 0;
+            other.m_Open = false;
+        }
+        return *this;
+    }
+
+    bool MappedFile::Open(const std::string& filename, MapAccess access)
+    {
+        SGL_FUNCTION();
+
+        Close();
+        m_Error.clear();
+
+    #ifdef _WIN32
+        const DWORD kFlags = access == MapAccess::Sequential
+                             ? FILE_FLAG_SEQUENTIAL_SCAN
+                             : FILE_FLAG_RANDOM_ACCESS;
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ,
+                                  FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | kFlags, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            m_Error = fmt::format("Failed to open '{}': error {}", filename,
+                                  GetLastError());
+            return false;
+        }
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size))
+        {
+            m_Error = fmt::format("Failed to get the size of '{}': error {}",
+                                  filename, GetLastError());
+            CloseHandle(file);
+            return false;
+        }
+
+        m_Size = static_cast<size_t>(size.QuadPart);
+        if (m_Size > 0)
+        {
+            // The view keeps the mapping and the file open
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY,
+                                                0, 0, nullptr);
+            if (mapping != nullptr)
+            {
+                m_Data = static_cast<const unsigned char*>(
+                    MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+            }
+
+            if (m_Data == nullptr)
+            {
+                m_Error = fmt::format("Failed to map '{}': error {}",
+                                      filename, GetLastError());
+                m_Size = 0;
+                CloseHandle(file);
+                return false;
+            }
+        }
+        CloseHandle(file);
+    #else
+        const int kFile = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (kFile < 0)
+        {
+            m_Error = fmt::format("Failed to open '{}': {}", filename,
+                                  std::strerror(errno));
+            return false;
+        }
+
+        struct stat status{};
+        if (::fstat(kFile, &status) != 0)
+        {
+            m_Error = fmt::format("Failed to stat '{}': {}", filename,
+                                  std::strerror(errno));
+            ::close(kFile);
+            return false;
+        }
+
+        // Empty files cannot be mapped, they open with no data
+        m_Size = static_cast<size_t>(status.st_size);
+        if (m_Size > 0)
+        {
+            void* data = ::mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE,
+                                kFile, 0);
+            if (data == MAP_FAILED)
+            {
+                m_Error = fmt::format("Failed to map '{}': {}", filename,
+                                      std::strerror(errno));
+                m_Size = 0;
+                ::close(kFile);
+                return false;
+            }
+            m_Data = static_cast<const unsigned char*>(data);
+
+            // Sequential reads double the readahead and start it now, so
+            //  the first pages are not faulted in one by one
+            if (access == MapAccess::Sequential)
+            {
+                ::madvise(data, m_Size, MADV_SEQUENTIAL);
+                ::madvise(data, m_Size, MADV_WILLNEED);
+            }
+            else
+            {
+                ::madvise(data, m_Size, MADV_RANDOM);
+            }
+        }
+
+        // The mapping keeps a reference to the file
+        ::close(kFile);
+    #endif
+
+        m_Open = true;
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_Data != nullptr)
+        {
+        #ifdef _WIN32
+            UnmapViewOfFile(m_Data);
+        #else
+            ::munmap(const_cast<unsigned char*>(m_Data), m_Size);
+        #endif
+        }
+
+        m_Data = nullptr;
+        m_Size = 0;
+        m_Open = false;
+    }
+
+} // namespace sgl
@@ -0,0 +1,76 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_MAPPED_FILE_H_
+#define SGL_CORE_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+
+namespace sgl
+{
+    /** @brief How the pages of a mapping are read, hints the readahead */
+    enum class MapAccess
+    {
+        Sequential = 0,     ///< Read once from start to end, prefetched
+        Random              ///< Scattered reads, no readahead
+    };
+
+    /**
+     * @brief Read-only mapping of a whole file, its pages are read by the
+     *  kernel on first access and never copied through a stream buffer.
+     *  Unmapped when out of scope, the data must not be used then.
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        /** @brief "Open" */
+        explicit MappedFile(const std::string& filename,
+                            MapAccess access = MapAccess::Sequential);
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * @brief Maps a file, the previous one is unmapped
+         * @return False if the file could not be opened or mapped, see
+         *  "GetError"
+         */
+        bool Open(const std::string& filename,
+                  MapAccess access = MapAccess::Sequential);
+        void Close();
+
+        /** @return Whether a file is mapped, it may be empty */
+        bool IsOpen() const { return m_Open; }
+        explicit operator bool() const { return m_Open; }
+
+        /** @return Null for an empty file */
+        const unsigned char* GetData() const { return m_Data; }
+        size_t GetSize() const { return m_Size; }
+        /** @return The bytes of the file, valid while it is mapped */
+        std::string_view GetView() const {
+            return { reinterpret_cast<const char*>(m_Data), m_Size };
+        }
+        /** @return Why the last "Open" failed */
+        const std::string& GetError() const { return m_Error; }
+
+    private:
+        const unsigned char* m_Data{ nullptr };
+        size_t m_Size{ 0 };
+        bool m_Open{ false };
+        std::string m_Error;
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_CORE_MAPPED_FILE_H_
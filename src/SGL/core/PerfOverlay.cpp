@@ -0,0 +1,110 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/core/PerfOverlay.h"
+#include "SGL/core/GpuProfiler.h"
+
+#include <cfloat>
+#include <cstdio>
+
+#include <imgui/imgui.h>
+
+
+namespace sgl
+{
+    void PerfOverlay::Draw(const FrameStats& frameStats)
+    {
+        if (!m_Visible)
+            return;
+
+        const ImGuiWindowFlags kFlags = ImGuiWindowFlags_AlwaysAutoResize
+                                      | ImGuiWindowFlags_NoSavedSettings
+                                      | ImGuiWindowFlags_NoFocusOnAppearing
+                                      | ImGuiWindowFlags_NoNav;
+
+        ImGui::SetNextWindowPos(ImVec2(10.0f, 10.0f), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowBgAlpha(0.75f);
+        if (ImGui::Begin("Performance", &m_Visible, kFlags))
+        {
+            DrawFrameTimes(frameStats);
+            ImGui::Separator();
+            DrawCounters();
+        }
+        ImGui::End();
+    }
+
+    void PerfOverlay::DrawFrameTimes(const FrameStats& frameStats)
+    {
+        const uint32_t kCount = frameStats.GetCount(FrameStage::Frame);
+        if (kCount == 0)
+        {
+            ImGui::Text("No frames recorded");
+            return;
+        }
+
+        const TimingSummary kFrame = frameStats.GetSummary(FrameStage::Frame);
+        const float kScale = std::max(kFrame.max * 1.1f, 1.0f);
+
+        char overlay[32];
+        std::snprintf(overlay, sizeof(overlay), "%.2f ms",
+                      frameStats.GetLast(FrameStage::Frame));
+        ImGui::PlotLines("Frame", frameStats.GetHistory(FrameStage::Frame),
+                         kCount, frameStats.GetHistoryOffset(FrameStage::Frame),
+                         overlay, 0.0f, kScale, ImVec2(240.0f, 60.0f));
+        ImGui::PlotLines("CPU", frameStats.GetHistory(FrameStage::Cpu),
+                         frameStats.GetCount(FrameStage::Cpu),
+                         frameStats.GetHistoryOffset(FrameStage::Cpu),
+                         nullptr, 0.0f, kScale, ImVec2(240.0f, 40.0f));
+
+        // Frame times bucketed from 0 to the max
+        m_Histogram.fill(0.0f);
+        const float kBinScale = HistogramBins / kScale;
+        const float* kFrameTimes = frameStats.GetHistory(FrameStage::Frame);
+        for (uint32_t i = 0; i < kCount; ++i)
+        {
+            const uint32_t kBin = static_cast<uint32_t>(kFrameTimes[i]
+                                                        * kBinScale);
+            m_Histogram[std::min(kBin, HistogramBins - 1)] += 1.0f;
+        }
+        ImGui::PlotHistogram("Histogram", m_Histogram.data(), HistogramBins,
+                             0, nullptr, 0.0f, FLT_MAX,
+                             ImVec2(240.0f, 40.0f));
+
+        ImGui::Text("p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms",
+                    kFrame.p50, kFrame.p95, kFrame.p99, kFrame.max);
+        ImGui::Text("mean %.2f  stddev %.3f ms", kFrame.mean, kFrame.stdDev);
+        ImGui::Text("Update %.2f  Render %.2f ms",
+                    frameStats.GetMean(FrameStage::Update),
+                    frameStats.GetMean(FrameStage::Render));
+
+        // Averages over the window, the GPU profiler has its own window
+        const float kCpu = frameStats.GetMean(FrameStage::Cpu);
+
+        const GpuScopeStats* kGpuStats = GpuProfiler::Get().GetFrameStats();
+        if (GpuProfiler::Get().IsEnabled() && kGpuStats != nullptr)
+        {
+            const float kGpu = kGpuStats->average;
+            ImGui::Text("CPU %.2f ms  GPU %.2f ms  (%s bound)", kCpu, kGpu,
+                        kGpu > kCpu ? "GPU" : "CPU");
+        }
+        else
+        {
+            ImGui::Text("CPU %.2f ms  GPU n/a (profiler disabled)", kCpu);
+        }
+    }
+
+    void PerfOverlay::DrawCounters() const
+    {
+        ImGui::Text("Draw calls      %u", m_LastStats.drawCalls);
+        ImGui::Text("Program binds   %u", m_LastStats.programBinds);
+        ImGui::Text("VAO binds       %u", m_LastStats.vertexArrayBinds);
+        ImGui::Text("Texture binds   %u", m_LastStats.textureBinds);
+        ImGui::Text("Uniform updates %u", m_LastStats.uniformUpdates);
+        ImGui::Text("Uploaded        %.1f KiB",
+                    m_LastStats.bytesUploaded / 1024.0);
+    }
+
+} // namespace sgl
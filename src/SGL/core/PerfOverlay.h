@@ -0,0 +1,56 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_PERF_OVERLAY_H_
+#define SGL_CORE_PERF_OVERLAY_H_
+
+#include <array>
+#include <cstdint>
+
+#include "SGL/core/FrameStats.h"
+#include "SGL/core/RenderStats.h"
+
+
+namespace sgl
+{
+    /**
+     * @brief ImGui HUD with the frame times, their percentiles, the CPU and
+     *  GPU split and the render counters of the last frame.
+     *  The times come from the "FrameStats" of the Application.
+     */
+    class PerfOverlay
+    {
+    public:
+        static constexpr uint32_t HistogramBins = 32;
+
+    public:
+        void SetVisible(bool visible) { m_Visible = visible; }
+        bool IsVisible() const { return m_Visible; }
+
+        /** @brief Called once per frame by the Application loop */
+        void Record(const RenderStats& stats) { m_LastStats = stats; }
+
+        /** @brief Draws the overlay window, call inside an ImGui frame */
+        void Draw(const FrameStats& frameStats);
+
+        /** @return Render counters of the last recorded frame */
+        const RenderStats& GetLastStats() const { return m_LastStats; }
+
+    private:
+        void DrawFrameTimes(const FrameStats& frameStats);
+        void DrawCounters() const;
+
+    private:
+        bool m_Visible{ false };
+
+        RenderStats m_LastStats;
+
+        std::array<float, HistogramBins> m_Histogram{};
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_CORE_PERF_OVERLAY_H_
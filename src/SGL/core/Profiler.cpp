@@ -0,0 +1,285 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/core/Profiler.h"
+
+#include <cstdio>
+
+
+namespace sgl
+{
+    static constexpr uint64_t kBufferMask = Profiler::ThreadBufferSize - 1;
+    static_assert((Profiler::ThreadBufferSize & kBufferMask) == 0,
+                  "Thread buffer size must be a power of two");
+
+    /** @brief Buffer of the calling thread, trivial for a cheap access */
+    static thread_local void* t_Buffer = nullptr;
+
+    /** @brief Keeps the buffer registered while the thread lives */
+    static thread_local std::shared_ptr<void> t_BufferOwner;
+
+    static thread_local uint32_t t_ThreadID = ~0u;
+    static std::atomic<uint32_t> s_NextThreadID{ 0 };
+
+    /** @brief Sequential id of the calling thread, assigned on first use */
+    static uint32_t GetThreadID()
+    {
+        if (t_ThreadID == ~0u)
+            t_ThreadID = s_NextThreadID.fetch_add(1, std::memory_order_relaxed);
+
+        return t_ThreadID;
+    }
+
+    /** @brief Writes a string as a JSON string literal */
+    static void WriteJsonString(std::FILE* file, const char* str)
+    {
+        std::fputc('"', file);
+        for (; *str != '\0'; ++str)
+        {
+            const char kChar = *str;
+            if (kChar == '"' || kChar == '\\')
+            {
+                std::fputc('\\', file);
+                std::fputc(kChar, file);
+            }
+            else if (static_cast<unsigned char>(kChar) < 0x20)
+            {
+                std::fprintf(file, "\\u%04x", kChar);
+            }
+            else
+            {
+                std::fputc(kChar, file);
+            }
+        }
+        std::fputc('"', file);
+    }
+
+    Profiler& Profiler::Get()
+    {
+        static Profiler s_Profiler;
+        return s_Profiler;
+    }
+
+    void Profiler::Record(const char* name, uint64_t begin, uint64_t end)
+    {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        Push(buffer, buffer.threadID, name, begin, end);
+    }
+
+    void Profiler::RecordOnTrack(uint32_t trackID, const char* name,
+                                 uint64_t begin, uint64_t end)
+    {
+        Push(GetThreadBuffer(), trackID, name, begin, end);
+    }
+
+    void Profiler::Push(ThreadBuffer& buffer, uint32_t trackID,
+                        const char* name, uint64_t begin, uint64_t end)
+    {
+        const uint64_t kHead = buffer.head.load(std::memory_order_relaxed);
+        const uint64_t kTail = buffer.tail.load(std::memory_order_acquire);
+        if (kHead - kTail >= ThreadBufferSize)
+        {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        ProfileEvent& event = buffer.events[kHead & kBufferMask];
+        event.name = name;
+        event.begin = begin;
+        event.end = end;
+        event.threadID = trackID;
+
+        // Publishes the event to "Collect"
+        buffer.head.store(kHead + 1, std::memory_order_release);
+    }
+
+    void Profiler::SetThreadName(const std::string& name)
+    {
+        // Does not allocate the buffer, the thread may never record
+        SetTrackName(GetThreadID(), name);
+    }
+
+    void Profiler::SetTrackName(uint32_t trackID, const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(Get().m_Mutex);
+        Get().m_ThreadNames[trackID] = name;
+    }
+
+    Profiler::ThreadBuffer& Profiler::GetThreadBuffer()
+    {
+        if (t_Buffer == nullptr)
+            t_Buffer = Get().RegisterThread();
+
+        return *static_cast<ThreadBuffer*>(t_Buffer);
+    }
+
+    // =========================================================================
+
+    void Profiler::BeginSession()
+    {
+        SGL_FUNCTION();
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Events.clear();
+            m_SessionStart = Now();
+
+            // Drops the events recorded before the session
+            for (auto& buffer : m_Threads)
+                Drain(*buffer);
+        }
+
+        s_Recording.store(true, std::memory_order_relaxed);
+    }
+
+    void Profiler::EndSession()
+    {
+        SGL_FUNCTION();
+
+        s_Recording.store(false, std::memory_order_relaxed);
+        Collect();
+    }
+
+    void Profiler::Collect()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        for (auto& buffer : m_Threads)
+            Drain(*buffer);
+
+        // Only the registry holds buffers of finished threads
+        m_Threads.erase(
+            std::remove_if(m_Threads.begin(), m_Threads.end(),
+                           [](const std::shared_ptr<ThreadBuffer>& buffer) {
+                               return buffer.use_count() == 1;
+                           }),
+            m_Threads.end());
+    }
+
+    void Profiler::DiscardBefore(uint64_t time)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        while (!m_Events.empty() && m_Events.front().end < time)
+            m_Events.pop_front();
+    }
+
+    bool Profiler::WriteChromeTrace(const std::string& filename) const
+    {
+        return WriteChromeTrace(GetTrace(), filename);
+    }
+
+    ProfileTrace Profiler::GetTrace() const
+    {
+        SGL_FUNCTION();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return ProfileTrace{
+            std::vector<ProfileEvent>(m_Events.begin(), m_Events.end()),
+            m_ThreadNames, m_SessionStart };
+    }
+
+    bool Profiler::WriteChromeTrace(const ProfileTrace& trace,
+                                    const std::string& filename)
+    {
+        SGL_FUNCTION();
+
+        std::FILE* file = std::fopen(filename.c_str(), "w");
+        if (file == nullptr)
+        {
+            SGL_LOG_ERR("Failed to open a file '{}' for writing", filename);
+            return false;
+        }
+
+        std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+        bool first = true;
+        for (const auto& [kThreadID, kName] : trace.threadNames)
+        {
+            std::fprintf(file, "%s\n{\"ph\":\"M\",\"pid\":0,\"tid\":%u,"
+                         "\"name\":\"thread_name\",\"args\":{\"name\":",
+                         first ? "" : ",", kThreadID);
+            WriteJsonString(file, kName.c_str());
+            std::fprintf(file, "}}");
+            first = false;
+        }
+
+        // Microseconds, with the nanoseconds as decimals
+        for (const auto& kEvent : trace.events)
+        {
+            const uint64_t kBegin = kEvent.begin - trace.sessionStart;
+            const uint64_t kDuration = kEvent.end - kEvent.begin;
+
+            std::fprintf(file, "%s\n{\"ph\":\"X\",\"pid\":0,\"tid\":%u,"
+                         "\"ts\":%llu.%03llu,\"dur\":%llu.%03llu,\"name\":",
+                         first ? "" : ",", kEvent.threadID,
+                         static_cast<unsigned long long>(kBegin / 1000),
+                         static_cast<unsigned long long>(kBegin % 1000),
+                         static_cast<unsigned long long>(kDuration / 1000),
+                         static_cast<unsigned long long>(kDuration % 1000));
+            WriteJsonString(file, kEvent.name);
+            std::fputc('}', file);
+            first = false;
+        }
+
+        std::fprintf(file, "\n]}\n");
+        std::fclose(file);
+
+        SGL_LOG_INFO("Wrote {} profile events to '{}'", trace.events.size(),
+                     filename);
+        return true;
+    }
+
+    size_t Profiler::GetEventCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Events.size();
+    }
+
+    uint64_t Profiler::GetDroppedCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        uint64_t dropped = 0;
+        for (const auto& kBuffer : m_Threads)
+            dropped += kBuffer->dropped.load(std::memory_order_relaxed);
+
+        return dropped;
+    }
+
+    Profiler::ThreadBuffer* Profiler::RegisterThread()
+    {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        buffer->events = std::make_unique<ProfileEvent[]>(ThreadBufferSize);
+        buffer->threadID = GetThreadID();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        m_Threads.push_back(buffer);
+        t_BufferOwner = buffer;
+
+        return buffer.get();
+    }
+
+    void Profiler::Drain(ThreadBuffer& buffer)
+    {
+        const uint64_t kTail = buffer.tail.load(std::memory_order_relaxed);
+        const uint64_t kHead = buffer.head.load(std::memory_order_acquire);
+
+        for (uint64_t i = kTail; i < kHead; ++i)
+        {
+            const ProfileEvent& kEvent = buffer.events[i & kBufferMask];
+
+            // Left over from before the session
+            if (kEvent.begin >= m_SessionStart)
+                m_Events.push_back(kEvent);
+        }
+
+        // Frees the slots for the owner
+        buffer.tail.store(kHead, std::memory_order_release);
+    }
+
+} // namespace sgl
@@ -0,0 +1,190 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_PROFILER_H_
+#define SGL_CORE_PROFILER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "SGL/core/Clock.h"
+
+
+namespace sgl
+{
+    /** @brief Complete scope, times in nanoseconds of the "Clock" */
+    struct ProfileEvent
+    {
+        const char* name{ nullptr };    ///< Static string, e.g. a literal
+        uint64_t begin{ 0 };
+        uint64_t end{ 0 };
+        uint32_t threadID{ 0 };
+    };
+
+    /** @brief Copy of the session, can be written on another thread */
+    struct ProfileTrace
+    {
+        std::vector<ProfileEvent> events;
+        std::map<uint32_t, std::string> threadNames;
+        uint64_t sessionStart{ 0 };
+    };
+
+    /**
+     * @brief Records CPU scopes into per-thread lock-free ring buffers.
+     *  Only the owning thread writes a buffer, "Collect" drains them all
+     *  into the session, which can be written as a Chrome trace
+     *  (chrome://tracing, https://ui.perfetto.dev).
+     */
+    class Profiler
+    {
+    public:
+        /** @brief Events a thread can record between two "Collect" calls */
+        static constexpr uint32_t ThreadBufferSize = 1 << 15;
+
+        /** @brief Track of the GPU scopes, times mapped to the "Clock" */
+        static constexpr uint32_t GpuTrackID = 0x7FFF0000;
+
+        static Profiler& Get();
+
+        /** @return Nanoseconds of the "Clock", the TSC once enabled */
+        static uint64_t Now() { return Clock::Now(); }
+
+        static bool IsRecording() {
+            return s_Recording.load(std::memory_order_relaxed);
+        }
+
+        /** @brief Hot path, called from any thread at the end of a scope */
+        static void Record(const char* name, uint64_t begin, uint64_t end);
+        /** @brief Records to another track than the one of the thread */
+        static void RecordOnTrack(uint32_t trackID, const char* name,
+                                  uint64_t begin, uint64_t end);
+
+        /** @brief Name of the calling thread in the trace */
+        static void SetThreadName(const std::string& name);
+        static void SetTrackName(uint32_t trackID, const std::string& name);
+
+    public:
+        Profiler(const Profiler&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+
+        /** @brief Clears the previous session, starts recording */
+        void BeginSession();
+        /** @brief Stops recording, collects the remaining events */
+        void EndSession();
+
+        /** @brief Moves recorded events of all threads into the session */
+        void Collect();
+
+        /**
+         * @brief Drops collected events that ended before "time", from the
+         *  oldest collected one, in amortised O(1) per event. Events are
+         *  collected roughly in time order, one that ended later than a
+         *  newer one may stay until a later call.
+         */
+        void DiscardBefore(uint64_t time);
+
+        /** @brief Writes the session events as Chrome trace JSON */
+        bool WriteChromeTrace(const std::string& filename) const;
+
+        /** @return Copy of the collected events, cheaper than a write */
+        ProfileTrace GetTrace() const;
+        /** @brief Writes a copy of a session, from any thread */
+        static bool WriteChromeTrace(const ProfileTrace& trace,
+                                     const std::string& filename);
+
+        size_t GetEventCount() const;
+        /** @return Events lost to full thread buffers */
+        uint64_t GetDroppedCount() const;
+
+    private:
+        struct ThreadBuffer
+        {
+            std::unique_ptr<ProfileEvent[]> events;
+            std::atomic<uint64_t> head{ 0 };    ///< Written by the owner
+            std::atomic<uint64_t> tail{ 0 };    ///< Written by "Collect"
+            std::atomic<uint64_t> dropped{ 0 };
+
+            uint32_t threadID{ 0 };
+        };
+
+        Profiler() = default;
+
+        static ThreadBuffer& GetThreadBuffer();
+        static void Push(ThreadBuffer& buffer, uint32_t trackID,
+                         const char* name, uint64_t begin, uint64_t end);
+        ThreadBuffer* RegisterThread();
+
+        void Drain(ThreadBuffer& buffer);
+
+    private:
+        inline static std::atomic<bool> s_Recording{ false };
+
+        mutable std::mutex m_Mutex;
+
+        /// Shared, a buffer outlives its thread until drained
+        std::vector<std::shared_ptr<ThreadBuffer>> m_Threads;
+        std::deque<ProfileEvent> m_Events;  ///< In collection order
+        std::map<uint32_t, std::string> m_ThreadNames;
+        uint64_t m_SessionStart{ 0 };
+    };
+
+    /** @brief Records the time until the end of the C++ scope */
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(const char* name)
+            : m_Name(name),
+              m_Begin(Profiler::IsRecording() ? Profiler::Now() : 0)
+        {
+        }
+
+        ~ProfileScope()
+        {
+            if (m_Begin != 0)
+                Profiler::Record(m_Name, m_Begin, Profiler::Now());
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        const char* m_Name;
+        uint64_t m_Begin;
+    };
+
+} // namespace sgl
+
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define SGL_FUNCTION_SIGNATURE __PRETTY_FUNCTION__
+#elif defined(_MSC_VER)
+    #define SGL_FUNCTION_SIGNATURE __FUNCSIG__
+#else
+    #define SGL_FUNCTION_SIGNATURE __func__
+#endif
+
+#define SGL_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SGL_PROFILE_CONCAT(a, b) SGL_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef SGL_ENABLE_PROFILING
+    /** @brief Records the rest of the C++ scope, name must be static */
+    #define SGL_PROFILE_SCOPE(name) \
+        ::sgl::ProfileScope SGL_PROFILE_CONCAT(sglProfileScope, __LINE__)(name)
+    #define SGL_PROFILE_FUNCTION() SGL_PROFILE_SCOPE(SGL_FUNCTION_SIGNATURE)
+    #define SGL_PROFILE_THREAD(name) ::sgl::Profiler::SetThreadName(name)
+#else
+    #define SGL_PROFILE_SCOPE(name)
+    #define SGL_PROFILE_FUNCTION()
+    #define SGL_PROFILE_THREAD(name)
+#endif
+
+
+#endif // SGL_CORE_PROFILER_H_
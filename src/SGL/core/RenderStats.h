@@ -0,0 +1,49 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_RENDER_STATS_H_
+#define SGL_CORE_RENDER_STATS_H_
+
+#include <cstdint>
+
+
+namespace sgl
+{
+    /**
+     * @brief GL work issued through the SGL classes since the last reset.
+     *  Counted per thread, each thread drives its own context, the
+     *  Application resets and reads the counters of the main thread.
+     */
+    struct RenderStats
+    {
+        uint32_t drawCalls{ 0 };
+        uint32_t programBinds{ 0 };
+        uint32_t vertexArrayBinds{ 0 };
+        uint32_t textureBinds{ 0 };
+        uint32_t uniformUpdates{ 0 };
+        uint64_t bytesUploaded{ 0 };    ///< Buffer and texture data
+
+        /** @return Counters of the calling thread */
+        static RenderStats& Current() {
+            static thread_local RenderStats s_Stats;
+            return s_Stats;
+        }
+
+        static void Reset() { Current() = RenderStats(); }
+    };
+
+} // namespace sgl
+
+
+#ifdef SGL_ENABLE_PROFILING
+    /** @brief Adds to a counter of the calling thread, e.g. drawCalls */
+    #define SGL_RENDER_STAT(counter, value) \
+        (::sgl::RenderStats::Current().counter += (value))
+#else
+    #define SGL_RENDER_STAT(counter, value) ((void)0)
+#endif
+
+
+#endif // SGL_CORE_RENDER_STATS_H_
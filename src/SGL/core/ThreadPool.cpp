@@ -0,0 +1,106 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/core/ThreadPool.h"
+#include "SGL/core/Profiler.h"
+
+
+namespace sgl
+{
+    std::shared_ptr<ThreadPool> ThreadPool::Create(uint32_t threadCount)
+    {
+        return std::make_shared<ThreadPool>(threadCount);
+    }
+
+    // =========================================================================
+
+    ThreadPool::ThreadPool(uint32_t threadCount)
+    {
+        SGL_FUNCTION();
+
+        if (threadCount == 0)
+            threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+        m_Workers.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; ++i)
+            m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        SGL_FUNCTION();
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stop = true;
+        }
+        m_TaskAvailable.notify_all();
+
+        for (auto& worker : m_Workers)
+            worker.join();
+    }
+
+    void ThreadPool::Enqueue(std::function<void()> task)
+    {
+        SGL_ASSERT(task);
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            SGL_ASSERT_MSG(!m_Stop, "Task queued on a stopped thread pool");
+            m_Tasks.push_back(std::move(task));
+        }
+        m_TaskAvailable.notify_one();
+    }
+
+    void ThreadPool::WaitIdle()
+    {
+        SGL_FUNCTION();
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Idle.wait(lock, [this]() { return m_Tasks.empty() && m_Busy == 0; });
+    }
+
+    size_t ThreadPool::GetQueuedCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Tasks.size();
+    }
+
+    void ThreadPool::WorkerLoop()
+    {
+        SGL_PROFILE_THREAD("ThreadPool");
+
+        std::function<void()> task;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_TaskAvailable.wait(lock, [this]() {
+                    return m_Stop || !m_Tasks.empty();
+                });
+
+                // Drains the queue before stopping
+                if (m_Tasks.empty())
+                    return;
+
+                task = std::move(m_Tasks.front());
+                m_Tasks.pop_front();
+                ++m_Busy;
+            }
+
+            task();
+            task = nullptr;
+
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                --m_Busy;
+            }
+            m_Idle.notify_all();
+        }
+    }
+
+} // namespace sgl
@@ -0,0 +1,86 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_CORE_THREAD_POOL_H_
+#define SGL_CORE_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace sgl
+{
+    /** @brief Fixed number of worker threads running queued tasks in order */
+    class ThreadPool
+    {
+    public:
+        /** @param threadCount 0 picks the number of hardware threads */
+        static std::shared_ptr<ThreadPool> Create(uint32_t threadCount = 0);
+
+    public:
+        /** @param threadCount 0 picks the number of hardware threads */
+        ThreadPool(uint32_t threadCount = 0);
+
+        /** @brief Runs the queued tasks, then stops the workers */
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /** @brief Queues a task, the future holds its result */
+        template<typename Func>
+        auto Submit(Func&& func) -> std::future<std::invoke_result_t<Func>>
+        {
+            using Result = std::invoke_result_t<Func>;
+
+            // std::function needs a copyable target
+            auto task = std::make_shared<std::packaged_task<Result()>>(
+                std::forward<Func>(func));
+            std::future<Result> result = task->get_future();
+
+            Enqueue([task]() { (*task)(); });
+
+            return result;
+        }
+
+        /** @brief Queues a task without a future */
+        void Enqueue(std::function<void()> task);
+
+        /** @brief Blocks until the queue is empty and no task runs */
+        void WaitIdle();
+
+        uint32_t GetThreadCount() const {
+            return static_cast<uint32_t>(m_Workers.size());
+        }
+
+        /** @return Tasks waiting for a worker */
+        size_t GetQueuedCount() const;
+
+    private:
+        void WorkerLoop();
+
+    private:
+        std::vector<std::thread> m_Workers;
+
+        mutable std::mutex m_Mutex;
+        std::condition_variable m_TaskAvailable;
+        std::condition_variable m_Idle;
+        std::deque<std::function<void()>> m_Tasks;
+        uint32_t m_Busy{ 0 };
+        bool m_Stop{ false };
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_CORE_THREAD_POOL_H_
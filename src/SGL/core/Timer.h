@@ -6,13 +6,19 @@
 #ifndef SGL_CORE_TIMER_H_
 #define SGL_CORE_TIMER_H_
 
-#include <chrono>
+#include <cstdint>
+
+#include "SGL/core/Clock.h"
 
 #define MILLIS_TO_SECONDS 0.001f
+#define MICROS_TO_SECONDS 0.000001f
+#define NANOS_TO_SECONDS 1e-9
+#define NANOS_TO_MILLIS 1e-6
 
 
 namespace sgl 
 {
+    /** @brief Measures in nanoseconds of the "Clock", fractions are kept */
     class Timer
     {
     public:
@@ -23,32 +29,40 @@ namespace sgl
 
         inline void Start()
         {
-            m_Start = std::chrono::high_resolution_clock::now();
+            m_Start = Clock::Now();
         }
 
         /** @return Time elapsed in seconds */
         inline operator float() const { return Elapsed(); }
 
+        inline uint64_t ElapsedNanos() const
+        {
+            // Never wraps, even if the clock source changed meanwhile
+            const uint64_t kNow = Clock::Now();
+            return kNow > m_Start ? kNow - m_Start : 0;
+        }
+
         inline float ElapsedMillis() const
         {
-            return std::chrono::duration_cast<std::chrono::milliseconds>
-                (std::chrono::high_resolution_clock::now() - m_Start).count();
+            return static_cast<float>(ElapsedNanos() * NANOS_TO_MILLIS);
         }
 
         inline float ElapsedMicro() const
         {
-            return std::chrono::duration_cast<std::chrono::microseconds>
-                (std::chrono::high_resolution_clock::now() - m_Start).count();
+            return static_cast<float>(ElapsedNanos() * 1e-3);
         }
 
         // @return Time elapsed in seconds
         inline float Elapsed() const
         {
-            return ElapsedMillis() * MILLIS_TO_SECONDS; 
+            return static_cast<float>(ElapsedNanos() * NANOS_TO_SECONDS);
         }
 
+        /** @return Nanoseconds of the "Clock" when started */
+        inline uint64_t GetStart() const { return m_Start; }
+
     private:
-        std::chrono::time_point<std::chrono::high_resolution_clock> m_Start;
+        uint64_t m_Start{ 0 };
     };
 
 } // namespace sgl 
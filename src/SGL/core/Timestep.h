@@ -6,22 +6,37 @@
 #ifndef SGL_CORE_TIMESTEP_H_
 #define SGL_CORE_TIMESTEP_H_
 
+#include <cstdint>
+
 
 namespace sgl 
 {
     class Timestep
     {
     public:
-        Timestep(float t) : m_Step(t) {}
+        Timestep(float t)
+            : m_Step(t),
+              m_Nanos(t > 0.0f ? static_cast<uint64_t>(t * 1e9) : 0) {}
+
+        /** @brief Keeps the exact duration, e.g. of a "Timer" */
+        static constexpr Timestep FromNanos(uint64_t nanos) {
+            return Timestep(static_cast<float>(nanos * 1e-9), nanos);
+        }
 
         /** @return Time in seconds */
         inline constexpr operator float() const { return m_Step; }
 
         inline constexpr float Seconds() const { return m_Step; }
         inline constexpr float Millis() const { return m_Step * 1000.0f; }
+        inline constexpr uint64_t Nanos() const { return m_Nanos; }
+
+    private:
+        constexpr Timestep(float t, uint64_t nanos)
+            : m_Step(t), m_Nanos(nanos) {}
 
     private:
         float m_Step;
+        uint64_t m_Nanos;
     };
     
 } // namespace sgl 
@@ -5,8 +5,9 @@
 
 #include "SGL/pch.h"
 #include "SGL/core/Utils.h"
+#include "SGL/core/MappedFile.h"
 
-#include <fstream>
+#include <limits>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
@@ -18,45 +19,34 @@ namespace sgl
     {
         SGL_LOG_INFO("Loading file: {}", filename);
 
-        // Open reading from the end, read as binary
-        std::ifstream file( filename.data(),
-                            std::ios::ate | std::ios::binary );
-        SGL_ASSERT_MSG(file.is_open(), "Failed to open a file '{}'", filename);
+        const MappedFile kFile{ std::string(filename) };
+        SGL_ASSERT_MSG(kFile.IsOpen(), "Failed to open a file '{}'", filename);
 
-        if (!file.is_open())
+        if (!kFile.IsOpen())
         {
-            std::cerr << "Failed to open a file: '" << filename << "'\n";
+            std::cerr << kFile.GetError() << '\n';
             exit(1);
         }
 
-        // Use read position to determine the size of the file
-        size_t fileSize = (size_t) file.tellg();
-        std::vector<char> buffer(fileSize);
-
-        // Seek back to the beginning of the file and read all of the bytes
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
-
-        file.close();
-
-        return buffer;
+        const char* kData = kFile.GetView().data();
+        return std::vector<char>(kData, kData + kFile.GetSize());
     }
 
     std::string LoadTextFile(std::string_view filename)
     {
         SGL_LOG_INFO("Loading Text file: {}", filename);
 
-        std::ifstream inFile( filename.data() );
-        SGL_ASSERT_MSG(inFile.is_open(),
+        // One copy out of the mapping, line endings are kept as they are
+        const MappedFile kFile{ std::string(filename) };
+        SGL_ASSERT_MSG(kFile.IsOpen(),
                         "Failed to open a file '{}'", filename);
-        if (!inFile.is_open())
+        if (!kFile.IsOpen())
         {
-            std::cerr << "Failed to open a file: '" << filename << "'\n";
+            std::cerr << kFile.GetError() << '\n';
             exit(1);
         }
 
-        return { std::istreambuf_iterator<char>(inFile), 
-                 std::istreambuf_iterator<char>() };
+        return std::string(kFile.GetView());
     }
 
     unsigned char* LoadImageData(const char* filename,
@@ -67,9 +57,40 @@ namespace sgl
     {
         SGL_FUNCTION();
 
-        return stbi_load(filename,
-                         &outWidth, &outHeight,
-                         &outComponents, requiredComponents);
+        const MappedFile kFile(filename);
+        if (!kFile.IsOpen())
+        {
+            // Sets the failure reason of stb_image
+            return stbi_load(filename,
+                             &outWidth, &outHeight,
+                             &outComponents, requiredComponents);
+        }
+
+        return LoadImageDataFromMemory(kFile.GetData(), kFile.GetSize(),
+                                       outWidth, outHeight, outComponents,
+                                       requiredComponents);
+    }
+
+    unsigned char* LoadImageDataFromMemory(const void* data,
+                                           size_t size,
+                                           int& outWidth,
+                                           int& outHeight,
+                                           int& outComponents,
+                                           int requiredComponents)
+    {
+        SGL_FUNCTION();
+
+        // stb_image takes the size as int
+        if (size > static_cast<size_t>(std::numeric_limits<int>::max()))
+        {
+            SGL_LOG_ERR("Images of {} bytes are too large to decode", size);
+            return NULL;
+        }
+
+        return stbi_load_from_memory(static_cast<const stbi_uc*>(data),
+                                     static_cast<int>(size),
+                                     &outWidth, &outHeight,
+                                     &outComponents, requiredComponents);
     }
 
     void FreeImageData(unsigned char* data)
@@ -114,5 +135,26 @@ namespace sgl
                                   data.channels, requiredComponents);
         return data;
     }
+
+    STBData LoadImageFromMemory(const void* data,
+                                size_t size,
+                                int requiredComponents)
+    {
+        SGL_FUNCTION();
+
+        STBData image;
+        image.data = LoadImageDataFromMemory(data, size,
+                                             image.width, image.height,
+                                             image.channels,
+                                             requiredComponents);
+        return image;
+    }
+
+    STBData LoadImage(const MappedFile& file,
+                      int requiredComponents)
+    {
+        return LoadImageFromMemory(file.GetData(), file.GetSize(),
+                                   requiredComponents);
+    }
     
 } // namespace sgl
@@ -9,15 +9,19 @@
 
 namespace sgl
 {
+    class MappedFile;
+
     /**
-     * @brief Reads contents of a file as binary
+     * @brief Reads contents of a file as binary, copied from a mapping of
+     *  the file, see "MappedFile"
      * @param filename The file to read from
      * @return Vector of characters from read binary data
      */
     std::vector<char> LoadFile(std::string_view filename);
 
     /**
-     * @brief Reads file as a text
+     * @brief Reads file as a text, copied from a mapping of the file.
+     *  Line endings are not converted.
      * @param filename The file to read from
      */
     std::string LoadTextFile(std::string_view filename);
@@ -38,6 +42,18 @@ namespace sgl
                                  int& outComponents,
                                  int requiredComponents = 0);
 
+    /**
+     * @brief "LoadImageData" of an encoded image in memory, e.g. a
+     *  "MappedFile". The file variant decodes from a mapping too.
+     * @param size Of the encoded image, in **bytes**
+     */
+    unsigned char* LoadImageDataFromMemory(const void* data,
+                                           size_t size,
+                                           int& outWidth,
+                                           int& outHeight,
+                                           int& outComponents,
+                                           int requiredComponents = 0);
+
     /** @param data Pixel data allocated by 'LoadImage()' */
     void FreeImageData(unsigned char* data);
 
@@ -69,6 +85,18 @@ namespace sgl
      */
     STBData LoadImage(const char* filename,
                       int requiredComponents = 0);
+
+    /** @brief "LoadImage" of an encoded image in memory */
+    STBData LoadImageFromMemory(const void* data,
+                                size_t size,
+                                int requiredComponents = 0);
+
+    /**
+     * @brief "LoadImage" decoding straight from the pages of a mapped
+     *  file, the file stays mapped by the caller
+     */
+    STBData LoadImage(const MappedFile& file,
+                      int requiredComponents = 0);
     
 } // namespace sgl
 
@@ -5,11 +5,24 @@
 
 #include "SGL/pch.h"
 #include "SGL/core/Window.h"
+#include "SGL/core/HeadlessContext.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
 
 
 namespace sgl
 {
-    uint8_t Window::s_WindowCount = 0;
+    std::atomic<uint32_t> Window::s_WindowCount{ 0 };
+
+    // Headless windows have no event loop to post to, "WaitEvents" sleeps
+    //  on this condition instead
+    static std::mutex s_WakeMutex;
+    static std::condition_variable s_WakeCondition;
+    static bool s_WakePending = false;
 
     std::unique_ptr<Window> Window::Create(const WindowData& data)
     {
@@ -29,15 +42,23 @@ namespace sgl
     {
         SGL_FUNCTION();
 
+        m_Data.backend = ResolveBackend(m_Data.backend);
+        if (m_Data.backend == WindowBackend::Headless)
+        {
+            CreateHeadless();
+            return;
+        }
+
         InitGLFW();
         CreateWindow();
 
         glfwMakeContextCurrent(m_Window);
 
         // TODO Load GL only once?
-        LoadGL();
+        LoadGL(reinterpret_cast<void* (*)(const char*)>(glfwGetProcAddress));
 
         SetUserPointer(&m_Data);
+        InstallEventCallbacks();
 
         SetVSync(true);
     }
@@ -54,18 +75,68 @@ namespace sgl
         ++s_WindowCount;
     }
 
+    void Window::CreateHeadless()
+    {
+        SGL_FUNCTION();
+
+        m_Headless = std::make_unique<HeadlessContext>();
+        LoadGL(HeadlessContext::GetProcAddress);
+
+        // Becomes the default framebuffer, also sets the viewport
+        m_Headless->CreateFramebuffer(m_Data.width, m_Data.height);
+        m_Data.VSync = false;
+
+        if (const char* frames = std::getenv("SGL_HEADLESS_FRAMES"))
+            m_Data.headlessFrames = std::strtoull(frames, nullptr, 10);
+
+        SGL_LOG_INFO("Created headless context {}x{}, frames: {}",
+                     m_Data.width, m_Data.height, m_Data.headlessFrames);
+    }
+
+    WindowBackend Window::ResolveBackend(WindowBackend backend)
+    {
+        if (backend == WindowBackend::Auto)
+        {
+            const char* kHeadless = std::getenv("SGL_HEADLESS");
+            const bool kForced = kHeadless != nullptr && kHeadless[0] != '\0'
+                                 && std::strcmp(kHeadless, "0") != 0;
+        #ifdef __linux__
+            const bool kNoDisplay = std::getenv("DISPLAY") == nullptr &&
+                                    std::getenv("WAYLAND_DISPLAY") == nullptr;
+        #else
+            const bool kNoDisplay = false;
+        #endif
+            backend = kForced || kNoDisplay ? WindowBackend::Headless
+                                            : WindowBackend::GLFW;
+        }
+
+        if (backend == WindowBackend::Headless &&
+            !HeadlessContext::IsAvailable())
+        {
+            SGL_LOG_WARN("Headless backend not available, using GLFW");
+            backend = WindowBackend::GLFW;
+        }
+
+        return backend;
+    }
+
     Window::~Window()
     {
         SGL_FUNCTION();
 
+        const bool kHeadless = IsHeadless();
         DestroyWindow();
-        TerminateGLFW();
+
+        if (!kHeadless)
+            TerminateGLFW();
     }
 
     void Window::DestroyWindow()
     {
         SGL_FUNCTION();
 
+        m_Headless.reset();
+
         if (m_Window == nullptr)
             return;
 
@@ -75,10 +146,85 @@ namespace sgl
         --s_WindowCount;
     }
 
+    bool Window::IsOpen() const
+    {
+        if (m_Window != nullptr)
+            return !glfwWindowShouldClose(m_Window);
+
+        return !m_ShouldClose && (m_Data.headlessFrames == 0 ||
+                                  m_FrameCount < m_Data.headlessFrames);
+    }
+
+    void Window::Close()
+    {
+        SGL_FUNCTION();
+
+        if (m_Window != nullptr)
+            glfwSetWindowShouldClose(m_Window, GLFW_TRUE);
+        m_ShouldClose = true;
+    }
+
+    void Window::Display()
+    {
+        ++m_FrameCount;
+
+        if (m_Window != nullptr)
+            glfwSwapBuffers(m_Window);
+        else
+            glFlush();
+    }
+
+    void Window::PollEvents() const
+    {
+        if (m_Window != nullptr)
+            glfwPollEvents();
+    }
+
+    void Window::WaitEvents(double timeout)
+    {
+        if (m_Window != nullptr)
+        {
+            glfwWaitEventsTimeout(timeout);
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(s_WakeMutex);
+        s_WakeCondition.wait_for(lock,
+                                 std::chrono::duration<double>(timeout),
+                                 [] { return s_WakePending; });
+        s_WakePending = false;
+    }
+
+    void Window::PostEmptyEvent()
+    {
+        if (s_WindowCount > 0)
+            glfwPostEmptyEvent();
+
+        {
+            std::lock_guard<std::mutex> lock(s_WakeMutex);
+            s_WakePending = true;
+        }
+        s_WakeCondition.notify_all();
+    }
+
+    uint32_t Window::GetFramebufferID() const
+    {
+        return m_Headless != nullptr ? m_Headless->GetFramebufferID() : 0;
+    }
+
+    void Window::BindDefaultFramebuffer() const
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, GetFramebufferID());
+    }
+
     void Window::UpdateSize()
     {
         SGL_FUNCTION();
 
+        // Headless framebuffer keeps its size
+        if (m_Window == nullptr)
+            return;
+
         int width, height;
         glfwGetFramebufferSize(m_Window, &width, &height);
 
@@ -90,6 +236,9 @@ namespace sgl
     {
         SGL_FUNCTION();
 
+        if (m_Window == nullptr)
+            return;
+
         if (enabled)
             glfwSwapInterval(1);
         else
@@ -98,51 +247,141 @@ namespace sgl
         m_Data.VSync = enabled;
     }
 
+    float Window::GetRefreshRate() const
+    {
+        SGL_FUNCTION();
+
+        if (m_Window == nullptr)
+            return 60.0f;
+
+        // Windowed mode windows have no monitor
+        GLFWmonitor* monitor = glfwGetWindowMonitor(m_Window);
+        if (monitor == nullptr)
+            monitor = glfwGetPrimaryMonitor();
+
+        const GLFWvidmode* mode = monitor != nullptr
+                                  ? glfwGetVideoMode(monitor) : nullptr;
+        if (mode == nullptr || mode->refreshRate <= 0)
+        {
+            SGL_LOG_WARN("Unknown monitor refresh rate, assuming 60 Hz");
+            return 60.0f;
+        }
+
+        return static_cast<float>(mode->refreshRate);
+    }
+
     void Window::SetUserPointer(void* ptr) const
     {
-        glfwSetWindowUserPointer(m_Window, ptr);
+        if (m_Window != nullptr)
+            glfwSetWindowUserPointer(m_Window, ptr);
+    }
+
+    void Window::SetKeyCallback(GLFWkeyfun callback)
+    {
+        SGL_FUNCTION();
+        m_Data.callbacks.key = callback;
     }
 
-    void Window::SetKeyCallback(GLFWkeyfun callback) const
+    void Window::SetWindowSizeCallback(GLFWwindowsizefun callback)
     {
         SGL_FUNCTION();
-        glfwSetKeyCallback(m_Window, callback);
+        m_Data.callbacks.windowSize = callback;
     }
 
-    void Window::SetWindowSizeCallback(GLFWwindowsizefun callback) const
+    void Window::SetWindowCloseCallback(GLFWwindowclosefun callback)
     {
         SGL_FUNCTION();
-        glfwSetWindowSizeCallback(m_Window, callback);
+        m_Data.callbacks.windowClose = callback;
     }
 
-    void Window::SetWindowCloseCallback(GLFWwindowclosefun callback) const
+    void Window::SetCharCallback(GLFWcharfun callback)
     {
         SGL_FUNCTION();
-        glfwSetWindowCloseCallback(m_Window, callback);
+        m_Data.callbacks.character = callback;
     }
 
-    void Window::SetCharCallback(GLFWcharfun callback) const
+    void Window::SetMouseButtonCallback(GLFWmousebuttonfun callback)
     {
         SGL_FUNCTION();
-        glfwSetCharCallback(m_Window, callback);
+        m_Data.callbacks.mouseButton = callback;
     }
 
-    void Window::SetMouseButtonCallback(GLFWmousebuttonfun callback) const
+    void Window::SetScrollCallback(GLFWscrollfun callback)
     {
         SGL_FUNCTION();
-        glfwSetMouseButtonCallback(m_Window, callback);
+        m_Data.callbacks.scroll = callback;
     }
 
-    void Window::SetScrollCallback(GLFWscrollfun callback) const
+    void Window::SetCursorPosCallback(GLFWcursorposfun callback)
     {
         SGL_FUNCTION();
-        glfwSetScrollCallback(m_Window, callback);
+        m_Data.callbacks.cursorPos = callback;
     }
 
-    void Window::SetCursorPosCallback(GLFWcursorposfun callback) const
+    void Window::InstallEventCallbacks() const
     {
         SGL_FUNCTION();
-        glfwSetCursorPosCallback(m_Window, callback);
+
+        // Callbacks installed later by ImGui chain to these ones
+        glfwSetKeyCallback(m_Window,
+            [](GLFWwindow* w, int key, int scancode, int action, int mods) {
+                WindowData& data = GetUserData(w);
+                ++data.eventCount;
+                if (data.callbacks.key)
+                    data.callbacks.key(w, key, scancode, action, mods);
+            });
+        glfwSetWindowSizeCallback(m_Window,
+            [](GLFWwindow* w, int width, int height) {
+                WindowData& data = GetUserData(w);
+                ++data.eventCount;
+                if (data.callbacks.windowSize)
+                    data.callbacks.windowSize(w, width, height);
+            });
+        glfwSetWindowCloseCallback(m_Window,
+            [](GLFWwindow* w) {
+                WindowData& data = GetUserData(w);
+                ++data.eventCount;
+                if (data.callbacks.windowClose)
+                    data.callbacks.windowClose(w);
+            });
+        glfwSetCharCallback(m_Window,
+            [](GLFWwindow* w, unsigned int codepoint) {
+                WindowData& data = GetUserData(w);
+                ++data.eventCount;
+                if (data.callbacks.character)
+                    data.callbacks.character(w, codepoint);
+            });
+        glfwSetMouseButtonCallback(m_Window,
+            [](GLFWwindow* w, int button, int action, int mods) {
+                WindowData& data = GetUserData(w);
+                ++data.eventCount;
+                if (data.callbacks.mouseButton)
+                    data.callbacks.mouseButton(w, button, action, mods);
+            });
+        glfwSetScrollCallback(m_Window,
+            [](GLFWwindow* w, double xoffset, double yoffset) {
+                WindowData& data = GetUserData(w);
+                ++data.eventCount;
+                if (data.callbacks.scroll)
+                    data.callbacks.scroll(w, xoffset, yoffset);
+            });
+        glfwSetCursorPosCallback(m_Window,
+            [](GLFWwindow* w, double xpos, double ypos) {
+                WindowData& data = GetUserData(w);
+                ++data.eventCount;
+                if (data.callbacks.cursorPos)
+                    data.callbacks.cursorPos(w, xpos, ypos);
+            });
+
+        // Events without user callbacks, only trigger redraws
+        glfwSetWindowRefreshCallback(m_Window,
+            [](GLFWwindow* w) { ++GetUserData(w).eventCount; });
+        glfwSetWindowFocusCallback(m_Window,
+            [](GLFWwindow* w, int) { ++GetUserData(w).eventCount; });
+        glfwSetCursorEnterCallback(m_Window,
+            [](GLFWwindow* w, int) { ++GetUserData(w).eventCount; });
+        glfwSetFramebufferSizeCallback(m_Window,
+            [](GLFWwindow* w, int, int) { ++GetUserData(w).eventCount; });
     }
 
     // =========================================================================
@@ -204,13 +443,17 @@ namespace sgl
     }
 #endif  // SGL_DEBUG
 
-    void Window::LoadGL()
+    void Window::LoadGL(void* (*loader)(const char*))
     {
         SGL_FUNCTION();
 
-        int success = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+        int success = gladLoadGLLoader(loader);
         SGL_ASSERT_MSG(success, "Could not load OpenGL using GLAD");
 
+        // Image rows of SGL are tightly packed, set once instead of around
+        //  each upload, odd widths of RGB are not 4 byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
     #ifdef SGL_DEBUG
         glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
         glDebugMessageCallback(DebugCallback, nullptr);
@@ -8,6 +8,7 @@
 
 #include <string>
 #include <memory>
+#include <atomic>
 
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
@@ -17,6 +18,27 @@
 
 namespace sgl
 {
+    class HeadlessContext;
+
+    enum class WindowBackend
+    {
+        Auto = 0,   ///< Headless if "SGL_HEADLESS" is set or no display exists
+        GLFW,       ///< Window with a context on a display server
+        Headless    ///< Offscreen context rendering into a framebuffer object
+    };
+
+    /** @brief User callbacks, called after the window records the event */
+    struct WindowCallbacks
+    {
+        GLFWkeyfun key{ nullptr };
+        GLFWwindowsizefun windowSize{ nullptr };
+        GLFWwindowclosefun windowClose{ nullptr };
+        GLFWcharfun character{ nullptr };
+        GLFWmousebuttonfun mouseButton{ nullptr };
+        GLFWscrollfun scroll{ nullptr };
+        GLFWcursorposfun cursorPos{ nullptr };
+    };
+
     // One place of change
     struct WindowData
     {
@@ -25,6 +47,18 @@ namespace sgl
         uint32_t height;
         bool VSync;
 
+        WindowBackend backend{ WindowBackend::Auto };
+        /// Headless only, frames after which the window closes, 0 is never.
+        ///  Overridden by the "SGL_HEADLESS_FRAMES" environment variable
+        uint64_t headlessFrames{ 0 };
+
+        /// Incremented on each received input or window event
+        uint64_t eventCount{ 0 };
+        WindowCallbacks callbacks;
+
+        /// Free for the user callbacks, the GLFW user pointer is this data
+        void* userPointer{ nullptr };
+
         WindowData(const std::string& title = SGL_WINDOW_DEFAULT_TITLE,
                    uint32_t width = SGL_WINDOW_DEFAULT_WIDTH,
                    uint32_t height = SGL_WINDOW_DEFAULT_HEIGHT)
@@ -32,7 +66,8 @@ namespace sgl
     };
 
     /**
-     * Abstracts window and OpenGL context using GLFWWindow handle
+     * Abstracts window and OpenGL context using GLFWWindow handle, or an
+     *  offscreen context when the backend is headless
      */
     class Window
     {
@@ -50,21 +85,59 @@ namespace sgl
         Window(const WindowData& data = WindowData());
         ~Window();
 
+        /** @return GLFW window handle, null if headless */
         operator GLFWwindow*() const { return m_Window; }
         GLFWwindow* GetGLFWWindow() const { return m_Window; }
 
-        inline bool IsOpen() const { return !glfwWindowShouldClose(m_Window); }
+        bool IsHeadless() const { return m_Headless != nullptr; }
+
+        /** @return Offscreen context to share objects with, null if GLFW */
+        const HeadlessContext* GetHeadlessContext() const {
+            return m_Headless.get();
+        }
+
+        bool IsOpen() const;
+
+        /** @brief Requests the window to close */
+        void Close();
 
         /**
          * @brief Swaps buffers to display the rendered frame
          */
-        inline void Display() const { glfwSwapBuffers(m_Window); }
+        void Display();
 
         /**
          * @brief Processes pending events that have already been received, and
          *  returns immediately 
          */
-        inline void PollEvents() const { glfwPollEvents(); }
+        void PollEvents() const;
+
+        /**
+         * @brief Sleeps until at least one event has been received, or the
+         *  timeout elapsed, then processes the received events.
+         *  Headless windows receive no events, they sleep until the timeout
+         *  or until "PostEmptyEvent".
+         * @param timeout In seconds
+         */
+        void WaitEvents(double timeout);
+
+        /**
+         * @brief Wakes up the thread waiting in "WaitEvents",
+         *  may be called from any thread
+         */
+        static void PostEmptyEvent();
+
+        /**
+         * @return Framebuffer object that replaces the default framebuffer,
+         *  0 unless headless
+         */
+        uint32_t GetFramebufferID() const;
+
+        /** @brief Binds the default framebuffer of this window */
+        void BindDefaultFramebuffer() const;
+
+        /** @return Number of input and window events received so far */
+        uint64_t GetEventCount() const { return m_Data.eventCount; }
 
         /**
          * @brief Destroys the window handle for it to be later created again
@@ -79,18 +152,19 @@ namespace sgl
         void SetVSync(bool enabled);
         bool IsVSync() const { return m_Data.VSync; }
 
+        /** @return Refresh rate of the monitor in Hz */
+        float GetRefreshRate() const;
+
         // ---------------------------------------------------------------------
         // Callbacks
 
-        void SetUserPointer(void* ptr) const;
-
         /**
          * @param callback Function of signature:
          *  void fname(GLFWwindow* window, int key, int scancode, int action,
          *             int mods)
          * Called when a key is pressed, repeated or released.
          */
-        void SetKeyCallback(GLFWkeyfun callback) const;
+        void SetKeyCallback(GLFWkeyfun callback);
 
         /**
          * @param callback Function of signature:
@@ -98,7 +172,7 @@ namespace sgl
          * 
          * Called when the window is resized
          */
-        void SetWindowSizeCallback(GLFWwindowsizefun callback) const;
+        void SetWindowSizeCallback(GLFWwindowsizefun callback);
 
         /**
          * @param callback Function of signature:
@@ -106,7 +180,7 @@ namespace sgl
          * 
          * Called when the user attempts to close the window
          */
-        void SetWindowCloseCallback(GLFWwindowclosefun callback) const;
+        void SetWindowCloseCallback(GLFWwindowclosefun callback);
 
         /**
          * @param callback Function of signature:
@@ -116,7 +190,7 @@ namespace sgl
          * Is keyboard layout dependent, characters do not map 1:1 to
          *  physical keys,
          */
-        void SetCharCallback(GLFWcharfun callback) const;
+        void SetCharCallback(GLFWcharfun callback);
 
         /**
          * @param callback Function of signature:
@@ -124,7 +198,7 @@ namespace sgl
          * 
          * Called when a mouse button is pressed or released.
          */
-        void SetMouseButtonCallback(GLFWmousebuttonfun callback) const;
+        void SetMouseButtonCallback(GLFWmousebuttonfun callback);
         
         /**
          * @param callback Function of signature:
@@ -133,7 +207,7 @@ namespace sgl
          * Called when a scrolling device is used, such as a mouse wheel or
          *  scrolling area of a touchpad.
          */
-        void SetScrollCallback(GLFWscrollfun callback) const;
+        void SetScrollCallback(GLFWscrollfun callback);
 
         /**
          * @param callback Function of signature:
@@ -143,20 +217,36 @@ namespace sgl
          *  position, in screen coordinates, relative to the upper-left corner
          *  of the content area of the window.
          */
-        void SetCursorPosCallback(GLFWcursorposfun callback) const;
+        void SetCursorPosCallback(GLFWcursorposfun callback);
     
     private:
         void CreateWindow();
+        void CreateHeadless();
+
+        static WindowBackend ResolveBackend(WindowBackend backend);
+
+        /**
+         * @brief Installs callbacks that count the events and forward them
+         *  to the user callbacks
+         */
+        void InstallEventCallbacks() const;
+        /** @brief Always "m_Data", the event callbacks cast it back */
+        void SetUserPointer(void* ptr) const;
 
         static void InitGLFW();
         static void TerminateGLFW();
-        static void LoadGL();
+        static void LoadGL(void* (*loader)(const char*));
 
     private:
         GLFWwindow* m_Window{ nullptr };
+        std::unique_ptr<HeadlessContext> m_Headless;
         WindowData m_Data;
 
-        static uint8_t s_WindowCount;
+        uint64_t m_FrameCount{ 0 };
+        bool m_ShouldClose{ false };    ///< Headless only
+
+        /** @brief GLFW windows, read by "PostEmptyEvent" from any thread */
+        static std::atomic<uint32_t> s_WindowCount;
     };
 }
 
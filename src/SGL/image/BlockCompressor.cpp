@@ -0,0 +1,794 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/image/BlockCompressor.h"
+#include "SGL/image/MipChain.h"
+#include "SGL/core/Profiler.h"
+#include "SGL/core/ThreadPool.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #define SGL_BC_SSE2
+    #include <emmintrin.h>
+#endif
+
+
+namespace sgl
+{
+    namespace bc
+    {
+        /** @brief Tasks queued per worker, smaller tiles balance better */
+        constexpr uint32_t kTasksPerWorker = 4;
+
+        /** @brief Block index of a point on the BC1 line, from c0 to c1 */
+        constexpr uint32_t kIndices4[4] = { 0, 2, 3, 1 };
+        constexpr uint32_t kIndices3[3] = { 0, 2, 1 };
+        constexpr uint32_t kTransparentIndex = 3;
+
+        enum class Kind
+        {
+            BC1 = 0,
+            BC1Alpha,   ///< Punch-through alpha
+            BC3,
+            BC4,
+            BC5
+        };
+
+        struct Job
+        {
+            const unsigned char* pixels{ nullptr };
+            uint32_t width{ 0 };
+            uint32_t height{ 0 };
+            uint32_t channels{ 0 };
+            Kind kind{ Kind::BC1 };
+            uint32_t blockBytes{ 0 };
+            uint32_t blocksX{ 0 };
+            unsigned char* out{ nullptr };
+        };
+
+        bool GetKind(uint32_t format, Kind& outKind)
+        {
+            switch (format)
+            {
+                case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+                case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+                    outKind = Kind::BC1;
+                    return true;
+                case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+                case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+                    outKind = Kind::BC1Alpha;
+                    return true;
+                case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+                    outKind = Kind::BC3;
+                    return true;
+                case GL_COMPRESSED_RED_RGTC1:
+                    outKind = Kind::BC4;
+                    return true;
+                case GL_COMPRESSED_RG_RGTC2:
+                    outKind = Kind::BC5;
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        /** @brief Texels past the edges repeat the last row and column */
+        void LoadBlockRGBA(const Job& job, uint32_t x0, uint32_t y0,
+                           unsigned char* out)
+        {
+            const uint32_t kChannels = job.channels;
+
+            if (kChannels == 4 && x0 + 4 <= job.width
+                && y0 + 4 <= job.height)
+            {
+                for (uint32_t y = 0; y < 4; ++y)
+                {
+                    std::memcpy(out + y * 16, job.pixels
+                                + ((size_t(y0) + y) * job.width + x0) * 4,
+                                16);
+                }
+                return;
+            }
+
+            for (uint32_t y = 0; y < 4; ++y)
+            {
+                const size_t kRow = std::min(y0 + y, job.height - 1);
+                for (uint32_t x = 0; x < 4; ++x)
+                {
+                    const size_t kColumn = std::min(x0 + x, job.width - 1);
+                    const unsigned char* kTexel = job.pixels
+                        + (kRow * job.width + kColumn) * kChannels;
+                    unsigned char* texel = out + (y * 4 + x) * 4;
+
+                    if (kChannels <= 2)
+                    {
+                        texel[0] = texel[1] = texel[2] = kTexel[0];
+                        texel[3] = kChannels == 2 ? kTexel[1] : 255;
+                    }
+                    else
+                    {
+                        texel[0] = kTexel[0];
+                        texel[1] = kTexel[1];
+                        texel[2] = kTexel[2];
+                        texel[3] = kChannels == 4 ? kTexel[3] : 255;
+                    }
+                }
+            }
+        }
+
+        /** @brief A channel past the last one repeats the last one */
+        void LoadBlockChannel(const Job& job, uint32_t channel, uint32_t x0,
+                              uint32_t y0, unsigned char* out)
+        {
+            channel = std::min(channel, job.channels - 1);
+
+            for (uint32_t y = 0; y < 4; ++y)
+            {
+                const size_t kRow = std::min(y0 + y, job.height - 1);
+                for (uint32_t x = 0; x < 4; ++x)
+                {
+                    const size_t kColumn = std::min(x0 + x, job.width - 1);
+                    out[y * 4 + x] = job.pixels[(kRow * job.width + kColumn)
+                                                * job.channels + channel];
+                }
+            }
+        }
+
+        void MinMaxRGBA(const unsigned char* block, unsigned char* outMin,
+                        unsigned char* outMax)
+        {
+        #ifdef SGL_BC_SSE2
+            const __m128i* kRows = reinterpret_cast<const __m128i*>(block);
+            const __m128i kRow0 = _mm_loadu_si128(kRows);
+            const __m128i kRow1 = _mm_loadu_si128(kRows + 1);
+            const __m128i kRow2 = _mm_loadu_si128(kRows + 2);
+            const __m128i kRow3 = _mm_loadu_si128(kRows + 3);
+
+            __m128i low = _mm_min_epu8(_mm_min_epu8(kRow0, kRow1),
+                                       _mm_min_epu8(kRow2, kRow3));
+            __m128i high = _mm_max_epu8(_mm_max_epu8(kRow0, kRow1),
+                                        _mm_max_epu8(kRow2, kRow3));
+
+            // Four texels left, then two, then one
+            low = _mm_min_epu8(low, _mm_shuffle_epi32(low, 0x4E));
+            low = _mm_min_epu8(low, _mm_shuffle_epi32(low, 0xB1));
+            high = _mm_max_epu8(high, _mm_shuffle_epi32(high, 0x4E));
+            high = _mm_max_epu8(high, _mm_shuffle_epi32(high, 0xB1));
+
+            const int kLow = _mm_cvtsi128_si32(low);
+            const int kHigh = _mm_cvtsi128_si32(high);
+            std::memcpy(outMin, &kLow, 4);
+            std::memcpy(outMax, &kHigh, 4);
+        #else
+            std::memcpy(outMin, block, 4);
+            std::memcpy(outMax, block, 4);
+            for (uint32_t i = 4; i < 64; ++i)
+            {
+                outMin[i & 3] = std::min(outMin[i & 3], block[i]);
+                outMax[i & 3] = std::max(outMax[i & 3], block[i]);
+            }
+        #endif
+        }
+
+        void MinMax16(const unsigned char* values, unsigned char& outMin,
+                      unsigned char& outMax)
+        {
+        #ifdef SGL_BC_SSE2
+            const __m128i kValues = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(values));
+
+            __m128i low = _mm_min_epu8(kValues, _mm_srli_si128(kValues, 8));
+            __m128i high = _mm_max_epu8(kValues, _mm_srli_si128(kValues, 8));
+            low = _mm_min_epu8(low, _mm_srli_si128(low, 4));
+            high = _mm_max_epu8(high, _mm_srli_si128(high, 4));
+            low = _mm_min_epu8(low, _mm_srli_si128(low, 2));
+            high = _mm_max_epu8(high, _mm_srli_si128(high, 2));
+            low = _mm_min_epu8(low, _mm_srli_si128(low, 1));
+            high = _mm_max_epu8(high, _mm_srli_si128(high, 1));
+
+            outMin = static_cast<unsigned char>(_mm_cvtsi128_si32(low));
+            outMax = static_cast<unsigned char>(_mm_cvtsi128_si32(high));
+        #else
+            outMin = outMax = values[0];
+            for (uint32_t i = 1; i < 16; ++i)
+            {
+                outMin = std::min(outMin, values[i]);
+                outMax = std::max(outMax, values[i]);
+            }
+        #endif
+        }
+
+        /**
+         * @brief Projects the texels on the line from "start" along "dir"
+         *  and rounds them to the nearest of "steps" + 1 points, 0 at the
+         *  start and "steps" at the end
+         * @param steps 2 or 3
+         */
+        void QuantizeToLine(const unsigned char* block, const int* start,
+                            const int* dir, int steps, int32_t* outLevels)
+        {
+            const int kLength = dir[0] * dir[0] + dir[1] * dir[1]
+                                + dir[2] * dir[2];
+            if (kLength == 0)
+            {
+                std::fill(outLevels, outLevels + 16, 0);
+                return;
+            }
+
+            // The level is the count of midpoints 2 * steps * t passes,
+            //  the midpoints are at odd multiples of the length
+        #ifdef SGL_BC_SSE2
+            const __m128i kZero = _mm_setzero_si128();
+            const __m128i kStart = _mm_setr_epi16(
+                static_cast<short>(start[0]), static_cast<short>(start[1]),
+                static_cast<short>(start[2]), 0,
+                static_cast<short>(start[0]), static_cast<short>(start[1]),
+                static_cast<short>(start[2]), 0);
+            const __m128i kDir = _mm_setr_epi16(
+                static_cast<short>(dir[0]), static_cast<short>(dir[1]),
+                static_cast<short>(dir[2]), 0,
+                static_cast<short>(dir[0]), static_cast<short>(dir[1]),
+                static_cast<short>(dir[2]), 0);
+            const __m128i kMid0 = _mm_set1_epi32(kLength - 1);
+            const __m128i kMid1 = _mm_set1_epi32(3 * kLength - 1);
+            const __m128i kMid2 = _mm_set1_epi32(5 * kLength - 1);
+
+            for (int i = 0; i < 4; ++i)
+            {
+                const __m128i kTexels = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(block + i * 16));
+                const __m128i kLow = _mm_sub_epi16(
+                    _mm_unpacklo_epi8(kTexels, kZero), kStart);
+                const __m128i kHigh = _mm_sub_epi16(
+                    _mm_unpackhi_epi8(kTexels, kZero), kStart);
+
+                // (r * dr + g * dg, b * db) pairs, summed per texel
+                const __m128 kDotLow = _mm_castsi128_ps(
+                    _mm_madd_epi16(kLow, kDir));
+                const __m128 kDotHigh = _mm_castsi128_ps(
+                    _mm_madd_epi16(kHigh, kDir));
+                __m128i dot = _mm_add_epi32(
+                    _mm_castps_si128(_mm_shuffle_ps(kDotLow, kDotHigh,
+                                                    _MM_SHUFFLE(2, 0, 2, 0))),
+                    _mm_castps_si128(_mm_shuffle_ps(kDotLow, kDotHigh,
+                                                    _MM_SHUFFLE(3, 1, 3, 1))));
+
+                dot = steps == 3
+                    ? _mm_add_epi32(_mm_slli_epi32(dot, 2),
+                                    _mm_slli_epi32(dot, 1))
+                    : _mm_slli_epi32(dot, 2);
+
+                // Compares are -1 when true
+                __m128i level = _mm_sub_epi32(kZero,
+                                              _mm_cmpgt_epi32(dot, kMid0));
+                level = _mm_sub_epi32(level, _mm_cmpgt_epi32(dot, kMid1));
+                if (steps == 3)
+                    level = _mm_sub_epi32(level, _mm_cmpgt_epi32(dot, kMid2));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(outLevels + i * 4),
+                                 level);
+            }
+        #else
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                const unsigned char* kTexel = block + i * 4;
+                const int kDot = (kTexel[0] - start[0]) * dir[0]
+                                 + (kTexel[1] - start[1]) * dir[1]
+                                 + (kTexel[2] - start[2]) * dir[2];
+                const int kScaled = 2 * steps * kDot;
+
+                int32_t level = 0;
+                for (int mid = 0; mid < steps; ++mid)
+                    level += kScaled >= (2 * mid + 1) * kLength;
+                outLevels[i] = level;
+            }
+        #endif
+        }
+
+        uint16_t To565(int r, int g, int b)
+        {
+            return static_cast<uint16_t>(((r * 31 + 127) / 255) << 11
+                                         | ((g * 63 + 127) / 255) << 5
+                                         | ((b * 31 + 127) / 255));
+        }
+
+        void From565(uint16_t color, int* out)
+        {
+            const int kRed = color >> 11;
+            const int kGreen = (color >> 5) & 63;
+            const int kBlue = color & 31;
+            out[0] = (kRed << 3) | (kRed >> 2);
+            out[1] = (kGreen << 2) | (kGreen >> 4);
+            out[2] = (kBlue << 3) | (kBlue >> 2);
+        }
+
+        void WriteColorBlock(uint16_t c0, uint16_t c1, uint32_t indices,
+                             unsigned char* out)
+        {
+            out[0] = static_cast<unsigned char>(c0);
+            out[1] = static_cast<unsigned char>(c0 >> 8);
+            out[2] = static_cast<unsigned char>(c1);
+            out[3] = static_cast<unsigned char>(c1 >> 8);
+            std::memcpy(out + 4, &indices, 4);
+        }
+
+        /** @return Squared error of the texels at the levels of c0 - c1 */
+        int ColorError(const unsigned char* block, const int* p0,
+                       const int* p1, const int32_t* levels)
+        {
+            int palette[4][3];
+            for (int c = 0; c < 3; ++c)
+            {
+                palette[0][c] = p0[c];
+                palette[1][c] = (2 * p0[c] + p1[c]) / 3;
+                palette[2][c] = (p0[c] + 2 * p1[c]) / 3;
+                palette[3][c] = p1[c];
+            }
+
+            int error = 0;
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                const int* kColor = palette[levels[i]];
+                for (int c = 0; c < 3; ++c)
+                {
+                    const int kDelta = block[i * 4 + c] - kColor[c];
+                    error += kDelta * kDelta;
+                }
+            }
+            return error;
+        }
+
+        /** @brief Least squares endpoints for the levels, 0 to 3 */
+        bool RefineEndpoints(const unsigned char* block,
+                             const int32_t* levels, uint16_t& outC0,
+                             uint16_t& outC1)
+        {
+            float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+            float ax[3] = {}, bx[3] = {};
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                const float kB = levels[i] / 3.0f;
+                const float kA = 1.0f - kB;
+                aa += kA * kA;
+                bb += kB * kB;
+                ab += kA * kB;
+                for (int c = 0; c < 3; ++c)
+                {
+                    ax[c] += kA * block[i * 4 + c];
+                    bx[c] += kB * block[i * 4 + c];
+                }
+            }
+
+            const float kDet = aa * bb - ab * ab;
+            if (std::abs(kDet) < 1e-6f)
+                return false;
+
+            int a[3], b[3];
+            for (int c = 0; c < 3; ++c)
+            {
+                const float kA = (ax[c] * bb - bx[c] * ab) / kDet;
+                const float kB = (bx[c] * aa - ax[c] * ab) / kDet;
+                a[c] = std::clamp(static_cast<int>(kA + 0.5f), 0, 255);
+                b[c] = std::clamp(static_cast<int>(kB + 0.5f), 0, 255);
+            }
+
+            outC0 = To565(a[0], a[1], a[2]);
+            outC1 = To565(b[0], b[1], b[2]);
+            return true;
+        }
+
+        /** @brief Four color mode, c0 > c1 */
+        void EncodeColor4(const unsigned char* block, uint16_t c0,
+                          uint16_t c1, unsigned char* out)
+        {
+            if (c0 < c1)
+                std::swap(c0, c1);
+
+            int p0[3], p1[3], dir[3];
+            alignas(16) int32_t levels[16];
+
+            From565(c0, p0);
+            From565(c1, p1);
+            for (int c = 0; c < 3; ++c)
+                dir[c] = p1[c] - p0[c];
+            QuantizeToLine(block, p0, dir, 3, levels);
+
+            uint16_t refined0 = 0, refined1 = 0;
+            if (c0 != c1 && RefineEndpoints(block, levels, refined0,
+                                            refined1))
+            {
+                if (refined0 < refined1)
+                    std::swap(refined0, refined1);
+
+                if (refined0 != refined1)
+                {
+                    int q0[3], q1[3];
+                    alignas(16) int32_t refinedLevels[16];
+
+                    From565(refined0, q0);
+                    From565(refined1, q1);
+                    for (int c = 0; c < 3; ++c)
+                        dir[c] = q1[c] - q0[c];
+                    QuantizeToLine(block, q0, dir, 3, refinedLevels);
+
+                    if (ColorError(block, q0, q1, refinedLevels)
+                        < ColorError(block, p0, p1, levels))
+                    {
+                        c0 = refined0;
+                        c1 = refined1;
+                        std::memcpy(levels, refinedLevels, sizeof(levels));
+                    }
+                }
+            }
+
+            uint32_t indices = 0;
+            for (uint32_t i = 0; i < 16; ++i)
+                indices |= kIndices4[levels[i]] << (2 * i);
+            WriteColorBlock(c0, c1, indices, out);
+        }
+
+        /** @brief Three color mode, c0 <= c1, the 4th index is black */
+        void EncodeColor3(const unsigned char* block, uint16_t c0,
+                          uint16_t c1, unsigned char* out)
+        {
+            if (c0 > c1)
+                std::swap(c0, c1);
+
+            int p0[3], p1[3], dir[3];
+            alignas(16) int32_t levels[16];
+
+            From565(c0, p0);
+            From565(c1, p1);
+            for (int c = 0; c < 3; ++c)
+                dir[c] = p1[c] - p0[c];
+            QuantizeToLine(block, p0, dir, 2, levels);
+
+            uint32_t indices = 0;
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                const uint32_t kIndex = block[i * 4 + 3] < 128
+                                        ? kTransparentIndex
+                                        : kIndices3[levels[i]];
+                indices |= kIndex << (2 * i);
+            }
+            WriteColorBlock(c0, c1, indices, out);
+        }
+
+        /**
+         * @param punchThrough Texels with an alpha under 128 become
+         *  transparent, BC1 with alpha only
+         */
+        void EncodeColor(const unsigned char* block, bool punchThrough,
+                         unsigned char* out)
+        {
+            unsigned char low[4], high[4];
+            MinMaxRGBA(block, low, high);
+
+            const bool kTransparent = punchThrough && low[3] < 128;
+            if (kTransparent)
+            {
+                // Bounds of the opaque texels only
+                std::fill(low, low + 4, 255);
+                std::fill(high, high + 4, 0);
+                for (uint32_t i = 0; i < 16; ++i)
+                {
+                    if (block[i * 4 + 3] < 128)
+                        continue;
+
+                    for (uint32_t c = 0; c < 3; ++c)
+                    {
+                        low[c] = std::min(low[c], block[i * 4 + c]);
+                        high[c] = std::max(high[c], block[i * 4 + c]);
+                    }
+                }
+
+                if (low[0] > high[0])
+                {
+                    WriteColorBlock(0, 0, 0xFFFFFFFF, out);
+                    return;
+                }
+            }
+
+            // Box of the colors, inset by 1/16 of its size for the
+            //  rounding of the endpoints
+            int start[3], end[3], center[3];
+            for (int c = 0; c < 3; ++c)
+            {
+                const int kInset = (high[c] - low[c]) >> 4;
+                start[c] = high[c] - kInset;
+                end[c] = low[c] + kInset;
+                center[c] = (high[c] + low[c] + 1) >> 1;
+            }
+
+            // Diagonal of the box following the colors, red and blue flip
+            //  against green when they vary the other way
+            int covarianceRG = 0;
+            int covarianceBG = 0;
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                if (kTransparent && block[i * 4 + 3] < 128)
+                    continue;
+
+                const int kGreen = block[i * 4 + 1] - center[1];
+                covarianceRG += (block[i * 4] - center[0]) * kGreen;
+                covarianceBG += (block[i * 4 + 2] - center[2]) * kGreen;
+            }
+            if (covarianceRG < 0)
+                std::swap(start[0], end[0]);
+            if (covarianceBG < 0)
+                std::swap(start[2], end[2]);
+
+            const uint16_t kC0 = To565(start[0], start[1], start[2]);
+            const uint16_t kC1 = To565(end[0], end[1], end[2]);
+            if (kTransparent)
+                EncodeColor3(block, kC0, kC1, out);
+            else
+                EncodeColor4(block, kC0, kC1, out);
+        }
+
+        /** @brief BC4 block, also the alpha of BC3 */
+        void EncodeChannel(const unsigned char* values, unsigned char* out)
+        {
+            unsigned char low = 0;
+            unsigned char high = 0;
+            MinMax16(values, low, high);
+
+            // Eight values mode, high to low, the level of a value is the
+            //  count of midpoints it reaches
+            const int kRange = high - low;
+            alignas(16) unsigned char levels[16];
+        #ifdef SGL_BC_SSE2
+            const __m128i kValues = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(values));
+            __m128i count = _mm_setzero_si128();
+            for (int mid = 0; mid < 7; ++mid)
+            {
+                const int kThreshold = low + ((2 * mid + 1) * kRange + 13)
+                                             / 14;
+                const __m128i kReached = _mm_cmpeq_epi8(
+                    _mm_max_epu8(kValues, _mm_set1_epi8(
+                        static_cast<char>(kThreshold))), kValues);
+                count = _mm_sub_epi8(count, kReached);
+            }
+            _mm_store_si128(reinterpret_cast<__m128i*>(levels), count);
+        #else
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                int level = 0;
+                for (int mid = 0; mid < 7; ++mid)
+                {
+                    level += values[i] >= low + ((2 * mid + 1) * kRange + 13)
+                                               / 14;
+                }
+                levels[i] = static_cast<unsigned char>(level);
+            }
+        #endif
+
+            uint64_t indices = 0;
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                // Level 7 is the first endpoint, 0 the second, then 6 to 1
+                const uint64_t kIndex = levels[i] == 7 ? 0
+                                        : levels[i] == 0 ? 1
+                                        : 8 - levels[i];
+                indices |= kIndex << (3 * i);
+            }
+
+            out[0] = high;
+            out[1] = low;
+            for (uint32_t i = 0; i < 6; ++i)
+                out[2 + i] = static_cast<unsigned char>(indices >> (8 * i));
+        }
+
+        void EncodeRows(const Job& job, uint32_t rowBegin, uint32_t rowEnd)
+        {
+            alignas(16) unsigned char block[64];
+            alignas(16) unsigned char values[16];
+
+            for (uint32_t row = rowBegin; row < rowEnd; ++row)
+            {
+                unsigned char* out = job.out
+                    + size_t(row) * job.blocksX * job.blockBytes;
+
+                for (uint32_t column = 0; column < job.blocksX; ++column)
+                {
+                    const uint32_t kX = column * 4;
+                    const uint32_t kY = row * 4;
+
+                    switch (job.kind)
+                    {
+                        case Kind::BC1:
+                        case Kind::BC1Alpha:
+                            LoadBlockRGBA(job, kX, kY, block);
+                            EncodeColor(block, job.kind == Kind::BC1Alpha,
+                                        out);
+                            break;
+                        case Kind::BC3:
+                            LoadBlockRGBA(job, kX, kY, block);
+                            for (uint32_t i = 0; i < 16; ++i)
+                                values[i] = block[i * 4 + 3];
+                            EncodeChannel(values, out);
+                            EncodeColor(block, false, out + 8);
+                            break;
+                        case Kind::BC4:
+                            LoadBlockChannel(job, 0, kX, kY, values);
+                            EncodeChannel(values, out);
+                            break;
+                        case Kind::BC5:
+                            LoadBlockChannel(job, 0, kX, kY, values);
+                            EncodeChannel(values, out);
+                            LoadBlockChannel(job, 1, kX, kY, values);
+                            EncodeChannel(values, out + 8);
+                            break;
+                    }
+
+                    out += job.blockBytes;
+                }
+            }
+        }
+
+        /**
+         * @param out Blocks of the level
+         * @return Error message, empty on success
+         */
+        std::string EncodeLevel(const unsigned char* pixels, uint32_t width,
+                                uint32_t height, uint32_t channels,
+                                uint32_t format, unsigned char* out,
+                                ThreadPool* pool)
+        {
+            Job job;
+            if (!GetKind(format, job.kind))
+            {
+                return fmt::format("{} cannot be encoded",
+                                   GetCompressedFormatName(format));
+            }
+            if (pixels == nullptr || width == 0 || height == 0
+                || channels == 0 || channels > 4)
+            {
+                return fmt::format("Invalid image {}x{}, {} channels", width,
+                                   height, channels);
+            }
+
+            job.pixels = pixels;
+            job.width = width;
+            job.height = height;
+            job.channels = channels;
+            job.blockBytes = GetCompressedFormatInfo(format)->blockBytes;
+            job.blocksX = (width + 3) / 4;
+            job.out = out;
+
+            const uint32_t kBlockRows = (height + 3) / 4;
+            if (pool == nullptr)
+            {
+                EncodeRows(job, 0, kBlockRows);
+                return std::string();
+            }
+
+            // Tiles of whole block rows write disjoint ranges of the output
+            const uint32_t kTileRows = std::max(
+                kBlockRows / (pool->GetThreadCount() * kTasksPerWorker), 1u);
+
+            std::vector<std::future<void>> tiles;
+            for (uint32_t row = 0; row < kBlockRows; row += kTileRows)
+            {
+                const uint32_t kEnd = std::min(row + kTileRows, kBlockRows);
+                tiles.push_back(pool->Submit([&job, row, kEnd]() {
+                    EncodeRows(job, row, kEnd);
+                }));
+            }
+
+            for (std::future<void>& tile : tiles)
+                tile.wait();
+
+            return std::string();
+        }
+    } // namespace bc
+
+    bool CanCompressFormat(uint32_t format)
+    {
+        bc::Kind kind;
+        return bc::GetKind(format, kind);
+    }
+
+    CompressedImage CompressImage(const unsigned char* pixels, uint32_t width,
+                                  uint32_t height, uint32_t channels,
+                                  uint32_t format, ThreadPool* pool)
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Compress Image");
+
+        CompressedImage image;
+        if (!CanCompressFormat(format))
+        {
+            image.error = fmt::format("{} cannot be encoded",
+                                      GetCompressedFormatName(format));
+            return image;
+        }
+
+        image.file.resize(GetCompressedImageSize(format, width, height));
+        image.error = bc::EncodeLevel(pixels, width, height, channels,
+                                      format, image.file.data(), pool);
+        if (!image.error.empty())
+            return image;
+
+        image.width = width;
+        image.height = height;
+        image.format = format;
+        image.levelCount = 1;
+        image.faceCount = 1;
+        image.levels.push_back({ image.file.data(), image.file.size() });
+        return image;
+    }
+
+    CompressedImage CompressMipChain(const MipChain& chain, uint32_t format,
+                                     ThreadPool* pool)
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Compress Mip Chain");
+
+        CompressedImage image;
+        if (chain.Empty() || !CanCompressFormat(format))
+        {
+            image.error = fmt::format("{} cannot be encoded from {} levels",
+                                      GetCompressedFormatName(format),
+                                      chain.GetLevelCount());
+            return image;
+        }
+
+        std::vector<size_t> offsets;
+        size_t size = 0;
+        for (const MipLevel& level : chain.levels)
+        {
+            offsets.push_back(size);
+            size += GetCompressedImageSize(format, level.width, level.height);
+        }
+        image.file.resize(size);
+
+        for (uint32_t i = 0; i < chain.GetLevelCount(); ++i)
+        {
+            const MipLevel& kLevel = chain.levels[i];
+            image.error = bc::EncodeLevel(chain.GetPixels(i), kLevel.width,
+                                          kLevel.height, chain.channels,
+                                          format,
+                                          image.file.data() + offsets[i],
+                                          pool);
+            if (!image.error.empty())
+            {
+                image.file.clear();
+                return image;
+            }
+        }
+
+        image.width = chain.levels[0].width;
+        image.height = chain.levels[0].height;
+        image.format = format;
+        image.levelCount = chain.GetLevelCount();
+        image.faceCount = 1;
+        for (uint32_t i = 0; i < image.levelCount; ++i)
+        {
+            const size_t kEnd = i + 1 < image.levelCount ? offsets[i + 1]
+                                                         : size;
+            image.levels.push_back({ image.file.data() + offsets[i],
+                                     kEnd - offsets[i] });
+        }
+        return image;
+    }
+
+    CompressedImage CompressImage(const STBData& image,
+                                  int requiredComponents, uint32_t format,
+                                  ThreadPool* pool)
+    {
+        // STBData keeps the channels of the file
+        const int kChannels = requiredComponents != 0 ? requiredComponents
+                                                      : image.channels;
+        return CompressImage(image.data, static_cast<uint32_t>(image.width),
+                             static_cast<uint32_t>(image.height),
+                             static_cast<uint32_t>(kChannels), format, pool);
+    }
+
+} // namespace sgl
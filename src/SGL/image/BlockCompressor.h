@@ -0,0 +1,64 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_IMAGE_BLOCK_COMPRESSOR_H_
+#define SGL_IMAGE_BLOCK_COMPRESSOR_H_
+
+#include <cstdint>
+
+#include "SGL/image/CompressedImage.h"
+
+
+namespace sgl
+{
+    class ThreadPool;
+    struct STBData;
+    struct MipChain;
+
+    /**
+     * @return Whether "CompressImage" encodes the format: BC1 and BC3 with
+     *  their sRGB variants, unsigned BC4 and BC5
+     */
+    bool CanCompressFormat(uint32_t format);
+
+    /**
+     * @brief Encodes 8-bit pixels into 4x4 blocks, a fast range fit with a
+     *  least squares refinement of the color endpoints, in SSE2 where
+     *  available. BC1 and BC3 read gray, gray alpha, RGB and RGBA pixels,
+     *  BC4 and BC5 their first one or two channels. sRGB BC1 and BC3 are
+     *  encoded as the linear ones, the values are not converted.
+     * @param pool Encodes tiles of block rows in parallel, null encodes on
+     *  the calling thread. Do not call from a worker of the same pool.
+     * @return Image of a single level, with an error if the format is not
+     *  supported
+     */
+    CompressedImage CompressImage(const unsigned char* pixels,
+                                  uint32_t width,
+                                  uint32_t height,
+                                  uint32_t channels,
+                                  uint32_t format,
+                                  ThreadPool* pool = nullptr);
+
+    /**
+     * @param requiredComponents As passed to "LoadImage", the data has as
+     *  many channels, 0 if it has the channels of the file
+     */
+    CompressedImage CompressImage(const STBData& image,
+                                  int requiredComponents,
+                                  uint32_t format,
+                                  ThreadPool* pool = nullptr);
+
+    /**
+     * @brief "CompressImage" of every level of a chain, into one image with
+     *  as many levels
+     */
+    CompressedImage CompressMipChain(const MipChain& chain,
+                                     uint32_t format,
+                                     ThreadPool* pool = nullptr);
+
+} // namespace sgl
+
+
+#endif // SGL_IMAGE_BLOCK_COMPRESSOR_H_
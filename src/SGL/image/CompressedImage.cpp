@@ -0,0 +1,532 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/image/CompressedImage.h"
+#include "SGL/image/MipChain.h"
+#include "SGL/core/MappedFile.h"
+
+#include <cstring>
+#include <fstream>
+
+
+namespace sgl
+{
+    // Both containers are little endian, as are the supported hosts
+    static uint32_t ReadU32(std::string_view file, size_t offset)
+    {
+        uint32_t value = 0;
+        std::memcpy(&value, file.data() + offset, sizeof(value));
+        return value;
+    }
+
+    static uint64_t ReadU64(std::string_view file, size_t offset)
+    {
+        uint64_t value = 0;
+        std::memcpy(&value, file.data() + offset, sizeof(value));
+        return value;
+    }
+
+    static constexpr uint32_t FourCC(char a, char b, char c, char d)
+    {
+        return uint32_t(uint8_t(a)) | uint32_t(uint8_t(b)) << 8
+               | uint32_t(uint8_t(c)) << 16 | uint32_t(uint8_t(d)) << 24;
+    }
+
+    namespace ktx2
+    {
+        constexpr unsigned char kIdentifier[12] = {
+            0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+        constexpr size_t kHeaderSize = 80;
+        constexpr size_t kLevelIndexEntrySize = 24;
+
+        /** @return GL format of a VkFormat, 0 if not block compressed */
+        uint32_t ToGLFormat(uint32_t vkFormat)
+        {
+            switch (vkFormat)
+            {
+                case 131: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+                case 132: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+                case 133: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+                case 134: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+                case 135: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+                case 136: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+                case 137: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                case 138: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+                case 139: return GL_COMPRESSED_RED_RGTC1;
+                case 140: return GL_COMPRESSED_SIGNED_RED_RGTC1;
+                case 141: return GL_COMPRESSED_RG_RGTC2;
+                case 142: return GL_COMPRESSED_SIGNED_RG_RGTC2;
+                case 143: return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+                case 144: return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+                case 145: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+                case 146: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+                case 147: return GL_COMPRESSED_RGB8_ETC2;
+                case 148: return GL_COMPRESSED_SRGB8_ETC2;
+                case 149: return GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+                case 150: return GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+                case 151: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+                case 152: return GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;
+                case 153: return GL_COMPRESSED_R11_EAC;
+                case 154: return GL_COMPRESSED_SIGNED_R11_EAC;
+                case 155: return GL_COMPRESSED_RG11_EAC;
+                case 156: return GL_COMPRESSED_SIGNED_RG11_EAC;
+                default:  return 0;
+            }
+        }
+    } // namespace ktx2
+
+    namespace dds
+    {
+        constexpr uint32_t kMagic = FourCC('D', 'D', 'S', ' ');
+        constexpr size_t kHeaderSize = 4 + 124;
+        constexpr size_t kHeaderDX10Size = 20;
+
+        constexpr uint32_t kFlagsRequired = 0x1 | 0x2 | 0x4 | 0x1000;
+        constexpr uint32_t kFlagLinearSize = 0x80000;
+        constexpr uint32_t kFlagMipMapCount = 0x20000;
+        constexpr uint32_t kCapsTexture = 0x1000;
+        constexpr uint32_t kCapsComplex = 0x8;
+        constexpr uint32_t kCapsMipMap = 0x400000;
+        constexpr uint32_t kPixelFlagFourCC = 0x4;
+        constexpr uint32_t kCaps2CubeMap = 0x200;
+        constexpr uint32_t kCaps2AllFaces = 0xFC00;
+        constexpr uint32_t kCaps2Volume = 0x200000;
+        constexpr uint32_t kMiscTextureCube = 0x4;
+        constexpr uint32_t kDimensionTexture2D = 3;
+
+        /** @return GL format of a legacy FourCC, 0 if not supported */
+        uint32_t FourCCToGLFormat(uint32_t fourCC)
+        {
+            switch (fourCC)
+            {
+                case FourCC('D', 'X', 'T', '1'):
+                    return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+                case FourCC('D', 'X', 'T', '3'):
+                    return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+                case FourCC('D', 'X', 'T', '5'):
+                    return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                case FourCC('A', 'T', 'I', '1'):
+                case FourCC('B', 'C', '4', 'U'):
+                    return GL_COMPRESSED_RED_RGTC1;
+                case FourCC('B', 'C', '4', 'S'):
+                    return GL_COMPRESSED_SIGNED_RED_RGTC1;
+                case FourCC('A', 'T', 'I', '2'):
+                case FourCC('B', 'C', '5', 'U'):
+                    return GL_COMPRESSED_RG_RGTC2;
+                case FourCC('B', 'C', '5', 'S'):
+                    return GL_COMPRESSED_SIGNED_RG_RGTC2;
+                default:
+                    return 0;
+            }
+        }
+
+        /** @return GL format of a DXGI_FORMAT, 0 if not supported */
+        uint32_t DXGIToGLFormat(uint32_t dxgiFormat)
+        {
+            switch (dxgiFormat)
+            {
+                case 71: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+                case 72: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+                case 74: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+                case 75: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+                case 77: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                case 78: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+                case 80: return GL_COMPRESSED_RED_RGTC1;
+                case 81: return GL_COMPRESSED_SIGNED_RED_RGTC1;
+                case 83: return GL_COMPRESSED_RG_RGTC2;
+                case 84: return GL_COMPRESSED_SIGNED_RG_RGTC2;
+                case 95: return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+                case 96: return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+                case 98: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+                case 99: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+                default: return 0;
+            }
+        }
+
+        /** @return DXGI_FORMAT of a GL format, 0 if there is none */
+        uint32_t GLFormatToDXGI(uint32_t format)
+        {
+            // BC1 without alpha is read back as BC1 with alpha
+            if (format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+                return 71;
+            if (format == GL_COMPRESSED_SRGB_S3TC_DXT1_EXT)
+                return 72;
+
+            for (uint32_t dxgi = 71; dxgi <= 99; ++dxgi)
+            {
+                if (DXGIToGLFormat(dxgi) == format)
+                    return dxgi;
+            }
+            return 0;
+        }
+    } // namespace dds
+
+    /** @brief Checks the shape shared by both containers */
+    static bool ValidateShape(CompressedImage& image)
+    {
+        if (image.width == 0 || image.height == 0)
+        {
+            image.error = "Empty image";
+            return false;
+        }
+
+        if (image.faceCount != 1 && image.faceCount != 6)
+        {
+            image.error = fmt::format("{} faces, 1 or 6 are supported",
+                                      image.faceCount);
+            return false;
+        }
+
+        if (image.levelCount == 0
+            || image.levelCount > GetMipLevelCount(image.width, image.height))
+        {
+            image.error = fmt::format("{} mip levels for {}x{}",
+                                      image.levelCount, image.width,
+                                      image.height);
+            return false;
+        }
+
+        return true;
+    }
+
+    static bool ParseKTX2(CompressedImage& image, std::string_view kFile)
+    {
+        if (kFile.size() < ktx2::kHeaderSize)
+        {
+            image.error = "Truncated KTX2 header";
+            return false;
+        }
+
+        const uint32_t kVkFormat = ReadU32(kFile, 12);
+        const uint32_t kDepth = ReadU32(kFile, 28);
+        const uint32_t kLayers = ReadU32(kFile, 32);
+        const uint32_t kSupercompression = ReadU32(kFile, 44);
+
+        image.width = ReadU32(kFile, 20);
+        image.height = ReadU32(kFile, 24);
+        image.faceCount = ReadU32(kFile, 36);
+        // 0 asks the loader to generate the mips, only the base is stored
+        image.levelCount = std::max(ReadU32(kFile, 40), 1u);
+        image.format = ktx2::ToGLFormat(kVkFormat);
+
+        if (image.format == 0)
+        {
+            image.error = fmt::format("VkFormat {} is not block compressed, "
+                                      "or Basis Universal", kVkFormat);
+            return false;
+        }
+        if (kSupercompression != 0)
+        {
+            image.error = fmt::format("Supercompression scheme {} is not "
+                                      "supported", kSupercompression);
+            return false;
+        }
+        if (kDepth > 1 || kLayers > 1)
+        {
+            image.error = "Volume and array textures are not supported";
+            return false;
+        }
+        if (!ValidateShape(image))
+            return false;
+
+        const size_t kIndexEnd = ktx2::kHeaderSize
+                                 + image.levelCount
+                                   * ktx2::kLevelIndexEntrySize;
+        if (kFile.size() < kIndexEnd)
+        {
+            image.error = "Truncated KTX2 level index";
+            return false;
+        }
+
+        image.levels.resize(size_t(image.levelCount) * image.faceCount);
+        for (uint32_t level = 0; level < image.levelCount; ++level)
+        {
+            const size_t kEntry = ktx2::kHeaderSize
+                                  + level * ktx2::kLevelIndexEntrySize;
+            const uint64_t kOffset = ReadU64(kFile, kEntry);
+            const uint64_t kLength = ReadU64(kFile, kEntry + 8);
+
+            const size_t kFaceSize = GetCompressedImageSize(
+                image.format, std::max(image.width >> level, 1u),
+                std::max(image.height >> level, 1u));
+            if (kOffset > kFile.size() || kLength > kFile.size() - kOffset
+                || kLength < kFaceSize * image.faceCount)
+            {
+                image.error = fmt::format("Level {} is out of the file",
+                                          level);
+                return false;
+            }
+
+            // Faces of a level are consecutive
+            for (uint32_t face = 0; face < image.faceCount; ++face)
+            {
+                CompressedLevel& out
+                    = image.levels[level * image.faceCount + face];
+                out.data = kFile.data() + kOffset + face * kFaceSize;
+                out.size = kFaceSize;
+            }
+        }
+
+        return true;
+    }
+
+    static bool ParseDDS(CompressedImage& image, std::string_view kFile)
+    {
+        if (kFile.size() < dds::kHeaderSize)
+        {
+            image.error = "Truncated DDS header";
+            return false;
+        }
+
+        const uint32_t kFlags = ReadU32(kFile, 8);
+        const uint32_t kMipMapCount = ReadU32(kFile, 28);
+        const uint32_t kPixelFlags = ReadU32(kFile, 80);
+        const uint32_t kFourCC = ReadU32(kFile, 84);
+        const uint32_t kCaps2 = ReadU32(kFile, 112);
+
+        image.height = ReadU32(kFile, 12);
+        image.width = ReadU32(kFile, 16);
+        image.levelCount = (kFlags & dds::kFlagMipMapCount) != 0
+                           ? std::max(kMipMapCount, 1u) : 1;
+        image.faceCount = 1;
+
+        if ((kPixelFlags & dds::kPixelFlagFourCC) == 0)
+        {
+            image.error = "Uncompressed DDS files are not supported";
+            return false;
+        }
+
+        size_t offset = dds::kHeaderSize;
+        if (kFourCC == FourCC('D', 'X', '1', '0'))
+        {
+            if (kFile.size() < offset + dds::kHeaderDX10Size)
+            {
+                image.error = "Truncated DDS DX10 header";
+                return false;
+            }
+
+            const uint32_t kDXGIFormat = ReadU32(kFile, offset);
+            const uint32_t kDimension = ReadU32(kFile, offset + 4);
+            const uint32_t kMiscFlag = ReadU32(kFile, offset + 8);
+            const uint32_t kArraySize = ReadU32(kFile, offset + 12);
+            offset += dds::kHeaderDX10Size;
+
+            image.format = dds::DXGIToGLFormat(kDXGIFormat);
+            if (image.format == 0)
+            {
+                image.error = fmt::format("DXGI format {} is not supported",
+                                          kDXGIFormat);
+                return false;
+            }
+            if (kDimension != dds::kDimensionTexture2D || kArraySize > 1)
+            {
+                image.error = "Volume and array textures are not supported";
+                return false;
+            }
+            if ((kMiscFlag & dds::kMiscTextureCube) != 0)
+                image.faceCount = 6;
+        }
+        else
+        {
+            image.format = dds::FourCCToGLFormat(kFourCC);
+            if (image.format == 0)
+            {
+                image.error = fmt::format("FourCC '{}' is not supported",
+                                          std::string(reinterpret_cast<
+                                              const char*>(&kFourCC), 4));
+                return false;
+            }
+            if ((kCaps2 & dds::kCaps2Volume) != 0)
+            {
+                image.error = "Volume textures are not supported";
+                return false;
+            }
+            if ((kCaps2 & dds::kCaps2CubeMap) != 0)
+            {
+                if ((kCaps2 & dds::kCaps2AllFaces) != dds::kCaps2AllFaces)
+                {
+                    image.error = "Cube maps need all the faces";
+                    return false;
+                }
+                image.faceCount = 6;
+            }
+        }
+
+        if (!ValidateShape(image))
+            return false;
+
+        // All the levels of a face, then the next face
+        image.levels.resize(size_t(image.levelCount) * image.faceCount);
+        for (uint32_t face = 0; face < image.faceCount; ++face)
+        {
+            for (uint32_t level = 0; level < image.levelCount; ++level)
+            {
+                const size_t kSize = GetCompressedImageSize(
+                    image.format, std::max(image.width >> level, 1u),
+                    std::max(image.height >> level, 1u));
+                if (kSize > kFile.size() - offset)
+                {
+                    image.error = fmt::format("Level {} of face {} is out "
+                                              "of the file", level, face);
+                    return false;
+                }
+
+                CompressedLevel& out
+                    = image.levels[level * image.faceCount + face];
+                out.data = kFile.data() + offset;
+                out.size = kSize;
+                offset += kSize;
+            }
+        }
+
+        return true;
+    }
+
+    // =========================================================================
+
+    size_t CompressedImage::Size() const
+    {
+        size_t size = 0;
+        for (const CompressedLevel& kLevel : levels)
+            size += kLevel.size;
+        return size;
+    }
+
+    bool IsCompressedImageFile(const std::string& filename)
+    {
+        const size_t kDot = filename.find_last_of('.');
+        if (kDot == std::string::npos)
+            return false;
+
+        std::string extension = filename.substr(kDot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        return extension == "ktx2" || extension == "dds";
+    }
+
+    /** @brief Parses the contents of a file kept by the image */
+    static void Parse(CompressedImage& image, std::string_view file)
+    {
+        bool parsed = false;
+        if (file.size() >= sizeof(ktx2::kIdentifier)
+            && std::memcmp(file.data(), ktx2::kIdentifier,
+                           sizeof(ktx2::kIdentifier)) == 0)
+        {
+            parsed = ParseKTX2(image, file);
+        }
+        else if (file.size() >= 4 && ReadU32(file, 0) == dds::kMagic)
+        {
+            parsed = ParseDDS(image, file);
+        }
+        else
+        {
+            image.error = "Not a KTX2 or DDS file";
+        }
+
+        if (!parsed)
+        {
+            image.levels.clear();
+            image.file.clear();
+            image.mapping.Close();
+        }
+    }
+
+    CompressedImage LoadCompressedImage(const std::string& filename)
+    {
+        SGL_FUNCTION();
+
+        MappedFile file(filename);
+        if (!file.IsOpen())
+        {
+            CompressedImage image;
+            image.error = file.GetError();
+            return image;
+        }
+
+        CompressedImage image = ParseCompressedImage(std::move(file));
+        if (!image.Loaded())
+            image.error = fmt::format("'{}': {}", filename, image.error);
+
+        return image;
+    }
+
+    CompressedImage ParseCompressedImage(std::vector<unsigned char> file)
+    {
+        SGL_FUNCTION();
+
+        CompressedImage image;
+        image.file = std::move(file);
+        Parse(image, { reinterpret_cast<const char*>(image.file.data()),
+                       image.file.size() });
+
+        return image;
+    }
+
+    CompressedImage ParseCompressedImage(MappedFile file)
+    {
+        SGL_FUNCTION();
+
+        // The levels point into the mapping, which moves with the image
+        CompressedImage image;
+        image.mapping = std::move(file);
+        Parse(image, image.mapping.GetView());
+
+        return image;
+    }
+
+    bool WriteDDS(const std::string& filename, const CompressedImage& image)
+    {
+        SGL_FUNCTION();
+
+        const uint32_t kDXGIFormat = dds::GLFormatToDXGI(image.format);
+        if (kDXGIFormat == 0 || !image.Loaded())
+            return false;
+
+        uint32_t header[(dds::kHeaderSize + dds::kHeaderDX10Size) / 4] = {};
+        header[0] = dds::kMagic;
+        header[1] = 124;
+        header[2] = dds::kFlagsRequired | dds::kFlagLinearSize
+                    | (image.levelCount > 1 ? dds::kFlagMipMapCount : 0);
+        header[3] = image.height;
+        header[4] = image.width;
+        header[5] = static_cast<uint32_t>(image.levels[0].size);
+        header[7] = image.levelCount;
+        header[19] = 32;
+        header[20] = dds::kPixelFlagFourCC;
+        header[21] = FourCC('D', 'X', '1', '0');
+        header[27] = dds::kCapsTexture
+                     | (image.levelCount > 1 ? dds::kCapsComplex
+                                               | dds::kCapsMipMap : 0)
+                     | (image.IsCubeMap() ? dds::kCapsComplex : 0);
+        header[28] = image.IsCubeMap() ? dds::kCaps2CubeMap
+                                         | dds::kCaps2AllFaces : 0;
+        header[32] = kDXGIFormat;
+        header[33] = dds::kDimensionTexture2D;
+        header[34] = image.IsCubeMap() ? dds::kMiscTextureCube : 0;
+        header[35] = 1;
+
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+        // All the levels of a face, then the next face
+        for (uint32_t face = 0; face < image.faceCount; ++face)
+        {
+            for (uint32_t level = 0; level < image.levelCount; ++level)
+            {
+                const CompressedLevel& kLevel
+                    = image.levels[level * image.faceCount + face];
+                file.write(static_cast<const char*>(kLevel.data),
+                           static_cast<std::streamsize>(kLevel.size));
+            }
+        }
+
+        return static_cast<bool>(file);
+    }
+
+} // namespace sgl
@@ -0,0 +1,78 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_IMAGE_COMPRESSED_IMAGE_H_
+#define SGL_IMAGE_COMPRESSED_IMAGE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SGL/core/MappedFile.h"
+#include "SGL/opengl/CompressedFormat.h"
+
+
+namespace sgl
+{
+    /**
+     * @brief Block compressed mip chain read from a KTX2 or DDS file. The
+     *  levels point into the file contents, they are uploaded as is.
+     *  The contents are the mapping of a file read from disk, or a buffer.
+     *  Move only, a copy would point into the buffer of the original.
+     */
+    struct CompressedImage
+    {
+        uint32_t width{ 0 };
+        uint32_t height{ 0 };
+        uint32_t format{ 0 };       ///< GL internal format
+        uint32_t levelCount{ 0 };
+        uint32_t faceCount{ 0 };    ///< 1, or 6 for a cube map
+
+        /// Indexed [level * faceCount + face], largest level first
+        std::vector<CompressedLevel> levels;
+        std::vector<unsigned char> file;   ///< Contents in memory
+        MappedFile mapping;                 ///< Or mapped
+        std::string error;          ///< Why the file was rejected
+
+        CompressedImage() = default;
+        CompressedImage(CompressedImage&&) = default;
+        CompressedImage& operator=(CompressedImage&&) = default;
+        CompressedImage(const CompressedImage&) = delete;
+        CompressedImage& operator=(const CompressedImage&) = delete;
+
+        bool Loaded() const { return !levels.empty(); }
+        bool IsCubeMap() const { return faceCount == 6; }
+
+        /** @return Bytes of all the levels */
+        size_t Size() const;
+    };
+
+    /** @return Whether the extension is ".ktx2" or ".dds" */
+    bool IsCompressedImageFile(const std::string& filename);
+
+    /**
+     * @brief Reads a KTX2 or DDS file, detected from its contents. Arrays,
+     *  volumes and supercompressed KTX2 files (Basis, Zstandard) are not
+     *  supported.
+     * @return Image with an error message if it could not be loaded
+     */
+    CompressedImage LoadCompressedImage(const std::string& filename);
+
+    /** @brief "LoadCompressedImage" from the contents of a file */
+    CompressedImage ParseCompressedImage(std::vector<unsigned char> file);
+    /** @brief "LoadCompressedImage" from a mapping, the image keeps it */
+    CompressedImage ParseCompressedImage(MappedFile file);
+
+    /**
+     * @brief Writes a DDS file with a DX10 header, BC formats only
+     * @return False if the format has no DXGI equivalent, or on a write
+     *  failure
+     */
+    bool WriteDDS(const std::string& filename, const CompressedImage& image);
+
+} // namespace sgl
+
+
+#endif // SGL_IMAGE_COMPRESSED_IMAGE_H_
@@ -0,0 +1,181 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/image/CompressionCache.h"
+#include "SGL/image/BlockCompressor.h"
+#include "SGL/core/Hash.h"
+#include "SGL/core/MappedFile.h"
+#include "SGL/core/Profiler.h"
+
+#include <filesystem>
+#include <thread>
+
+#include <stb/stb_image.h>
+
+#ifdef _WIN32
+    #include <process.h>
+#else
+    #include <unistd.h>
+#endif
+
+
+namespace sgl
+{
+    /** @brief Processes may share a directory, their temporaries differ */
+    static unsigned long GetProcessID()
+    {
+    #ifdef _WIN32
+        return static_cast<unsigned long>(_getpid());
+    #else
+        return static_cast<unsigned long>(::getpid());
+    #endif
+    }
+
+    std::shared_ptr<CompressionCache> CompressionCache::Create(
+        const std::string& directory)
+    {
+        return std::make_shared<CompressionCache>(directory);
+    }
+
+    // =========================================================================
+
+    CompressionCache::CompressionCache(const std::string& directory)
+        : m_Directory(directory)
+    {
+        SGL_FUNCTION();
+
+        std::error_code error;
+        std::filesystem::create_directories(m_Directory, error);
+        if (error)
+        {
+            SGL_LOG_WARN("Could not create the compression cache '{}': {}",
+                         m_Directory, error.message());
+        }
+    }
+
+    CompressedImage CompressionCache::Load(const std::string& filename,
+                                           uint32_t format,
+                                           ThreadPool* pool)
+    {
+        MipChainSpec mips;
+        mips.maxLevels = 1;
+        return Load(filename, format, mips, pool);
+    }
+
+    CompressedImage CompressionCache::Load(const std::string& filename,
+                                           uint32_t format,
+                                           const MipChainSpec& mips,
+                                           ThreadPool* pool)
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("CompressionCache::Load");
+
+        const MappedFile kSource(filename);
+        if (!kSource.IsOpen())
+        {
+            CompressedImage image;
+            image.error = kSource.GetError();
+            return image;
+        }
+
+        // The format, the chain and the encoder select the entry as much as
+        //  the source
+        const uint32_t kSeed[5] = { format, EncoderVersion,
+                                    static_cast<uint32_t>(mips.filter),
+                                    mips.srgb ? 1u : 0u, mips.maxLevels };
+        const uint64_t kKey = Hash64(kSource.GetData(), kSource.GetSize(),
+                                     Hash64(kSeed, sizeof(kSeed)));
+        const std::string kEntry = GetEntryPath(kKey);
+
+        std::error_code error;
+        if (std::filesystem::exists(kEntry, error))
+        {
+            CompressedImage cached = LoadCompressedImage(kEntry);
+            if (cached.Loaded())
+            {
+                // DDS has no BC1 without alpha, the blocks are the same
+                cached.format = format;
+                ++m_Hits;
+                return cached;
+            }
+
+            SGL_LOG_WARN("Compression cache entry of '{}' is invalid, it is "
+                         "replaced: {}", filename, cached.error);
+        }
+
+        ++m_Misses;
+
+        const Timer kTimer;
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        unsigned char* pixels = LoadImageDataFromMemory(
+            kSource.GetData(), kSource.GetSize(), width, height, channels);
+        if (pixels == nullptr)
+        {
+            CompressedImage image;
+            image.error = fmt::format("Failed to decode '{}': {}", filename,
+                                      stbi_failure_reason());
+            return image;
+        }
+
+        CompressedImage image;
+        if (mips.maxLevels == 1)
+        {
+            image = CompressImage(pixels, static_cast<uint32_t>(width),
+                                  static_cast<uint32_t>(height),
+                                  static_cast<uint32_t>(channels), format,
+                                  pool);
+        }
+        else
+        {
+            const MipChain kChain = BuildMipChain(
+                pixels, static_cast<uint32_t>(width),
+                static_cast<uint32_t>(height),
+                static_cast<uint32_t>(channels), mips, pool);
+            image = CompressMipChain(kChain, format, pool);
+        }
+        stbi_image_free(pixels);
+
+        if (!image.Loaded())
+            return image;
+
+        SGL_LOG_INFO("Compressed '{}' to {}, {} levels, in {:.2f} ms",
+                     filename, GetCompressedFormatName(format),
+                     image.levelCount, kTimer.ElapsedMillis());
+
+        // Readers never see a partial entry. Thread ids are only unique
+        //  in a process, the process id is part of the name too.
+        const std::string kTemporary = fmt::format(
+            "{}.{}.{:x}.tmp", kEntry, GetProcessID(),
+            std::hash<std::thread::id>()(std::this_thread::get_id()));
+        if (WriteDDS(kTemporary, image))
+        {
+            std::filesystem::rename(kTemporary, kEntry, error);
+            if (error)
+            {
+                SGL_LOG_WARN("Could not write the compression cache entry "
+                             "'{}': {}", kEntry, error.message());
+                std::filesystem::remove(kTemporary, error);
+            }
+        }
+        else
+        {
+            SGL_LOG_WARN("Could not write the compression cache entry '{}'",
+                         kTemporary);
+            // A partial write, not left behind in the directory
+            std::filesystem::remove(kTemporary, error);
+        }
+
+        return image;
+    }
+
+    std::string CompressionCache::GetEntryPath(uint64_t key) const
+    {
+        return fmt::format("{}/{:016x}.dds", m_Directory, key);
+    }
+
+} // namespace sgl
@@ -0,0 +1,79 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_IMAGE_COMPRESSION_CACHE_H_
+#define SGL_IMAGE_COMPRESSION_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "SGL/image/CompressedImage.h"
+#include "SGL/image/MipChain.h"
+
+
+namespace sgl
+{
+    class ThreadPool;
+
+    /**
+     * @brief Block compressed images on disk, keyed by the hash of the
+     *  source file contents, the target format and the mip chain. A source
+     *  is decoded, filtered and compressed once, later loads read the DDS
+     *  entry directly. Entries are written to a temporary file then
+     *  renamed, so processes can share the directory. Thread safe.
+     */
+    class CompressionCache
+    {
+    public:
+        /** @brief Part of the key, entries of another version are ignored */
+        static constexpr uint32_t EncoderVersion = 1;
+
+        static std::shared_ptr<CompressionCache> Create(
+            const std::string& directory);
+
+    public:
+        /** @param directory Created if missing */
+        CompressionCache(const std::string& directory);
+
+        /**
+         * @brief Compressed image of an image file (JPEG, PNG, ...), read
+         *  from the cache or compressed and stored
+         * @param format See "CanCompressFormat"
+         * @param pool Compresses the tiles on a miss, see "CompressImage"
+         * @return Image with an error if the source could not be decoded
+         */
+        CompressedImage Load(const std::string& filename,
+                             uint32_t format,
+                             ThreadPool* pool = nullptr);
+
+        /**
+         * @brief "Load" of a mip chain, built with "BuildMipChain" then
+         *  compressed level by level on a miss
+         * @param mips Part of the key, "srgb" should follow the format
+         */
+        CompressedImage Load(const std::string& filename,
+                             uint32_t format,
+                             const MipChainSpec& mips,
+                             ThreadPool* pool = nullptr);
+
+        /** @return Entry file of a key, whether it exists or not */
+        std::string GetEntryPath(uint64_t key) const;
+
+        uint64_t GetHitCount() const { return m_Hits.load(); }
+        uint64_t GetMissCount() const { return m_Misses.load(); }
+
+    private:
+        std::string m_Directory;
+
+        std::atomic<uint64_t> m_Hits{ 0 };
+        std::atomic<uint64_t> m_Misses{ 0 };
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_IMAGE_COMPRESSION_CACHE_H_
@@ -0,0 +1,248 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/image/ImageWriter.h"
+
+#include <cstdio>
+#include <cstring>
+
+#if __has_include(<stb/stb_image_write.h>)
+    #define SGL_HAS_STB_IMAGE_WRITE
+    #define STB_IMAGE_WRITE_IMPLEMENTATION
+    #define STB_IMAGE_WRITE_STATIC
+    #include <stb/stb_image_write.h>
+#endif
+
+
+namespace sgl
+{
+    namespace qoi
+    {
+        constexpr unsigned char kOpIndex = 0x00;
+        constexpr unsigned char kOpDiff = 0x40;
+        constexpr unsigned char kOpLuma = 0x80;
+        constexpr unsigned char kOpRun = 0xc0;
+        constexpr unsigned char kOpRGB = 0xfe;
+        constexpr unsigned char kOpRGBA = 0xff;
+
+        constexpr uint32_t kHeaderSize = 14;
+        constexpr unsigned char kEndMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+        constexpr uint32_t kMaxRun = 62;
+
+        struct Pixel
+        {
+            unsigned char r, g, b, a;
+
+            bool operator==(const Pixel& o) const {
+                return r == o.r && g == o.g && b == o.b && a == o.a;
+            }
+        };
+
+        inline uint32_t Hash(const Pixel& p)
+        {
+            return (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) % 64;
+        }
+
+        inline void Write32(unsigned char*& out, uint32_t value)
+        {
+            *out++ = (value >> 24) & 0xff;
+            *out++ = (value >> 16) & 0xff;
+            *out++ = (value >> 8) & 0xff;
+            *out++ = value & 0xff;
+        }
+    } // namespace qoi
+
+    bool IsImageFileFormatSupported(ImageFileFormat format)
+    {
+        switch (format)
+        {
+        case ImageFileFormat::QOI:
+            return true;
+        case ImageFileFormat::PNG:
+#ifdef SGL_HAS_STB_IMAGE_WRITE
+            return true;
+#else
+            return false;
+#endif
+        }
+        return false;
+    }
+
+    const char* GetImageFileExtension(ImageFileFormat format)
+    {
+        switch (format)
+        {
+        case ImageFileFormat::QOI: return "qoi";
+        case ImageFileFormat::PNG: return "png";
+        }
+        return "";
+    }
+
+    std::vector<unsigned char> EncodeQOI(const unsigned char* pixels,
+                                         uint32_t width, uint32_t height,
+                                         uint32_t channels,
+                                         bool flipVertically)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(pixels != nullptr && width > 0 && height > 0);
+        SGL_ASSERT_MSG(channels == 3 || channels == 4,
+                       "QOI supports 3 or 4 channels, got {}", channels);
+
+        // Worst case, every pixel as an RGBA op
+        std::vector<unsigned char> encoded(
+            qoi::kHeaderSize + size_t(width) * height * (channels + 1)
+            + sizeof(qoi::kEndMarker));
+        unsigned char* out = encoded.data();
+
+        *out++ = 'q'; *out++ = 'o'; *out++ = 'i'; *out++ = 'f';
+        qoi::Write32(out, width);
+        qoi::Write32(out, height);
+        *out++ = static_cast<unsigned char>(channels);
+        *out++ = 0;     // sRGB with linear alpha
+
+        qoi::Pixel index[64];
+        std::memset(index, 0, sizeof(index));
+
+        qoi::Pixel prev = { 0, 0, 0, 255 };
+        qoi::Pixel px = prev;
+        uint32_t run = 0;
+
+        const size_t kStride = size_t(width) * channels;
+        for (uint32_t row = 0; row < height; ++row)
+        {
+            const uint32_t kY = flipVertically ? height - 1 - row : row;
+            const unsigned char* in = pixels + kY * kStride;
+
+            for (uint32_t x = 0; x < width; ++x, in += channels)
+            {
+                px.r = in[0];
+                px.g = in[1];
+                px.b = in[2];
+                px.a = channels == 4 ? in[3] : 255;
+
+                if (px == prev)
+                {
+                    if (++run == qoi::kMaxRun)
+                    {
+                        *out++ = qoi::kOpRun | (run - 1);
+                        run = 0;
+                    }
+                    continue;
+                }
+
+                if (run > 0)
+                {
+                    *out++ = qoi::kOpRun | (run - 1);
+                    run = 0;
+                }
+
+                const uint32_t kHash = qoi::Hash(px);
+                if (index[kHash] == px)
+                {
+                    *out++ = qoi::kOpIndex | kHash;
+                }
+                else
+                {
+                    index[kHash] = px;
+
+                    if (px.a == prev.a)
+                    {
+                        const int8_t kDr = px.r - prev.r;
+                        const int8_t kDg = px.g - prev.g;
+                        const int8_t kDb = px.b - prev.b;
+                        const int8_t kDrDg = kDr - kDg;
+                        const int8_t kDbDg = kDb - kDg;
+
+                        if (kDr > -3 && kDr < 2 && kDg > -3 && kDg < 2 &&
+                            kDb > -3 && kDb < 2)
+                        {
+                            *out++ = qoi::kOpDiff | (kDr + 2) << 4
+                                     | (kDg + 2) << 2 | (kDb + 2);
+                        }
+                        else if (kDrDg > -9 && kDrDg < 8 &&
+                                 kDg > -33 && kDg < 32 &&
+                                 kDbDg > -9 && kDbDg < 8)
+                        {
+                            *out++ = qoi::kOpLuma | (kDg + 32);
+                            *out++ = (kDrDg + 8) << 4 | (kDbDg + 8);
+                        }
+                        else
+                        {
+                            *out++ = qoi::kOpRGB;
+                            *out++ = px.r;
+                            *out++ = px.g;
+                            *out++ = px.b;
+                        }
+                    }
+                    else
+                    {
+                        *out++ = qoi::kOpRGBA;
+                        *out++ = px.r;
+                        *out++ = px.g;
+                        *out++ = px.b;
+                        *out++ = px.a;
+                    }
+                }
+
+                prev = px;
+            }
+        }
+
+        if (run > 0)
+            *out++ = qoi::kOpRun | (run - 1);
+
+        std::memcpy(out, qoi::kEndMarker, sizeof(qoi::kEndMarker));
+        out += sizeof(qoi::kEndMarker);
+
+        encoded.resize(out - encoded.data());
+        return encoded;
+    }
+
+    bool WriteImage(const std::string& filename, ImageFileFormat format,
+                    const unsigned char* pixels,
+                    uint32_t width, uint32_t height, uint32_t channels,
+                    bool flipVertically)
+    {
+        SGL_FUNCTION();
+
+        if (format == ImageFileFormat::PNG)
+        {
+#ifdef SGL_HAS_STB_IMAGE_WRITE
+            // Negative stride from the last row, the flip setting of stb
+            //  is global, so not safe with several encoding threads
+            const int kStride = static_cast<int>(width * channels);
+            const unsigned char* first = flipVertically
+                ? pixels + size_t(height - 1) * kStride
+                : pixels;
+
+            return stbi_write_png(filename.c_str(), width, height, channels,
+                                  first, flipVertically ? -kStride : kStride)
+                   != 0;
+#else
+            SGL_LOG_ERR("PNG writing is not available, add "
+                        "stb/stb_image_write.h to the include path");
+            return false;
+#endif
+        }
+
+        const std::vector<unsigned char> kEncoded = EncodeQOI(
+            pixels, width, height, channels, flipVertically);
+
+        std::FILE* file = std::fopen(filename.c_str(), "wb");
+        if (file == nullptr)
+        {
+            SGL_LOG_ERR("Failed to open a file '{}' for writing", filename);
+            return false;
+        }
+
+        const size_t kWritten = std::fwrite(kEncoded.data(), 1,
+                                            kEncoded.size(), file);
+        std::fclose(file);
+
+        return kWritten == kEncoded.size();
+    }
+
+} // namespace sgl
@@ -0,0 +1,56 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_IMAGE_IMAGE_WRITER_H_
+#define SGL_IMAGE_IMAGE_WRITER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace sgl
+{
+    enum class ImageFileFormat
+    {
+        QOI = 0,    ///< Lossless, fast to encode, @see https://qoiformat.org
+        PNG         ///< Needs stb_image_write.h in the include path
+    };
+
+    /** @return False if the format was not compiled in */
+    bool IsImageFileFormatSupported(ImageFileFormat format);
+
+    /** @return File extension of the format, without the dot */
+    const char* GetImageFileExtension(ImageFileFormat format);
+
+    /**
+     * @brief Encodes 8 bit pixels as a QOI image
+     * @param channels 3 (RGB) or 4 (RGBA)
+     * @param flipVertically Rows are bottom to top, as read from OpenGL
+     */
+    std::vector<unsigned char> EncodeQOI(const unsigned char* pixels,
+                                         uint32_t width,
+                                         uint32_t height,
+                                         uint32_t channels,
+                                         bool flipVertically = false);
+
+    /**
+     * @brief Encodes and writes 8 bit pixels to a file
+     * @param channels 3 (RGB) or 4 (RGBA)
+     * @param flipVertically Rows are bottom to top, as read from OpenGL
+     * @return False if the format is not supported or writing failed
+     */
+    bool WriteImage(const std::string& filename,
+                    ImageFileFormat format,
+                    const unsigned char* pixels,
+                    uint32_t width,
+                    uint32_t height,
+                    uint32_t channels,
+                    bool flipVertically = false);
+
+} // namespace sgl
+
+
+#endif // SGL_IMAGE_IMAGE_WRITER_H_
@@ -0,0 +1,506 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/image/MipChain.h"
+#include "SGL/core/Profiler.h"
+#include "SGL/core/ThreadPool.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #define SGL_MIP_SSE2
+    #include <emmintrin.h>
+#endif
+
+
+namespace sgl
+{
+    namespace mip
+    {
+        /** @brief Tasks queued per worker, smaller bands balance better */
+        constexpr uint32_t kTasksPerWorker = 4;
+        /** @brief Rows under which a band is not worth a task */
+        constexpr uint32_t kMinBandRows = 16;
+
+        /** @brief Radius in destination texels, and shape, of the window */
+        constexpr double kKaiserRadius = 3.0;
+        constexpr double kKaiserAlpha = 4.0;
+
+        /** @brief Entries of the linear to sRGB table, 1/5 of a code apart
+         *  at the steepest */
+        constexpr uint32_t kEncodeSize = 16384;
+
+        /**
+         * @brief Weights of the source texels of each destination texel of
+         *  one axis. Every texel has "count" taps, indices are clamped to the
+         *  edges and unused taps weigh 0.
+         */
+        struct Taps
+        {
+            uint32_t count{ 0 };
+            std::vector<uint32_t> indices;
+            std::vector<float> weights;
+        };
+
+        struct Level
+        {
+            /// The base level is decoded a row at a time, the others are
+            ///  read from the floats of the previous level
+            const unsigned char* base{ nullptr };
+            const float* const* decode{ nullptr };  ///< Tables per channel
+            const float* source{ nullptr };
+            float* horizontal{ nullptr };   ///< Destination width, source rows
+            float* destination{ nullptr };
+            unsigned char* pixels{ nullptr };
+            uint32_t sourceWidth{ 0 };
+            uint32_t width{ 0 };
+            uint32_t height{ 0 };
+            uint32_t channels{ 0 };
+            const Taps* tapsX{ nullptr };
+            const Taps* tapsY{ nullptr };
+            const bool* srgb{ nullptr };    ///< Per channel
+        };
+
+        const std::array<float, 256>& GetDecodeTable(bool srgb)
+        {
+            static const std::array<float, 256> kLinear = []() {
+                std::array<float, 256> table;
+                for (uint32_t i = 0; i < 256; ++i)
+                    table[i] = i / 255.0f;
+                return table;
+            }();
+            static const std::array<float, 256> kSRGB = []() {
+                std::array<float, 256> table;
+                for (uint32_t i = 0; i < 256; ++i)
+                {
+                    const double kValue = i / 255.0;
+                    table[i] = static_cast<float>(
+                        kValue <= 0.04045
+                            ? kValue / 12.92
+                            : std::pow((kValue + 0.055) / 1.055, 2.4));
+                }
+                return table;
+            }();
+
+            return srgb ? kSRGB : kLinear;
+        }
+
+        const std::vector<unsigned char>& GetEncodeTable()
+        {
+            static const std::vector<unsigned char> kTable = []() {
+                std::vector<unsigned char> table(kEncodeSize);
+                for (uint32_t i = 0; i < kEncodeSize; ++i)
+                {
+                    const double kValue = i / double(kEncodeSize - 1);
+                    const double kEncoded =
+                        kValue <= 0.0031308
+                            ? kValue * 12.92
+                            : 1.055 * std::pow(kValue, 1.0 / 2.4) - 0.055;
+                    table[i] = static_cast<unsigned char>(
+                        std::clamp(kEncoded * 255.0 + 0.5, 0.0, 255.0));
+                }
+                return table;
+            }();
+
+            return kTable;
+        }
+
+        double Sinc(double x)
+        {
+            if (std::abs(x) < 1e-9)
+                return 1.0;
+
+            const double kX = x * 3.14159265358979323846;
+            return std::sin(kX) / kX;
+        }
+
+        /** @brief Modified Bessel function of the first kind, order 0 */
+        double BesselI0(double x)
+        {
+            double sum = 1.0;
+            double term = 1.0;
+            const double kHalfSquared = x * x * 0.25;
+            for (uint32_t k = 1; k < 32 && term > sum * 1e-12; ++k)
+            {
+                term *= kHalfSquared / (double(k) * k);
+                sum += term;
+            }
+            return sum;
+        }
+
+        double Kaiser(double x)
+        {
+            if (std::abs(x) >= 1.0)
+                return 0.0;
+
+            return BesselI0(kKaiserAlpha * std::sqrt(1.0 - x * x))
+                   / BesselI0(kKaiserAlpha);
+        }
+
+        /**
+         * @brief Taps of a reduction from "sourceSize" to "size". Odd sizes
+         *  keep their exact footprint, a box over 5 texels covers 2.5 of
+         *  them per destination texel with 3 taps.
+         */
+        Taps MakeTaps(MipFilter filter, uint32_t sourceSize, uint32_t size)
+        {
+            Taps taps;
+            if (sourceSize == size)
+            {
+                taps.count = 1;
+                taps.indices.resize(size);
+                taps.weights.assign(size, 1.0f);
+                for (uint32_t i = 0; i < size; ++i)
+                    taps.indices[i] = i;
+                return taps;
+            }
+
+            const double kScale = double(sourceSize) / size;
+            const double kRadius = filter == MipFilter::Box
+                                   ? kScale * 0.5
+                                   : kScale * kKaiserRadius;
+
+            // Coordinates of texel edges, texel i covers [i, i + 1]
+            std::vector<std::vector<std::pair<int64_t, double>>> texels(size);
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                const double kCenter = (x + 0.5) * kScale;
+                const int64_t kFirst = static_cast<int64_t>(
+                    std::floor(kCenter - kRadius));
+                const int64_t kLast = static_cast<int64_t>(
+                    std::ceil(kCenter + kRadius));
+
+                double sum = 0.0;
+                for (int64_t i = kFirst; i < kLast; ++i)
+                {
+                    double weight = 0.0;
+                    if (filter == MipFilter::Box)
+                    {
+                        weight = std::min<double>(i + 1, kCenter + kRadius)
+                                 - std::max<double>(i, kCenter - kRadius);
+                    }
+                    else
+                    {
+                        const double kDistance = (i + 0.5 - kCenter) / kScale;
+                        weight = Sinc(kDistance)
+                                 * Kaiser(kDistance / kKaiserRadius);
+                    }
+
+                    if (std::abs(weight) < 1e-7)
+                        continue;
+
+                    texels[x].emplace_back(i, weight);
+                    sum += weight;
+                }
+
+                for (std::pair<int64_t, double>& texel : texels[x])
+                    texel.second /= sum;
+
+                taps.count = std::max(
+                    taps.count, static_cast<uint32_t>(texels[x].size()));
+            }
+
+            taps.indices.assign(size_t(size) * taps.count, 0);
+            taps.weights.assign(size_t(size) * taps.count, 0.0f);
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                for (size_t k = 0; k < texels[x].size(); ++k)
+                {
+                    const int64_t kIndex = std::clamp<int64_t>(
+                        texels[x][k].first, 0, int64_t(sourceSize) - 1);
+                    taps.indices[x * taps.count + k] =
+                        static_cast<uint32_t>(kIndex);
+                    taps.weights[x * taps.count + k] =
+                        static_cast<float>(texels[x][k].second);
+                }
+            }
+
+            return taps;
+        }
+
+        template <uint32_t t_Channels>
+        void FilterHorizontal(const Level& level, uint32_t rowBegin,
+                              uint32_t rowEnd)
+        {
+            const Taps& kTaps = *level.tapsX;
+            const size_t kSourceRowSize = size_t(level.sourceWidth)
+                                          * t_Channels;
+
+            std::vector<float> decoded;
+            if (level.base != nullptr)
+                decoded.resize(kSourceRowSize);
+
+            for (uint32_t y = rowBegin; y < rowEnd; ++y)
+            {
+                const float* row = decoded.data();
+                if (level.base != nullptr)
+                {
+                    const unsigned char* kBytes = level.base
+                                                  + y * kSourceRowSize;
+                    for (size_t i = 0; i < kSourceRowSize; i += t_Channels)
+                    {
+                        for (uint32_t c = 0; c < t_Channels; ++c)
+                            decoded[i + c] = level.decode[c][kBytes[i + c]];
+                    }
+                }
+                else
+                {
+                    row = level.source + y * kSourceRowSize;
+                }
+                float* out = level.horizontal
+                    + size_t(y) * level.width * t_Channels;
+
+                for (uint32_t x = 0; x < level.width; ++x)
+                {
+                    const uint32_t* kIndices = &kTaps.indices[x * kTaps.count];
+                    const float* kWeights = &kTaps.weights[x * kTaps.count];
+
+                #ifdef SGL_MIP_SSE2
+                    if constexpr (t_Channels == 4)
+                    {
+                        __m128 sum = _mm_setzero_ps();
+                        for (uint32_t k = 0; k < kTaps.count; ++k)
+                        {
+                            sum = _mm_add_ps(sum, _mm_mul_ps(
+                                _mm_set1_ps(kWeights[k]),
+                                _mm_loadu_ps(row + kIndices[k] * 4)));
+                        }
+                        _mm_storeu_ps(out + x * 4, sum);
+                        continue;
+                    }
+                #endif
+
+                    float sum[t_Channels] = {};
+                    for (uint32_t k = 0; k < kTaps.count; ++k)
+                    {
+                        const float* kTexel = row + kIndices[k] * t_Channels;
+                        for (uint32_t c = 0; c < t_Channels; ++c)
+                            sum[c] += kWeights[k] * kTexel[c];
+                    }
+                    for (uint32_t c = 0; c < t_Channels; ++c)
+                        out[x * t_Channels + c] = sum[c];
+                }
+            }
+        }
+
+        /** @brief Also clamps the destination and encodes it to 8 bits */
+        void FilterVertical(const Level& level, uint32_t rowBegin,
+                            uint32_t rowEnd)
+        {
+            const Taps& kTaps = *level.tapsY;
+            const size_t kRowSize = size_t(level.width) * level.channels;
+            const std::vector<unsigned char>& kEncode = GetEncodeTable();
+
+            for (uint32_t y = rowBegin; y < rowEnd; ++y)
+            {
+                const uint32_t* kIndices = &kTaps.indices[y * kTaps.count];
+                const float* kWeights = &kTaps.weights[y * kTaps.count];
+                float* out = level.destination + y * kRowSize;
+
+                size_t i = 0;
+            #ifdef SGL_MIP_SSE2
+                const __m128 kZero = _mm_setzero_ps();
+                const __m128 kOne = _mm_set1_ps(1.0f);
+                for (; i + 4 <= kRowSize; i += 4)
+                {
+                    __m128 sum = _mm_setzero_ps();
+                    for (uint32_t k = 0; k < kTaps.count; ++k)
+                    {
+                        sum = _mm_add_ps(sum, _mm_mul_ps(
+                            _mm_set1_ps(kWeights[k]),
+                            _mm_loadu_ps(level.horizontal
+                                         + kIndices[k] * kRowSize + i)));
+                    }
+                    _mm_storeu_ps(out + i,
+                                  _mm_min_ps(_mm_max_ps(sum, kZero), kOne));
+                }
+            #endif
+                for (; i < kRowSize; ++i)
+                {
+                    float sum = 0.0f;
+                    for (uint32_t k = 0; k < kTaps.count; ++k)
+                    {
+                        sum += kWeights[k]
+                               * level.horizontal[kIndices[k] * kRowSize + i];
+                    }
+                    out[i] = std::clamp(sum, 0.0f, 1.0f);
+                }
+
+                unsigned char* pixels = level.pixels + y * kRowSize;
+                for (size_t j = 0; j < kRowSize; j += level.channels)
+                {
+                    for (uint32_t c = 0; c < level.channels; ++c)
+                    {
+                        const float kValue = out[j + c];
+                        pixels[j + c] = level.srgb[c]
+                            ? kEncode[static_cast<uint32_t>(
+                                  kValue * (kEncodeSize - 1) + 0.5f)]
+                            : static_cast<unsigned char>(
+                                  kValue * 255.0f + 0.5f);
+                    }
+                }
+            }
+        }
+
+        template <typename t_Function>
+        void ForEachBand(ThreadPool* pool, uint32_t rows,
+                         const t_Function& function)
+        {
+            if (pool == nullptr || rows < 2 * kMinBandRows)
+            {
+                function(0, rows);
+                return;
+            }
+
+            const uint32_t kBandRows = std::max(
+                rows / (pool->GetThreadCount() * kTasksPerWorker),
+                kMinBandRows);
+
+            std::vector<std::future<void>> bands;
+            for (uint32_t row = 0; row < rows; row += kBandRows)
+            {
+                const uint32_t kEnd = std::min(row + kBandRows, rows);
+                bands.push_back(pool->Submit([&function, row, kEnd]() {
+                    function(row, kEnd);
+                }));
+            }
+
+            for (std::future<void>& band : bands)
+                band.wait();
+        }
+    } // namespace mip
+
+    uint32_t GetMipLevelCount(uint32_t width, uint32_t height)
+    {
+        uint32_t size = std::max(width, height);
+        uint32_t levels = 1;
+        while (size > 1)
+        {
+            size >>= 1;
+            ++levels;
+        }
+        return levels;
+    }
+
+    MipChain BuildMipChain(const unsigned char* pixels, uint32_t width,
+                           uint32_t height, uint32_t channels,
+                           const MipChainSpec& spec, ThreadPool* pool)
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Build Mip Chain");
+
+        MipChain chain;
+        if (pixels == nullptr || width == 0 || height == 0 || channels == 0
+            || channels > 4)
+        {
+            SGL_LOG_ERR("Invalid image {}x{}, {} channels, for a mip chain",
+                        width, height, channels);
+            return chain;
+        }
+
+        uint32_t levelCount = GetMipLevelCount(width, height);
+        if (spec.maxLevels != 0)
+            levelCount = std::min(levelCount, spec.maxLevels);
+
+        chain.channels = channels;
+        chain.levels.resize(levelCount);
+        size_t size = 0;
+        for (uint32_t i = 0; i < levelCount; ++i)
+        {
+            MipLevel& level = chain.levels[i];
+            level.width = std::max(width >> i, 1u);
+            level.height = std::max(height >> i, 1u);
+            level.offset = size;
+            level.size = size_t(level.width) * level.height * channels;
+            size += level.size;
+        }
+
+        chain.pixels.resize(size);
+        std::memcpy(chain.pixels.data(), pixels, chain.levels[0].size);
+        if (levelCount == 1)
+            return chain;
+
+        bool srgb[4] = {};
+        const bool kHasAlpha = channels == 2 || channels == 4;
+        for (uint32_t c = 0; c < channels; ++c)
+            srgb[c] = spec.srgb && !(kHasAlpha && c == channels - 1);
+
+        const float* decode[4] = {};
+        for (uint32_t c = 0; c < channels; ++c)
+            decode[c] = mip::GetDecodeTable(srgb[c]).data();
+
+        // Levels are filtered from the previous one in linear floats, the
+        //  error of 8 bits does not add up along the chain. The buffers are
+        //  written before they are read, they are not cleared.
+        const size_t kHorizontalSize = size_t(chain.levels[1].width)
+                                       * height * channels;
+        const size_t kLevelSize = chain.levels[1].size;
+        std::unique_ptr<float[]> horizontal(new float[kHorizontalSize]);
+        std::unique_ptr<float[]> levelsA(new float[kLevelSize]);
+        std::unique_ptr<float[]> levelsB(new float[kLevelSize]);
+        float* source = nullptr;
+        float* destination = levelsA.get();
+
+        for (uint32_t i = 1; i < levelCount; ++i)
+        {
+            const MipLevel& kSource = chain.levels[i - 1];
+            const MipLevel& kLevel = chain.levels[i];
+            const mip::Taps kTapsX = mip::MakeTaps(spec.filter, kSource.width,
+                                                   kLevel.width);
+            const mip::Taps kTapsY = mip::MakeTaps(spec.filter,
+                                                   kSource.height,
+                                                   kLevel.height);
+
+            mip::Level level;
+            level.base = i == 1 ? pixels : nullptr;
+            level.decode = decode;
+            level.source = source;
+            level.horizontal = horizontal.get();
+            level.destination = destination;
+            level.pixels = chain.pixels.data() + kLevel.offset;
+            level.sourceWidth = kSource.width;
+            level.width = kLevel.width;
+            level.height = kLevel.height;
+            level.channels = channels;
+            level.tapsX = &kTapsX;
+            level.tapsY = &kTapsY;
+            level.srgb = srgb;
+
+            mip::ForEachBand(pool, kSource.height, [&level](uint32_t begin,
+                                                            uint32_t end) {
+                switch (level.channels)
+                {
+                    case 1:
+                        mip::FilterHorizontal<1>(level, begin, end);
+                        break;
+                    case 2:
+                        mip::FilterHorizontal<2>(level, begin, end);
+                        break;
+                    case 3:
+                        mip::FilterHorizontal<3>(level, begin, end);
+                        break;
+                    default:
+                        mip::FilterHorizontal<4>(level, begin, end);
+                        break;
+                }
+            });
+
+            mip::ForEachBand(pool, kLevel.height, [&level](uint32_t begin,
+                                                           uint32_t end) {
+                mip::FilterVertical(level, begin, end);
+            });
+
+            // The destination is the source of the next level
+            source = destination;
+            destination = destination == levelsA.get() ? levelsB.get()
+                                                       : levelsA.get();
+        }
+
+        return chain;
+    }
+
+} // namespace sgl
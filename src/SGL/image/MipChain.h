@@ -0,0 +1,77 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_IMAGE_MIP_CHAIN_H_
+#define SGL_IMAGE_MIP_CHAIN_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace sgl
+{
+    class ThreadPool;
+
+    enum class MipFilter
+    {
+        Box = 0,    ///< 2x2 average, the fastest
+        Kaiser      ///< Kaiser windowed sinc, sharper, 12 taps per axis
+    };
+
+    struct MipChainSpec
+    {
+        MipFilter filter{ MipFilter::Box };
+        /// Color channels are averaged in linear space, alpha never is
+        bool srgb{ false };
+        uint32_t maxLevels{ 0 };    ///< 0 for the full chain
+    };
+
+    struct MipLevel
+    {
+        uint32_t width{ 0 };
+        uint32_t height{ 0 };
+        size_t offset{ 0 };         ///< In "MipChain::pixels"
+        size_t size{ 0 };
+    };
+
+    /** @brief 8-bit levels, largest first, tightly packed rows */
+    struct MipChain
+    {
+        uint32_t channels{ 0 };
+        std::vector<MipLevel> levels;
+        std::vector<unsigned char> pixels;
+
+        bool Empty() const { return levels.empty(); }
+        uint32_t GetLevelCount() const {
+            return static_cast<uint32_t>(levels.size());
+        }
+        const unsigned char* GetPixels(uint32_t level) const {
+            return pixels.data() + levels[level].offset;
+        }
+    };
+
+    /** @return Levels of a full chain, down to 1x1, non-square included */
+    uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+
+    /**
+     * @brief Builds the levels on the CPU, each from the previous one kept
+     *  in floating point. Level sizes halve and round down, as in OpenGL.
+     * @param channels 1 to 4, alpha is the last of 2 and 4
+     * @param pool Filters bands of rows of each level in parallel, null
+     *  filters on the calling thread. Do not call from a worker of the same
+     *  pool.
+     */
+    MipChain BuildMipChain(const unsigned char* pixels,
+                           uint32_t width,
+                           uint32_t height,
+                           uint32_t channels,
+                           const MipChainSpec& spec = MipChainSpec(),
+                           ThreadPool* pool = nullptr);
+
+} // namespace sgl
+
+
+#endif // SGL_IMAGE_MIP_CHAIN_H_
@@ -75,16 +75,15 @@ namespace sgl
 
     void BufferLayout::DebugPrint() const
     {
-    #ifdef SGL_DEBUG
-        SGL_LOG_INFO("BufferLayout info:\n Elements total: {}, Stride {}",
-                     m_Elements.size(), m_Stride);
+        // Compiled out with the debug level
+        SGL_LOG_DEBUG("BufferLayout info:\n Elements total: {}, Stride {}",
+                      m_Elements.size(), m_Stride);
 
         uint32_t ctr = 0;
         for (const auto& e : m_Elements)
         {
-            SGL_LOG_INFO(" Element {}: {}", ctr++, e.ToString());
+            SGL_LOG_DEBUG(" Element {}: {}", ctr++, e.ToString());
         }
-    #endif
     }
 
     // =========================================================================
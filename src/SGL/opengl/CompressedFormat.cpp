@@ -0,0 +1,110 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/opengl/CompressedFormat.h"
+
+
+namespace sgl
+{
+    static constexpr CompressedFormatInfo kCompressedFormats[] = {
+        // BC1-BC3 (S3TC, DXT1-DXT5)
+        { GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 4, 4, 8, false, "BC1 RGB" },
+        { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 4, 4, 8, false, "BC1 RGBA" },
+        { GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, 4, 4, 8, true, "BC1 sRGB" },
+        { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, 4, 4, 8, true,
+          "BC1 sRGB alpha" },
+        { GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 4, 4, 16, false, "BC2" },
+        { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, 4, 4, 16, true,
+          "BC2 sRGB" },
+        { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 4, 4, 16, false, "BC3" },
+        { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, 4, 4, 16, true,
+          "BC3 sRGB" },
+        // BC4-BC5 (RGTC)
+        { GL_COMPRESSED_RED_RGTC1, 4, 4, 8, false, "BC4" },
+        { GL_COMPRESSED_SIGNED_RED_RGTC1, 4, 4, 8, false, "BC4 signed" },
+        { GL_COMPRESSED_RG_RGTC2, 4, 4, 16, false, "BC5" },
+        { GL_COMPRESSED_SIGNED_RG_RGTC2, 4, 4, 16, false, "BC5 signed" },
+        // BC6H-BC7 (BPTC)
+        { GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, 4, 4, 16, false,
+          "BC6H unsigned" },
+        { GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT, 4, 4, 16, false,
+          "BC6H signed" },
+        { GL_COMPRESSED_RGBA_BPTC_UNORM, 4, 4, 16, false, "BC7" },
+        { GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, 4, 4, 16, true, "BC7 sRGB" },
+        // ETC2 and EAC, core since 4.3
+        { GL_COMPRESSED_RGB8_ETC2, 4, 4, 8, false, "ETC2 RGB" },
+        { GL_COMPRESSED_SRGB8_ETC2, 4, 4, 8, true, "ETC2 sRGB" },
+        { GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2, 4, 4, 8, false,
+          "ETC2 RGB A1" },
+        { GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2, 4, 4, 8, true,
+          "ETC2 sRGB A1" },
+        { GL_COMPRESSED_RGBA8_ETC2_EAC, 4, 4, 16, false, "ETC2 RGBA" },
+        { GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC, 4, 4, 16, true,
+          "ETC2 sRGB alpha" },
+        { GL_COMPRESSED_R11_EAC, 4, 4, 8, false, "EAC R11" },
+        { GL_COMPRESSED_SIGNED_R11_EAC, 4, 4, 8, false, "EAC R11 signed" },
+        { GL_COMPRESSED_RG11_EAC, 4, 4, 16, false, "EAC RG11" },
+        { GL_COMPRESSED_SIGNED_RG11_EAC, 4, 4, 16, false,
+          "EAC RG11 signed" },
+    };
+
+    const CompressedFormatInfo* GetCompressedFormatInfo(uint32_t format)
+    {
+        for (const CompressedFormatInfo& kInfo : kCompressedFormats)
+        {
+            if (kInfo.format == format)
+                return &kInfo;
+        }
+        return nullptr;
+    }
+
+    const char* GetCompressedFormatName(uint32_t format)
+    {
+        const CompressedFormatInfo* kInfo = GetCompressedFormatInfo(format);
+        return kInfo != nullptr ? kInfo->name : "Uncompressed";
+    }
+
+    size_t GetCompressedImageSize(uint32_t format, uint32_t width,
+                                  uint32_t height)
+    {
+        const CompressedFormatInfo* kInfo = GetCompressedFormatInfo(format);
+        SGL_ASSERT_MSG(kInfo != nullptr, "Format 0x{:X} is not compressed",
+                       format);
+        if (kInfo == nullptr)
+            return 0;
+
+        const size_t kBlocksX = (width + kInfo->blockWidth - 1)
+                                / kInfo->blockWidth;
+        const size_t kBlocksY = (height + kInfo->blockHeight - 1)
+                                / kInfo->blockHeight;
+        return kBlocksX * kBlocksY * kInfo->blockBytes;
+    }
+
+    bool IsCompressedFormatSupported(uint32_t format, uint32_t target)
+    {
+        if (!IsCompressedFormat(format))
+            return false;
+
+        GLint supported = GL_FALSE;
+        glGetInternalformativ(target, format, GL_INTERNALFORMAT_SUPPORTED,
+                              1, &supported);
+        return supported == GL_TRUE;
+    }
+
+    std::vector<uint32_t> GetSupportedCompressedFormats(uint32_t target)
+    {
+        SGL_FUNCTION();
+
+        std::vector<uint32_t> formats;
+        for (const CompressedFormatInfo& kInfo : kCompressedFormats)
+        {
+            if (IsCompressedFormatSupported(kInfo.format, target))
+                formats.push_back(kInfo.format);
+        }
+        return formats;
+    }
+
+} // namespace sgl
@@ -0,0 +1,84 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_OPENGL_COMPRESSED_FORMAT_H_
+#define SGL_OPENGL_COMPRESSED_FORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+// S3TC is an extension, not in the core profile loader
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+    #define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+    #define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+    #define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+    #define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+    #define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+    #define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+    #define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT 0x8C4E
+    #define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+
+namespace sgl
+{
+    /** @brief Block layout of a compressed internal format */
+    struct CompressedFormatInfo
+    {
+        uint32_t format{ 0 };       ///< Sized internal format
+        uint32_t blockWidth{ 4 };
+        uint32_t blockHeight{ 4 };
+        uint32_t blockBytes{ 0 };
+        bool srgb{ false };
+        const char* name{ "" };
+    };
+
+    /** @brief Mip level of a compressed image, tightly packed blocks */
+    struct CompressedLevel
+    {
+        const void* data{ nullptr };
+        size_t size{ 0 };           ///< In **bytes**
+    };
+
+    /**
+     * @return Layout of a BC1-BC7, ETC2 or EAC format, null for any other
+     *  format
+     */
+    const CompressedFormatInfo* GetCompressedFormatInfo(uint32_t format);
+
+    inline bool IsCompressedFormat(uint32_t format) {
+        return GetCompressedFormatInfo(format) != nullptr;
+    }
+
+    /** @return Name for the logs, e.g. "BC7 sRGB" */
+    const char* GetCompressedFormatName(uint32_t format);
+
+    /** @return Bytes of a level, partial blocks at the edges included */
+    size_t GetCompressedImageSize(uint32_t format,
+                                  uint32_t width,
+                                  uint32_t height);
+
+    /**
+     * @brief Asks the driver, needs a current context. Desktop drivers may
+     *  support ETC2 and EAC by decompressing them on upload, which saves no
+     *  memory, prefer BC formats there.
+     * @param target GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP, ...
+     */
+    bool IsCompressedFormatSupported(uint32_t format,
+                                     uint32_t target = GL_TEXTURE_2D);
+
+    /** @return Formats of the table supported by the driver */
+    std::vector<uint32_t> GetSupportedCompressedFormats(
+        uint32_t target = GL_TEXTURE_2D);
+
+} // namespace sgl
+
+
+#endif // SGL_OPENGL_COMPRESSED_FORMAT_H_
@@ -5,6 +5,8 @@
 
 #include "SGL/pch.h"
 #include "CubeMapTexture.h"
+#include "SGL/core/Profiler.h"
+#include "SGL/core/RenderStats.h"
 
 
 namespace sgl
@@ -16,12 +18,37 @@ namespace sgl
         const FacesData& facesData)
         : m_FaceWidth(faceWidth),
           m_FaceHeight(faceHeight),
-          m_FaceFormat(faceChannels == 4 ? GL_RGBA : GL_RGB)
+          m_FaceFormat(faceChannels == 4 ? GL_RGBA : GL_RGB),
+          m_Format(faceChannels == 4 ? GL_RGBA8 : GL_RGB8)
     {
         SGL_FUNCTION();
         CreateCubeMapTexture(facesData);
     }
 
+    CubeMapTexture::CubeMapTexture(
+        uint32_t faceWidth,
+        uint32_t faceHeight,
+        uint32_t format,
+        const CompressedLevel* levels,
+        uint32_t levelCount)
+        : m_FaceWidth(faceWidth),
+          m_FaceHeight(faceHeight),
+          m_Format(format),
+          m_MipLevels(levelCount)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT_MSG(IsCompressedFormatSupported(format,
+                                                   GL_TEXTURE_CUBE_MAP),
+                       "{} cube maps are not supported by the driver",
+                       GetCompressedFormatName(format));
+        SGL_ASSERT(levelCount >= 1);
+
+        CreateTexture();
+        SetupStorage();
+        SetCompressedFaces(levels);
+        SetTextureParams();
+    }
+
     void CubeMapTexture::CreateCubeMapTexture(
         const FacesData& imagesData)
     {
@@ -40,6 +67,7 @@ namespace sgl
     void CubeMapTexture::Bind() const
     {
         glBindTexture(GL_TEXTURE_CUBE_MAP, m_ID);
+        SGL_RENDER_STAT(textureBinds, 1);
     }
 
     void CubeMapTexture::UnBind() const
@@ -58,11 +86,9 @@ namespace sgl
     {
         SGL_FUNCTION();
 
-        const uint32_t kFormat = m_FaceFormat == GL_RGB ? GL_RGB8
-                                                        : GL_RGBA8;
         glTextureStorage2D(m_ID,
-                           1,
-                           kFormat,
+                           m_MipLevels,
+                           m_Format,
                            m_FaceWidth,
                            m_FaceHeight);
     }
@@ -70,6 +96,7 @@ namespace sgl
     void CubeMapTexture::SetFacesData(const FacesData& imagesData) const
     {
         SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Upload CubeMapTexture");
 
         uint32_t face = 0;
         for (auto data : imagesData)
@@ -86,6 +113,37 @@ namespace sgl
                                 GL_UNSIGNED_BYTE, // type,
                                 data);
             ++face;
+
+            SGL_RENDER_STAT(bytesUploaded, m_FaceWidth * m_FaceHeight
+                            * (m_FaceFormat == GL_RGB ? 3 : 4));
+        }
+    }
+
+    void CubeMapTexture::SetCompressedFaces(
+        const CompressedLevel* levels) const
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Upload CubeMapTexture");
+
+        for (uint32_t level = 0; level < m_MipLevels; ++level)
+        {
+            const uint32_t kWidth = std::max(m_FaceWidth >> level, 1u);
+            const uint32_t kHeight = std::max(m_FaceHeight >> level, 1u);
+
+            for (uint32_t face = 0; face < CubeFaceCount; ++face)
+            {
+                const CompressedLevel& kLevel
+                    = levels[level * CubeFaceCount + face];
+                SGL_ASSERT(kLevel.size == GetCompressedImageSize(
+                    m_Format, kWidth, kHeight));
+
+                glCompressedTextureSubImage3D(
+                    m_ID, level, 0, 0, face, kWidth, kHeight, 1, m_Format,
+                    static_cast<GLsizei>(kLevel.size), kLevel.data);
+
+                SGL_RENDER_STAT(bytesUploaded,
+                                static_cast<uint64_t>(kLevel.size));
+            }
         }
     }
 
@@ -93,8 +151,9 @@ namespace sgl
     {
         SGL_FUNCTION();
 
-        int param = GL_LINEAR;
+        int param = m_MipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
         glTextureParameteriv(m_ID, GL_TEXTURE_MIN_FILTER, &param);
+        param = GL_LINEAR;
         glTextureParameteriv(m_ID, GL_TEXTURE_MAG_FILTER, &param);
         param = GL_CLAMP_TO_EDGE;
         glTextureParameteriv(m_ID, GL_TEXTURE_WRAP_S, &param);
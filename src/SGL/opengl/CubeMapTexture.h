@@ -9,6 +9,8 @@
 #include <array>
 #include <cstdint>
 
+#include "SGL/opengl/CompressedFormat.h"
+
 
 namespace sgl
 {
@@ -26,15 +28,32 @@ namespace sgl
                        uint32_t faceHeight,
                        uint32_t faceChannels,
                        const FacesData& facesData);
+        /**
+         * @brief Block compressed faces, mips are not generated
+         * @param format BC1-BC7, ETC2 or EAC, see "CompressedFormat.h"
+         * @param levels Indexed [level * CubeFaceCount + face], largest
+         *  level first, faces in the +X, -X, +Y, -Y, +Z, -Z order
+         */
+        CubeMapTexture(uint32_t faceWidth,
+                       uint32_t faceHeight,
+                       uint32_t format,
+                       const CompressedLevel* levels,
+                       uint32_t levelCount);
         ~CubeMapTexture();
 
         void Bind() const;
         void UnBind() const;
 
+        uint32_t GetID() const { return m_ID; }
+        uint32_t GetMipLevels() const { return m_MipLevels; }
+        /** @return Sized internal format of the storage */
+        uint32_t GetFormat() const { return m_Format; }
+
     private:
         void CreateCubeMapTexture(const FacesData& imagesData);
         void SetupStorage() const;
         void SetFacesData(const FacesData& imagesData) const;
+        void SetCompressedFaces(const CompressedLevel* levels) const;
         void DeleteTexture();
 
         void SetTextureParams() const;
@@ -46,6 +65,8 @@ namespace sgl
         uint32_t m_FaceWidth{ 0 };
         uint32_t m_FaceHeight{ 0 };
         uint32_t m_FaceFormat{ 0 };
+        uint32_t m_Format{ 0 };
+        uint32_t m_MipLevels{ 1 };
     };
 
 } // namespace sgl
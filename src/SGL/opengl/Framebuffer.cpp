@@ -0,0 +1,489 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/opengl/Framebuffer.h"
+#include "SGL/opengl/Renderbuffer.h"
+#include "SGL/opengl/Texture2D.h"
+
+
+namespace sgl
+{
+    static bool IsDepthFormat(uint32_t format)
+    {
+        switch (format)
+        {
+        case GL_DEPTH_COMPONENT16:
+        case GL_DEPTH_COMPONENT24:
+        case GL_DEPTH_COMPONENT32:
+        case GL_DEPTH_COMPONENT32F:
+        case GL_DEPTH24_STENCIL8:
+        case GL_DEPTH32F_STENCIL8:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /** @brief Only sampleable attachments kept after the pass are resolved */
+    static bool IsResolved(const AttachmentSpec& spec)
+    {
+        return spec.format != 0 && spec.type == AttachmentType::Texture &&
+               !spec.transient;
+    }
+
+    uint32_t Attachment::GetID() const
+    {
+        if (texture)
+            return texture->GetID();
+        if (renderbuffer)
+            return renderbuffer->GetID();
+        return 0;
+    }
+
+    // =========================================================================
+
+    AttachmentPool& AttachmentPool::Get()
+    {
+        static AttachmentPool s_Pool;
+        return s_Pool;
+    }
+
+    uint32_t AttachmentPool::BucketSize(uint32_t size)
+    {
+        const uint32_t kBuckets = (size + BucketGranularity - 1)
+                                  / BucketGranularity;
+        return std::max(kBuckets, 1u) * BucketGranularity;
+    }
+
+    Attachment AttachmentPool::Acquire(const Key& key)
+    {
+        SGL_FUNCTION();
+
+        auto it = m_Free.find(key);
+        if (it != m_Free.end())
+        {
+            Attachment attachment = std::move(it->second);
+            m_Free.erase(it);
+
+            auto order = std::find_if(m_ReleaseOrder.begin(),
+                                      m_ReleaseOrder.end(),
+                                      [&key](const Key& k) {
+                                          return !(k < key) && !(key < k);
+                                      });
+            m_ReleaseOrder.erase(order);
+
+            return attachment;
+        }
+
+        Attachment attachment;
+        if (key.type == AttachmentType::Renderbuffer || key.samples > 1)
+        {
+            attachment.renderbuffer = Renderbuffer::Create(
+                key.width, key.height, key.format, key.samples);
+        }
+        else
+        {
+            // Image format is not used, no data is uploaded
+            attachment.texture = Texture2D::Create(
+                key.width, key.height, nullptr, key.format, GL_RGBA);
+        }
+
+        return attachment;
+    }
+
+    void AttachmentPool::Release(const Key& key, Attachment attachment)
+    {
+        SGL_FUNCTION();
+
+        if (!attachment)
+            return;
+
+        // Still held by a user, e.g. from "GetColorTexture", reusing it
+        //  would render into a texture that is being sampled
+        if ((attachment.texture && attachment.texture.use_count() > 1) ||
+            (attachment.renderbuffer &&
+             attachment.renderbuffer.use_count() > 1))
+            return;
+
+        m_Free.emplace(key, std::move(attachment));
+        m_ReleaseOrder.push_back(key);
+
+        // Deletes the least recently released ones
+        while (m_ReleaseOrder.size() > MaxPooled)
+        {
+            m_Free.erase(m_Free.find(m_ReleaseOrder.front()));
+            m_ReleaseOrder.erase(m_ReleaseOrder.begin());
+        }
+    }
+
+    void AttachmentPool::Clear()
+    {
+        SGL_FUNCTION();
+
+        m_Free.clear();
+        m_ReleaseOrder.clear();
+    }
+
+    // =========================================================================
+
+    std::shared_ptr<Framebuffer> Framebuffer::Create(
+        const FramebufferSpec& spec)
+    {
+        return std::make_shared<Framebuffer>(spec);
+    }
+
+    // =========================================================================
+
+    Framebuffer::Framebuffer(const FramebufferSpec& spec)
+        : m_Spec(spec)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(spec.width > 0 && spec.height > 0 && spec.samples > 0);
+        SGL_ASSERT_MSG(spec.depth.format == 0 ||
+                       IsDepthFormat(spec.depth.format),
+                       "Depth attachment needs a depth format");
+
+        glCreateFramebuffers(1, &m_ID);
+        SGL_ASSERT(m_ID > 0);
+
+        // Without a texture to resolve into, it would be incomplete
+        const bool kResolved = IsResolved(spec.depth) ||
+            std::any_of(spec.colors.begin(), spec.colors.end(), IsResolved);
+        if (IsMultisampled() && kResolved)
+            glCreateFramebuffers(1, &m_ResolveID);
+
+        CreateAttachments();
+    }
+
+    Framebuffer::~Framebuffer()
+    {
+        SGL_FUNCTION();
+
+        ReleaseAttachments();
+
+        glDeleteFramebuffers(1, &m_ID);
+        if (m_ResolveID != 0)
+            glDeleteFramebuffers(1, &m_ResolveID);
+    }
+
+    void Framebuffer::Bind() const
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_ID);
+        glViewport(0, 0, m_Spec.width, m_Spec.height);
+    }
+
+    void Framebuffer::UnBind()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void Framebuffer::Resize(uint32_t width, uint32_t height)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(width > 0 && height > 0);
+
+        m_Spec.width = width;
+        m_Spec.height = height;
+
+        if (AttachmentPool::BucketSize(width) == m_BucketWidth &&
+            AttachmentPool::BucketSize(height) == m_BucketHeight)
+            return;
+
+        ReleaseAttachments();
+        CreateAttachments();
+    }
+
+    void Framebuffer::EndPass() const
+    {
+        SGL_FUNCTION();
+
+        Resolve();
+
+        if (!IsMultisampled())
+        {
+            InvalidateTransient();
+            return;
+        }
+
+        // A resolved copy now lives in the textures, so its multisampled
+        //  storage can be dropped, which saves writing it back on tiled
+        //  GPUs. The unresolved ones keep their contents, BlitTo reads them.
+        std::vector<GLenum> attachments;
+        for (uint32_t i = 0; i < m_Colors.size(); ++i)
+        {
+            const bool kResolved = i < m_ResolvedColors.size() &&
+                                   m_ResolvedColors[i].attachment;
+            if (m_Colors[i].transient || kResolved)
+                attachments.push_back(GL_COLOR_ATTACHMENT0 + i);
+        }
+        if (m_Depth.attachment &&
+            (m_Depth.transient || m_ResolvedDepth.attachment))
+            attachments.push_back(DepthAttachmentPoint(m_Spec.depth.format));
+
+        if (attachments.empty())
+            return;
+
+        glInvalidateNamedFramebufferData(m_ID,
+                                         static_cast<GLsizei>(
+                                             attachments.size()),
+                                         attachments.data());
+    }
+
+    void Framebuffer::Resolve() const
+    {
+        SGL_FUNCTION();
+
+        if (m_ResolveID == 0)
+            return;
+
+        const GLint kW = m_Spec.width;
+        const GLint kH = m_Spec.height;
+
+        for (uint32_t i = 0; i < m_ResolvedColors.size(); ++i)
+        {
+            if (!m_ResolvedColors[i].attachment)
+                continue;
+
+            glNamedFramebufferReadBuffer(m_ID, GL_COLOR_ATTACHMENT0 + i);
+            glNamedFramebufferDrawBuffer(m_ResolveID,
+                                         GL_COLOR_ATTACHMENT0 + i);
+            glBlitNamedFramebuffer(m_ID, m_ResolveID, 0, 0, kW, kH,
+                                   0, 0, kW, kH, GL_COLOR_BUFFER_BIT,
+                                   GL_NEAREST);
+        }
+
+        if (m_ResolvedDepth.attachment)
+        {
+            GLbitfield mask = GL_DEPTH_BUFFER_BIT;
+            if (DepthAttachmentPoint(m_Spec.depth.format) ==
+                GL_DEPTH_STENCIL_ATTACHMENT)
+                mask |= GL_STENCIL_BUFFER_BIT;
+
+            glBlitNamedFramebuffer(m_ID, m_ResolveID, 0, 0, kW, kH,
+                                   0, 0, kW, kH, mask, GL_NEAREST);
+        }
+
+        glNamedFramebufferReadBuffer(m_ID, m_Colors.empty()
+                                           ? GL_NONE
+                                           : GL_COLOR_ATTACHMENT0);
+    }
+
+    void Framebuffer::InvalidateTransient() const
+    {
+        SGL_FUNCTION();
+
+        std::vector<GLenum> attachments;
+        for (uint32_t i = 0; i < m_Colors.size(); ++i)
+        {
+            if (m_Colors[i].transient)
+                attachments.push_back(GL_COLOR_ATTACHMENT0 + i);
+        }
+        if (m_Depth.transient && m_Depth.attachment)
+            attachments.push_back(DepthAttachmentPoint(m_Spec.depth.format));
+
+        if (attachments.empty())
+            return;
+
+        glInvalidateNamedFramebufferData(m_ID,
+                                         static_cast<GLsizei>(
+                                             attachments.size()),
+                                         attachments.data());
+    }
+
+    void Framebuffer::BlitTo(uint32_t dstFramebuffer, uint32_t dstWidth,
+                             uint32_t dstHeight, uint32_t filter) const
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(!m_Colors.empty());
+
+        // The resolved texture, so a scaled blit works when multisampled.
+        //  An unresolved one is blitted from the multisampled storage.
+        const bool kResolved = IsMultisampled() &&
+                               m_ResolvedColors[0].attachment;
+        const uint32_t kSrc = kResolved ? m_ResolveID : m_ID;
+        glNamedFramebufferReadBuffer(kSrc, GL_COLOR_ATTACHMENT0);
+
+        glBlitNamedFramebuffer(kSrc, dstFramebuffer,
+                               0, 0, m_Spec.width, m_Spec.height,
+                               0, 0, dstWidth, dstHeight,
+                               GL_COLOR_BUFFER_BIT, filter);
+    }
+
+    std::shared_ptr<Texture2D> Framebuffer::GetColorTexture(
+        uint32_t index) const
+    {
+        SGL_ASSERT(index < m_Colors.size());
+
+        return IsMultisampled()
+            ? m_ResolvedColors[index].attachment.texture
+            : m_Colors[index].attachment.texture;
+    }
+
+    std::shared_ptr<Texture2D> Framebuffer::GetDepthTexture() const
+    {
+        return IsMultisampled()
+            ? m_ResolvedDepth.attachment.texture
+            : m_Depth.attachment.texture;
+    }
+
+    glm::vec2 Framebuffer::GetUVScale() const
+    {
+        return glm::vec2(float(m_Spec.width) / m_BucketWidth,
+                         float(m_Spec.height) / m_BucketHeight);
+    }
+
+    void Framebuffer::CreateAttachments()
+    {
+        SGL_FUNCTION();
+
+        m_BucketWidth = AttachmentPool::BucketSize(m_Spec.width);
+        m_BucketHeight = AttachmentPool::BucketSize(m_Spec.height);
+
+        std::vector<GLenum> drawBuffers;
+        for (uint32_t i = 0; i < m_Spec.colors.size(); ++i)
+        {
+            const AttachmentSpec& kSpec = m_Spec.colors[i];
+            const GLenum kPoint = GL_COLOR_ATTACHMENT0 + i;
+
+            m_Colors.push_back(AcquireTarget(kSpec, m_Spec.samples,
+                                             kSpec.type));
+            Attach(m_ID, kPoint, m_Colors.back().attachment);
+            drawBuffers.push_back(kPoint);
+
+            if (!IsMultisampled())
+                continue;
+
+            // Only textures are resolved, renderbuffers cannot be sampled
+            m_ResolvedColors.emplace_back();
+            if (IsResolved(kSpec))
+            {
+                m_ResolvedColors.back() = AcquireTarget(
+                    kSpec, 1, AttachmentType::Texture);
+                Attach(m_ResolveID, kPoint,
+                       m_ResolvedColors.back().attachment);
+            }
+        }
+
+        if (drawBuffers.empty())
+        {
+            glNamedFramebufferDrawBuffer(m_ID, GL_NONE);
+            glNamedFramebufferReadBuffer(m_ID, GL_NONE);
+        }
+        else
+        {
+            glNamedFramebufferDrawBuffers(m_ID,
+                                          static_cast<GLsizei>(
+                                              drawBuffers.size()),
+                                          drawBuffers.data());
+            glNamedFramebufferReadBuffer(m_ID, GL_COLOR_ATTACHMENT0);
+        }
+
+        const AttachmentSpec& kDepth = m_Spec.depth;
+        if (kDepth.format != 0)
+        {
+            const GLenum kPoint = DepthAttachmentPoint(kDepth.format);
+
+            m_Depth = AcquireTarget(kDepth, m_Spec.samples, kDepth.type);
+            Attach(m_ID, kPoint, m_Depth.attachment);
+
+            if (IsMultisampled() && IsResolved(kDepth))
+            {
+                m_ResolvedDepth = AcquireTarget(kDepth, 1,
+                                                AttachmentType::Texture);
+                Attach(m_ResolveID, kPoint, m_ResolvedDepth.attachment);
+            }
+        }
+
+        CheckStatus(m_ID);
+        if (m_ResolveID != 0)
+            CheckStatus(m_ResolveID);
+    }
+
+    void Framebuffer::ReleaseAttachments()
+    {
+        SGL_FUNCTION();
+
+        AttachmentPool& pool = AttachmentPool::Get();
+
+        for (auto& target : m_Colors)
+            pool.Release(target.key, std::move(target.attachment));
+        for (auto& target : m_ResolvedColors)
+            pool.Release(target.key, std::move(target.attachment));
+        pool.Release(m_Depth.key, std::move(m_Depth.attachment));
+        pool.Release(m_ResolvedDepth.key,
+                     std::move(m_ResolvedDepth.attachment));
+
+        m_Colors.clear();
+        m_ResolvedColors.clear();
+        m_Depth = Target();
+        m_ResolvedDepth = Target();
+    }
+
+    Framebuffer::Target Framebuffer::AcquireTarget(const AttachmentSpec& spec,
+                                                   uint32_t samples,
+                                                   AttachmentType type) const
+    {
+        SGL_FUNCTION();
+
+        // Multisampled textures would need sampler2DMS, so multisampled
+        //  attachments are always renderbuffers
+        if (samples > 1)
+            type = AttachmentType::Renderbuffer;
+
+        Target target;
+        target.key = { type, spec.format, samples,
+                       m_BucketWidth, m_BucketHeight };
+        target.attachment = AttachmentPool::Get().Acquire(target.key);
+        target.transient = spec.transient;
+
+        // Pooled textures may have been used with other sampling states
+        if (target.attachment.texture)
+        {
+            const GLenum kFilter = IsDepthFormat(spec.format) ? GL_NEAREST
+                                                              : GL_LINEAR;
+            target.attachment.texture->SetWrap(GL_CLAMP_TO_EDGE,
+                                               GL_CLAMP_TO_EDGE);
+            target.attachment.texture->SetFiltering(kFilter, kFilter);
+        }
+
+        return target;
+    }
+
+    void Framebuffer::Attach(uint32_t fbo, uint32_t attachmentPoint,
+                             const Attachment& attachment)
+    {
+        if (attachment.texture)
+        {
+            glNamedFramebufferTexture(fbo, attachmentPoint,
+                                      attachment.texture->GetID(), 0);
+        }
+        else
+        {
+            glNamedFramebufferRenderbuffer(fbo, attachmentPoint,
+                                           GL_RENDERBUFFER,
+                                           attachment.GetID());
+        }
+    }
+
+    uint32_t Framebuffer::DepthAttachmentPoint(uint32_t format)
+    {
+        return format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8
+            ? GL_DEPTH_STENCIL_ATTACHMENT
+            : GL_DEPTH_ATTACHMENT;
+    }
+
+    void Framebuffer::CheckStatus(uint32_t fbo) const
+    {
+        const GLenum kStatus = glCheckNamedFramebufferStatus(fbo,
+                                                             GL_FRAMEBUFFER);
+        if (kStatus != GL_FRAMEBUFFER_COMPLETE)
+        {
+            SGL_LOG_ERR("Framebuffer {} is incomplete, status: {:#x}",
+                        fbo, kStatus);
+        }
+    }
+
+} // namespace sgl
@@ -0,0 +1,220 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_OPENGL_FRAMEBUFFER_H_
+#define SGL_OPENGL_FRAMEBUFFER_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+
+namespace sgl
+{
+    class Texture2D;
+    class Renderbuffer;
+
+    enum class AttachmentType
+    {
+        Texture = 0,    ///< Texture2D, may be sampled after the pass
+        Renderbuffer    ///< Cannot be sampled, e.g. depth used only in a pass
+    };
+
+    struct AttachmentSpec
+    {
+        uint32_t format{ 0 };   ///< Sized internal format, 0 means none
+        AttachmentType type{ AttachmentType::Texture };
+
+        /// Contents are not needed after the pass, invalidated in "EndPass"
+        bool transient{ false };
+    };
+
+    struct FramebufferSpec
+    {
+        uint32_t width{ 0 };
+        uint32_t height{ 0 };
+
+        /// Sample count, above 1 the attachments are multisampled
+        ///  renderbuffers resolved into textures
+        uint32_t samples{ 1 };
+
+        std::vector<AttachmentSpec> colors;
+        AttachmentSpec depth;   ///< Depth or depth-stencil, optional
+    };
+
+    /** @brief Texture or renderbuffer storage of a framebuffer attachment */
+    struct Attachment
+    {
+        std::shared_ptr<Texture2D> texture;
+        std::shared_ptr<Renderbuffer> renderbuffer;
+
+        uint32_t GetID() const;
+        explicit operator bool() const { return texture || renderbuffer; }
+    };
+
+    /**
+     * @brief Keeps released attachments for reuse. Sizes are rounded up to
+     *  buckets, so resizing within a bucket keeps the same attachments, and
+     *  sizes visited before do not allocate again. Attachments still
+     *  referenced outside the framebuffer are not kept. Not thread-safe,
+     *  used only by the main thread with the main context current.
+     */
+    class AttachmentPool
+    {
+    public:
+        struct Key
+        {
+            AttachmentType type{ AttachmentType::Texture };
+            uint32_t format{ 0 };
+            uint32_t samples{ 1 };
+            uint32_t width{ 0 };    ///< Bucket width
+            uint32_t height{ 0 };   ///< Bucket height
+
+            bool operator<(const Key& o) const {
+                return std::tie(type, format, samples, width, height) <
+                       std::tie(o.type, o.format, o.samples, o.width,
+                                o.height);
+            }
+        };
+
+        /** @brief Granularity of the size buckets, in pixels */
+        static constexpr uint32_t BucketGranularity = 64;
+
+        /** @brief Max released attachments kept */
+        static constexpr uint32_t MaxPooled = 16;
+
+        /**
+         * @brief Pool of the main context, cleared by "~Application"
+         *  before the context is destroyed
+         */
+        static AttachmentPool& Get();
+
+        static uint32_t BucketSize(uint32_t size);
+
+    public:
+        /** @brief Reuses a released attachment, or creates a new one */
+        Attachment Acquire(const Key& key);
+        void Release(const Key& key, Attachment attachment);
+
+        /** @brief Deletes all released attachments */
+        void Clear();
+
+    private:
+        std::multimap<Key, Attachment> m_Free;
+        std::vector<Key> m_ReleaseOrder;    ///< Oldest first
+    };
+
+    /**
+     * @brief Render target with color and depth attachments.
+     *  Attachments are allocated in size buckets, so the rendered area may
+     *  be smaller than the attachments, @see GetUVScale.
+     */
+    class Framebuffer
+    {
+    public:
+        static std::shared_ptr<Framebuffer> Create(const FramebufferSpec& spec);
+
+    public:
+        Framebuffer(const FramebufferSpec& spec);
+        ~Framebuffer();
+
+        /** @brief Binds for drawing and reading, sets the viewport */
+        void Bind() const;
+
+        /**
+         * @brief Binds framebuffer 0, use Window::BindDefaultFramebuffer
+         *  when headless
+         */
+        static void UnBind();
+
+        /** @brief Reuses the attachments if the size stays within a bucket */
+        void Resize(uint32_t width, uint32_t height);
+
+        /**
+         * @brief Resolves the multisampled attachments, then invalidates
+         *  the transient ones and the multisampled storage of the resolved
+         *  ones. Call after the last draw of the pass.
+         */
+        void EndPass() const;
+
+        /** @brief Blits multisampled attachments into the textures */
+        void Resolve() const;
+
+        /** @brief Invalidates the attachments marked as transient */
+        void InvalidateTransient() const;
+
+        /**
+         * @brief Blits the first color attachment (resolved) into another
+         *  framebuffer, e.g. the default one. If it is not resolved, e.g. a
+         *  renderbuffer, the sizes must match, multisampled blits cannot
+         *  scale.
+         */
+        void BlitTo(uint32_t dstFramebuffer, uint32_t dstWidth,
+                    uint32_t dstHeight, uint32_t filter = GL_LINEAR) const;
+
+        /**
+         * @return Sampleable texture, resolved if multisampled. A texture
+         *  still held on "Resize" or destruction is not reused by the pool.
+         */
+        std::shared_ptr<Texture2D> GetColorTexture(uint32_t index = 0) const;
+        std::shared_ptr<Texture2D> GetDepthTexture() const;
+
+        /**
+         * @return Scale of the UVs to sample only the rendered area of the
+         *  attachment textures
+         */
+        glm::vec2 GetUVScale() const;
+
+        uint32_t GetID() const { return m_ID; }
+        uint32_t GetWidth() const { return m_Spec.width; }
+        uint32_t GetHeight() const { return m_Spec.height; }
+        uint32_t GetSamples() const { return m_Spec.samples; }
+        bool IsMultisampled() const { return m_Spec.samples > 1; }
+
+    private:
+        struct Target
+        {
+            AttachmentPool::Key key;
+            Attachment attachment;
+            bool transient{ false };
+        };
+
+        void CreateAttachments();
+        void ReleaseAttachments();
+
+        Target AcquireTarget(const AttachmentSpec& spec, uint32_t samples,
+                             AttachmentType type) const;
+
+        static void Attach(uint32_t fbo, uint32_t attachmentPoint,
+                           const Attachment& attachment);
+
+        static uint32_t DepthAttachmentPoint(uint32_t format);
+
+        void CheckStatus(uint32_t fbo) const;
+
+    private:
+        uint32_t m_ID{ 0 };
+        /// Single sampled, when multisampled and something is resolved
+        uint32_t m_ResolveID{ 0 };
+
+        FramebufferSpec m_Spec;
+        uint32_t m_BucketWidth{ 0 };
+        uint32_t m_BucketHeight{ 0 };
+
+        std::vector<Target> m_Colors;
+        Target m_Depth;
+
+        std::vector<Target> m_ResolvedColors;
+        Target m_ResolvedDepth;
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_OPENGL_FRAMEBUFFER_H_
@@ -5,6 +5,8 @@
 
 #include "SGL/pch.h"
 #include <SGL/opengl/IndexBuffer.h>
+#include <SGL/core/Profiler.h>
+#include <SGL/core/RenderStats.h>
 
 
 namespace sgl
@@ -21,6 +23,7 @@ namespace sgl
         : m_IndicesCount(indicesCount)
     {
         SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Upload IndexBuffer");
 
         glCreateBuffers(1, &m_ID);
 
@@ -28,6 +31,9 @@ namespace sgl
                              indicesCount * sizeof(uint32_t),
                              indices,
                              GL_DYNAMIC_STORAGE_BIT);
+
+        if (indices != nullptr)
+            SGL_RENDER_STAT(bytesUploaded, indicesCount * sizeof(uint32_t));
     }
     
     IndexBuffer::~IndexBuffer()
@@ -0,0 +1,296 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/opengl/ReadbackQueue.h"
+#include "SGL/opengl/Texture2D.h"
+
+
+namespace sgl
+{
+    std::shared_ptr<ReadbackQueue> ReadbackQueue::Create(uint32_t ringSize)
+    {
+        return std::make_shared<ReadbackQueue>(ringSize);
+    }
+
+    // =========================================================================
+
+    ReadbackQueue::ReadbackQueue(uint32_t ringSize)
+        : m_Slots(std::max(ringSize, 1u))
+    {
+        SGL_FUNCTION();
+    }
+
+    ReadbackQueue::~ReadbackQueue()
+    {
+        SGL_FUNCTION();
+
+        // Pending callbacks may own resources, so they are still called
+        Flush();
+
+        for (auto& slot : m_Slots)
+            DeleteBuffer(slot);
+    }
+
+    uint64_t ReadbackQueue::ReadFramebuffer(uint32_t framebuffer,
+                                            int32_t x, int32_t y,
+                                            uint32_t width, uint32_t height,
+                                            ReadbackCallback callback,
+                                            uint32_t format, uint32_t type)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(width > 0 && height > 0 && callback);
+
+        Slot* slot = AcquireSlot(size_t(width) * height
+                                 * PixelSize(format, type));
+        if (slot == nullptr)
+            return 0;
+
+        GLint prevRead = 0;
+        GLint prevAlignment = 4;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prevRead);
+        glGetIntegerv(GL_PACK_ALIGNMENT, &prevAlignment);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+        // With a pack buffer bound, the pointer is an offset into it
+        glReadPixels(x, y, width, height, format, type, nullptr);
+
+        glPixelStorei(GL_PACK_ALIGNMENT, prevAlignment);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, prevRead);
+
+        return Submit(*slot, width, height, format, type,
+                      std::move(callback));
+    }
+
+    uint64_t ReadbackQueue::ReadTexture(const Texture2D& texture,
+                                        ReadbackCallback callback,
+                                        uint32_t level,
+                                        uint32_t format, uint32_t type)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(level < texture.GetMipLevels() && callback);
+
+        const uint32_t kWidth = std::max(texture.GetWidth() >> level, 1u);
+        const uint32_t kHeight = std::max(texture.GetHeight() >> level, 1u);
+        const size_t kSize = size_t(kWidth) * kHeight
+                             * PixelSize(format, type);
+
+        Slot* slot = AcquireSlot(kSize);
+        if (slot == nullptr)
+            return 0;
+
+        GLint prevAlignment = 4;
+        glGetIntegerv(GL_PACK_ALIGNMENT, &prevAlignment);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+        glGetTextureImage(texture.GetID(), level, format, type,
+                          static_cast<GLsizei>(kSize), nullptr);
+
+        glPixelStorei(GL_PACK_ALIGNMENT, prevAlignment);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        return Submit(*slot, kWidth, kHeight, format, type,
+                      std::move(callback));
+    }
+
+    uint32_t ReadbackQueue::Poll()
+    {
+        SGL_FUNCTION();
+
+        // Called by a read of a callback, the oldest slot is in use
+        if (m_Delivering)
+            return 0;
+
+        uint32_t delivered = 0;
+        while (m_Pending > 0)
+        {
+            Slot& slot = m_Slots[m_Oldest];
+
+            // Flushes, so that the fence is sure to signal eventually
+            const GLenum kStatus = glClientWaitSync(
+                slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            SGL_ASSERT_MSG(kStatus != GL_WAIT_FAILED,
+                           "Waiting on a readback fence failed");
+
+            // Later reads cannot be done before this one
+            if (kStatus == GL_TIMEOUT_EXPIRED)
+                break;
+
+            Deliver(slot);
+            ++delivered;
+        }
+
+        return delivered;
+    }
+
+    void ReadbackQueue::Flush()
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT_MSG(!m_Delivering, "Readbacks flushed from a callback");
+
+        // One second, waits in a loop as the driver may cap the timeout
+        const GLuint64 kTimeoutNanos = 1000000000;
+
+        while (m_Pending > 0)
+        {
+            Slot& slot = m_Slots[m_Oldest];
+
+            GLenum status = glClientWaitSync(slot.fence,
+                                             GL_SYNC_FLUSH_COMMANDS_BIT,
+                                             kTimeoutNanos);
+            while (status == GL_TIMEOUT_EXPIRED)
+                status = glClientWaitSync(slot.fence, 0, kTimeoutNanos);
+
+            SGL_ASSERT_MSG(status != GL_WAIT_FAILED,
+                           "Waiting on a readback fence failed");
+
+            Deliver(slot);
+        }
+    }
+
+    uint32_t ReadbackQueue::PixelSize(uint32_t format, uint32_t type)
+    {
+        uint32_t components = 0;
+        switch (format)
+        {
+        case GL_RED: case GL_GREEN: case GL_BLUE:
+        case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX:
+            components = 1;
+            break;
+        case GL_RG: case GL_RG_INTEGER:
+            components = 2;
+            break;
+        case GL_RGB: case GL_BGR: case GL_RGB_INTEGER:
+            components = 3;
+            break;
+        case GL_RGBA: case GL_BGRA: case GL_RGBA_INTEGER:
+            components = 4;
+            break;
+        default:
+            SGL_ASSERT_MSG(false, "Unsupported readback pixel format");
+        }
+
+        switch (type)
+        {
+        case GL_UNSIGNED_BYTE: case GL_BYTE:
+            return components;
+        case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+            return components * 2;
+        case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT:
+            return components * 4;
+        case GL_UNSIGNED_INT_24_8:
+            return 4;
+        default:
+            SGL_ASSERT_MSG(false, "Unsupported readback pixel type");
+        }
+
+        return 0;
+    }
+
+    ReadbackQueue::Slot* ReadbackQueue::AcquireSlot(size_t size)
+    {
+        // Frees the slots the GPU is done with first
+        if (m_Pending == m_Slots.size())
+            Poll();
+
+        if (m_Pending == m_Slots.size())
+        {
+            ++m_Dropped;
+            SGL_LOG_WARN("Readback dropped, all {} buffers are in flight",
+                         m_Slots.size());
+            return nullptr;
+        }
+
+        Slot& slot = m_Slots[m_Next];
+        Reserve(slot, size);
+
+        return &slot;
+    }
+
+    uint64_t ReadbackQueue::Submit(Slot& slot, uint32_t width,
+                                   uint32_t height, uint32_t format,
+                                   uint32_t type, ReadbackCallback callback)
+    {
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        slot.image.width = width;
+        slot.image.height = height;
+        slot.image.format = format;
+        slot.image.type = type;
+        slot.image.data = slot.mapped;
+        slot.image.size = size_t(width) * height * PixelSize(format, type);
+        slot.image.id = m_NextID++;
+        slot.callback = std::move(callback);
+
+        m_Next = (m_Next + 1) % m_Slots.size();
+        ++m_Pending;
+
+        return slot.image.id;
+    }
+
+    void ReadbackQueue::Deliver(Slot& slot)
+    {
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        // Moved out first, the callback may issue new reads. The slot is
+        //  freed once it returns, so that a new read cannot reuse the
+        //  buffer of the image being delivered.
+        ReadbackCallback callback = std::move(slot.callback);
+        slot.callback = nullptr;
+
+        m_Delivering = true;
+        callback(slot.image);
+        m_Delivering = false;
+
+        m_Oldest = (m_Oldest + 1) % m_Slots.size();
+        --m_Pending;
+    }
+
+    void ReadbackQueue::Reserve(Slot& slot, size_t size)
+    {
+        if (slot.capacity >= size)
+            return;
+
+        DeleteBuffer(slot);
+
+        // Persistently mapped, coherent, so the data can be read as soon
+        //  as the fence signals, without mapping each time
+        const GLbitfield kFlags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT
+                                  | GL_MAP_COHERENT_BIT;
+
+        glCreateBuffers(1, &slot.buffer);
+        SGL_ASSERT(slot.buffer > 0);
+
+        glNamedBufferStorage(slot.buffer, size, nullptr,
+                             kFlags | GL_CLIENT_STORAGE_BIT);
+        slot.mapped = static_cast<const unsigned char*>(
+            glMapNamedBufferRange(slot.buffer, 0, size, kFlags));
+        SGL_ASSERT_MSG(slot.mapped != nullptr,
+                       "Could not map the readback buffer");
+
+        slot.capacity = size;
+    }
+
+    void ReadbackQueue::DeleteBuffer(Slot& slot)
+    {
+        if (slot.buffer == 0)
+            return;
+
+        glUnmapNamedBuffer(slot.buffer);
+        glDeleteBuffers(1, &slot.buffer);
+
+        slot.buffer = 0;
+        slot.capacity = 0;
+        slot.mapped = nullptr;
+    }
+
+} // namespace sgl
@@ -0,0 +1,140 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_OPENGL_READBACK_QUEUE_H_
+#define SGL_OPENGL_READBACK_QUEUE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+
+namespace sgl
+{
+    class Texture2D;
+
+    /** @brief Pixels of a finished readback, valid only in the callback */
+    struct ReadbackImage
+    {
+        uint32_t width{ 0 };
+        uint32_t height{ 0 };
+        uint32_t format{ 0 };   ///< Pixel format, e.g. GL_RGBA
+        uint32_t type{ 0 };     ///< Component type, e.g. GL_UNSIGNED_BYTE
+
+        /// Tightly packed rows, bottom to top
+        const unsigned char* data{ nullptr };
+        size_t size{ 0 };       ///< In **bytes**
+
+        uint64_t id{ 0 };       ///< Returned by the Read call
+    };
+
+    using ReadbackCallback = std::function<void(const ReadbackImage&)>;
+
+    /**
+     * @brief Reads pixels without stalling. Each read copies into a pixel
+     *  pack buffer of a ring and is fenced, the data is handed to the
+     *  callback from "Poll", once the GPU is done, usually a frame or more
+     *  later. Callbacks are called in the order of the reads. They may
+     *  issue reads, the buffer of the image they get stays in flight
+     *  until they return.
+     */
+    class ReadbackQueue
+    {
+    public:
+        /** @brief Default number of reads in flight */
+        static constexpr uint32_t DefaultRingSize = 3;
+
+        static std::shared_ptr<ReadbackQueue> Create(
+            uint32_t ringSize = DefaultRingSize);
+
+    public:
+        ReadbackQueue(uint32_t ringSize = DefaultRingSize);
+        ~ReadbackQueue();
+
+        ReadbackQueue(const ReadbackQueue&) = delete;
+        ReadbackQueue& operator=(const ReadbackQueue&) = delete;
+
+        /**
+         * @brief Reads a region of a framebuffer's read buffer
+         * @param framebuffer 0 or Window::GetFramebufferID for the default
+         * @return Id passed to the callback, 0 if all buffers are in
+         *  flight and the read was dropped
+         */
+        uint64_t ReadFramebuffer(uint32_t framebuffer,
+                                 int32_t x, int32_t y,
+                                 uint32_t width, uint32_t height,
+                                 ReadbackCallback callback,
+                                 uint32_t format = GL_RGBA,
+                                 uint32_t type = GL_UNSIGNED_BYTE);
+
+        /**
+         * @brief Reads a mip level of a texture
+         * @return Id passed to the callback, 0 if all buffers are in
+         *  flight and the read was dropped
+         */
+        uint64_t ReadTexture(const Texture2D& texture,
+                             ReadbackCallback callback,
+                             uint32_t level = 0,
+                             uint32_t format = GL_RGBA,
+                             uint32_t type = GL_UNSIGNED_BYTE);
+
+        /**
+         * @brief Hands finished reads to their callbacks, does not block
+         * @return Number of delivered reads
+         */
+        uint32_t Poll();
+
+        /** @brief Blocks until all reads in flight are delivered */
+        void Flush();
+
+        uint32_t GetRingSize() const {
+            return static_cast<uint32_t>(m_Slots.size());
+        }
+        uint32_t GetPendingCount() const { return m_Pending; }
+        uint64_t GetDroppedCount() const { return m_Dropped; }
+
+        /** @return Bytes of a tightly packed pixel */
+        static uint32_t PixelSize(uint32_t format, uint32_t type);
+
+    private:
+        struct Slot
+        {
+            uint32_t buffer{ 0 };
+            size_t capacity{ 0 };
+            const unsigned char* mapped{ nullptr };
+
+            GLsync fence{ nullptr };
+            ReadbackImage image;
+            ReadbackCallback callback;
+        };
+
+        /** @return Free slot with the capacity, null if all are in flight */
+        Slot* AcquireSlot(size_t size);
+
+        uint64_t Submit(Slot& slot, uint32_t width, uint32_t height,
+                        uint32_t format, uint32_t type,
+                        ReadbackCallback callback);
+
+        void Deliver(Slot& slot);
+
+        static void Reserve(Slot& slot, size_t size);
+        static void DeleteBuffer(Slot& slot);
+
+    private:
+        std::vector<Slot> m_Slots;
+        uint32_t m_Next{ 0 };       ///< Next slot to write
+        uint32_t m_Oldest{ 0 };     ///< Next slot to deliver
+        uint32_t m_Pending{ 0 };
+        bool m_Delivering{ false }; ///< In a callback, the slot is in use
+
+        uint64_t m_NextID{ 1 };
+        uint64_t m_Dropped{ 0 };
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_OPENGL_READBACK_QUEUE_H_
@@ -0,0 +1,47 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include <SGL/opengl/Renderbuffer.h>
+
+
+namespace sgl
+{
+    std::shared_ptr<Renderbuffer> Renderbuffer::Create(
+        uint32_t width, uint32_t height, uint32_t format, uint32_t samples)
+    {
+        return std::make_shared<Renderbuffer>(width, height, format, samples);
+    }
+
+    // =========================================================================
+
+    Renderbuffer::Renderbuffer(uint32_t width, uint32_t height,
+                               uint32_t format, uint32_t samples)
+        : m_Width(width),
+          m_Height(height),
+          m_Format(format),
+          m_Samples(samples)
+    {
+        SGL_FUNCTION();
+
+        glCreateRenderbuffers(1, &m_ID);
+        SGL_ASSERT(m_ID > 0);
+
+        if (samples > 1)
+            glNamedRenderbufferStorageMultisample(m_ID, samples, format,
+                                                  width, height);
+        else
+            glNamedRenderbufferStorage(m_ID, format, width, height);
+    }
+
+    Renderbuffer::~Renderbuffer()
+    {
+        SGL_FUNCTION();
+
+        glDeleteRenderbuffers(1, &m_ID);
+        m_ID = 0;
+    }
+
+} // namespace sgl
@@ -0,0 +1,55 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_OPENGL_RENDERBUFFER_H_
+#define SGL_OPENGL_RENDERBUFFER_H_
+
+#include <cstdint>
+#include <memory>
+
+
+namespace sgl
+{
+    /**
+     * @brief Render target storage that cannot be sampled, may be
+     *  multisampled
+     */
+    class Renderbuffer
+    {
+    public:
+        static std::shared_ptr<Renderbuffer> Create(uint32_t width,
+                                                    uint32_t height,
+                                                    uint32_t format,
+                                                    uint32_t samples = 1);
+    public:
+        /**
+         * @param format Sized internal format, e.g. GL_RGBA8
+         * @param samples Sample count, 1 is not multisampled
+         */
+        Renderbuffer(uint32_t width,
+                     uint32_t height,
+                     uint32_t format,
+                     uint32_t samples = 1);
+        ~Renderbuffer();
+
+        uint32_t GetID() const { return m_ID; }
+        uint32_t GetWidth() const { return m_Width; }
+        uint32_t GetHeight() const { return m_Height; }
+        uint32_t GetFormat() const { return m_Format; }
+        uint32_t GetSamples() const { return m_Samples; }
+
+    private:
+        uint32_t m_ID{ 0 };
+
+        uint32_t m_Width{ 0 };
+        uint32_t m_Height{ 0 };
+        uint32_t m_Format{ 0 };
+        uint32_t m_Samples{ 1 };
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_OPENGL_RENDERBUFFER_H_
@@ -6,6 +6,8 @@
 #include "SGL/pch.h"
 #include <SGL/opengl/Shader.h>
 #include <SGL/opengl/ShaderObject.h>
+#include <SGL/core/Profiler.h>
+#include <SGL/core/RenderStats.h>
 
 
 namespace sgl
@@ -92,6 +94,7 @@ namespace sgl
     void Shader::LinkProgram() const
     {
         SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Link Shader");
 
         glLinkProgram(m_ID);
 
@@ -102,6 +105,7 @@ namespace sgl
     void Shader::Use() const
     {
         glUseProgram(m_ID);
+        SGL_RENDER_STAT(programBinds, 1);
     }
     void Shader::UnUse() const
     {
@@ -112,6 +116,7 @@ namespace sgl
     {
         const GLint kLocation = glGetUniformLocation(m_ID, name.c_str());
         glUniform1i(kLocation, value);
+        SGL_RENDER_STAT(uniformUpdates, 1);
     }
 
     void Shader::SetIntArray(const std::string& name, int* values,
@@ -119,42 +124,49 @@ namespace sgl
     {
         const GLint kLocation = glGetUniformLocation(m_ID, name.c_str());
         glUniform1iv(kLocation, count, values);
+        SGL_RENDER_STAT(uniformUpdates, 1);
     }
 
     void Shader::SetFloat(const std::string& name, float value) const
     {
         const GLint kLocation = glGetUniformLocation(m_ID, name.c_str());
         glUniform1f(kLocation, value);
+        SGL_RENDER_STAT(uniformUpdates, 1);
     }
 
     void Shader::SetFloat2(const std::string& name, const glm::vec2& value) const
     {
         const GLint kLocation = glGetUniformLocation(m_ID, name.c_str());
         glUniform2f(kLocation, value.x, value.y);
+        SGL_RENDER_STAT(uniformUpdates, 1);
     }
 
     void Shader::SetFloat3(const std::string& name, const glm::vec3& value) const
     {
         const GLint kLocation = glGetUniformLocation(m_ID, name.c_str());
         glUniform3f(kLocation, value.x, value.y, value.z);
+        SGL_RENDER_STAT(uniformUpdates, 1);
     }
 
     void Shader::SetFloat4(const std::string& name, const glm::vec4& value) const
     {
         const GLint kLocation = glGetUniformLocation(m_ID, name.c_str());
         glUniform4f(kLocation, value.x, value.y, value.z, value.w);
+        SGL_RENDER_STAT(uniformUpdates, 1);
     }
 
     void Shader::SetMat3(const std::string& name, const glm::mat3& mat) const
     {
         const GLint kLocation = glGetUniformLocation(m_ID, name.c_str());
         glUniformMatrix3fv(kLocation, 1, GL_FALSE, glm::value_ptr(mat));
+        SGL_RENDER_STAT(uniformUpdates, 1);
     }
 
     void Shader::SetMat4(const std::string& name, const glm::mat4& mat) const
     {
         const GLint kLocation = glGetUniformLocation(m_ID, name.c_str());
         glUniformMatrix4fv(kLocation, 1, GL_FALSE, glm::value_ptr(mat));
+        SGL_RENDER_STAT(uniformUpdates, 1);
     }
 
     int Shader::CheckLinkErrors() const
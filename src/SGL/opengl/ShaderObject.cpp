@@ -5,6 +5,7 @@
 
 #include "SGL/pch.h"
 #include <SGL/opengl/ShaderObject.h>
+#include <SGL/core/Profiler.h>
 
 
 namespace sgl
@@ -85,6 +86,7 @@ namespace sgl
     void ShaderObject::Compile() const
     {
         SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Compile ShaderObject");
 
         {
             const Timer compileTime;
@@ -0,0 +1,143 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/opengl/StagingRing.h"
+
+
+namespace sgl
+{
+    static size_t AlignUp(size_t offset)
+    {
+        return (offset + StagingRing::Alignment - 1)
+               & ~(StagingRing::Alignment - 1);
+    }
+
+    std::shared_ptr<StagingRing> StagingRing::Create(size_t size)
+    {
+        return std::make_shared<StagingRing>(size);
+    }
+
+    // =========================================================================
+
+    StagingRing::StagingRing(size_t size)
+        : m_Size(size)
+    {
+        SGL_FUNCTION();
+
+        if (m_Size == 0)
+            return;
+
+        const GLbitfield kFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT
+                                  | GL_MAP_COHERENT_BIT;
+
+        glCreateBuffers(1, &m_Buffer);
+        glNamedBufferStorage(m_Buffer, m_Size, nullptr, kFlags);
+        m_Data = static_cast<unsigned char*>(glMapNamedBufferRange(
+            m_Buffer, 0, m_Size, kFlags));
+        SGL_ASSERT_MSG(m_Data != nullptr,
+                       "Could not map the staging buffer");
+    }
+
+    StagingRing::~StagingRing()
+    {
+        SGL_FUNCTION();
+
+        while (!m_InFlight.empty())
+            Release(true);
+
+        if (m_Buffer != 0)
+        {
+            glUnmapNamedBuffer(m_Buffer);
+            glDeleteBuffers(1, &m_Buffer);
+        }
+    }
+
+    size_t StagingRing::Allocate(size_t size)
+    {
+        if (size == 0 || size > m_Size)
+            return m_Size;
+
+        // Nothing in use, starts over for the largest contiguous range
+        if (m_InFlight.empty() && m_BatchBegin == m_Head)
+        {
+            m_Head = 0;
+            m_BatchBegin = 0;
+        }
+
+        const size_t kTail = m_InFlight.empty() ? m_BatchBegin
+                                                : m_InFlight.front().begin;
+        const bool kUsed = !m_InFlight.empty() || m_BatchBegin != m_Head;
+
+        // The used range runs from the tail to the head, it may wrap.
+        //  Ranges never fill the ring up to the tail, so that a full ring
+        //  differs from an empty one. The head moves to the aligned end of
+        //  a range, that end is what has to stay below the tail.
+        size_t offset = m_Head;
+        if (!kUsed || m_Head >= kTail)
+        {
+            if (offset + size > m_Size)
+            {
+                offset = 0;
+                if (kUsed && AlignUp(size) >= kTail)
+                    return m_Size;
+            }
+        }
+        else if (AlignUp(offset + size) >= kTail)
+        {
+            return m_Size;
+        }
+
+        // At the end of the ring, the next range wraps
+        m_Head = std::min(AlignUp(offset + size), m_Size);
+
+        return offset;
+    }
+
+    void StagingRing::Commit()
+    {
+        if (m_Head == m_BatchBegin)
+            return;
+
+        Batch batch;
+        batch.begin = m_BatchBegin;
+        batch.end = m_Head;
+        batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_InFlight.push_back(batch);
+
+        m_BatchBegin = m_Head;
+    }
+
+    void StagingRing::Release(bool wait)
+    {
+        // One second, waits in a loop as the driver may cap the timeout
+        const GLuint64 kTimeout = wait ? 1000000000 : 0;
+
+        while (!m_InFlight.empty())
+        {
+            Batch& batch = m_InFlight.front();
+
+            const GLenum kStatus = glClientWaitSync(
+                batch.fence, GL_SYNC_FLUSH_COMMANDS_BIT, kTimeout);
+            SGL_ASSERT_MSG(kStatus != GL_WAIT_FAILED,
+                           "Waiting on a staging fence failed");
+
+            if (kStatus == GL_TIMEOUT_EXPIRED)
+            {
+                if (!wait)
+                    return;
+                continue;
+            }
+
+            glDeleteSync(batch.fence);
+            m_InFlight.pop_front();
+
+            // A wait frees one range, the caller retries
+            if (wait)
+                return;
+        }
+    }
+
+} // namespace sgl
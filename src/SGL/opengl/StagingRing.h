@@ -0,0 +1,85 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_OPENGL_STAGING_RING_H_
+#define SGL_OPENGL_STAGING_RING_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+
+namespace sgl
+{
+    /**
+     * @brief Persistently mapped pixel unpack buffer used as a ring. Ranges
+     *  are written by the CPU, read by upload commands, and fenced in
+     *  batches, a batch is reused once the GPU has passed its fence.
+     *  Must be used from the GL thread.
+     */
+    class StagingRing
+    {
+    public:
+        /** @brief Ranges start at multiples of it, for the DMA copy */
+        static constexpr size_t Alignment = 256;
+
+        static std::shared_ptr<StagingRing> Create(size_t size);
+
+    public:
+        /** @param size In **bytes**, 0 creates no buffer, nothing fits */
+        StagingRing(size_t size);
+
+        /** @brief Waits for the GPU to be done with the ranges */
+        ~StagingRing();
+
+        StagingRing(const StagingRing&) = delete;
+        StagingRing& operator=(const StagingRing&) = delete;
+
+        /**
+         * @return Offset of a free range, or "GetSize()" if the ring has no
+         *  room for it now, or ever if it is larger than the ring
+         */
+        size_t Allocate(size_t size);
+
+        /** @brief Fences the ranges allocated since the last call, call
+         *  after the commands reading them */
+        void Commit();
+
+        /**
+         * @brief Frees the ranges the GPU is done with
+         * @param wait Blocks until the oldest batch is freed, if any
+         */
+        void Release(bool wait);
+
+        uint32_t GetBuffer() const { return m_Buffer; }
+        size_t GetSize() const { return m_Size; }
+        /** @return Mapped range at an offset returned by "Allocate" */
+        unsigned char* GetData(size_t offset) const {
+            return m_Data + offset;
+        }
+        /** @return Whether batches are waiting for the GPU */
+        bool IsBusy() const { return !m_InFlight.empty(); }
+
+    private:
+        /** @brief Range the GPU may still read */
+        struct Batch
+        {
+            size_t begin{ 0 };
+            size_t end{ 0 };
+            GLsync fence{ nullptr };
+        };
+
+        uint32_t m_Buffer{ 0 };
+        unsigned char* m_Data{ nullptr };
+        size_t m_Size{ 0 };
+        size_t m_Head{ 0 };                 ///< Next byte to write
+        std::deque<Batch> m_InFlight;       ///< Oldest first
+        size_t m_BatchBegin{ 0 };           ///< Of the current batch
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_OPENGL_STAGING_RING_H_
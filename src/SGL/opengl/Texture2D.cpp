@@ -6,6 +6,10 @@
 
 #include "SGL/pch.h"
 #include "SGL/opengl/Texture2D.h"
+#include "SGL/opengl/TextureFormat.h"
+#include "SGL/core/Profiler.h"
+#include "SGL/core/RenderStats.h"
+#include "SGL/image/MipChain.h"
 
 
 namespace sgl
@@ -24,12 +28,28 @@ namespace sgl
                                            imageFormat, mipmaps);
     }
 
+    std::shared_ptr<Texture2D> Texture2D::Create(
+        uint32_t width, uint32_t height, uint32_t format,
+        const CompressedLevel* levels, uint32_t levelCount)
+    {
+        return std::make_shared<Texture2D>(width, height, format, levels,
+                                           levelCount);
+    }
+
+    std::shared_ptr<Texture2D> Texture2D::Create(const MipChain& chain,
+                                                 uint32_t format,
+                                                 uint32_t imageFormat)
+    {
+        return std::make_shared<Texture2D>(chain, format, imageFormat);
+    }
+
     const uint32_t Texture2D::DEFAULT_WRAP_S = GL_REPEAT;
     const uint32_t Texture2D::DEFAULT_WRAP_T = GL_REPEAT;
     const uint32_t Texture2D::DEFAULT_MIN_FILTER = GL_LINEAR;
     const uint32_t Texture2D::DEFAULT_MIN_FILTER_MIPMAP 
         = GL_LINEAR_MIPMAP_LINEAR;
     const uint32_t Texture2D::DEFAULT_MAG_FILTER = GL_LINEAR;
+    const float Texture2D::DEFAULT_MIN_LOD = -1000.0f;
 
     // =========================================================================
 
@@ -51,7 +71,38 @@ namespace sgl
         Init(width, height, format, imageFormat, mipmaps);
         CreateTexture();
         SetDataImmutable(data);
-        GenMipMaps();
+        if (data != nullptr)
+            GenMipMaps();
+
+        ApplyFiltering();
+    }
+
+    Texture2D::Texture2D(uint32_t width,
+                         uint32_t height,
+                         uint32_t format,
+                         const CompressedLevel* levels,
+                         uint32_t levelCount)
+    {
+        SGL_FUNCTION();
+
+        InitCompressed(width, height, format, levelCount);
+        CreateTexture();
+        SetCompressedLevels(levels);
+
+        ApplyFiltering();
+    }
+
+    Texture2D::Texture2D(const MipChain& chain, uint32_t format,
+                         uint32_t imageFormat)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(!chain.Empty());
+
+        Init(chain.levels[0].width, chain.levels[0].height, format,
+             imageFormat, chain.GetLevelCount() > 1);
+        m_MipLevels = chain.GetLevelCount();
+        CreateTexture();
+        SetMipLevels(chain);
 
         ApplyFiltering();
     }
@@ -65,11 +116,13 @@ namespace sgl
     void Texture2D::Bind() const
     {
         glBindTexture(GL_TEXTURE_2D, m_ID);
+        SGL_RENDER_STAT(textureBinds, 1);
     }
 
     void Texture2D::BindUnit(uint32_t unit) const
     {
         glBindTextureUnit(unit, m_ID);
+        SGL_RENDER_STAT(textureBinds, 1);
     }
 
     void Texture2D::UnBind()
@@ -87,11 +140,80 @@ namespace sgl
                              uint32_t imageFormat, bool mipmaps)
     {
         SGL_FUNCTION();
+
+        // Immutable storage cannot be respecified, the texture is replaced
+        if (m_Width != 0)
+        {
+            DeleteTexture();
+            CreateTexture();
+        }
+
         Init(width, height, format, imageFormat, mipmaps);
 
         SetDataImmutable(data);
-        GenMipMaps();
-        ApplyFiltering();
+        if (data != nullptr)
+            GenMipMaps();
+        ApplySampler();
+    }
+
+    void Texture2D::SetCompressedImage(uint32_t width, uint32_t height,
+                                       uint32_t format,
+                                       const CompressedLevel* levels,
+                                       uint32_t levelCount)
+    {
+        SGL_FUNCTION();
+
+        if (m_Width != 0)
+        {
+            DeleteTexture();
+            CreateTexture();
+        }
+
+        InitCompressed(width, height, format, levelCount);
+
+        SetCompressedLevels(levels);
+        ApplySampler();
+    }
+
+    void Texture2D::SetMipChain(const MipChain& chain, uint32_t format,
+                                uint32_t imageFormat)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(!chain.Empty());
+
+        if (m_Width != 0)
+        {
+            DeleteTexture();
+            CreateTexture();
+        }
+
+        Init(chain.levels[0].width, chain.levels[0].height, format,
+             imageFormat, chain.GetLevelCount() > 1);
+        m_MipLevels = chain.GetLevelCount();
+
+        SetMipLevels(chain);
+        ApplySampler();
+    }
+
+    void Texture2D::SetStorage(uint32_t width, uint32_t height,
+                               uint32_t levelCount, uint32_t format,
+                               uint32_t imageFormat)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(levelCount >= 1
+                   && levelCount <= GetMipLevelCount(width, height));
+
+        if (m_Width != 0)
+        {
+            DeleteTexture();
+            CreateTexture();
+        }
+
+        Init(width, height, format, imageFormat, levelCount > 1);
+        m_MipLevels = levelCount;
+
+        SetDataImmutable(nullptr);
+        ApplySampler();
     }
 
     void Texture2D::CreateTexture()
@@ -118,21 +240,44 @@ namespace sgl
         m_Format = format;
         m_ImageFormat = imageFormat;
 
-        m_Wrap_S = Texture2D::DEFAULT_WRAP_S;
-        m_Wrap_T = Texture2D::DEFAULT_WRAP_T;
+        // The levels sampled belong to the storage, e.g. of a stream
+        m_BaseLevel = 0;
+        m_MinLod = Texture2D::DEFAULT_MIN_LOD;
+        m_MipLevels = mipmaps ? GetMipLevelCount(width, height) : 1;
 
-        if (mipmaps)
+        // Sampling set by the user is kept when the storage is replaced,
+        //  e.g. on a placeholder until the image is loaded
+        if (!m_CustomWrap)
         {
-            m_MipLevels = std::log2(width);
-            m_FilterMin = Texture2D::DEFAULT_MIN_FILTER_MIPMAP;
-            m_FilterMag = Texture2D::DEFAULT_MAG_FILTER;
+            m_Wrap_S = Texture2D::DEFAULT_WRAP_S;
+            m_Wrap_T = Texture2D::DEFAULT_WRAP_T;
         }
-        else
+        if (!m_CustomFiltering)
         {
-            m_MipLevels = 1;
-            m_FilterMin = Texture2D::DEFAULT_MIN_FILTER;
+            m_FilterMin = mipmaps ? Texture2D::DEFAULT_MIN_FILTER_MIPMAP
+                                  : Texture2D::DEFAULT_MIN_FILTER;
             m_FilterMag = Texture2D::DEFAULT_MAG_FILTER;
         }
+
+        m_Compressed = false;
+    }
+
+    void Texture2D::InitCompressed(uint32_t width, uint32_t height,
+                                   uint32_t format, uint32_t levelCount)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT_MSG(IsCompressedFormat(format),
+                       "Format 0x{:X} is not block compressed", format);
+        SGL_ASSERT_MSG(IsCompressedFormatSupported(format),
+                       "{} textures are not supported by the driver",
+                       GetCompressedFormatName(format));
+
+        SGL_ASSERT(levelCount >= 1
+                   && levelCount <= GetMipLevelCount(width, height));
+
+        Init(width, height, format, 0, levelCount > 1);
+        m_MipLevels = levelCount;
+        m_Compressed = true;
     }
 
     void Texture2D::SetDataImmutable(const unsigned char* data) const
@@ -147,12 +292,34 @@ namespace sgl
                            m_Format,
                            // in texels
                            m_Width, m_Height);
-        UpdateData(data);
+        if (data != nullptr)
+            UpdateData(data);
+    }
+
+    void Texture2D::SetCompressedLevels(const CompressedLevel* levels) const
+    {
+        SGL_FUNCTION();
+
+        glTextureStorage2D(m_ID, m_MipLevels, m_Format, m_Width, m_Height);
+        for (uint32_t level = 0; level < m_MipLevels; ++level)
+            UpdateCompressedData(level, levels[level].data, levels[level].size);
+    }
+
+    void Texture2D::SetMipLevels(const MipChain& chain) const
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(chain.channels == GetChannelCount(m_ImageFormat));
+
+        glTextureStorage2D(m_ID, m_MipLevels, m_Format, m_Width, m_Height);
+        for (uint32_t level = 0; level < m_MipLevels; ++level)
+            UpdateLevel(level, chain.GetPixels(level));
     }
 
     void Texture2D::UpdateData(const unsigned char* data) const
     {
         SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Upload Texture2D");
+        SGL_ASSERT(!m_Compressed);
 
         glTextureSubImage2D(m_ID,               // texture id
                             0,                  // level
@@ -167,6 +334,93 @@ namespace sgl
                             // A pointer to the image data in memory
                             data);
 
+        SGL_RENDER_STAT(bytesUploaded, static_cast<uint64_t>(m_Width)
+                        * m_Height * GetChannelCount(m_ImageFormat));
+    }
+
+    void Texture2D::UpdateLevel(uint32_t level,
+                                const unsigned char* data) const
+    {
+        UpdateRows(level, 0, std::max(m_Height >> level, 1u), data);
+    }
+
+    void Texture2D::UpdateRows(uint32_t level, uint32_t firstRow,
+                               uint32_t rowCount,
+                               const unsigned char* data) const
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Upload Texture2D");
+
+        UploadRows(level, firstRow, rowCount, data);
+    }
+
+    void Texture2D::UpdateDataFromBuffer(uint32_t unpackBuffer,
+                                         size_t offset)
+    {
+        UpdateLevelFromBuffer(0, unpackBuffer, offset);
+        GenMipMaps();
+    }
+
+    void Texture2D::UpdateLevelFromBuffer(uint32_t level,
+                                          uint32_t unpackBuffer,
+                                          size_t offset) const
+    {
+        UpdateRowsFromBuffer(level, 0, std::max(m_Height >> level, 1u),
+                             unpackBuffer, offset);
+    }
+
+    void Texture2D::UpdateRowsFromBuffer(uint32_t level, uint32_t firstRow,
+                                         uint32_t rowCount,
+                                         uint32_t unpackBuffer,
+                                         size_t offset) const
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Upload Texture2D");
+
+        // With an unpack buffer bound, the pointer is an offset into it.
+        //  Unbound after, not restored, see the header.
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, unpackBuffer);
+        UploadRows(level, firstRow, rowCount,
+                   reinterpret_cast<const void*>(offset));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    void Texture2D::UploadRows(uint32_t level, uint32_t firstRow,
+                               uint32_t rowCount, const void* pixels) const
+    {
+        SGL_ASSERT(!m_Compressed && level < m_MipLevels);
+
+        const uint32_t kWidth = std::max(m_Width >> level, 1u);
+        SGL_ASSERT(firstRow + rowCount <= std::max(m_Height >> level, 1u));
+
+        // Tightly packed rows, the unpack alignment of 1 is set by "Window"
+        glTextureSubImage2D(m_ID, level, 0, firstRow, kWidth, rowCount,
+                            m_ImageFormat, GL_UNSIGNED_BYTE, pixels);
+
+        SGL_RENDER_STAT(bytesUploaded, static_cast<uint64_t>(kWidth)
+                        * rowCount * GetChannelCount(m_ImageFormat));
+    }
+
+    void Texture2D::UpdateCompressedData(uint32_t level, const void* data,
+                                         size_t size) const
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Upload Texture2D");
+        SGL_ASSERT(m_Compressed && level < m_MipLevels);
+
+        const uint32_t kWidth = std::max(m_Width >> level, 1u);
+        const uint32_t kHeight = std::max(m_Height >> level, 1u);
+        SGL_ASSERT_MSG(size == GetCompressedImageSize(m_Format, kWidth,
+                                                      kHeight),
+                       "Level {} of a {} texture has {} bytes", level,
+                       GetCompressedFormatName(m_Format), size);
+
+        // Uploaded as is, the driver copies the blocks
+        glCompressedTextureSubImage2D(m_ID, level, 0, 0, kWidth, kHeight,
+                                      m_Format, static_cast<GLsizei>(size),
+                                      data);
+
+        SGL_RENDER_STAT(bytesUploaded, static_cast<uint64_t>(size));
     }
 
     void Texture2D::GenMipMaps()
@@ -184,12 +438,27 @@ namespace sgl
         glTextureParameteri(m_ID, GL_TEXTURE_MIN_FILTER, m_FilterMin);
         glTextureParameteri(m_ID, GL_TEXTURE_MAG_FILTER, m_FilterMag);
     }
+
+    void Texture2D::ApplySampler() const
+    {
+        SGL_FUNCTION();
+        ApplyFiltering();
+
+        glTextureParameteri(m_ID, GL_TEXTURE_WRAP_S, m_Wrap_S);
+        glTextureParameteri(m_ID, GL_TEXTURE_WRAP_T, m_Wrap_T);
+        if (m_CustomBorderColor)
+        {
+            glTextureParameterfv(m_ID, GL_TEXTURE_BORDER_COLOR,
+                                 glm::value_ptr(m_BorderColor));
+        }
+    }
     
     void Texture2D::SetFiltering(uint32_t min_f, uint32_t mag_f)
     {
         SGL_FUNCTION();
         m_FilterMin = min_f;
         m_FilterMag = mag_f;
+        m_CustomFiltering = true;
 
         ApplyFiltering();
     }
@@ -199,15 +468,50 @@ namespace sgl
         SGL_FUNCTION();
         m_Wrap_S = wrap_s;
         m_Wrap_T = wrap_t;
+        m_CustomWrap = true;
         glTextureParameteri(m_ID, GL_TEXTURE_WRAP_S, wrap_s);
         glTextureParameteri(m_ID, GL_TEXTURE_WRAP_T, wrap_t);
     }
 
-    void Texture2D::SetBorderColor(const glm::vec4& kColor) const
+    void Texture2D::SetBorderColor(const glm::vec4& kColor)
     {
         SGL_FUNCTION();
+        m_BorderColor = kColor;
+        m_CustomBorderColor = true;
         glTextureParameterfv(m_ID, GL_TEXTURE_BORDER_COLOR,
                              glm::value_ptr(kColor));
     }
+
+    uint64_t Texture2D::GetMemorySize() const
+    {
+        if (m_Width == 0)
+            return 0;
+
+        uint64_t size = 0;
+        for (uint32_t level = 0; level < m_MipLevels; ++level)
+        {
+            const uint32_t kWidth = std::max(m_Width >> level, 1u);
+            const uint32_t kHeight = std::max(m_Height >> level, 1u);
+            size += m_Compressed
+                    ? GetCompressedImageSize(m_Format, kWidth, kHeight)
+                    : uint64_t(kWidth) * kHeight * GetTexelSize(m_Format);
+        }
+        return size;
+    }
+
+    void Texture2D::SetBaseLevel(uint32_t level)
+    {
+        SGL_ASSERT(level < m_MipLevels);
+
+        m_BaseLevel = level;
+        glTextureParameteri(m_ID, GL_TEXTURE_BASE_LEVEL,
+                            static_cast<GLint>(level));
+    }
+
+    void Texture2D::SetMinLod(float lod)
+    {
+        m_MinLod = lod;
+        glTextureParameterf(m_ID, GL_TEXTURE_MIN_LOD, lod);
+    }
     
 } // namespace sgl
@@ -8,9 +8,17 @@
 
 #include <memory>
 
+#include "SGL/opengl/CompressedFormat.h"
+
 
 namespace sgl
 {
+    struct MipChain;
+
+    /**
+     * @brief Uploads expect tightly packed rows, with the unpack alignment
+     *  of 1 that SGL sets on its contexts
+     */
     class Texture2D
     {
     public:
@@ -21,14 +29,28 @@ namespace sgl
                                                  uint32_t format,
                                                  uint32_t imageFormat,
                                                  bool mipmaps = false);
+        static std::shared_ptr<Texture2D> Create(
+            uint32_t width,
+            uint32_t height,
+            uint32_t format,
+            const CompressedLevel* levels,
+            uint32_t levelCount);
+        static std::shared_ptr<Texture2D> Create(const MipChain& chain,
+                                                 uint32_t format,
+                                                 uint32_t imageFormat);
 
         static const uint32_t DEFAULT_WRAP_S, DEFAULT_WRAP_T;
         static const uint32_t DEFAULT_MIN_FILTER, 
                               DEFAULT_MIN_FILTER_MIPMAP, DEFAULT_MAG_FILTER;
+        static const float DEFAULT_MIN_LOD;
     public:
         Texture2D();
 
-        /** @brief Immutable data storage */
+        /**
+         * @brief Immutable data storage
+         * @param data May be null to only allocate the storage, e.g. for
+         *  render targets
+         */
         Texture2D(uint32_t width,
                   uint32_t height,
                   const unsigned char* data,
@@ -36,6 +58,26 @@ namespace sgl
                   uint32_t imageFormat,
                   bool mipmaps = false);
 
+        /**
+         * @brief Immutable storage of a block compressed mip chain
+         * @param format BC1-BC7, ETC2 or EAC, see "CompressedFormat.h"
+         * @param levels Largest first, mips are not generated
+         */
+        Texture2D(uint32_t width,
+                  uint32_t height,
+                  uint32_t format,
+                  const CompressedLevel* levels,
+                  uint32_t levelCount);
+
+        /**
+         * @brief Immutable storage of a mip chain built on the CPU, see
+         *  "BuildMipChain", uploaded as is
+         * @param imageFormat Of "chain.channels" unsigned bytes
+         */
+        Texture2D(const MipChain& chain,
+                  uint32_t format,
+                  uint32_t imageFormat);
+
         ~Texture2D();
 
         void Bind() const;
@@ -44,35 +86,131 @@ namespace sgl
         static void UnBind();
         static void UnBindUnit(uint32_t unit);
 
-        /** @brief Immutable data storage */
+        /**
+         * @brief Immutable data storage. Replaces the texture if it already
+         *  had a storage, the ID changes, so a texture bound before has to
+         *  be bound again. The wrap, filtering and border color set before
+         *  are kept, the base level and min LOD are reset.
+         */
         void SetImage(uint32_t width,
                       uint32_t height,
                       const unsigned char* data,
                       uint32_t format,
                       uint32_t imageFormat,
                       bool mipmaps = false);
+        /** @brief Compressed "SetImage", the same rebinding applies */
+        void SetCompressedImage(uint32_t width,
+                                uint32_t height,
+                                uint32_t format,
+                                const CompressedLevel* levels,
+                                uint32_t levelCount);
+        /** @brief "SetImage" of a mip chain, the same rebinding applies */
+        void SetMipChain(const MipChain& chain,
+                         uint32_t format,
+                         uint32_t imageFormat);
+        /**
+         * @brief "SetImage" of the storage only, with a number of levels,
+         *  e.g. to upload them later with "UpdateLevel"
+         */
+        void SetStorage(uint32_t width,
+                        uint32_t height,
+                        uint32_t levelCount,
+                        uint32_t format,
+                        uint32_t imageFormat);
         
         void UpdateData(const unsigned char* data) const;
+        /**
+         * @brief Uploads one level of tightly packed pixels, the other
+         *  levels are left as they are
+         */
+        void UpdateLevel(uint32_t level, const unsigned char* data) const;
+        /** @brief "UpdateLevel" of a range of rows, from the first one */
+        void UpdateRows(uint32_t level,
+                        uint32_t firstRow,
+                        uint32_t rowCount,
+                        const unsigned char* data) const;
+        /**
+         * @brief Uploads the base level from a pixel unpack buffer and
+         *  regenerates the mips, the copy does not block on the GPU.
+         *  The "FromBuffer" updates leave no unpack buffer bound, the
+         *  binding is not queried and restored on the streaming path.
+         * @param offset Of the tightly packed pixels, in **bytes**
+         */
+        void UpdateDataFromBuffer(uint32_t unpackBuffer, size_t offset);
+        /** @brief "UpdateLevel" from a pixel unpack buffer */
+        void UpdateLevelFromBuffer(uint32_t level,
+                                   uint32_t unpackBuffer,
+                                   size_t offset) const;
+        /** @brief "UpdateRows" from a pixel unpack buffer */
+        void UpdateRowsFromBuffer(uint32_t level,
+                                  uint32_t firstRow,
+                                  uint32_t rowCount,
+                                  uint32_t unpackBuffer,
+                                  size_t offset) const;
+        /** @param size Of the level blocks, in **bytes** */
+        void UpdateCompressedData(uint32_t level,
+                                  const void* data,
+                                  size_t size) const;
 
         void SetWrap(uint32_t wrap_s, 
                      uint32_t wrap_t);
 
         void SetFiltering(uint32_t min_f,
                           uint32_t mag_f);
-        void SetBorderColor(const glm::vec4& kColor) const;
+        void SetBorderColor(const glm::vec4& kColor);
+
+        /**
+         * @brief Clamps sampling to the levels from "level" down, for the
+         *  levels above it are not uploaded yet (GL_TEXTURE_BASE_LEVEL)
+         */
+        void SetBaseLevel(uint32_t level);
+        /**
+         * @brief Lowest level of detail sampled, relative to the base
+         *  level, fractions blend with the next level (GL_TEXTURE_MIN_LOD)
+         */
+        void SetMinLod(float lod);
+
+        uint32_t GetID() const { return m_ID; }
+        uint32_t GetWidth() const { return m_Width; }
+        uint32_t GetHeight() const { return m_Height; }
+        uint32_t GetMipLevels() const { return m_MipLevels; }
+        uint32_t GetBaseLevel() const { return m_BaseLevel; }
+        float GetMinLod() const { return m_MinLod; }
+        /** @return Sized internal format of the storage */
+        uint32_t GetFormat() const { return m_Format; }
+        bool IsCompressed() const { return m_Compressed; }
+        /**
+         * @return Estimate of the bytes of all the levels, drivers may pad
+         *  them, 0 without a storage
+         */
+        uint64_t GetMemorySize() const;
 
     private:
         void Init(uint32_t width, uint32_t height, uint32_t format,
                   uint32_t imageFormat, bool mipmaps);
+        void InitCompressed(uint32_t width, uint32_t height, uint32_t format,
+                            uint32_t levelCount);
 
         void CreateTexture();
         void DeleteTexture();
 
         void SetDataImmutable(const unsigned char* data) const;
+        void SetCompressedLevels(const CompressedLevel* levels) const;
+        void SetMipLevels(const MipChain& chain) const;
 
+        /** @param pixels Pointer, or offset in the bound unpack buffer */
+        void UploadRows(uint32_t level, uint32_t firstRow, uint32_t rowCount,
+                        const void* pixels) const;
+
+        /**
+         * @brief On the GPU, in the color space of the format. Software
+         *  drivers filter slowly, prefer "BuildMipChain" there.
+         */
         void GenMipMaps();
 
         void ApplyFiltering() const;
+        /** @brief Filtering, wrap and border color, on a new texture */
+        void ApplySampler() const;
 
     private:
         uint32_t m_ID{ 0 };
@@ -80,14 +218,23 @@ namespace sgl
         uint32_t m_Width{ 0 };
         uint32_t m_Height{ 0 };
         uint32_t m_MipLevels{ 1 };
+        uint32_t m_BaseLevel{ 0 };
+        float m_MinLod{ -1000.0f };
 
         uint32_t m_Format{ 0 };
         uint32_t m_ImageFormat{ 0 };
+        bool m_Compressed{ false };
 
         uint32_t m_Wrap_S{ 0 };
         uint32_t m_Wrap_T{ 0 };
         uint32_t m_FilterMin{ 0 };
         uint32_t m_FilterMag{ 0 };
+        glm::vec4 m_BorderColor{ 0.0f, 0.0f, 0.0f, 0.0f };
+
+        /// Set by the user, kept when the storage is replaced
+        bool m_CustomWrap{ false };
+        bool m_CustomFiltering{ false };
+        bool m_CustomBorderColor{ false };
     };
     
 } // namespace sgl
@@ -0,0 +1,277 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/opengl/Texture2DArray.h"
+#include "SGL/opengl/CompressedFormat.h"
+#include "SGL/opengl/TextureFormat.h"
+#include "SGL/opengl/Texture2D.h"
+#include "SGL/core/Profiler.h"
+#include "SGL/core/RenderStats.h"
+#include "SGL/image/MipChain.h"
+
+
+namespace sgl
+{
+    std::shared_ptr<Texture2DArray> Texture2DArray::Create(
+        uint32_t width, uint32_t height, uint32_t layerCount,
+        uint32_t format, uint32_t imageFormat, uint32_t levelCount)
+    {
+        return std::make_shared<Texture2DArray>(width, height, layerCount,
+                                                format, imageFormat,
+                                                levelCount);
+    }
+
+    // =========================================================================
+
+    Texture2DArray::Texture2DArray(uint32_t width,
+                                   uint32_t height,
+                                   uint32_t layerCount,
+                                   uint32_t format,
+                                   uint32_t imageFormat,
+                                   uint32_t levelCount)
+        : m_Width(width),
+          m_Height(height),
+          m_LayerCount(layerCount),
+          m_Format(format),
+          m_ImageFormat(imageFormat),
+          m_Compressed(IsCompressedFormat(format))
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(width > 0 && height > 0 && layerCount > 0);
+
+        GLint maxLayers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        SGL_ASSERT_MSG(layerCount <= static_cast<uint32_t>(maxLayers),
+                       "{} layers are over the limit of {}", layerCount,
+                       maxLayers);
+        SGL_ASSERT_MSG(!m_Compressed
+                       || IsCompressedFormatSupported(format,
+                                                      GL_TEXTURE_2D_ARRAY),
+                       "{} array textures are not supported by the driver",
+                       GetCompressedFormatName(format));
+
+        const uint32_t kMaxLevels = GetMipLevelCount(width, height);
+        SGL_ASSERT(levelCount <= kMaxLevels);
+        m_MipLevels = levelCount == 0 ? kMaxLevels : levelCount;
+
+        m_Wrap_S = Texture2D::DEFAULT_WRAP_S;
+        m_Wrap_T = Texture2D::DEFAULT_WRAP_T;
+        m_FilterMin = m_MipLevels > 1 ? Texture2D::DEFAULT_MIN_FILTER_MIPMAP
+                                      : Texture2D::DEFAULT_MIN_FILTER;
+        m_FilterMag = Texture2D::DEFAULT_MAG_FILTER;
+
+        CreateTexture();
+        glTextureStorage3D(m_ID, m_MipLevels, m_Format, m_Width, m_Height,
+                           m_LayerCount);
+        ApplyFiltering();
+
+        m_FreeLayers.resize(m_LayerCount);
+        for (uint32_t i = 0; i < m_LayerCount; ++i)
+            m_FreeLayers[i] = m_LayerCount - 1 - i;
+    }
+
+    Texture2DArray::~Texture2DArray()
+    {
+        SGL_FUNCTION();
+        DeleteTexture();
+    }
+
+    void Texture2DArray::Bind() const
+    {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_ID);
+        SGL_RENDER_STAT(textureBinds, 1);
+    }
+
+    void Texture2DArray::BindUnit(uint32_t unit) const
+    {
+        glBindTextureUnit(unit, m_ID);
+        SGL_RENDER_STAT(textureBinds, 1);
+    }
+
+    void Texture2DArray::UnBind()
+    {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+
+    void Texture2DArray::UnBindUnit(uint32_t unit)
+    {
+        glBindTextureUnit(unit, 0);
+    }
+
+    uint32_t Texture2DArray::AllocateLayer()
+    {
+        if (m_FreeLayers.empty())
+            return NoLayer;
+
+        const uint32_t kLayer = m_FreeLayers.back();
+        m_FreeLayers.pop_back();
+        return kLayer;
+    }
+
+    void Texture2DArray::FreeLayer(uint32_t layer)
+    {
+        SGL_ASSERT(layer < m_LayerCount);
+
+        // Kept in decreasing order, freed layers are reused lowest first
+        const auto kIt = std::lower_bound(m_FreeLayers.begin(),
+                                          m_FreeLayers.end(), layer,
+                                          std::greater<uint32_t>());
+        SGL_ASSERT_MSG(kIt == m_FreeLayers.end() || *kIt != layer,
+                       "Layer {} is freed twice", layer);
+        m_FreeLayers.insert(kIt, layer);
+    }
+
+    void Texture2DArray::UpdateLayer(uint32_t layer,
+                                     const unsigned char* data,
+                                     uint32_t level) const
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Upload Texture2DArray");
+
+        UploadLayer(layer, level, data);
+    }
+
+    void Texture2DArray::UpdateLayerFromBuffer(uint32_t layer,
+                                               uint32_t unpackBuffer,
+                                               size_t offset,
+                                               uint32_t level) const
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Upload Texture2DArray");
+
+        // With an unpack buffer bound, the pointer is an offset into it
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, unpackBuffer);
+        UploadLayer(layer, level, reinterpret_cast<const void*>(offset));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    void Texture2DArray::UpdateCompressedLayer(uint32_t layer,
+                                               const void* data,
+                                               size_t size,
+                                               uint32_t level) const
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Upload Texture2DArray");
+        SGL_ASSERT(m_Compressed && layer < m_LayerCount
+                   && level < m_MipLevels);
+
+        const uint32_t kWidth = std::max(m_Width >> level, 1u);
+        const uint32_t kHeight = std::max(m_Height >> level, 1u);
+        SGL_ASSERT_MSG(size == GetCompressedImageSize(m_Format, kWidth,
+                                                      kHeight),
+                       "Level {} of a {} layer has {} bytes", level,
+                       GetCompressedFormatName(m_Format), size);
+
+        glCompressedTextureSubImage3D(m_ID, level, 0, 0, layer, kWidth,
+                                      kHeight, 1, m_Format,
+                                      static_cast<GLsizei>(size), data);
+
+        SGL_RENDER_STAT(bytesUploaded, static_cast<uint64_t>(size));
+    }
+
+    void Texture2DArray::SetLayerMipChain(uint32_t layer,
+                                          const MipChain& chain) const
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Upload Texture2DArray");
+        SGL_ASSERT(!chain.Empty()
+                   && chain.channels == GetChannelCount(m_ImageFormat));
+        SGL_ASSERT_MSG(chain.levels[0].width == m_Width
+                       && chain.levels[0].height == m_Height,
+                       "A chain of {}x{} does not fit layers of {}x{}",
+                       chain.levels[0].width, chain.levels[0].height,
+                       m_Width, m_Height);
+
+        const uint32_t kLevels = std::min(chain.GetLevelCount(),
+                                          m_MipLevels);
+        for (uint32_t level = 0; level < kLevels; ++level)
+            UploadLayer(layer, level, chain.GetPixels(level));
+    }
+
+    void Texture2DArray::GenLayerMipMaps(uint32_t layer) const
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(!m_Compressed && layer < m_LayerCount);
+        if (m_MipLevels <= 1)
+            return;
+
+        // A view of the one layer shares its storage, the mips generated
+        //  for the view land in the layer. Views take a name never bound.
+        GLuint view = 0;
+        glGenTextures(1, &view);
+        glTextureView(view, GL_TEXTURE_2D, m_ID, m_Format, 0, m_MipLevels,
+                      layer, 1);
+        glGenerateTextureMipmap(view);
+        glDeleteTextures(1, &view);
+    }
+
+    void Texture2DArray::GenMipMaps() const
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(!m_Compressed);
+        if (m_MipLevels <= 1)
+            return;
+
+        glGenerateTextureMipmap(m_ID);
+    }
+
+    void Texture2DArray::SetWrap(uint32_t wrap_s, uint32_t wrap_t)
+    {
+        SGL_FUNCTION();
+        m_Wrap_S = wrap_s;
+        m_Wrap_T = wrap_t;
+        glTextureParameteri(m_ID, GL_TEXTURE_WRAP_S, wrap_s);
+        glTextureParameteri(m_ID, GL_TEXTURE_WRAP_T, wrap_t);
+    }
+
+    void Texture2DArray::SetFiltering(uint32_t min_f, uint32_t mag_f)
+    {
+        SGL_FUNCTION();
+        m_FilterMin = min_f;
+        m_FilterMag = mag_f;
+
+        ApplyFiltering();
+    }
+
+    void Texture2DArray::CreateTexture()
+    {
+        SGL_FUNCTION();
+        glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &m_ID);
+        SGL_ASSERT(m_ID > 0);
+    }
+
+    void Texture2DArray::DeleteTexture()
+    {
+        SGL_FUNCTION();
+        glDeleteTextures(1, &m_ID);
+        m_ID = 0;
+    }
+
+    void Texture2DArray::UploadLayer(uint32_t layer, uint32_t level,
+                                     const void* pixels) const
+    {
+        SGL_ASSERT(!m_Compressed && layer < m_LayerCount
+                   && level < m_MipLevels);
+
+        const uint32_t kWidth = std::max(m_Width >> level, 1u);
+        const uint32_t kHeight = std::max(m_Height >> level, 1u);
+
+        // Tightly packed rows, the unpack alignment of 1 is set by "Window"
+        glTextureSubImage3D(m_ID, level, 0, 0, layer, kWidth, kHeight, 1,
+                            m_ImageFormat, GL_UNSIGNED_BYTE, pixels);
+
+        SGL_RENDER_STAT(bytesUploaded, static_cast<uint64_t>(kWidth)
+                        * kHeight * GetChannelCount(m_ImageFormat));
+    }
+
+    void Texture2DArray::ApplyFiltering() const
+    {
+        SGL_FUNCTION();
+        glTextureParameteri(m_ID, GL_TEXTURE_MIN_FILTER, m_FilterMin);
+        glTextureParameteri(m_ID, GL_TEXTURE_MAG_FILTER, m_FilterMag);
+    }
+
+} // namespace sgl
@@ -0,0 +1,157 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_OPENGL_TEXTURE_2D_ARRAY_H_
+#define SGL_OPENGL_TEXTURE_2D_ARRAY_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+namespace sgl
+{
+    struct MipChain;
+
+    /**
+     * @brief Layers of the same size and format in one texture object,
+     *  sampled as sampler2DArray with the layer as the third coordinate.
+     *  Objects of different materials then share a bind, and a draw, when
+     *  each indexes its layer in the shader, e.g. from an instance
+     *  attribute. The storage is immutable, layers are handed out by
+     *  "AllocateLayer" and filled by the updates, with tightly packed
+     *  rows as in "Texture2D".
+     */
+    class Texture2DArray
+    {
+    public:
+        /** @brief Returned by "AllocateLayer" when all layers are in use */
+        static constexpr uint32_t NoLayer = ~0u;
+
+        static std::shared_ptr<Texture2DArray> Create(uint32_t width,
+                                                      uint32_t height,
+                                                      uint32_t layerCount,
+                                                      uint32_t format,
+                                                      uint32_t imageFormat,
+                                                      uint32_t levelCount = 1);
+
+    public:
+        /**
+         * @brief Immutable storage of all the layers, their content is
+         *  undefined until updated
+         * @param format Sized internal format, e.g. GL_SRGB8_ALPHA8, or
+         *  block compressed, see "CompressedFormat.h"
+         * @param imageFormat Of the unsigned byte pixels of the updates,
+         *  ignored for compressed formats
+         * @param levelCount 0 for the full chain
+         */
+        Texture2DArray(uint32_t width,
+                       uint32_t height,
+                       uint32_t layerCount,
+                       uint32_t format,
+                       uint32_t imageFormat,
+                       uint32_t levelCount = 1);
+        ~Texture2DArray();
+
+        Texture2DArray(const Texture2DArray&) = delete;
+        Texture2DArray& operator=(const Texture2DArray&) = delete;
+
+        void Bind() const;
+        void BindUnit(uint32_t unit) const;
+
+        static void UnBind();
+        static void UnBindUnit(uint32_t unit);
+
+        /**
+         * @brief Takes the lowest free layer
+         * @return "NoLayer" if all of them are in use
+         */
+        uint32_t AllocateLayer();
+        /** @brief Gives a layer back, its content stays until updated */
+        void FreeLayer(uint32_t layer);
+
+        /** @brief Uploads one level of a layer, tightly packed pixels */
+        void UpdateLayer(uint32_t layer,
+                         const unsigned char* data,
+                         uint32_t level = 0) const;
+        /**
+         * @brief "UpdateLayer" from a pixel unpack buffer
+         * @param offset Of the tightly packed pixels, in **bytes**
+         */
+        void UpdateLayerFromBuffer(uint32_t layer,
+                                   uint32_t unpackBuffer,
+                                   size_t offset,
+                                   uint32_t level = 0) const;
+        /** @param size Of the level blocks, in **bytes** */
+        void UpdateCompressedLayer(uint32_t layer,
+                                   const void* data,
+                                   size_t size,
+                                   uint32_t level = 0) const;
+        /**
+         * @brief Uploads the levels of a chain built on the CPU, see
+         *  "BuildMipChain", levels past those of the texture are skipped
+         */
+        void SetLayerMipChain(uint32_t layer, const MipChain& chain) const;
+
+        /**
+         * @brief Generates the mips of one layer from its base level, the
+         *  other layers are left as they are
+         */
+        void GenLayerMipMaps(uint32_t layer) const;
+        /** @brief Generates the mips of all the layers */
+        void GenMipMaps() const;
+
+        void SetWrap(uint32_t wrap_s,
+                     uint32_t wrap_t);
+        void SetFiltering(uint32_t min_f,
+                          uint32_t mag_f);
+
+        uint32_t GetID() const { return m_ID; }
+        uint32_t GetWidth() const { return m_Width; }
+        uint32_t GetHeight() const { return m_Height; }
+        uint32_t GetLayerCount() const { return m_LayerCount; }
+        uint32_t GetMipLevels() const { return m_MipLevels; }
+        /** @return Sized internal format of the storage */
+        uint32_t GetFormat() const { return m_Format; }
+        bool IsCompressed() const { return m_Compressed; }
+        uint32_t GetFreeLayerCount() const {
+            return static_cast<uint32_t>(m_FreeLayers.size());
+        }
+
+    private:
+        void CreateTexture();
+        void DeleteTexture();
+
+        /** @param pixels Pointer, or offset in the bound unpack buffer */
+        void UploadLayer(uint32_t layer, uint32_t level,
+                         const void* pixels) const;
+
+        void ApplyFiltering() const;
+
+    private:
+        uint32_t m_ID{ 0 };
+
+        uint32_t m_Width{ 0 };
+        uint32_t m_Height{ 0 };
+        uint32_t m_LayerCount{ 0 };
+        uint32_t m_MipLevels{ 1 };
+
+        uint32_t m_Format{ 0 };
+        uint32_t m_ImageFormat{ 0 };
+        bool m_Compressed{ false };
+
+        uint32_t m_Wrap_S{ 0 };
+        uint32_t m_Wrap_T{ 0 };
+        uint32_t m_FilterMin{ 0 };
+        uint32_t m_FilterMag{ 0 };
+
+        /** @brief Free layers, the highest first so the lowest pops */
+        std::vector<uint32_t> m_FreeLayers;
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_OPENGL_TEXTURE_2D_ARRAY_H_
@@ -0,0 +1,301 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/opengl/TextureAtlas.h"
+#include "SGL/opengl/Texture2D.h"
+#include "SGL/opengl/Texture2DArray.h"
+#include "SGL/core/Profiler.h"
+#include "SGL/image/MipChain.h"
+
+#include <cstring>
+
+// The copy of stb_rect_pack vendored with ImGui, private to this unit as in
+//  imgui_draw.cpp. Large rects make the coordinates int in older versions.
+#define STBRP_STATIC
+#define STBRP_LARGE_RECTS
+#define STBRP_ASSERT(x) SGL_ASSERT(x)
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imstb_rectpack.h>
+
+
+namespace sgl
+{
+    std::shared_ptr<TextureAtlas> TextureAtlas::Create(uint32_t pageSize,
+                                                       uint32_t padding,
+                                                       bool mipmaps,
+                                                       bool srgb)
+    {
+        return std::make_shared<TextureAtlas>(pageSize, padding, mipmaps,
+                                              srgb);
+    }
+
+    // =========================================================================
+
+    TextureAtlas::TextureAtlas(uint32_t pageSize, uint32_t padding,
+                               bool mipmaps, bool srgb)
+        : m_PageSize(pageSize), m_Padding(padding), m_SRGB(srgb)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(pageSize > 0);
+
+        // Level n halves the border n times, it keeps a texel up to the
+        //  level of log2(padding). Rectangles start at multiples of the
+        //  texels a texel of that level covers, so its 2x2 footprints never
+        //  straddle two images.
+        m_MipLevels = mipmaps && padding > 0
+                      ? GetMipLevelCount(padding, padding)
+                      : 1;
+        m_Alignment = 1u << (m_MipLevels - 1);
+    }
+
+    TextureAtlas::~TextureAtlas()
+    {
+        SGL_FUNCTION();
+    }
+
+    uint32_t TextureAtlas::Add(const unsigned char* pixels, uint32_t width,
+                               uint32_t height, uint32_t channels)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(pixels != nullptr && width > 0 && height > 0);
+        SGL_ASSERT(channels >= 1 && channels <= 4);
+
+        Image image;
+        image.width = width;
+        image.height = height;
+        image.pixels.resize(size_t(width) * height * 4);
+
+        const size_t kTexels = size_t(width) * height;
+        if (channels == 4)
+        {
+            std::memcpy(image.pixels.data(), pixels, kTexels * 4);
+        }
+        else
+        {
+            for (size_t i = 0; i < kTexels; ++i)
+            {
+                const unsigned char* kTexel = pixels + i * channels;
+                unsigned char* texel = image.pixels.data() + i * 4;
+                if (channels <= 2)
+                {
+                    texel[0] = texel[1] = texel[2] = kTexel[0];
+                    texel[3] = channels == 2 ? kTexel[1] : 255;
+                }
+                else
+                {
+                    texel[0] = kTexel[0];
+                    texel[1] = kTexel[1];
+                    texel[2] = kTexel[2];
+                    texel[3] = 255;
+                }
+            }
+        }
+
+        m_Images.push_back(std::move(image));
+        m_Regions.emplace_back();
+        return static_cast<uint32_t>(m_Images.size() - 1);
+    }
+
+    uint32_t TextureAtlas::Add(const STBData& image, int requiredComponents)
+    {
+        // STBData keeps the channels of the file
+        const int kChannels = requiredComponents != 0 ? requiredComponents
+                                                      : image.channels;
+        return Add(image.data, static_cast<uint32_t>(image.width),
+                   static_cast<uint32_t>(image.height),
+                   static_cast<uint32_t>(kChannels));
+    }
+
+    bool TextureAtlas::Build(ThreadPool* pool)
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("TextureAtlas::Build");
+
+        m_Pages.clear();
+        m_Array.reset();
+
+        return Pack(true, pool, [this](MipChain&& chain) {
+            auto texture = Texture2D::Create(
+                chain, m_SRGB ? GL_SRGB8_ALPHA8 : GL_RGBA8, GL_RGBA);
+            texture->SetWrap(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+            m_Pages.push_back(std::move(texture));
+        });
+    }
+
+    bool TextureAtlas::BuildArray(ThreadPool* pool)
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("TextureAtlas::BuildArray");
+
+        m_Pages.clear();
+        m_Array.reset();
+
+        std::vector<MipChain> chains;
+        const bool kPackedAll = Pack(false, pool,
+                                     [&chains](MipChain&& chain) {
+                                         chains.push_back(std::move(chain));
+                                     });
+        if (chains.empty())
+            return kPackedAll;
+
+        m_Array = Texture2DArray::Create(
+            m_PageSize, m_PageSize, static_cast<uint32_t>(chains.size()),
+            m_SRGB ? GL_SRGB8_ALPHA8 : GL_RGBA8, GL_RGBA, m_MipLevels);
+        m_Array->SetWrap(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+        for (uint32_t page = 0; page < chains.size(); ++page)
+        {
+            const uint32_t kLayer = m_Array->AllocateLayer();
+            m_Array->SetLayerMipChain(kLayer, chains[page]);
+        }
+
+        return kPackedAll;
+    }
+
+    bool TextureAtlas::Pack(bool trim, ThreadPool* pool,
+                            const std::function<void(MipChain&&)>& upload)
+    {
+        m_PageCount = 0;
+        std::fill(m_Regions.begin(), m_Regions.end(), AtlasRegion());
+
+        // Packed in units of the alignment, smaller and aligned for free
+        const int kUnits = static_cast<int>(m_PageSize / m_Alignment);
+        auto ToUnits = [this](uint32_t size) {
+            return static_cast<int>((size + 2 * m_Padding + m_Alignment - 1)
+                                    / m_Alignment);
+        };
+
+        bool packedAll = true;
+        std::vector<stbrp_rect> remaining;
+        for (uint32_t id = 0; id < m_Images.size(); ++id)
+        {
+            const Image& kImage = m_Images[id];
+            if (ToUnits(kImage.width) > kUnits
+                || ToUnits(kImage.height) > kUnits)
+            {
+                SGL_LOG_WARN("Atlas image {} of {}x{} is larger than a page "
+                             "of {}, it is not packed", id, kImage.width,
+                             kImage.height, m_PageSize);
+                packedAll = false;
+                continue;
+            }
+
+            stbrp_rect rect{};
+            rect.id = static_cast<int>(id);
+            rect.w = static_cast<stbrp_coord>(ToUnits(kImage.width));
+            rect.h = static_cast<stbrp_coord>(ToUnits(kImage.height));
+            remaining.push_back(rect);
+        }
+
+        std::vector<stbrp_node> nodes(static_cast<size_t>(kUnits));
+        std::vector<unsigned char> pixels;
+        uint64_t usedTexels = 0;
+        uint64_t pageTexels = 0;
+
+        // A page takes what fits, the rest goes to the next one
+        while (!remaining.empty())
+        {
+            stbrp_context context;
+            stbrp_init_target(&context, kUnits, kUnits, nodes.data(),
+                              kUnits);
+            stbrp_pack_rects(&context, remaining.data(),
+                             static_cast<int>(remaining.size()));
+
+            const uint32_t kPage = m_PageCount++;
+            std::vector<stbrp_rect> next;
+            uint32_t height = 0;
+            for (const stbrp_rect& kRect : remaining)
+            {
+                if (!kRect.was_packed)
+                {
+                    next.push_back(kRect);
+                    continue;
+                }
+
+                height = std::max(height, static_cast<uint32_t>(
+                    (kRect.y + kRect.h) * m_Alignment));
+            }
+            SGL_ASSERT(next.size() < remaining.size());
+
+            // Trimmed to the rows in use, the width stays for the UVs.
+            //  Layers of an array all have the size of a page.
+            const uint32_t kWidth = m_PageSize;
+            if (!trim)
+                height = m_PageSize;
+            pixels.assign(size_t(kWidth) * height * 4, 0);
+            pageTexels += uint64_t(kWidth) * height;
+
+            for (const stbrp_rect& kRect : remaining)
+            {
+                if (!kRect.was_packed)
+                    continue;
+
+                const Image& kImage = m_Images[kRect.id];
+                const uint32_t kX = kRect.x * m_Alignment;
+                const uint32_t kY = kRect.y * m_Alignment;
+                Blit(kImage, kX, kY, kWidth, pixels.data());
+
+                AtlasRegion& region = m_Regions[kRect.id];
+                region.page = kPage;
+                region.x = kX + m_Padding;
+                region.y = kY + m_Padding;
+                region.width = kImage.width;
+                region.height = kImage.height;
+                region.uvMin = glm::vec2(float(region.x) / kWidth,
+                                         float(region.y) / height);
+                region.uvMax = glm::vec2(
+                    float(region.x + region.width) / kWidth,
+                    float(region.y + region.height) / height);
+
+                usedTexels += uint64_t(kImage.width) * kImage.height;
+            }
+
+            MipChainSpec spec;
+            spec.srgb = m_SRGB;
+            spec.maxLevels = m_MipLevels;
+            upload(BuildMipChain(pixels.data(), kWidth, height, 4, spec,
+                                 pool));
+
+            remaining.swap(next);
+        }
+
+        SGL_LOG_INFO("Atlas of {} images on {} pages, {:.1f}% of the texels "
+                     "used", m_Images.size(), m_PageCount,
+                     pageTexels > 0 ? 100.0 * usedTexels / pageTexels : 0.0);
+
+        return packedAll;
+    }
+
+    void TextureAtlas::Blit(const Image& image, uint32_t x, uint32_t y,
+                            uint32_t pageWidth, unsigned char* page) const
+    {
+        // The border repeats the edge texels, as a clamped sampler would
+        const int64_t kPadding = m_Padding;
+        const int64_t kWidth = image.width;
+        const int64_t kHeight = image.height;
+        const size_t kRowSize = size_t(image.width) * 4;
+
+        for (int64_t row = -kPadding; row < kHeight + kPadding; ++row)
+        {
+            const int64_t kSourceRow = std::clamp<int64_t>(row, 0,
+                                                           kHeight - 1);
+            const unsigned char* kSource = image.pixels.data()
+                                           + kSourceRow * kRowSize;
+            unsigned char* out = page
+                + ((y + kPadding + row) * pageWidth + x) * 4;
+
+            for (int64_t i = 0; i < kPadding; ++i)
+                std::memcpy(out + i * 4, kSource, 4);
+
+            std::memcpy(out + kPadding * 4, kSource, kRowSize);
+
+            unsigned char* right = out + (kPadding + kWidth) * 4;
+            const unsigned char* kLast = kSource + (kWidth - 1) * 4;
+            for (int64_t i = 0; i < kPadding; ++i)
+                std::memcpy(right + i * 4, kLast, 4);
+        }
+    }
+
+} // namespace sgl
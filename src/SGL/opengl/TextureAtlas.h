@@ -0,0 +1,147 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_OPENGL_TEXTURE_ATLAS_H_
+#define SGL_OPENGL_TEXTURE_ATLAS_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+
+namespace sgl
+{
+    class Texture2D;
+    class Texture2DArray;
+    class ThreadPool;
+    struct MipChain;
+    struct STBData;
+
+    /** @brief Where an image landed, padding excluded */
+    struct AtlasRegion
+    {
+        uint32_t page{ 0 };
+        uint32_t x{ 0 };                    ///< In texels of the page
+        uint32_t y{ 0 };
+        uint32_t width{ 0 };                ///< 0 if it was not packed
+        uint32_t height{ 0 };
+        glm::vec2 uvMin{ 0.0f, 0.0f };      ///< Rows in the pixel order
+        glm::vec2 uvMax{ 0.0f, 0.0f };
+    };
+
+    /**
+     * @brief Packs many small images into few RGBA8 textures, pages, so
+     *  that they are drawn with one bind. The images are packed with
+     *  stb_rect_pack (skyline, bottom left) in the order of their height,
+     *  each with a border repeating its edge texels.
+     *  Mips are built on the CPU and stop before a level where the borders
+     *  would be under a texel, so neighbours never bleed into each other.
+     */
+    class TextureAtlas
+    {
+    public:
+        static constexpr uint32_t DefaultPageSize = 2048;
+        /** @brief Texels of border, 4 keeps 3 mip levels clean */
+        static constexpr uint32_t DefaultPadding = 4;
+
+        static std::shared_ptr<TextureAtlas> Create(
+            uint32_t pageSize = DefaultPageSize,
+            uint32_t padding = DefaultPadding,
+            bool mipmaps = true,
+            bool srgb = false);
+
+    public:
+        /** @param srgb Stored as GL_SRGB8_ALPHA8, mips averaged linearly */
+        TextureAtlas(uint32_t pageSize = DefaultPageSize,
+                     uint32_t padding = DefaultPadding,
+                     bool mipmaps = true,
+                     bool srgb = false);
+        ~TextureAtlas();
+
+        /**
+         * @brief Copies an image, converted to RGBA. Gray is copied to the
+         *  color channels, the alpha is opaque without an alpha channel.
+         * @return Id of the image, its region is known after "Build"
+         */
+        uint32_t Add(const unsigned char* pixels,
+                     uint32_t width,
+                     uint32_t height,
+                     uint32_t channels);
+
+        /** @param requiredComponents As passed to "LoadImage" */
+        uint32_t Add(const STBData& image, int requiredComponents);
+
+        /**
+         * @brief Packs all the images added so far and uploads a texture
+         *  per page, the previous pages or array are replaced
+         * @param pool Builds the mips in parallel, see "BuildMipChain"
+         * @return False if an image is larger than a page, its region is
+         *  empty
+         */
+        bool Build(ThreadPool* pool = nullptr);
+        /**
+         * @brief "Build" into the layers of one array texture, the page of
+         *  a region is its layer. Pages are not trimmed then.
+         */
+        bool BuildArray(ThreadPool* pool = nullptr);
+
+        const AtlasRegion& GetRegion(uint32_t id) const {
+            return m_Regions[id];
+        }
+        const std::shared_ptr<Texture2D>& GetTexture(uint32_t page) const {
+            return m_Pages[page];
+        }
+        /** @return Null unless built with "BuildArray" */
+        const std::shared_ptr<Texture2DArray>& GetArrayTexture() const {
+            return m_Array;
+        }
+        uint32_t GetPageCount() const { return m_PageCount; }
+        uint32_t GetImageCount() const {
+            return static_cast<uint32_t>(m_Images.size());
+        }
+        /** @return Levels of the page textures */
+        uint32_t GetMipLevels() const { return m_MipLevels; }
+
+    private:
+        struct Image
+        {
+            std::vector<unsigned char> pixels;      ///< RGBA
+            uint32_t width{ 0 };
+            uint32_t height{ 0 };
+        };
+
+        /**
+         * @brief Packs the images and builds the mip chain of each page
+         * @param trim Pages end at the last row in use
+         * @param upload Called with the chain of each page, in order
+         */
+        bool Pack(bool trim, ThreadPool* pool,
+                  const std::function<void(MipChain&&)>& upload);
+
+        /** @brief Copies an image and its border into a page */
+        void Blit(const Image& image, uint32_t x, uint32_t y,
+                  uint32_t pageWidth, unsigned char* page) const;
+
+    private:
+        uint32_t m_PageSize{ 0 };
+        uint32_t m_Padding{ 0 };
+        uint32_t m_MipLevels{ 1 };
+        uint32_t m_Alignment{ 1 };  ///< Of the packed rectangles, in texels
+        bool m_SRGB{ false };
+
+        std::vector<Image> m_Images;
+        std::vector<AtlasRegion> m_Regions;
+        std::vector<std::shared_ptr<Texture2D>> m_Pages;
+        std::shared_ptr<Texture2DArray> m_Array;
+        uint32_t m_PageCount{ 0 };
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_OPENGL_TEXTURE_ATLAS_H_
@@ -0,0 +1,239 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/opengl/TextureCache.h"
+#include "SGL/opengl/Texture2D.h"
+#include "SGL/opengl/TextureStreamer.h"
+#include "SGL/core/Hash.h"
+#include "SGL/core/Profiler.h"
+
+
+namespace sgl
+{
+    /** @return Hash of the options that change the texture of a file */
+    static uint64_t HashOptions(const TextureLoadOptions& options)
+    {
+        const uint32_t kSeed[5] = {
+            options.components, options.mipmaps ? 1u : 0u,
+            options.srgb ? 1u : 0u, options.cpuMipmaps ? 1u : 0u,
+            static_cast<uint32_t>(options.mipFilter) };
+        return Hash64(kSeed, sizeof(kSeed));
+    }
+
+    std::shared_ptr<TextureCache> TextureCache::Create(
+        std::shared_ptr<TextureLoader> loader, uint64_t budget)
+    {
+        return std::make_shared<TextureCache>(std::move(loader), budget);
+    }
+
+    // =========================================================================
+
+    TextureCache::TextureCache(std::shared_ptr<TextureLoader> loader,
+                               uint64_t budget)
+        : m_Loader(std::move(loader)),
+          m_Budget(budget),
+          m_Self(std::make_shared<TextureCache*>(this))
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(m_Loader != nullptr);
+    }
+
+    TextureCache::~TextureCache()
+    {
+        SGL_FUNCTION();
+    }
+
+    uint32_t TextureCache::Load(const std::string& path,
+                                const TextureLoadOptions& options)
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("TextureCache::Load");
+
+        const uint64_t kOptions = HashOptions(options);
+        const uint64_t kPathKey = Hash64(path.data(), path.size(), kOptions);
+
+        const auto kPath = m_Paths.find(kPathKey);
+        if (kPath != m_Paths.end())
+            return kPath->second;
+
+        Entry entry;
+        entry.texture = Texture2D::Create();
+        TextureLoader::SetPlaceholder(*entry.texture);
+        entry.path = path;
+        entry.options = options;
+
+        m_Entries.push_back(std::move(entry));
+        const uint32_t kHandle = static_cast<uint32_t>(m_Entries.size());
+        m_Entries.back().lru = m_LRU.insert(m_LRU.end(), kHandle);
+
+        m_Paths.emplace(kPathKey, kHandle);
+
+        // A copy under another name is found by "OnHashed"
+        StartLoad(kHandle);
+        return kHandle;
+    }
+
+    std::shared_ptr<Texture2D> TextureCache::Get(uint32_t handle)
+    {
+        SGL_ASSERT(handle != NoHandle && handle <= m_Entries.size());
+
+        handle = Resolve(handle);
+        Touch(handle);
+
+        Entry& entry = m_Entries[handle - 1];
+        if (entry.state == State::Evicted)
+            StartLoad(handle);
+
+        return entry.texture;
+    }
+
+    uint32_t TextureCache::Update()
+    {
+        SGL_PROFILE_SCOPE("TextureCache::Update");
+
+        uint32_t evicted = 0;
+        if (m_Budget != 0)
+        {
+            // Ordered by the last use, the textures of this frame are last
+            for (auto it = m_LRU.begin();
+                 it != m_LRU.end() && m_MemoryUsage > m_Budget; ++it)
+            {
+                Entry& entry = m_Entries[*it - 1];
+                if (entry.lastUsed == m_Frame)
+                    break;
+
+                if (entry.state == State::Resident)
+                {
+                    Evict(entry);
+                    ++evicted;
+                }
+            }
+
+            if (evicted > 0)
+            {
+                SGL_LOG_DEBUG("Evicted {} textures, {:.1f} of {:.1f} MB used",
+                              evicted, m_MemoryUsage / 1048576.0,
+                              m_Budget / 1048576.0);
+            }
+        }
+
+        ++m_Frame;
+        return evicted;
+    }
+
+    void TextureCache::EvictAll()
+    {
+        SGL_FUNCTION();
+
+        for (Entry& entry : m_Entries)
+        {
+            if (entry.state == State::Resident)
+                Evict(entry);
+        }
+    }
+
+    bool TextureCache::IsResident(uint32_t handle) const
+    {
+        SGL_ASSERT(handle != NoHandle && handle <= m_Entries.size());
+        return m_Entries[Resolve(handle) - 1].state == State::Resident;
+    }
+
+    void TextureCache::StartLoad(uint32_t handle)
+    {
+        Entry& entry = m_Entries[handle - 1];
+        entry.state = State::Loading;
+
+        // The loader may outlive the cache
+        const std::weak_ptr<TextureCache*> kSelf = m_Self;
+        TextureLoadOptions options = entry.options;
+        options.onLoaded = [kSelf, handle, onLoaded = entry.options.onLoaded](
+            const std::shared_ptr<Texture2D>& texture, bool loaded) {
+            if (auto cache = kSelf.lock())
+                (*cache)->OnLoaded(handle);
+            if (onLoaded)
+                onLoaded(texture, loaded);
+        };
+        options.onHashed = [kSelf, handle](uint64_t contentHash) {
+            auto cache = kSelf.lock();
+            return cache == nullptr
+                   || (*cache)->OnHashed(handle, contentHash);
+        };
+
+        m_Loader->LoadAsync(entry.texture, entry.path, options);
+    }
+
+    void TextureCache::OnLoaded(uint32_t handle)
+    {
+        Entry& entry = m_Entries[handle - 1];
+        SGL_ASSERT(entry.state == State::Loading);
+
+        // A failed load counts the placeholder, it is tried again once
+        //  evicted
+        entry.state = State::Resident;
+        entry.size = entry.texture->GetMemorySize();
+        m_MemoryUsage += entry.size;
+    }
+
+    bool TextureCache::OnHashed(uint32_t handle, uint64_t contentHash)
+    {
+        Entry& entry = m_Entries[handle - 1];
+        SGL_ASSERT(entry.state == State::Loading);
+
+        // Called again for an image retried, or loaded again once evicted
+        const uint64_t kContentKey = Hash64(&contentHash, sizeof(contentHash),
+                                            HashOptions(entry.options));
+        const auto kContent = m_Contents.emplace(kContentKey, handle).first;
+        if (kContent->second == handle)
+            return true;
+
+        const uint32_t kOriginal = kContent->second;
+        SGL_LOG_DEBUG("'{}' is a copy of '{}', its texture is shared",
+                      entry.path, m_Entries[kOriginal - 1].path);
+
+        // The placeholder is freed with the last reference of the caller
+        entry.texture = m_Entries[kOriginal - 1].texture;
+        entry.state = State::Shared;
+        entry.original = kOriginal;
+        m_LRU.erase(entry.lru);
+        ++m_Duplicates;
+
+        // Its last use carries over
+        if (entry.lastUsed == m_Frame)
+            Touch(kOriginal);
+
+        return false;
+    }
+
+    uint32_t TextureCache::Resolve(uint32_t handle) const
+    {
+        const Entry& kEntry = m_Entries[handle - 1];
+        return kEntry.state == State::Shared ? kEntry.original : handle;
+    }
+
+    void TextureCache::Evict(Entry& entry)
+    {
+        SGL_FUNCTION();
+
+        // A streamed texture may still have levels to upload
+        if (entry.options.streamer != nullptr)
+            entry.options.streamer->Cancel(entry.texture);
+
+        TextureLoader::SetPlaceholder(*entry.texture);
+
+        m_MemoryUsage -= entry.size;
+        entry.size = 0;
+        entry.state = State::Evicted;
+        ++m_Evictions;
+    }
+
+    void TextureCache::Touch(uint32_t handle)
+    {
+        Entry& entry = m_Entries[handle - 1];
+        entry.lastUsed = m_Frame;
+        m_LRU.splice(m_LRU.end(), m_LRU, entry.lru);
+    }
+
+} // namespace sgl
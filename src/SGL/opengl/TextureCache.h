@@ -0,0 +1,158 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_OPENGL_TEXTURE_CACHE_H_
+#define SGL_OPENGL_TEXTURE_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SGL/opengl/TextureLoader.h"
+
+
+namespace sgl
+{
+    class Texture2D;
+
+    /**
+     * @brief Shares the textures of image files and keeps their memory
+     *  under a budget. A file is loaded once per path and load options, and
+     *  once per content, files with the same bytes share a texture. The
+     *  decoders hash the files, a copy is found once it is decoded, and
+     *  its handle gives the texture of the first file from then on, so get
+     *  the textures every frame rather than keep them.
+     *  Textures not used for a frame are evicted least recently used first
+     *  when over the budget, their storage is replaced by the placeholder
+     *  of "TextureLoader", and loaded again by the next "Get".
+     *  All methods must be called from the GL thread.
+     */
+    class TextureCache
+    {
+    public:
+        /** @brief Returned by "Load" for no texture */
+        static constexpr uint32_t NoHandle = 0;
+        static constexpr uint64_t DefaultBudget = 512ull << 20;
+
+        /** @param budget Bytes of texture storage, 0 for no limit */
+        static std::shared_ptr<TextureCache> Create(
+            std::shared_ptr<TextureLoader> loader,
+            uint64_t budget = DefaultBudget);
+
+    public:
+        /** @param loader Loads the textures, updated by the caller */
+        TextureCache(std::shared_ptr<TextureLoader> loader,
+                     uint64_t budget = DefaultBudget);
+        ~TextureCache();
+
+        TextureCache(const TextureCache&) = delete;
+        TextureCache& operator=(const TextureCache&) = delete;
+
+        /**
+         * @brief Loads a file, unless it is in the cache already
+         * @param options "streamer" and "onLoaded" are not part of the key,
+         *  "onLoaded" is called on every load of the texture, but not for a
+         *  copy of another file. "onHashed" is set by the cache.
+         * @return Handle of the texture, the same for the same file and
+         *  options
+         */
+        uint32_t Load(const std::string& path,
+                      const TextureLoadOptions& options
+                          = TextureLoadOptions());
+
+        /**
+         * @brief Marks a texture used in this frame, and loads it again if
+         *  it was evicted, it shows the placeholder meanwhile
+         * @return Texture of the handle, a copy, since a later "Load" may
+         *  move the entries. Evictions and reloads keep the texture and
+         *  replace its storage, but a handle found to be a copy of another
+         *  file switches to the texture of the original, call this each
+         *  frame rather than keeping the result.
+         */
+        std::shared_ptr<Texture2D> Get(uint32_t handle);
+
+        /**
+         * @brief Ends a frame, evicts textures not used in it while the
+         *  estimated memory is over the budget. Call once per frame.
+         * @return Number of evicted textures
+         */
+        uint32_t Update();
+
+        /** @brief Evicts all the textures, the handles stay valid */
+        void EvictAll();
+
+        void SetBudget(uint64_t budget) { m_Budget = budget; }
+        uint64_t GetBudget() const { return m_Budget; }
+
+        /** @return Estimated bytes of the loaded textures */
+        uint64_t GetMemoryUsage() const { return m_MemoryUsage; }
+        /** @return Textures of different contents or options */
+        uint32_t GetTextureCount() const {
+            return static_cast<uint32_t>(m_Entries.size() - m_Duplicates);
+        }
+        bool IsResident(uint32_t handle) const;
+        /** @return Files answered by the texture of the same content */
+        uint64_t GetDuplicateCount() const { return m_Duplicates; }
+        uint64_t GetEvictionCount() const { return m_Evictions; }
+
+    private:
+        enum class State
+        {
+            Loading,
+            Resident,
+            Evicted,
+            Shared      ///< Copy of "Entry::original", uses its texture
+        };
+
+        struct Entry
+        {
+            std::shared_ptr<Texture2D> texture;
+            std::string path;
+            TextureLoadOptions options;
+            State state{ State::Loading };
+            uint64_t size{ 0 };         ///< Counted while resident
+            uint64_t lastUsed{ 0 };     ///< Frame of the last "Get"
+            uint32_t original{ NoHandle };  ///< Once "Shared"
+            /// Position in "m_LRU", least recently used at the front
+            std::list<uint32_t>::iterator lru;
+        };
+
+        /** @brief Only resident textures are evicted, not loading ones */
+        void StartLoad(uint32_t handle);
+        void OnLoaded(uint32_t handle);
+        /** @return False if the file is a copy, it is not uploaded */
+        bool OnHashed(uint32_t handle, uint64_t contentHash);
+        /** @return Handle of the entry with the texture */
+        uint32_t Resolve(uint32_t handle) const;
+        void Evict(Entry& entry);
+        void Touch(uint32_t handle);
+
+    private:
+        std::shared_ptr<TextureLoader> m_Loader;
+        uint64_t m_Budget{ 0 };
+
+        /// Handle - 1 indexes the entries
+        std::vector<Entry> m_Entries;
+        std::list<uint32_t> m_LRU;
+        /// Hashes of the path and options, of the content and options
+        std::unordered_map<uint64_t, uint32_t> m_Paths;
+        std::unordered_map<uint64_t, uint32_t> m_Contents;
+
+        uint64_t m_Frame{ 1 };
+        uint64_t m_MemoryUsage{ 0 };
+        uint64_t m_Duplicates{ 0 };
+        uint64_t m_Evictions{ 0 };
+
+        /// Held weakly by the callbacks of the loader, expires with the cache
+        std::shared_ptr<TextureCache*> m_Self;
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_OPENGL_TEXTURE_CACHE_H_
@@ -0,0 +1,53 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_OPENGL_TEXTURE_FORMAT_H_
+#define SGL_OPENGL_TEXTURE_FORMAT_H_
+
+#include <cstdint>
+
+#include <glad/glad.h>
+
+
+namespace sgl
+{
+    /** @return Bytes per pixel of unsigned byte image data */
+    inline uint32_t GetChannelCount(uint32_t imageFormat)
+    {
+        switch (imageFormat)
+        {
+            case GL_RED:    return 1;
+            case GL_RG:     return 2;
+            case GL_RGB:    return 3;
+            default:        return 4;
+        }
+    }
+
+    /** @return Bytes per texel of an uncompressed sized format */
+    inline uint32_t GetTexelSize(uint32_t format)
+    {
+        switch (format)
+        {
+            case GL_R8:
+                return 1;
+            case GL_RG8: case GL_R16: case GL_R16F:
+            case GL_DEPTH_COMPONENT16:
+                return 2;
+            case GL_RGB16F: case GL_RGBA16F: case GL_RG32F: case GL_RGBA16:
+            // Depth is 32 bits, stencil 8 bits with 24 bits of padding
+            case GL_DEPTH32F_STENCIL8:
+                return 8;
+            case GL_RGB32F: case GL_RGBA32F:
+                return 16;
+            // RGB8 is stored as RGBX8 by most drivers, depth 24 as 32 bits
+            default:
+                return 4;
+        }
+    }
+
+} // namespace sgl
+
+
+#endif // SGL_OPENGL_TEXTURE_FORMAT_H_
@@ -0,0 +1,408 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/opengl/TextureLoader.h"
+#include "SGL/opengl/StagingRing.h"
+#include "SGL/opengl/Texture2D.h"
+#include "SGL/opengl/TextureStreamer.h"
+#include "SGL/core/Hash.h"
+#include "SGL/core/MappedFile.h"
+#include "SGL/core/Profiler.h"
+#include "SGL/core/ThreadPool.h"
+#include "SGL/image/CompressedImage.h"
+
+#include <cstring>
+#include <thread>
+
+#include <stb/stb_image.h>
+
+
+namespace sgl
+{
+    /** @brief Opaque mid gray, shown until the image is uploaded */
+    static constexpr unsigned char kPlaceholderPixel[4] = {
+        128, 128, 128, 255 };
+
+    /** @brief Sized and pixel formats for a number of 8-bit components */
+    static void GetFormats(uint32_t components, bool srgb,
+                           uint32_t& outFormat, uint32_t& outImageFormat)
+    {
+        switch (components)
+        {
+            case 1:
+                outFormat = GL_R8;
+                outImageFormat = GL_RED;
+                break;
+            case 2:
+                outFormat = GL_RG8;
+                outImageFormat = GL_RG;
+                break;
+            case 3:
+                outFormat = srgb ? GL_SRGB8 : GL_RGB8;
+                outImageFormat = GL_RGB;
+                break;
+            default:
+                outFormat = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+                outImageFormat = GL_RGBA;
+                break;
+        }
+    }
+
+    std::shared_ptr<TextureLoader> TextureLoader::Create(uint32_t workerCount,
+                                                         size_t stagingSize)
+    {
+        return std::make_shared<TextureLoader>(workerCount, stagingSize);
+    }
+
+    // =========================================================================
+
+    TextureLoader::TextureLoader(uint32_t workerCount, size_t stagingSize)
+        : m_Staging(std::make_unique<StagingRing>(stagingSize))
+    {
+        SGL_FUNCTION();
+
+        // Leaves a core for the GL thread
+        if (workerCount == 0)
+        {
+            workerCount = std::max(std::thread::hardware_concurrency(), 2u)
+                          - 1;
+        }
+        m_Decoders = std::make_unique<ThreadPool>(workerCount);
+
+        SGL_LOG_INFO("Texture loader with {} decoders, {} MiB staging",
+                     workerCount, stagingSize >> 20);
+    }
+
+    TextureLoader::~TextureLoader()
+    {
+        SGL_FUNCTION();
+
+        // Queued decodes are skipped, the running ones are waited for
+        m_Cancelled.store(true, std::memory_order_relaxed);
+        m_Decoders.reset();
+
+        if (!m_Requests.empty())
+        {
+            SGL_LOG_WARN("{} textures were not loaded, they keep the "
+                         "placeholder", m_Requests.size());
+        }
+    }
+
+    std::shared_ptr<Texture2D> TextureLoader::LoadAsync(
+        const std::string& path, const TextureLoadOptions& options)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(options.components <= 4);
+
+        auto texture = Texture2D::Create(1, 1, kPlaceholderPixel, GL_RGBA8,
+                                         GL_RGBA, false);
+        LoadAsync(texture, path, options);
+        return texture;
+    }
+
+    void TextureLoader::LoadAsync(const std::shared_ptr<Texture2D>& texture,
+                                  const std::string& path,
+                                  const TextureLoadOptions& options)
+    {
+        SGL_FUNCTION();
+        SGL_ASSERT(texture != nullptr && options.components <= 4);
+
+        const uint64_t kID = m_NextID++;
+        m_Requests.emplace(kID, Request{ texture, options, path });
+
+        const uint32_t kComponents = options.components;
+        const bool kCpuMips = options.mipmaps && options.cpuMipmaps;
+        MipChainSpec mips;
+        mips.filter = options.mipFilter;
+        mips.srgb = options.srgb;
+        const bool kHash = static_cast<bool>(options.onHashed);
+        m_Decoders->Enqueue([this, kID, path, kComponents, kCpuMips, mips,
+                             kHash]() {
+            Decode(kID, path, kComponents, kCpuMips ? &mips : nullptr,
+                   kHash);
+        });
+    }
+
+    void TextureLoader::SetPlaceholder(Texture2D& texture)
+    {
+        texture.SetImage(1, 1, kPlaceholderPixel, GL_RGBA8, GL_RGBA, false);
+    }
+
+    uint32_t TextureLoader::Update(size_t byteBudget)
+    {
+        SGL_PROFILE_SCOPE("TextureLoader::Update");
+
+        m_Staging->Release(false);
+
+        uint32_t published = 0;
+        size_t uploaded = 0;
+        while (true)
+        {
+            DecodedImage image;
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (m_Decoded.empty())
+                    break;
+
+                const size_t kSize = m_Decoded.front().Size();
+                if (byteBudget > 0 && published > 0
+                    && uploaded + kSize > byteBudget)
+                    break;
+
+                image = std::move(m_Decoded.front());
+                m_Decoded.pop_front();
+            }
+
+            auto it = m_Requests.find(image.id);
+            SGL_ASSERT(it != m_Requests.end());
+            Request& request = it->second;
+
+            // Released by the caller meanwhile, only the loader holds it
+            if (request.texture.use_count() == 1)
+            {
+                m_Requests.erase(it);
+                continue;
+            }
+
+            if (image.compressed != nullptr
+                && !IsCompressedFormatSupported(image.compressed->format))
+            {
+                image.error = fmt::format(
+                    "{} is not supported by the driver",
+                    GetCompressedFormatName(image.compressed->format));
+                image.compressed.reset();
+            }
+
+            if (!image.Loaded())
+            {
+                SGL_LOG_ERR("Failed to load a texture '{}': {}",
+                            request.path, image.error);
+                ++m_Failed;
+                Publish(request, false);
+            }
+            else if (request.options.onHashed
+                     && !request.options.onHashed(image.contentHash))
+            {
+                // Dropped, e.g. answered by the texture of the same file
+                m_Requests.erase(it);
+                continue;
+            }
+            else if (Upload(image, request))
+            {
+                uploaded += image.Size();
+                ++m_Loaded;
+                Publish(request, true);
+            }
+            else
+            {
+                // Staging is full, retried once the GPU frees a range
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Decoded.push_front(std::move(image));
+                break;
+            }
+
+            m_Requests.erase(image.id);
+            ++published;
+        }
+
+        // One fence for the ranges written by this call
+        m_Staging->Commit();
+
+        return published;
+    }
+
+    void TextureLoader::Flush()
+    {
+        SGL_FUNCTION();
+
+        while (!m_Requests.empty())
+        {
+            Update();
+            if (m_Requests.empty())
+                break;
+
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            if (!m_Decoded.empty())
+            {
+                // Waits for the GPU to free staging ranges
+                lock.unlock();
+                m_Staging->Release(true);
+                continue;
+            }
+
+            m_DecodedReady.wait(lock, [this]() { return !m_Decoded.empty(); });
+        }
+    }
+
+    void TextureLoader::Decode(uint64_t id, const std::string& path,
+                               uint32_t components, const MipChainSpec* mips,
+                               bool hash)
+    {
+        if (m_Cancelled.load(std::memory_order_relaxed))
+            return;
+
+        SGL_PROFILE_SCOPE("Decode Texture");
+
+        DecodedImage image;
+        image.id = id;
+
+        MappedFile file(path);
+        if (!file.IsOpen())
+        {
+            image.error = file.GetError();
+            PushDecoded(std::move(image));
+            return;
+        }
+
+        if (hash)
+            image.contentHash = Hash64(file.GetData(), file.GetSize());
+
+        if (IsCompressedImageFile(path))
+        {
+            auto compressed = std::make_shared<CompressedImage>(
+                ParseCompressedImage(std::move(file)));
+            if (!compressed->Loaded())
+                image.error = compressed->error;
+            else if (compressed->IsCubeMap())
+                image.error = "Cube maps are loaded by CubeMapTexture";
+            else
+                image.compressed = std::move(compressed);
+
+            PushDecoded(std::move(image));
+            return;
+        }
+
+        int width = 0;
+        int height = 0;
+        int fileComponents = 0;
+        unsigned char* data = LoadImageDataFromMemory(
+            file.GetData(), file.GetSize(), width, height, fileComponents,
+            static_cast<int>(components));
+        if (data != nullptr)
+        {
+            image.pixels = std::shared_ptr<unsigned char>(data,
+                                                          FreeImageData);
+            image.width = static_cast<uint32_t>(width);
+            image.height = static_cast<uint32_t>(height);
+            image.components = components != 0
+                ? components : static_cast<uint32_t>(fileComponents);
+
+            // On this worker, the other images keep the other ones busy
+            if (mips != nullptr)
+            {
+                MipChainSpec spec = *mips;
+                spec.srgb = spec.srgb && image.components >= 3;
+                image.mips = std::make_shared<MipChain>(BuildMipChain(
+                    data, image.width, image.height, image.components, spec));
+                image.pixels.reset();
+            }
+        }
+        else
+        {
+            // Thread local in stb_image
+            image.error = stbi_failure_reason();
+        }
+
+        PushDecoded(std::move(image));
+    }
+
+    void TextureLoader::PushDecoded(DecodedImage&& image)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Decoded.push_back(std::move(image));
+        }
+        m_DecodedReady.notify_one();
+    }
+
+    bool TextureLoader::Upload(const DecodedImage& image, Request& request)
+    {
+        const TextureLoadOptions& kOptions = request.options;
+        Texture2D& texture = *request.texture;
+
+        // Blocks are uploaded straight from the file contents
+        if (image.compressed != nullptr)
+        {
+            const CompressedImage& kImage = *image.compressed;
+            texture.SetCompressedImage(kImage.width, kImage.height,
+                                       kImage.format, kImage.levels.data(),
+                                       kImage.levelCount);
+            return true;
+        }
+
+        uint32_t format = 0;
+        uint32_t imageFormat = 0;
+        GetFormats(image.components, kOptions.srgb, format, imageFormat);
+
+        if (image.mips != nullptr && kOptions.streamer != nullptr)
+        {
+            kOptions.streamer->Stream(request.texture, image.mips, format,
+                                      imageFormat);
+            return true;
+        }
+
+        const size_t kSize = image.Size();
+        const size_t kOffset = m_Staging->Allocate(kSize);
+        if (kOffset == m_Staging->GetSize())
+        {
+            if (kSize <= m_Staging->GetSize())
+                return false;
+
+            // Larger than the ring, uploaded from the client memory
+            if (image.mips != nullptr)
+            {
+                texture.SetMipChain(*image.mips, format, imageFormat);
+                return true;
+            }
+
+            texture.SetImage(image.width, image.height, image.pixels.get(),
+                             format, imageFormat, kOptions.mipmaps);
+            return true;
+        }
+
+        texture.SetImage(image.width, image.height, nullptr, format,
+                         imageFormat, kOptions.mipmaps);
+
+        if (image.mips != nullptr)
+        {
+            // Every level from the same staging range, none on the GPU
+            const MipChain& kChain = *image.mips;
+            SGL_ASSERT(kChain.GetLevelCount() == texture.GetMipLevels());
+
+            std::memcpy(m_Staging->GetData(kOffset), kChain.pixels.data(),
+                        kSize);
+            for (uint32_t level = 0; level < kChain.GetLevelCount(); ++level)
+            {
+                texture.UpdateLevelFromBuffer(
+                    level, m_Staging->GetBuffer(),
+                    kOffset + kChain.levels[level].offset);
+            }
+            return true;
+        }
+
+        std::memcpy(m_Staging->GetData(kOffset), image.pixels.get(), kSize);
+        texture.UpdateDataFromBuffer(m_Staging->GetBuffer(), kOffset);
+
+        return true;
+    }
+
+    size_t TextureLoader::DecodedImage::Size() const
+    {
+        if (compressed != nullptr)
+            return compressed->Size();
+        if (mips != nullptr)
+            return mips->pixels.size();
+
+        return size_t(width) * height * components;
+    }
+
+    void TextureLoader::Publish(Request& request, bool loaded)
+    {
+        if (request.options.onLoaded)
+            request.options.onLoaded(request.texture, loaded);
+    }
+
+} // namespace sgl
@@ -0,0 +1,198 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_OPENGL_TEXTURE_LOADER_H_
+#define SGL_OPENGL_TEXTURE_LOADER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SGL/image/MipChain.h"
+
+namespace sgl
+{
+    class StagingRing;
+    class Texture2D;
+    class TextureStreamer;
+    class ThreadPool;
+    struct CompressedImage;
+
+    /** @brief Called on the GL thread once a texture is published */
+    using TextureLoadCallback = std::function<void(
+        const std::shared_ptr<Texture2D>& texture, bool loaded)>;
+    /**
+     * @brief Called on the GL thread with the hash of the file contents,
+     *  before the upload
+     * @return False to drop the image, e.g. for the texture of the same
+     *  contents, the texture keeps its image and "onLoaded" is not called
+     */
+    using TextureHashCallback = std::function<bool(uint64_t contentHash)>;
+
+    /**
+     * @brief The format options apply to decoded images. KTX2 and DDS files
+     *  are uploaded in their own format, with their own mips.
+     */
+    struct TextureLoadOptions
+    {
+        uint32_t components{ 4 };   ///< Forced on decode, 0 keeps the file's
+        bool mipmaps{ true };
+        bool srgb{ false };         ///< For 3 and 4 components
+        /// Mips built by the decoders, gamma correct for sRGB, instead of
+        ///  "glGenerateTextureMipmap" on the GL thread
+        bool cpuMipmaps{ false };
+        MipFilter mipFilter{ MipFilter::Box };
+        /// With "cpuMipmaps", the chain is streamed by it, the texture is
+        ///  published with its smallest levels only
+        std::shared_ptr<TextureStreamer> streamer;
+
+        /// Texture is loaded, or kept as the placeholder if "loaded" is false
+        TextureLoadCallback onLoaded;
+        /// Files are hashed by the decoders only with it
+        TextureHashCallback onHashed;
+    };
+
+    /**
+     * @brief Loads textures without blocking the GL thread. Images are
+     *  decoded by a pool of workers, the GL thread copies them into a
+     *  persistently mapped pixel unpack buffer ring and uploads from it.
+     *  A texture is returned right away with a 1x1 placeholder image, its
+     *  storage is replaced once the image is uploaded.
+     *  All methods must be called from the GL thread.
+     */
+    class TextureLoader
+    {
+    public:
+        /** @brief Bytes of the staging ring, larger images skip it */
+        static constexpr size_t DefaultStagingSize = 64 << 20;
+
+        /** @param workerCount 0 picks hardware threads - 1 */
+        static std::shared_ptr<TextureLoader> Create(
+            uint32_t workerCount = 0,
+            size_t stagingSize = DefaultStagingSize);
+
+    public:
+        TextureLoader(uint32_t workerCount = 0,
+                      size_t stagingSize = DefaultStagingSize);
+
+        /** @brief Cancels the queued decodes, drops the pending uploads */
+        ~TextureLoader();
+
+        TextureLoader(const TextureLoader&) = delete;
+        TextureLoader& operator=(const TextureLoader&) = delete;
+
+        /**
+         * @brief Queues the decode of an image file
+         * @return Texture with the placeholder image until it is loaded,
+         *  the ID changes then, see "Texture2D::SetImage"
+         */
+        std::shared_ptr<Texture2D> LoadAsync(
+            const std::string& path,
+            const TextureLoadOptions& options = TextureLoadOptions());
+        /**
+         * @brief "LoadAsync" into a texture, it keeps its image until the
+         *  new one is uploaded, e.g. to reload it
+         */
+        void LoadAsync(const std::shared_ptr<Texture2D>& texture,
+                       const std::string& path,
+                       const TextureLoadOptions& options
+                           = TextureLoadOptions());
+
+        /**
+         * @brief Replaces the image of a texture with the 1x1 placeholder,
+         *  its storage is freed, see "Texture2D::SetImage"
+         */
+        static void SetPlaceholder(Texture2D& texture);
+
+        /**
+         * @brief Uploads decoded images and publishes their textures, call
+         *  once per frame
+         * @param byteBudget Bytes uploaded at most, 0 for no limit, the
+         *  first image is always uploaded
+         * @return Number of published textures
+         */
+        uint32_t Update(size_t byteBudget = 0);
+
+        /** @brief Blocks until all requested textures are published */
+        void Flush();
+
+        /** @return Textures requested and not published yet */
+        uint32_t GetPendingCount() const {
+            return static_cast<uint32_t>(m_Requests.size());
+        }
+        uint64_t GetLoadedCount() const { return m_Loaded; }
+        uint64_t GetFailedCount() const { return m_Failed; }
+
+    private:
+        struct Request
+        {
+            std::shared_ptr<Texture2D> texture;
+            TextureLoadOptions options;
+            std::string path;
+        };
+
+        /** @brief Decoded by a worker, waiting for the GL thread */
+        struct DecodedImage
+        {
+            uint64_t id{ 0 };
+            std::shared_ptr<unsigned char> pixels;
+            uint32_t width{ 0 };
+            uint32_t height{ 0 };
+            uint32_t components{ 0 };
+            /// KTX2 or DDS file, instead of the pixels
+            std::shared_ptr<CompressedImage> compressed;
+            /// With "cpuMipmaps", instead of the pixels
+            std::shared_ptr<MipChain> mips;
+            uint64_t contentHash{ 0 };  ///< Of the file, if asked for
+            std::string error;
+
+            bool Loaded() const {
+                return pixels != nullptr || compressed != nullptr
+                       || mips != nullptr;
+            }
+            size_t Size() const;
+        };
+
+        /**
+         * @param mips Null if the mips are generated on the GPU
+         * @param hash Hashes the file, it is read once for both
+         */
+        void Decode(uint64_t id, const std::string& path,
+                    uint32_t components, const MipChainSpec* mips,
+                    bool hash);
+        void PushDecoded(DecodedImage&& image);
+
+        /** @return Whether the image was uploaded, false to retry later */
+        bool Upload(const DecodedImage& image, Request& request);
+        void Publish(Request& request, bool loaded);
+
+    private:
+        std::unique_ptr<ThreadPool> m_Decoders;
+        std::atomic<bool> m_Cancelled{ false };
+
+        std::mutex m_Mutex;     ///< Guards the decoded images
+        std::condition_variable m_DecodedReady;
+        std::deque<DecodedImage> m_Decoded;
+
+        std::unordered_map<uint64_t, Request> m_Requests;
+        uint64_t m_NextID{ 1 };
+
+        std::unique_ptr<StagingRing> m_Staging;
+
+        uint64_t m_Loaded{ 0 };
+        uint64_t m_Failed{ 0 };
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_OPENGL_TEXTURE_LOADER_H_
@@ -0,0 +1,250 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "SGL/pch.h"
+#include "SGL/opengl/TextureStreamer.h"
+#include "SGL/opengl/StagingRing.h"
+#include "SGL/opengl/Texture2D.h"
+#include "SGL/core/Profiler.h"
+#include "SGL/image/MipChain.h"
+
+#include <cstring>
+
+
+namespace sgl
+{
+    std::shared_ptr<TextureStreamer> TextureStreamer::Create(
+        size_t stagingSize, uint32_t fadeFrames)
+    {
+        return std::make_shared<TextureStreamer>(stagingSize, fadeFrames);
+    }
+
+    // =========================================================================
+
+    TextureStreamer::TextureStreamer(size_t stagingSize, uint32_t fadeFrames)
+        : m_Staging(std::make_unique<StagingRing>(stagingSize))
+    {
+        SGL_FUNCTION();
+
+        m_FadeStep = fadeFrames > 0 ? 1.0f / fadeFrames : 0.0f;
+    }
+
+    TextureStreamer::~TextureStreamer()
+    {
+        SGL_FUNCTION();
+
+        if (!m_Entries.empty())
+        {
+            SGL_LOG_WARN("{} textures were not fully streamed, they keep "
+                         "their uploaded levels", m_Entries.size());
+        }
+    }
+
+    void TextureStreamer::Stream(const std::shared_ptr<Texture2D>& texture,
+                                 std::shared_ptr<const MipChain> chain,
+                                 uint32_t format, uint32_t imageFormat,
+                                 uint32_t initialSize)
+    {
+        SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("TextureStreamer::Stream");
+        SGL_ASSERT(chain != nullptr && !chain->Empty());
+
+        // A texture streamed again drops its previous chain
+        Cancel(texture);
+
+        const uint32_t kLevelCount = chain->GetLevelCount();
+        texture->SetStorage(chain->levels[0].width, chain->levels[0].height,
+                            kLevelCount, format, imageFormat);
+
+        uint32_t first = kLevelCount - 1;
+        while (first > 0 && chain->levels[first - 1].width <= initialSize
+               && chain->levels[first - 1].height <= initialSize)
+        {
+            --first;
+        }
+
+        for (uint32_t level = first; level < kLevelCount; ++level)
+        {
+            texture->UpdateLevel(level, chain->GetPixels(level));
+            m_Uploaded += chain->levels[level].size;
+        }
+        texture->SetBaseLevel(first);
+
+        if (first > 0)
+        {
+            Entry entry;
+            entry.texture = texture;
+            entry.chain = std::move(chain);
+            entry.resident = first;
+            m_Entries.push_back(std::move(entry));
+        }
+    }
+
+    std::shared_ptr<Texture2D> TextureStreamer::Stream(
+        std::shared_ptr<const MipChain> chain, uint32_t format,
+        uint32_t imageFormat, uint32_t initialSize)
+    {
+        auto texture = Texture2D::Create();
+        Stream(texture, std::move(chain), format, imageFormat, initialSize);
+        return texture;
+    }
+
+    size_t TextureStreamer::Update(size_t byteBudget)
+    {
+        SGL_PROFILE_SCOPE("TextureStreamer::Update");
+
+        m_Staging->Release(false);
+
+        for (Entry& entry : m_Entries)
+        {
+            if (entry.minLod > 0.0f)
+            {
+                entry.minLod = std::max(entry.minLod - m_FadeStep, 0.0f);
+                entry.texture->SetMinLod(entry.minLod > 0.0f
+                                         ? entry.minLod
+                                         : Texture2D::DEFAULT_MIN_LOD);
+            }
+        }
+
+        size_t uploaded = 0;
+        while (byteBudget == 0 || uploaded < byteBudget)
+        {
+            // Coarsest first, a level already started is finished first
+            Entry* next = nullptr;
+            for (Entry& entry : m_Entries)
+            {
+                if (entry.resident == 0)
+                    continue;
+
+                if (next == nullptr || entry.resident > next->resident
+                    || (entry.resident == next->resident
+                        && entry.nextRow > 0 && next->nextRow == 0))
+                {
+                    next = &entry;
+                }
+            }
+            if (next == nullptr)
+                break;
+
+            const size_t kAllowed = byteBudget == 0
+                                    ? std::numeric_limits<size_t>::max()
+                                    : byteBudget - uploaded;
+            const size_t kBytes = UploadStrip(*next, kAllowed,
+                                              uploaded == 0);
+            if (kBytes == 0)
+                break;
+
+            uploaded += kBytes;
+        }
+
+        // One fence for the ranges written by this call
+        m_Staging->Commit();
+        m_Uploaded += uploaded;
+
+        // Done once fully resident and faded in, or released by the caller
+        //  meanwhile, only the streamer holds it then
+        m_Entries.erase(std::remove_if(m_Entries.begin(), m_Entries.end(),
+                                       [](const Entry& entry) {
+                                           return (entry.resident == 0
+                                                   && entry.minLod <= 0.0f)
+                                               || entry.texture.use_count()
+                                                  == 1;
+                                       }),
+                        m_Entries.end());
+
+        return uploaded;
+    }
+
+    void TextureStreamer::Cancel(const std::shared_ptr<Texture2D>& texture)
+    {
+        m_Entries.erase(std::remove_if(m_Entries.begin(), m_Entries.end(),
+                                       [&texture](const Entry& entry) {
+                                           return entry.texture == texture;
+                                       }),
+                        m_Entries.end());
+    }
+
+    void TextureStreamer::Flush()
+    {
+        SGL_FUNCTION();
+
+        while (!m_Entries.empty())
+        {
+            for (Entry& entry : m_Entries)
+            {
+                entry.minLod = 0.0f;
+                entry.texture->SetMinLod(Texture2D::DEFAULT_MIN_LOD);
+            }
+
+            // Waits for the GPU to free staging ranges
+            if (Update(0) == 0)
+                m_Staging->Release(true);
+        }
+    }
+
+    size_t TextureStreamer::UploadStrip(Entry& entry, size_t maxBytes,
+                                        bool force)
+    {
+        const uint32_t kLevel = entry.resident - 1;
+        const MipLevel& kMip = entry.chain->levels[kLevel];
+        const size_t kRowSize = size_t(kMip.width) * entry.chain->channels;
+
+        // Half the ring at most, so that a strip fits again once the GPU
+        //  is past the previous frame
+        const size_t kMaxStrip = m_Staging->GetSize() / 2;
+        const bool kStaged = kRowSize <= kMaxStrip;
+
+        size_t rows = std::min<size_t>(kMip.height - entry.nextRow,
+                                       maxBytes / kRowSize);
+        if (kStaged)
+            rows = std::min(rows, kMaxStrip / kRowSize);
+        if (rows == 0)
+        {
+            if (!force)
+                return 0;
+            rows = 1;
+        }
+
+        const size_t kSize = rows * kRowSize;
+        const unsigned char* kPixels = entry.chain->GetPixels(kLevel)
+                                       + entry.nextRow * kRowSize;
+        const uint32_t kRows = static_cast<uint32_t>(rows);
+
+        if (kStaged)
+        {
+            const size_t kOffset = m_Staging->Allocate(kSize);
+            if (kOffset == m_Staging->GetSize())
+                return 0;
+
+            std::memcpy(m_Staging->GetData(kOffset), kPixels, kSize);
+            entry.texture->UpdateRowsFromBuffer(kLevel, entry.nextRow, kRows,
+                                                m_Staging->GetBuffer(),
+                                                kOffset);
+        }
+        else
+        {
+            // Rows larger than the ring, uploaded from the client memory
+            entry.texture->UpdateRows(kLevel, entry.nextRow, kRows, kPixels);
+        }
+
+        entry.nextRow += kRows;
+        if (entry.nextRow == kMip.height)
+        {
+            // The level of detail sampled stays where it was, then fades
+            //  from the level below
+            entry.resident = kLevel;
+            entry.nextRow = 0;
+            entry.texture->SetBaseLevel(kLevel);
+            if (m_FadeStep > 0.0f)
+            {
+                entry.minLod += 1.0f;
+                entry.texture->SetMinLod(entry.minLod);
+            }
+        }
+
+        return kSize;
+    }
+
+} // namespace sgl
@@ -0,0 +1,124 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_OPENGL_TEXTURE_STREAMER_H_
+#define SGL_OPENGL_TEXTURE_STREAMER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+namespace sgl
+{
+    class StagingRing;
+    class Texture2D;
+    struct MipChain;
+
+    /**
+     * @brief Streams mip chains into textures over frames. A texture gets
+     *  the storage of all its levels and its smallest levels right away,
+     *  sampling is clamped to the uploaded levels with GL_TEXTURE_BASE_LEVEL.
+     *  "Update" uploads the larger levels in strips of rows under a byte
+     *  budget, the coarsest first across textures, and fades each completed
+     *  level in through GL_TEXTURE_MIN_LOD.
+     *  All methods must be called from the GL thread.
+     */
+    class TextureStreamer
+    {
+    public:
+        /** @brief Bytes of the staging ring, larger strips skip it */
+        static constexpr size_t DefaultStagingSize = 16 << 20;
+        /** @brief Levels of 64x64 and smaller are uploaded by "Stream" */
+        static constexpr uint32_t DefaultInitialSize = 64;
+        static constexpr uint32_t DefaultFadeFrames = 8;
+
+        /** @param fadeFrames Frames a level takes to fade in, 0 for none */
+        static std::shared_ptr<TextureStreamer> Create(
+            size_t stagingSize = DefaultStagingSize,
+            uint32_t fadeFrames = DefaultFadeFrames);
+
+    public:
+        TextureStreamer(size_t stagingSize = DefaultStagingSize,
+                        uint32_t fadeFrames = DefaultFadeFrames);
+        ~TextureStreamer();
+
+        TextureStreamer(const TextureStreamer&) = delete;
+        TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+        /**
+         * @brief Replaces the storage of a texture with that of the chain,
+         *  see "Texture2D::SetStorage", and uploads its smallest levels
+         * @param chain Kept until all its levels are uploaded
+         * @param format Sized internal format, e.g. GL_SRGB8_ALPHA8
+         * @param imageFormat Of "chain.channels" unsigned bytes
+         * @param initialSize Levels no larger on either side are uploaded
+         *  now, the smallest level always is
+         */
+        void Stream(const std::shared_ptr<Texture2D>& texture,
+                    std::shared_ptr<const MipChain> chain,
+                    uint32_t format,
+                    uint32_t imageFormat,
+                    uint32_t initialSize = DefaultInitialSize);
+
+        /** @brief "Stream" into a new texture */
+        std::shared_ptr<Texture2D> Stream(
+            std::shared_ptr<const MipChain> chain,
+            uint32_t format,
+            uint32_t imageFormat,
+            uint32_t initialSize = DefaultInitialSize);
+
+        /**
+         * @brief Uploads the next strips and steps the fades, call once per
+         *  frame
+         * @param byteBudget Bytes uploaded at most, 0 for no limit, a row is
+         *  always uploaded
+         * @return Bytes uploaded
+         */
+        size_t Update(size_t byteBudget);
+
+        /**
+         * @brief Stops streaming a texture, it keeps the levels uploaded so
+         *  far, e.g. before its storage is replaced
+         */
+        void Cancel(const std::shared_ptr<Texture2D>& texture);
+
+        /** @brief Uploads all the levels left and ends the fades */
+        void Flush();
+
+        /** @return Textures with levels left to upload or fade in */
+        uint32_t GetPendingCount() const {
+            return static_cast<uint32_t>(m_Entries.size());
+        }
+        uint64_t GetUploadedBytes() const { return m_Uploaded; }
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<Texture2D> texture;
+            std::shared_ptr<const MipChain> chain;
+            uint32_t resident{ 0 };     ///< Largest level uploaded
+            uint32_t nextRow{ 0 };      ///< Of the level above it
+            float minLod{ 0.0f };       ///< Goes down to 0 as it fades in
+        };
+
+        /**
+         * @param force Uploads a row even if it is over "maxBytes"
+         * @return Bytes uploaded, 0 if the staging ring is full
+         */
+        size_t UploadStrip(Entry& entry, size_t maxBytes, bool force);
+
+    private:
+        std::unique_ptr<StagingRing> m_Staging;
+        std::vector<Entry> m_Entries;
+
+        float m_FadeStep{ 0.0f };       ///< Of "minLod" per frame
+        uint64_t m_Uploaded{ 0 };
+    };
+
+} // namespace sgl
+
+
+#endif // SGL_OPENGL_TEXTURE_STREAMER_H_
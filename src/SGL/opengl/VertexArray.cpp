@@ -8,6 +8,7 @@
 
 #include <SGL/opengl/VertexBuffer.h>
 #include <SGL/opengl/BufferLayout.h>
+#include <SGL/core/RenderStats.h>
 
 
 namespace sgl
@@ -248,6 +249,7 @@ namespace sgl
     void VertexArray::Bind() const
     {
         glBindVertexArray(m_ID);
+        SGL_RENDER_STAT(vertexArrayBinds, 1);
     }
 
     void VertexArray::UnBind()
@@ -255,4 +257,26 @@ namespace sgl
         glBindVertexArray(0);
     }
 
+    void VertexArray::DrawArrays(uint32_t mode, int32_t first, uint32_t count,
+                                 uint32_t instances)
+    {
+        if (instances > 1)
+            glDrawArraysInstanced(mode, first, count, instances);
+        else
+            glDrawArrays(mode, first, count);
+
+        SGL_RENDER_STAT(drawCalls, 1);
+    }
+
+    void VertexArray::DrawElements(uint32_t mode, uint32_t count,
+                                   uint32_t type, uint32_t instances)
+    {
+        if (instances > 1)
+            glDrawElementsInstanced(mode, count, type, nullptr, instances);
+        else
+            glDrawElements(mode, count, type, nullptr);
+
+        SGL_RENDER_STAT(drawCalls, 1);
+    }
+
 } // namespace sgl
@@ -34,6 +34,21 @@ namespace sgl
         void Bind() const;
         static void UnBind();
 
+        /**
+         * @brief Draws from the vertex buffers, the array and a shader
+         *  program must be bound
+         * @param instances More than 1 issues an instanced draw
+         */
+        static void DrawArrays(uint32_t mode, int32_t first, uint32_t count,
+                               uint32_t instances = 1);
+        /**
+         * @brief Draws "count" indices of the index buffer
+         * @param type Of the indices, @see IndexBuffer::GetIndexType
+         */
+        static void DrawElements(uint32_t mode, uint32_t count,
+                                 uint32_t type = GL_UNSIGNED_INT,
+                                 uint32_t instances = 1);
+
         uint32_t GetID() const { return m_ID; }
 
         std::vector< std::shared_ptr<VertexBuffer> > GetVertexBuffers() const {
@@ -5,6 +5,8 @@
 
 #include "SGL/pch.h"
 #include <SGL/opengl/VertexBuffer.h>
+#include <SGL/core/Profiler.h>
+#include <SGL/core/RenderStats.h>
 
 
 namespace sgl
@@ -58,6 +60,7 @@ namespace sgl
                                     bool immutable) const
     {
         SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Upload VertexBuffer");
 
         if (immutable)
             glNamedBufferStorage(m_ID, size, data, GL_DYNAMIC_STORAGE_BIT);
@@ -67,6 +70,9 @@ namespace sgl
                                                  : GL_STATIC_DRAW;
             glNamedBufferData(m_ID, size, data, usage);
         }
+
+        if (data != nullptr)
+            SGL_RENDER_STAT(bytesUploaded, size);
     }
 
     void VertexBuffer::DeleteBuffer()
@@ -100,7 +106,9 @@ namespace sgl
                                   int32_t offset) const
     {
         SGL_FUNCTION();
+        SGL_PROFILE_SCOPE("Upload VertexBuffer");
         glNamedBufferSubData(m_ID, offset, size, data);
+        SGL_RENDER_STAT(bytesUploaded, size);
     }
 
 } // namespace sgl
@@ -0,0 +1,300 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "Test.h"
+
+#include <cstring>
+
+
+using namespace sgl;
+
+// Reference decoders of the blocks, as in the S3TC and RGTC specifications
+
+static void Decode565(uint32_t color, int* outRGB)
+{
+    const int kR = (color >> 11) & 31;
+    const int kG = (color >> 5) & 63;
+    const int kB = color & 31;
+    outRGB[0] = (kR << 3) | (kR >> 2);
+    outRGB[1] = (kG << 2) | (kG >> 4);
+    outRGB[2] = (kB << 3) | (kB >> 2);
+}
+
+/** @param outRGBA 16 texels, alpha is 0 for the transparent index */
+static void DecodeColorBlock(const unsigned char* block, bool threeColors,
+                             int outRGBA[16][4])
+{
+    const uint32_t kColor0 = block[0] | block[1] << 8;
+    const uint32_t kColor1 = block[2] | block[3] << 8;
+
+    int palette[4][4] = {};
+    Decode565(kColor0, palette[0]);
+    Decode565(kColor1, palette[1]);
+    const bool kFourColors = !threeColors || kColor0 > kColor1;
+    for (int c = 0; c < 3; ++c)
+    {
+        if (kFourColors)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    for (int i = 0; i < 4; ++i)
+        palette[i][3] = 255;
+    if (!kFourColors)
+        palette[3][3] = 0;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        const int kIndex = (block[4 + i / 4] >> ((i % 4) * 2)) & 3;
+        std::memcpy(outRGBA[i], palette[kIndex], sizeof(palette[kIndex]));
+    }
+}
+
+static void DecodeAlphaBlock(const unsigned char* block, int outValues[16])
+{
+    const int kA0 = block[0];
+    const int kA1 = block[1];
+
+    int palette[8] = { kA0, kA1 };
+    if (kA0 > kA1)
+    {
+        for (int i = 1; i < 7; ++i)
+            palette[i + 1] = ((7 - i) * kA0 + i * kA1) / 7;
+    }
+    else
+    {
+        for (int i = 1; i < 5; ++i)
+            palette[i + 1] = ((5 - i) * kA0 + i * kA1) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; ++i)
+        bits |= uint64_t(block[2 + i]) << (8 * i);
+    for (int i = 0; i < 16; ++i)
+        outValues[i] = palette[(bits >> (3 * i)) & 7];
+}
+
+/** @return RGBA texels of a BC1, BC3, BC4 or BC5 level */
+static std::vector<int> DecodeLevel(const CompressedImage& image,
+                                    uint32_t level)
+{
+    const uint32_t kWidth = std::max(image.width >> level, 1u);
+    const uint32_t kHeight = std::max(image.height >> level, 1u);
+    const uint32_t kBlocksX = (kWidth + 3) / 4;
+    const uint32_t kBlockBytes
+        = GetCompressedFormatInfo(image.format)->blockBytes;
+    const unsigned char* kBlocks
+        = static_cast<const unsigned char*>(image.levels[level].data);
+
+    std::vector<int> texels(size_t(kWidth) * kHeight * 4, 0);
+    for (uint32_t y = 0; y < kHeight; ++y)
+    {
+        for (uint32_t x = 0; x < kWidth; ++x)
+        {
+            const unsigned char* kBlock
+                = kBlocks + ((y / 4) * kBlocksX + x / 4) * kBlockBytes;
+            const int kTexel = (y % 4) * 4 + x % 4;
+            int* out = &texels[(size_t(y) * kWidth + x) * 4];
+
+            int rgba[16][4];
+            int values[16];
+            switch (image.format)
+            {
+                case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+                case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+                    DecodeColorBlock(kBlock, true, rgba);
+                    std::memcpy(out, rgba[kTexel], sizeof(rgba[kTexel]));
+                    break;
+                case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                    DecodeColorBlock(kBlock + 8, false, rgba);
+                    DecodeAlphaBlock(kBlock, values);
+                    std::memcpy(out, rgba[kTexel], sizeof(rgba[kTexel]));
+                    out[3] = values[kTexel];
+                    break;
+                case GL_COMPRESSED_RED_RGTC1:
+                    DecodeAlphaBlock(kBlock, values);
+                    out[0] = values[kTexel];
+                    break;
+                case GL_COMPRESSED_RG_RGTC2:
+                    DecodeAlphaBlock(kBlock, values);
+                    out[0] = values[kTexel];
+                    DecodeAlphaBlock(kBlock + 8, values);
+                    out[1] = values[kTexel];
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    return texels;
+}
+
+/** @brief Smooth gradients, as in most textures, and a hard edge */
+static std::vector<unsigned char> MakePattern(uint32_t width, uint32_t height,
+                                              uint32_t channels)
+{
+    std::vector<unsigned char> pixels(size_t(width) * height * channels);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const int kValues[4] = { int(x * 255 / (width - 1)),
+                                     int(y * 255 / (height - 1)),
+                                     x < width / 2 ? 40 : 200,
+                                     int((x + y) * 255
+                                         / (width + height - 2)) };
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                pixels[(size_t(y) * width + x) * channels + c]
+                    = static_cast<unsigned char>(kValues[c]);
+            }
+        }
+    }
+    return pixels;
+}
+
+/** @return Largest difference of the channels over all the texels */
+static int MaxError(const std::vector<unsigned char>& pixels,
+                    uint32_t channels, const std::vector<int>& decoded,
+                    uint32_t checkedChannels)
+{
+    int error = 0;
+    const size_t kTexels = pixels.size() / channels;
+    for (size_t i = 0; i < kTexels; ++i)
+    {
+        for (uint32_t c = 0; c < checkedChannels; ++c)
+        {
+            error = std::max(error, std::abs(pixels[i * channels + c]
+                                             - decoded[i * 4 + c]));
+        }
+    }
+    return error;
+}
+
+// =============================================================================
+
+SGL_TEST(EncodesSolidColorsExactly)
+{
+    // Colors that 5:6:5 represents, odd sizes pad with the edge texels
+    const unsigned char kColor[4] = { 255, 0, 255, 255 };
+    std::vector<unsigned char> pixels;
+    for (uint32_t i = 0; i < 5 * 3; ++i)
+        pixels.insert(pixels.end(), kColor, kColor + 4);
+
+    for (const uint32_t kFormat : { GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+                                    GL_COMPRESSED_RGBA_S3TC_DXT5_EXT })
+    {
+        const CompressedImage kImage = CompressImage(pixels.data(), 5, 3, 4,
+                                                     kFormat);
+        SGL_REQUIRE(kImage.Loaded());
+        SGL_CHECK_EQ(kImage.levels[0].size,
+                     GetCompressedImageSize(kFormat, 5, 3));
+        SGL_CHECK_EQ(MaxError(pixels, 4, DecodeLevel(kImage, 0), 4), 0);
+    }
+}
+
+SGL_TEST(EncodesGradientsClosely)
+{
+    struct Case
+    {
+        uint32_t format;
+        uint32_t channels;
+        int maxError;
+    };
+    // Bounds of the range fit with a few codes of margin, a broken
+    //  endpoint or index order is off by far more
+    const Case kCases[] = {
+        { GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 3, 24 },
+        { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 4, 24 },
+        { GL_COMPRESSED_RED_RGTC1, 1, 4 },
+        { GL_COMPRESSED_RG_RGTC2, 2, 4 } };
+
+    for (const Case& kCase : kCases)
+    {
+        const std::vector<unsigned char> kPixels = MakePattern(
+            64, 32, kCase.channels);
+        const CompressedImage kImage = CompressImage(
+            kPixels.data(), 64, 32, kCase.channels, kCase.format);
+        SGL_REQUIRE(kImage.Loaded());
+
+        const int kError = MaxError(kPixels, kCase.channels,
+                                    DecodeLevel(kImage, 0), kCase.channels);
+        SGL_CHECK(kError <= kCase.maxError);
+        if (kError > kCase.maxError)
+        {
+            std::fprintf(stderr, "  %s: error %d\n",
+                         GetCompressedFormatName(kCase.format), kError);
+        }
+    }
+}
+
+SGL_TEST(SameBlocksOnAPool)
+{
+    const std::vector<unsigned char> kPixels = MakePattern(256, 128, 4);
+    ThreadPool pool(4);
+
+    for (const uint32_t kFormat : { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+                                    GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+                                    GL_COMPRESSED_RG_RGTC2 })
+    {
+        const CompressedImage kSerial = CompressImage(kPixels.data(), 256,
+                                                      128, 4, kFormat);
+        const CompressedImage kParallel = CompressImage(
+            kPixels.data(), 256, 128, 4, kFormat, &pool);
+        SGL_REQUIRE(kSerial.Loaded() && kParallel.Loaded());
+        SGL_CHECK(kSerial.file == kParallel.file);
+    }
+}
+
+SGL_TEST(EncodesEveryLevelOfAChain)
+{
+    const std::vector<unsigned char> kPixels = MakePattern(20, 12, 4);
+    const MipChain kChain = BuildMipChain(kPixels.data(), 20, 12, 4);
+    const CompressedImage kImage = CompressMipChain(
+        kChain, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+
+    SGL_REQUIRE(kImage.Loaded());
+    SGL_CHECK_EQ(kImage.levelCount, kChain.GetLevelCount());
+    SGL_REQUIRE(kImage.levels.size() == kChain.levels.size());
+    for (uint32_t i = 0; i < kImage.levelCount; ++i)
+    {
+        const MipLevel& kLevel = kChain.levels[i];
+        SGL_CHECK_EQ(kImage.levels[i].size,
+                     GetCompressedImageSize(kImage.format, kLevel.width,
+                                            kLevel.height));
+    }
+
+    // The last level is a single texel, the average of the image
+    const std::vector<int> kLast = DecodeLevel(kImage, kImage.levelCount - 1);
+    const unsigned char* kTexel = kChain.GetPixels(kChain.GetLevelCount() - 1);
+    for (uint32_t c = 0; c < 4; ++c)
+        SGL_CHECK(std::abs(kLast[c] - kTexel[c]) <= 8);
+}
+
+SGL_TEST(RejectsOtherFormats)
+{
+    const unsigned char kPixels[4] = {};
+    SGL_CHECK(CanCompressFormat(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT));
+    SGL_CHECK(!CanCompressFormat(GL_COMPRESSED_RGBA_BPTC_UNORM));
+
+    const CompressedImage kImage = CompressImage(
+        kPixels, 1, 1, 4, GL_COMPRESSED_RGBA_BPTC_UNORM);
+    SGL_CHECK(!kImage.Loaded());
+    SGL_CHECK(!kImage.error.empty());
+
+    const CompressedImage kEmpty = CompressImage(
+        nullptr, 0, 0, 4, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+    SGL_CHECK(!kEmpty.Loaded());
+}
+
+SGL_TEST_MAIN()
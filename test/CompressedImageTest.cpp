@@ -0,0 +1,228 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "Test.h"
+
+#include <cstring>
+
+
+using namespace sgl;
+
+static void WriteU32(std::vector<unsigned char>& file, size_t offset,
+                     uint32_t value)
+{
+    std::memcpy(file.data() + offset, &value, sizeof(value));
+}
+
+static void WriteU64(std::vector<unsigned char>& file, size_t offset,
+                     uint64_t value)
+{
+    std::memcpy(file.data() + offset, &value, sizeof(value));
+}
+
+/** @return Bytes counting up from "first", to find where levels point */
+static std::vector<unsigned char> MakeBlocks(size_t size, unsigned char first)
+{
+    std::vector<unsigned char> blocks(size);
+    for (size_t i = 0; i < size; ++i)
+        blocks[i] = static_cast<unsigned char>(first + i);
+    return blocks;
+}
+
+/**
+ * @brief KTX2 file of one face, the smallest level first in the file as
+ *  the specification recommends
+ */
+static std::vector<unsigned char> MakeKTX2(
+    uint32_t vkFormat, uint32_t width, uint32_t height,
+    const std::vector<std::vector<unsigned char>>& levels)
+{
+    static constexpr unsigned char kIdentifier[12] = {
+        0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    const size_t kIndexEnd = 80 + levels.size() * 24;
+    std::vector<unsigned char> file(kIndexEnd);
+    std::memcpy(file.data(), kIdentifier, sizeof(kIdentifier));
+    WriteU32(file, 12, vkFormat);
+    WriteU32(file, 16, 1);
+    WriteU32(file, 20, width);
+    WriteU32(file, 24, height);
+    WriteU32(file, 36, 1);
+    WriteU32(file, 40, static_cast<uint32_t>(levels.size()));
+
+    for (size_t level = levels.size(); level-- > 0;)
+    {
+        const size_t kEntry = 80 + level * 24;
+        WriteU64(file, kEntry, file.size());
+        WriteU64(file, kEntry + 8, levels[level].size());
+        WriteU64(file, kEntry + 16, levels[level].size());
+        file.insert(file.end(), levels[level].begin(), levels[level].end());
+    }
+    return file;
+}
+
+/** @brief DDS file with a legacy FourCC, no DX10 header */
+static std::vector<unsigned char> MakeDDS(
+    const char* fourCC, uint32_t width, uint32_t height,
+    const std::vector<std::vector<unsigned char>>& levels)
+{
+    std::vector<unsigned char> file(128);
+    std::memcpy(file.data(), "DDS ", 4);
+    WriteU32(file, 4, 124);
+    WriteU32(file, 8, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000);
+    WriteU32(file, 12, height);
+    WriteU32(file, 16, width);
+    WriteU32(file, 28, static_cast<uint32_t>(levels.size()));
+    WriteU32(file, 76, 32);
+    WriteU32(file, 80, 0x4);
+    std::memcpy(file.data() + 84, fourCC, 4);
+    WriteU32(file, 108, 0x1000);
+
+    for (const std::vector<unsigned char>& kLevel : levels)
+        file.insert(file.end(), kLevel.begin(), kLevel.end());
+    return file;
+}
+
+static bool SameBytes(const CompressedLevel& level,
+                      const std::vector<unsigned char>& bytes)
+{
+    return level.size == bytes.size()
+           && std::memcmp(level.data, bytes.data(), bytes.size()) == 0;
+}
+
+// =============================================================================
+
+SGL_TEST(ParsesKTX2Levels)
+{
+    // BC1 8x4, then 4x2
+    const std::vector<std::vector<unsigned char>> kLevels = {
+        MakeBlocks(16, 0), MakeBlocks(8, 100) };
+    const CompressedImage kImage = ParseCompressedImage(
+        MakeKTX2(131, 8, 4, kLevels));
+
+    SGL_REQUIRE(kImage.Loaded());
+    SGL_CHECK(kImage.error.empty());
+    SGL_CHECK_EQ(kImage.format, uint32_t(GL_COMPRESSED_RGB_S3TC_DXT1_EXT));
+    SGL_CHECK_EQ(kImage.width, 8u);
+    SGL_CHECK_EQ(kImage.height, 4u);
+    SGL_CHECK_EQ(kImage.levelCount, 2u);
+    SGL_CHECK_EQ(kImage.faceCount, 1u);
+    SGL_REQUIRE(kImage.levels.size() == 2);
+    SGL_CHECK(SameBytes(kImage.levels[0], kLevels[0]));
+    SGL_CHECK(SameBytes(kImage.levels[1], kLevels[1]));
+    SGL_CHECK_EQ(kImage.Size(), size_t(24));
+}
+
+SGL_TEST(ParsesLegacyDDS)
+{
+    // BC3 5x5 pads to 2x2 blocks, then 2x2 and 1x1 of a block each
+    const std::vector<std::vector<unsigned char>> kLevels = {
+        MakeBlocks(64, 0), MakeBlocks(16, 64), MakeBlocks(16, 80) };
+    const CompressedImage kImage = ParseCompressedImage(
+        MakeDDS("DXT5", 5, 5, kLevels));
+
+    SGL_REQUIRE(kImage.Loaded());
+    SGL_CHECK_EQ(kImage.format, uint32_t(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT));
+    SGL_CHECK_EQ(kImage.width, 5u);
+    SGL_CHECK_EQ(kImage.height, 5u);
+    SGL_REQUIRE(kImage.levels.size() == 3);
+    for (size_t i = 0; i < kLevels.size(); ++i)
+        SGL_CHECK(SameBytes(kImage.levels[i], kLevels[i]));
+}
+
+SGL_TEST(RejectsBrokenFiles)
+{
+    const std::vector<std::vector<unsigned char>> kLevels = {
+        MakeBlocks(16, 0), MakeBlocks(8, 100) };
+    const std::vector<unsigned char> kKTX2 = MakeKTX2(131, 8, 4, kLevels);
+
+    std::vector<std::vector<unsigned char>> broken;
+
+    // Not a container, truncated header and level
+    broken.push_back({ 'P', 'N', 'G', ' ', 0, 0, 0, 0 });
+    broken.emplace_back(kKTX2.begin(), kKTX2.begin() + 40);
+    broken.emplace_back(kKTX2.begin(), kKTX2.end() - 1);
+    // Uncompressed VkFormat, R8G8B8A8_UNORM
+    broken.push_back(kKTX2);
+    WriteU32(broken.back(), 12, 37);
+    // Supercompressed
+    broken.push_back(kKTX2);
+    WriteU32(broken.back(), 44, 2);
+    // More levels than a 8x4 chain has
+    broken.push_back(MakeKTX2(131, 8, 4, { MakeBlocks(16, 0),
+                                           MakeBlocks(8, 0),
+                                           MakeBlocks(8, 0),
+                                           MakeBlocks(8, 0),
+                                           MakeBlocks(8, 0) }));
+    // Unknown FourCC, and a level past the end
+    broken.push_back(MakeDDS("ABCD", 4, 4, { MakeBlocks(8, 0) }));
+    broken.push_back(MakeDDS("DXT1", 8, 8, { MakeBlocks(24, 0) }));
+
+    for (std::vector<unsigned char>& file : broken)
+    {
+        const CompressedImage kImage = ParseCompressedImage(std::move(file));
+        SGL_CHECK(!kImage.Loaded());
+        SGL_CHECK(!kImage.error.empty());
+        SGL_CHECK(kImage.levels.empty());
+    }
+}
+
+SGL_TEST(DDSRoundTripFromMapping)
+{
+    std::vector<unsigned char> pixels(12 * 8 * 4);
+    for (size_t i = 0; i < pixels.size(); ++i)
+        pixels[i] = static_cast<unsigned char>(i * 7);
+
+    const MipChain kChain = BuildMipChain(pixels.data(), 12, 8, 4);
+    const CompressedImage kWritten = CompressMipChain(
+        kChain, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+    SGL_REQUIRE(kWritten.Loaded());
+
+    const std::string kPath = test::TempPath("SGLCompressedImageTest.dds");
+    const test::RemoveOnExit kPathRemoved(kPath);
+    SGL_REQUIRE(WriteDDS(kPath, kWritten));
+
+    CompressedImage read = LoadCompressedImage(kPath);
+    SGL_REQUIRE(read.Loaded());
+    SGL_CHECK(read.mapping.IsOpen());
+    SGL_CHECK(read.file.empty());
+
+    // Levels point into the mapping, which moves with the image
+    const CompressedImage kMoved = std::move(read);
+    SGL_CHECK_EQ(kMoved.format, kWritten.format);
+    SGL_CHECK_EQ(kMoved.width, 12u);
+    SGL_CHECK_EQ(kMoved.height, 8u);
+    SGL_REQUIRE(kMoved.levels.size() == kWritten.levels.size());
+    for (size_t i = 0; i < kMoved.levels.size(); ++i)
+    {
+        const CompressedLevel& kLevel = kMoved.levels[i];
+        SGL_CHECK(kLevel.data >= kMoved.mapping.GetData());
+        const unsigned char* const kEnd
+            = static_cast<const unsigned char*>(kLevel.data) + kLevel.size;
+        SGL_CHECK(kEnd <= kMoved.mapping.GetData()
+                          + kMoved.mapping.GetSize());
+        SGL_CHECK_EQ(kLevel.size, kWritten.levels[i].size);
+        SGL_CHECK(std::memcmp(kLevel.data, kWritten.levels[i].data,
+                              kLevel.size) == 0);
+    }
+}
+
+SGL_TEST(ReportsMissingFiles)
+{
+    const CompressedImage kImage = LoadCompressedImage(
+        test::TempPath("SGLCompressedImageTest_missing.ktx2"));
+    SGL_CHECK(!kImage.Loaded());
+    SGL_CHECK(!kImage.error.empty());
+}
+
+SGL_TEST(DetectsExtensions)
+{
+    SGL_CHECK(IsCompressedImageFile("textures/wall.ktx2"));
+    SGL_CHECK(IsCompressedImageFile("textures/WALL.DDS"));
+    SGL_CHECK(!IsCompressedImageFile("textures/wall.png"));
+    SGL_CHECK(!IsCompressedImageFile("textures.dds/wall"));
+}
+
+SGL_TEST_MAIN()
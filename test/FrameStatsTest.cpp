@@ -0,0 +1,78 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "Test.h"
+
+#include <cmath>
+
+
+using namespace sgl;
+
+static bool Near(float a, float b, float tolerance = 1e-4f)
+{
+    return std::abs(a - b) <= tolerance;
+}
+
+static uint64_t Millis(double millis)
+{
+    return static_cast<uint64_t>(millis * 1e6);
+}
+
+// =============================================================================
+
+SGL_TEST(EmptyStagesAreZero)
+{
+    const FrameStats kStats;
+    SGL_CHECK_EQ(kStats.GetCount(FrameStage::Frame), 0u);
+    SGL_CHECK_EQ(kStats.GetMean(FrameStage::Frame), 0.0f);
+    SGL_CHECK_EQ(kStats.GetPercentile(FrameStage::Frame, 99.0f), 0.0f);
+    SGL_CHECK_EQ(kStats.GetSummary(FrameStage::Frame).samples, 0u);
+}
+
+SGL_TEST(SummarizesTheWindow)
+{
+    // 1 to 100 ms, shuffled, in the update stage only
+    FrameStats stats;
+    for (uint32_t i = 0; i < 100; ++i)
+        stats.Record(FrameStage::Update, Millis((i * 37) % 100 + 1));
+
+    const TimingSummary kSummary = stats.GetSummary(FrameStage::Update);
+    SGL_CHECK_EQ(kSummary.samples, 100u);
+    SGL_CHECK(Near(kSummary.mean, 50.5f));
+    // Population variance of 1..100
+    SGL_CHECK(Near(kSummary.stdDev, std::sqrt(833.25f), 1e-3f));
+    SGL_CHECK(Near(kSummary.min, 1.0f));
+    SGL_CHECK(Near(kSummary.max, 100.0f));
+    // Nearest rank of (count - 1) * p
+    SGL_CHECK(Near(kSummary.p50, 51.0f));
+    SGL_CHECK(Near(kSummary.p95, 95.0f));
+    SGL_CHECK(Near(kSummary.p99, 99.0f));
+    SGL_CHECK(Near(stats.GetLast(FrameStage::Update),
+                   float((99 * 37) % 100 + 1)));
+
+    SGL_CHECK_EQ(stats.GetCount(FrameStage::Render), 0u);
+}
+
+SGL_TEST(OldSamplesLeaveTheWindow)
+{
+    FrameStats stats;
+    for (uint32_t i = 0; i < FrameStats::WindowSize; ++i)
+        stats.Record(FrameStage::Frame, Millis(100.0));
+    for (uint32_t i = 0; i < FrameStats::WindowSize + 10; ++i)
+        stats.Record(FrameStage::Frame, Millis(4.0));
+
+    SGL_CHECK_EQ(stats.GetCount(FrameStage::Frame), FrameStats::WindowSize);
+    SGL_CHECK(Near(stats.GetMean(FrameStage::Frame), 4.0f));
+    SGL_CHECK(Near(stats.GetVariance(FrameStage::Frame), 0.0f, 1e-3f));
+    SGL_CHECK(Near(stats.GetPercentile(FrameStage::Frame, 100.0f), 4.0f));
+
+    // The oldest sample is at the offset
+    SGL_CHECK_EQ(stats.GetHistoryOffset(FrameStage::Frame), 10u);
+
+    stats.Clear();
+    SGL_CHECK_EQ(stats.GetCount(FrameStage::Frame), 0u);
+}
+
+SGL_TEST_MAIN()
@@ -0,0 +1,57 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "Test.h"
+
+#include <unordered_set>
+
+
+using namespace sgl;
+
+// =============================================================================
+
+SGL_TEST(HashesAreStable)
+{
+    // Cache keys are stored on disk, a change of the function drops them.
+    //  Values of little endian hosts.
+    const char kText[] = "The quick brown fox jumps over the lazy dog";
+    SGL_CHECK_EQ(Hash64(kText, sizeof(kText) - 1),
+                 uint64_t(0xEE0ACB7F9771E72Eull));
+    SGL_CHECK_EQ(Hash64(kText, sizeof(kText) - 1, 1),
+                 uint64_t(0xC9DF58A7DB48AB49ull));
+    SGL_CHECK_EQ(Hash64(kText, 0), Hash64("", 0));
+}
+
+SGL_TEST(EveryByteCounts)
+{
+    // Sizes around the 32-byte stripes and the 8-byte words
+    std::vector<unsigned char> bytes(200);
+    for (size_t i = 0; i < bytes.size(); ++i)
+        bytes[i] = static_cast<unsigned char>(i * 31);
+
+    for (const size_t kSize : { 1, 7, 8, 9, 31, 32, 33, 64, 100, 200 })
+    {
+        std::unordered_set<uint64_t> hashes;
+        hashes.insert(Hash64(bytes.data(), kSize));
+        hashes.insert(Hash64(bytes.data(), kSize - 1));
+        for (size_t i = 0; i < kSize; ++i)
+        {
+            bytes[i] ^= 1;
+            hashes.insert(Hash64(bytes.data(), kSize));
+            bytes[i] ^= 1;
+        }
+        SGL_CHECK_EQ(hashes.size(), kSize + 2);
+    }
+}
+
+SGL_TEST(DoesNotReadPastTheEnd)
+{
+    std::vector<unsigned char> bytes(64, 0xAA);
+    const uint64_t kHash = Hash64(bytes.data(), 40);
+    std::fill(bytes.begin() + 40, bytes.end(), 0x55);
+    SGL_CHECK_EQ(Hash64(bytes.data(), 40), kHash);
+}
+
+SGL_TEST_MAIN()
@@ -0,0 +1,161 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "Test.h"
+
+
+using namespace sgl;
+
+/**
+ * @brief Keeps the only thread of a queue in a callback, so that the
+ *  requests queued meanwhile are served in one known order
+ */
+class Blocker
+{
+public:
+    Blocker(IoQueue& queue, const std::string& path)
+    {
+        std::promise<void> started;
+        queue.Read(path, IoPriority::High,
+                   [this, &started](IoResult&&) {
+                       started.set_value();
+                       m_Release.get_future().wait();
+                   }, 0, 1);
+        started.get_future().wait();
+    }
+
+    /** @brief Releases the thread if a failed check ended the case */
+    ~Blocker()
+    {
+        if (!m_Released)
+            Release();
+    }
+
+    void Release()
+    {
+        m_Release.set_value();
+        m_Released = true;
+    }
+
+private:
+    std::promise<void> m_Release;
+    bool m_Released{ false };
+};
+
+// =============================================================================
+
+SGL_TEST(ReadsRanges)
+{
+    const std::string kPath = test::WriteFile(
+        "SGLIoQueueTest_ranges.bin", 100000);
+    const test::RemoveOnExit kPathRemoved(kPath);
+    IoQueue queue;
+
+    std::future<IoResult> whole = queue.ReadAsync(kPath,
+                                                  IoPriority::Normal);
+    std::future<IoResult> range = queue.ReadAsync(kPath, IoPriority::Normal,
+                                                  70000, 1000);
+    // Fewer bytes at the end of the file
+    std::future<IoResult> tail = queue.ReadAsync(kPath, IoPriority::Normal,
+                                                 99990, 100);
+    std::future<IoResult> past = queue.ReadAsync(kPath, IoPriority::Normal,
+                                                 200000, 10);
+    std::future<IoResult> missing = queue.ReadAsync(
+        test::TempPath("SGLIoQueueTest_missing.bin"), IoPriority::Normal);
+
+    const IoResult kWhole = whole.get();
+    SGL_CHECK(kWhole.Ok());
+    SGL_CHECK_EQ(kWhole.data.size(), size_t(100000));
+    SGL_CHECK(test::HasPattern(kWhole.data, 0));
+
+    const IoResult kRange = range.get();
+    SGL_CHECK(kRange.Ok());
+    SGL_CHECK_EQ(kRange.data.size(), size_t(1000));
+    SGL_CHECK(test::HasPattern(kRange.data, 70000));
+
+    const IoResult kTail = tail.get();
+    SGL_CHECK(kTail.Ok());
+    SGL_CHECK_EQ(kTail.data.size(), size_t(10));
+    SGL_CHECK(test::HasPattern(kTail.data, 99990));
+
+    SGL_CHECK(!past.get().Ok());
+    const IoResult kMissing = missing.get();
+    SGL_CHECK(kMissing.status == IoStatus::Failed);
+    SGL_CHECK(!kMissing.error.empty());
+
+    queue.WaitIdle();
+}
+
+SGL_TEST(MergesAdjacentRanges)
+{
+    const std::string kPath = test::WriteFile(
+        "SGLIoQueueTest_merge.bin", 50000);
+    const test::RemoveOnExit kPathRemoved(kPath);
+    IoQueue queue(1);
+
+    Blocker blocker(queue, kPath);
+    std::future<IoResult> first = queue.ReadAsync(kPath, IoPriority::Normal,
+                                                  0, 1000);
+    std::future<IoResult> second = queue.ReadAsync(kPath, IoPriority::Normal,
+                                                   20000, 1000);
+    blocker.Release();
+
+    const IoResult kFirst = first.get();
+    const IoResult kSecond = second.get();
+    SGL_CHECK(kFirst.Ok() && test::HasPattern(kFirst.data, 0));
+    SGL_CHECK(kSecond.Ok() && test::HasPattern(kSecond.data, 20000));
+    SGL_CHECK_EQ(kSecond.data.size(), size_t(1000));
+    SGL_CHECK_EQ(queue.GetMergedCount(), uint64_t(1));
+
+    queue.WaitIdle();
+}
+
+SGL_TEST(ServesByPriorityAndCancels)
+{
+    const std::string kPath = test::WriteFile(
+        "SGLIoQueueTest_priority.bin", 1000);
+    const std::string kOther = test::WriteFile(
+        "SGLIoQueueTest_priority2.bin", 1000);
+    const std::string kThird = test::WriteFile(
+        "SGLIoQueueTest_priority3.bin", 1000);
+    const test::RemoveOnExit kPathRemoved(kPath);
+    const test::RemoveOnExit kOtherRemoved(kOther);
+    const test::RemoveOnExit kThirdRemoved(kThird);
+    IoQueue queue(1);
+
+    std::mutex mutex;
+    std::vector<uint64_t> order;
+    std::vector<IoStatus> statuses;
+    auto Record = [&](IoResult&& result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(result.id);
+        statuses.push_back(result.status);
+    };
+
+    Blocker blocker(queue, kPath);
+    // Different files, not merged
+    const uint64_t kLow = queue.Read(kPath, IoPriority::Low, Record);
+    const uint64_t kHigh = queue.Read(kOther, IoPriority::High, Record);
+    const uint64_t kRaised = queue.Read(kThird, IoPriority::Low, Record);
+    const uint64_t kCancelled = queue.Read(kPath, IoPriority::High, Record,
+                                           500);
+
+    SGL_CHECK(queue.SetPriority(kRaised, IoPriority::Normal));
+    SGL_CHECK(queue.Cancel(kCancelled));
+    SGL_CHECK(!queue.Cancel(kCancelled));
+    SGL_CHECK_EQ(queue.GetQueuedCount(), size_t(3));
+
+    blocker.Release();
+    queue.WaitIdle();
+
+    // The cancelled one completes first, from "Cancel"
+    const std::vector<uint64_t> kOrder = { kCancelled, kHigh, kRaised, kLow };
+    SGL_CHECK(order == kOrder);
+    SGL_REQUIRE(statuses.size() == 4);
+    SGL_CHECK(statuses[0] == IoStatus::Cancelled);
+    SGL_CHECK(statuses[3] == IoStatus::Completed);
+}
+
+SGL_TEST_MAIN()
@@ -0,0 +1,52 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "Test.h"
+
+
+using namespace sgl;
+
+
+// =============================================================================
+
+SGL_TEST(MapsWholeFiles)
+{
+    const std::string kPath = test::WriteFile(
+        "SGLMappedFileTest_map.bin", 10000);
+    const test::RemoveOnExit kPathRemoved(kPath);
+
+    MappedFile file(kPath);
+    SGL_REQUIRE(file.IsOpen());
+    SGL_CHECK_EQ(file.GetSize(), size_t(10000));
+    SGL_CHECK(test::HasPattern(std::vector<unsigned char>(
+        file.GetData(), file.GetData() + file.GetSize()), 0));
+
+    // A move keeps the mapping
+    const unsigned char* const kData = file.GetData();
+    MappedFile moved = std::move(file);
+    SGL_CHECK(moved.IsOpen() && !file.IsOpen());
+    SGL_CHECK(moved.GetData() == kData);
+    SGL_CHECK_EQ(moved.GetView().size(), size_t(10000));
+
+    moved.Close();
+    SGL_CHECK(!moved.IsOpen());
+
+    const MappedFile kMissing(
+        test::TempPath("SGLMappedFileTest_missing.bin"));
+    SGL_CHECK(!kMissing.IsOpen());
+    SGL_CHECK(!kMissing.GetError().empty());
+}
+
+SGL_TEST(MapsEmptyFiles)
+{
+    const std::string kPath = test::WriteFile("SGLMappedFileTest_empty.bin", 0);
+    const test::RemoveOnExit kPathRemoved(kPath);
+
+    const MappedFile kFile(kPath);
+    SGL_CHECK(kFile.IsOpen());
+    SGL_CHECK_EQ(kFile.GetSize(), size_t(0));
+}
+
+SGL_TEST_MAIN()
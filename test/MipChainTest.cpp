@@ -0,0 +1,140 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#include "Test.h"
+
+#include <random>
+
+
+using namespace sgl;
+
+static std::vector<unsigned char> MakeNoise(uint32_t width, uint32_t height,
+                                            uint32_t channels)
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> value(0, 255);
+
+    std::vector<unsigned char> pixels(size_t(width) * height * channels);
+    for (unsigned char& pixel : pixels)
+        pixel = static_cast<unsigned char>(value(rng));
+    return pixels;
+}
+
+// =============================================================================
+
+SGL_TEST(CountsLevelsDownTo1x1)
+{
+    SGL_CHECK_EQ(GetMipLevelCount(1, 1), 1u);
+    SGL_CHECK_EQ(GetMipLevelCount(2, 1), 2u);
+    SGL_CHECK_EQ(GetMipLevelCount(256, 256), 9u);
+    SGL_CHECK_EQ(GetMipLevelCount(300, 20), 9u);
+    SGL_CHECK_EQ(GetMipLevelCount(1, 1024), 11u);
+}
+
+SGL_TEST(PacksLevelsLikeOpenGL)
+{
+    const std::vector<unsigned char> kPixels = MakeNoise(13, 6, 3);
+    const MipChain kChain = BuildMipChain(kPixels.data(), 13, 6, 3);
+
+    // Sizes halve and round down
+    const uint32_t kSizes[][2] = { { 13, 6 }, { 6, 3 }, { 3, 1 }, { 1, 1 } };
+    SGL_REQUIRE(kChain.GetLevelCount() == 4);
+    SGL_CHECK_EQ(kChain.channels, 3u);
+
+    size_t offset = 0;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        const MipLevel& kLevel = kChain.levels[i];
+        SGL_CHECK_EQ(kLevel.width, kSizes[i][0]);
+        SGL_CHECK_EQ(kLevel.height, kSizes[i][1]);
+        SGL_CHECK_EQ(kLevel.offset, offset);
+        SGL_CHECK_EQ(kLevel.size, size_t(kLevel.width) * kLevel.height * 3);
+        offset += kLevel.size;
+    }
+    SGL_CHECK_EQ(kChain.pixels.size(), offset);
+
+    // The base level is the image
+    SGL_CHECK(std::equal(kPixels.begin(), kPixels.end(),
+                         kChain.pixels.begin()));
+
+    MipChainSpec spec;
+    spec.maxLevels = 2;
+    SGL_CHECK_EQ(BuildMipChain(kPixels.data(), 13, 6, 3, spec)
+                     .GetLevelCount(), 2u);
+}
+
+SGL_TEST(BoxAveragesQuads)
+{
+    const unsigned char kPixels[] = {
+        0,   100,   10, 10,
+        200, 100,   30, 30 };
+    const MipChain kChain = BuildMipChain(kPixels, 4, 2, 1);
+
+    SGL_REQUIRE(kChain.GetLevelCount() == 3);
+    const unsigned char* kLevel1 = kChain.GetPixels(1);
+    SGL_CHECK_EQ(int(kLevel1[0]), 100);
+    SGL_CHECK_EQ(int(kLevel1[1]), 20);
+    SGL_CHECK_EQ(int(kChain.GetPixels(2)[0]), 60);
+}
+
+SGL_TEST(KeepsFlatImagesFlat)
+{
+    // Weights of every filter sum to 1, on odd sizes too
+    const std::vector<unsigned char> kPixels(size_t(37) * 21 * 4, 77);
+    for (const MipFilter kFilter : { MipFilter::Box, MipFilter::Kaiser })
+    {
+        MipChainSpec spec;
+        spec.filter = kFilter;
+        const MipChain kChain = BuildMipChain(kPixels.data(), 37, 21, 4,
+                                              spec);
+        SGL_CHECK(std::all_of(kChain.pixels.begin(), kChain.pixels.end(),
+                              [](unsigned char v) { return v == 77; }));
+    }
+}
+
+SGL_TEST(AveragesSRGBInLinearSpace)
+{
+    // Black and white, alpha 0 and 255
+    const unsigned char kPixels[] = { 0, 0, 0, 0,   255, 255, 255, 255 };
+
+    MipChainSpec spec;
+    spec.srgb = true;
+    const MipChain kSRGB = BuildMipChain(kPixels, 2, 1, 4, spec);
+    const MipChain kLinear = BuildMipChain(kPixels, 2, 1, 4);
+
+    // Linear 0.5 is 188 in sRGB, alpha is never converted
+    const unsigned char* kTexel = kSRGB.GetPixels(1);
+    SGL_CHECK_EQ(int(kTexel[0]), 188);
+    SGL_CHECK_EQ(int(kTexel[3]), 128);
+    SGL_CHECK_EQ(int(kLinear.GetPixels(1)[0]), 128);
+}
+
+SGL_TEST(SameLevelsOnAPool)
+{
+    const std::vector<unsigned char> kPixels = MakeNoise(300, 200, 4);
+    ThreadPool pool(4);
+
+    for (const MipFilter kFilter : { MipFilter::Box, MipFilter::Kaiser })
+    {
+        MipChainSpec spec;
+        spec.filter = kFilter;
+        spec.srgb = true;
+        const MipChain kSerial = BuildMipChain(kPixels.data(), 300, 200, 4,
+                                               spec);
+        const MipChain kParallel = BuildMipChain(kPixels.data(), 300, 200,
+                                                 4, spec, &pool);
+        SGL_CHECK(kSerial.pixels == kParallel.pixels);
+    }
+}
+
+SGL_TEST(RejectsInvalidImages)
+{
+    const unsigned char kPixels[4] = {};
+    SGL_CHECK(BuildMipChain(nullptr, 4, 4, 4).Empty());
+    SGL_CHECK(BuildMipChain(kPixels, 0, 1, 4).Empty());
+    SGL_CHECK(BuildMipChain(kPixels, 1, 1, 5).Empty());
+}
+
+SGL_TEST_MAIN()
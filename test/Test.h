@@ -0,0 +1,176 @@
+/**
+ *  Copyright (c) 2022 SGL authors Distributed under MIT License
+ * (http://opensource.org/licenses/MIT)
+ */
+
+#ifndef SGL_TEST_TEST_H_
+#define SGL_TEST_TEST_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <SGL/SGL.h>
+
+
+namespace sgl
+{
+    namespace test
+    {
+        struct Case
+        {
+            const char* name{ nullptr };
+            void (*function)(){ nullptr };
+        };
+
+        /** @brief Cases of the executable, in the order they are defined */
+        inline std::vector<Case>& GetCases()
+        {
+            static std::vector<Case> s_Cases;
+            return s_Cases;
+        }
+
+        /** @brief Failed checks of the running case */
+        inline uint32_t& GetFailures()
+        {
+            static uint32_t s_Failures = 0;
+            return s_Failures;
+        }
+
+        struct Registrar
+        {
+            Registrar(const char* name, void (*function)()) {
+                GetCases().push_back({ name, function });
+            }
+        };
+
+        inline void Fail(const char* file, int line, const std::string& what)
+        {
+            std::fprintf(stderr, "%s:%d: %s\n", file, line, what.c_str());
+            ++GetFailures();
+        }
+
+        /** @return Path of a file in the temporary directory */
+        inline std::string TempPath(const char* name)
+        {
+            return (std::filesystem::temp_directory_path() / name).string();
+        }
+
+        /** @return Path of a temporary file of "size" bytes, i % 251 */
+        inline std::string WriteFile(const char* name, size_t size)
+        {
+            std::vector<char> bytes(size);
+            for (size_t i = 0; i < size; ++i)
+                bytes[i] = static_cast<char>(i % 251);
+
+            const std::string kPath = TempPath(name);
+            std::ofstream file(kPath, std::ios::binary);
+            file.write(bytes.data(), static_cast<std::streamsize>(size));
+            return kPath;
+        }
+
+        /** @return Whether "data" is the "WriteFile" bytes from "offset" */
+        inline bool HasPattern(const std::vector<unsigned char>& data,
+                               uint64_t offset)
+        {
+            for (size_t i = 0; i < data.size(); ++i)
+            {
+                if (data[i] != (offset + i) % 251)
+                    return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Removes a file at the end of the scope, also when a
+         *  "SGL_REQUIRE" ends the case early
+         */
+        class RemoveOnExit
+        {
+        public:
+            explicit RemoveOnExit(std::string path)
+                : m_Path(std::move(path)) {}
+            ~RemoveOnExit()
+            {
+                std::error_code error;
+                std::filesystem::remove(m_Path, error);
+            }
+
+            RemoveOnExit(const RemoveOnExit&) = delete;
+            RemoveOnExit& operator=(const RemoveOnExit&) = delete;
+
+        private:
+            std::string m_Path;
+        };
+
+        /** @return Exit code, 1 if a check failed */
+        inline int RunAll()
+        {
+            Log::Init();
+            Log::SetLevel(SGL_LEVEL_WARN);
+
+            uint32_t failed = 0;
+            for (const Case& kCase : GetCases())
+            {
+                GetFailures() = 0;
+                kCase.function();
+
+                const bool kPassed = GetFailures() == 0;
+                std::printf("[%s] %s\n", kPassed ? "  OK  " : "FAILED",
+                            kCase.name);
+                if (!kPassed)
+                    ++failed;
+            }
+
+            std::printf("%zu cases, %u failed\n", GetCases().size(), failed);
+
+            Log::Shutdown();
+            return failed == 0 ? 0 : 1;
+        }
+    } // namespace test
+
+} // namespace sgl
+
+
+/** @brief Defines a case, run by "sgl::test::RunAll" */
+#define SGL_TEST(name)                                                      \
+    static void name();                                                     \
+    static const ::sgl::test::Registrar s_Registrar##name(#name, name);     \
+    static void name()
+
+/** @brief Records a failure and goes on with the case */
+#define SGL_CHECK(condition)                                                \
+    do {                                                                    \
+        if (!(condition))                                                   \
+            ::sgl::test::Fail(__FILE__, __LINE__, #condition);              \
+    } while (false)
+
+#define SGL_CHECK_EQ(a, b)                                                  \
+    do {                                                                    \
+        const auto kA = (a);                                                \
+        const auto kB = (b);                                                \
+        if (!(kA == kB))                                                    \
+        {                                                                   \
+            ::sgl::test::Fail(__FILE__, __LINE__, fmt::format(              \
+                "{} == {}, {} != {}", #a, #b, kA, kB));                     \
+        }                                                                   \
+    } while (false)
+
+/** @brief Ends the case, for checks the rest of it depends on */
+#define SGL_REQUIRE(condition)                                              \
+    do {                                                                    \
+        if (!(condition))                                                   \
+        {                                                                   \
+            ::sgl::test::Fail(__FILE__, __LINE__, #condition);              \
+            return;                                                         \
+        }                                                                   \
+    } while (false)
+
+#define SGL_TEST_MAIN()                                                     \
+    int main() { return ::sgl::test::RunAll(); }
+
+
+#endif // SGL_TEST_TEST_H_